@@ -0,0 +1,130 @@
+/**
+ * @file bench_layx.c
+ * @brief 布局基准：卡片网格 + 长列表，分别链接默认、16 位整数标量与 16 位 id 版本
+ *
+ * 用法：bench_layx [轮数]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "layx.h"
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// 卡片：标题 + 会换行的标签 + 右对齐的按钮
+static layx_id build_card(layx_context *ctx)
+{
+    layx_id card = layx_item(ctx);
+    layx_set_display(ctx, card, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(ctx, card, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_size(ctx, card, 140, 0);
+    layx_set_padding(ctx, card, 4);
+    layx_set_margin(ctx, card, 2);
+
+    layx_id title = layx_item(ctx);
+    layx_set_height(ctx, title, 14);
+    layx_append(ctx, card, title);
+
+    layx_id tags = layx_item(ctx);
+    layx_set_display(ctx, tags, LAYX_DISPLAY_FLEX);
+    layx_set_flex_wrap(ctx, tags, LAYX_FLEX_WRAP_WRAP);
+    layx_set_gap(ctx, tags, 2, 2);
+    layx_append(ctx, card, tags);
+    for (int i = 0; i < 5; i++) {
+        layx_id tag = layx_item(ctx);
+        layx_set_size(ctx, tag, (layx_scalar)(24 + 6 * i), 10);
+        layx_append(ctx, tags, tag);
+    }
+
+    layx_id footer = layx_item(ctx);
+    layx_set_display(ctx, footer, LAYX_DISPLAY_FLEX);
+    layx_set_justify_content(ctx, footer, LAYX_JUSTIFY_SPACE_BETWEEN);
+    layx_append(ctx, card, footer);
+    for (int i = 0; i < 2; i++) {
+        layx_id button = layx_item(ctx);
+        layx_set_size(ctx, button, 30, 12);
+        layx_set_flex_grow(ctx, button, 0.5f);
+        layx_append(ctx, footer, button);
+    }
+    return card;
+}
+
+// 根为 flex 行：左侧卡片网格（wrap），右侧固定宽度的列表（block）
+// 坐标保持在 16 位整数范围内
+static void build_scene(layx_context *ctx, int cards, int rows)
+{
+    layx_id root = layx_item(ctx);
+    layx_set_display(ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_size(ctx, root, 1920, 0);
+
+    layx_id grid = layx_item(ctx);
+    layx_set_display(ctx, grid, LAYX_DISPLAY_FLEX);
+    layx_set_flex_wrap(ctx, grid, LAYX_FLEX_WRAP_WRAP);
+    layx_set_flex_grow(ctx, grid, 1);
+    layx_append(ctx, root, grid);
+    for (int i = 0; i < cards; i++) {
+        layx_append(ctx, grid, build_card(ctx));
+    }
+
+    layx_id list = layx_item(ctx);
+    layx_set_display(ctx, list, LAYX_DISPLAY_BLOCK);
+    layx_set_width(ctx, list, 320);
+    layx_set_padding(ctx, list, 4);
+    layx_append(ctx, root, list);
+    for (int i = 0; i < rows; i++) {
+        layx_id row = layx_item(ctx);
+        layx_set_display(ctx, row, LAYX_DISPLAY_FLEX);
+        layx_set_height(ctx, row, 16);
+        layx_append(ctx, list, row);
+        for (int c = 0; c < 3; c++) {
+            layx_id cell = layx_item(ctx);
+            layx_set_flex_grow(ctx, cell, (float)(c + 1));
+            layx_append(ctx, row, cell);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const int rounds = argc > 1 ? atoi(argv[1]) : 200;
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    build_scene(&ctx, 1200, 1500);
+    const layx_id count = layx_items_count(&ctx);
+
+    layx_run_context(&ctx);     // 预热
+    uint64_t best = UINT64_MAX, total = 0;
+    for (int r = 0; r < rounds; r++) {
+        layx_mark_dirty(&ctx, 0);
+        const uint64_t start = bench_now_ns();
+        layx_run_context(&ctx);
+        const uint64_t elapsed = bench_now_ns() - start;
+        total += elapsed;
+        if (elapsed < best) best = elapsed;
+    }
+
+    layx_vec4 rect = layx_get_rect(&ctx, 0);
+    printf("scalar: %s, id: %d bits\n", LAYX_FLOAT == 1 ? "float" : "int16", LAYX_ID_BITS);
+    printf("items: %u, sizeof(layx_item_t)=%u, sizeof(layx_vec4)=%u\n",
+           (unsigned)count, (unsigned)sizeof(layx_item_t), (unsigned)sizeof(layx_vec4));
+    printf("item + rect memory: %.1f KiB\n",
+           (double)count * (double)(sizeof(layx_item_t) + sizeof(layx_vec4)) / 1024.0);
+    printf("box records: %u in use, %.1f KiB\n",
+           (unsigned)(ctx.boxes.count > 0 ? ctx.boxes.count - 1 - ctx.boxes.free_count : 0),
+           (double)ctx.boxes.capacity * (double)sizeof(layx_box) / 1024.0);
+    printf("root: %.0f x %.0f\n", (double)rect[2], (double)rect[3]);
+    printf("layout: best %.3f ms, mean %.3f ms, %.1f ns/item (%d rounds)\n",
+           (double)best / 1e6, (double)total / rounds / 1e6, (double)best / count, rounds);
+
+    layx_destroy_context(&ctx);
+    return 0;
+}
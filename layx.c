@@ -7,6 +7,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
 
 #ifndef LAYX_REALLOC
 #define LAYX_REALLOC(_block, _size) realloc(_block, _size)
@@ -17,6 +18,9 @@
 #define LAYX_MEMSET(_dst, _val, _size) memset(_dst, _val, _size)
 #endif
 
+// 统计计数只在 layx_set_stats_enabled 打开后记录
+#define LAYX_STATS_COUNT(_ctx, _field) do { if ((_ctx)->stats_enabled) (_ctx)->stats._field++; } while (0)
+
 #if defined(__GNUC__) || defined(__clang__)
 #define LAYX_FORCE_INLINE __attribute__((always_inline)) inline
 #ifdef __cplusplus
@@ -45,9 +49,15 @@ static LAYX_FORCE_INLINE float layx_float_max(float a, float b)
 { return a > b ? a : b; }
 static LAYX_FORCE_INLINE float layx_float_min(float a, float b)
 { return a < b ? a : b; }
+static LAYX_FORCE_INLINE float layx_float_abs(float a)
+{ return a < 0 ? -a : a; }
+
+// 没有 max-width/max-height 时的上限
+#define LAYX_FLEX_NO_MAX 1e30f
 
 // Helper functions to convert new enums to internal flags
 static LAYX_FORCE_INLINE uint32_t layx_display_to_flags(layx_display display) {
+    if (display == LAYX_DISPLAY_GRID) return LAYX_DISPLAY_GRID_BIT;
     return ((uint32_t)display & 0x3) << 2;  // Bits 2-3 for display type
 }
 
@@ -89,9 +99,56 @@ typedef enum {
 #define END_SIDE(dim) ((dim) == DIM_WIDTH ? TRBL_RIGHT: TRBL_BOTTOM)
 #define POINT_DIM(dim) ((dim) == DIM_WIDTH ? XYWH_X : XYWH_Y)
 #define SIZE_DIM(dim)    ((dim) == DIM_WIDTH ? XYWH_WIDTH : XYWH_HEIGHT)
+
+// 容器的布局策略：由 display、flex-direction、flex-wrap 推导，在这些属性修改时写入
+// flags 的 LAYX_ITEM_STRATEGY_MASK 位，布局时不再逐项解码。
+// 新 item 的 flags 为 0，对应 BLOCK（与 display: none 的处理相同）
+typedef enum {
+    LAYX_STRATEGY_BLOCK = 0,
+    LAYX_STRATEGY_INLINE,
+    LAYX_STRATEGY_INLINE_BLOCK,
+    LAYX_STRATEGY_GRID,
+    LAYX_STRATEGY_FLEX_ROW,
+    LAYX_STRATEGY_FLEX_COLUMN,
+    LAYX_STRATEGY_FLEX_ROW_WRAP,
+    LAYX_STRATEGY_FLEX_COLUMN_WRAP,
+    LAYX_STRATEGY_COUNT
+} layx_strategy;
+
+#define LAYX_STRATEGY_SHIFT 28
+
+static LAYX_FORCE_INLINE layx_strategy layx_get_strategy(uint32_t flags)
+{
+    return (layx_strategy)((flags & LAYX_ITEM_STRATEGY_MASK) >> LAYX_STRATEGY_SHIFT);
+}
+
+static layx_strategy layx_resolve_strategy(uint32_t flags)
+{
+    switch (layx_get_display_from_flags(flags)) {
+    case LAYX_DISPLAY_INLINE: return LAYX_STRATEGY_INLINE;
+    case LAYX_DISPLAY_INLINE_BLOCK: return LAYX_STRATEGY_INLINE_BLOCK;
+    case LAYX_DISPLAY_GRID: return LAYX_STRATEGY_GRID;
+    case LAYX_DISPLAY_FLEX: {
+        const bool is_row = layx_get_direction_dim(flags) == 0;
+        if ((flags & LAYX_FLEX_WRAP_MASK) != LAYX_FLEX_WRAP_NOWRAP) {
+            return is_row ? LAYX_STRATEGY_FLEX_ROW_WRAP : LAYX_STRATEGY_FLEX_COLUMN_WRAP;
+        }
+        return is_row ? LAYX_STRATEGY_FLEX_ROW : LAYX_STRATEGY_FLEX_COLUMN;
+    }
+    default: return LAYX_STRATEGY_BLOCK;
+    }
+}
+
+// display / flex-direction / flex-wrap 修改后调用
+static LAYX_FORCE_INLINE uint32_t layx_update_strategy(uint32_t flags)
+{
+    return (flags & ~LAYX_ITEM_STRATEGY_MASK) | ((uint32_t)layx_resolve_strategy(flags) << LAYX_STRATEGY_SHIFT);
+}
+
 // Context management
 void layx_init_context(layx_context *ctx)
 {
+    LAYX_MEMSET(ctx, 0, sizeof(layx_context));
     ctx->capacity = 0;
     ctx->count = 0;
     ctx->items = NULL;
@@ -100,14 +157,41 @@ void layx_init_context(layx_context *ctx)
     ctx->free_list_head = LAYX_INVALID_ID;
 }
 
+extern void layx_snapshot_release(layx_context *ctx);
+
+// items 与 rects 共用一块内存：[items x capacity][rects x capacity]
+// 扩容后 rects 的起点后移，需要把已有的 rects 搬到新位置
+static void layx_grow_storage(layx_context *ctx, uint32_t capacity)
+{
+    // 16 位 id 时按倍数扩容会超出 id 范围
+    if (capacity > LAYX_MAX_ITEMS) capacity = LAYX_MAX_ITEMS;
+    const size_t item_size = sizeof(layx_item_t) + sizeof(layx_vec4);
+    const layx_id old_capacity = ctx->capacity;
+    layx_item_t *items;
+    LAYX_STATS_COUNT(ctx, grow_events);
+    if (ctx->storage_kind != LAYX_STORAGE_OWNED) {
+        // 快照存储不能 realloc，复制到自有内存后释放映射
+        items = (layx_item_t*)LAYX_REALLOC(NULL, capacity * item_size);
+        memcpy(items, ctx->items, old_capacity * sizeof(layx_item_t));
+        memcpy(items + capacity, ctx->rects, old_capacity * sizeof(layx_vec4));
+        layx_snapshot_release(ctx);
+    } else {
+        items = (layx_item_t*)LAYX_REALLOC(ctx->items, capacity * item_size);
+        if (old_capacity > 0) {
+            memmove(items + capacity, items + old_capacity, old_capacity * sizeof(layx_vec4));
+        }
+    }
+    ctx->items = items;
+    ctx->capacity = (layx_id)capacity;
+    const layx_item_t *past_last = ctx->items + ctx->capacity;
+    ctx->rects = (layx_vec4*)past_last;
+}
+
 void layx_reserve_items_capacity(layx_context *ctx, layx_id count)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_RESERVE, LAYX_INVALID_ID, (uint32_t)count);
     if (count >= ctx->capacity) {
-        ctx->capacity = count;
-        const size_t item_size = sizeof(layx_item_t) + sizeof(layx_vec4);
-        ctx->items = (layx_item_t*)LAYX_REALLOC(ctx->items, ctx->capacity * item_size);
-        const layx_item_t *past_last = ctx->items + ctx->capacity;
-        ctx->rects = (layx_vec4*)past_last;
+        layx_grow_storage(ctx, count);
     }
 }
 
@@ -126,11 +210,11 @@ void layx_dump_tree(layx_context *layout_ctx, layx_id layout_id, int indent){
     const char* overflow_y_str = layx_get_overflow_string((layx_overflow)item->overflow_y);
 
     LAYX_DEBUG_PRINT("%*s<lay_item_%d: xywh=[%.1f, %.1f, %.1f, %.1f] margin=[%.1f, %.1f, %.1f, %.1f] padding=[%.1f, %.1f, %.1f, %.1f]",
-        indent, "", layout_id, x, y, width, height, l, t, r, b, padding_l, padding_t, padding_r, padding_b);
+        indent, "", layout_id, (double)x, (double)y, (double)width, (double)height, (double)l, (double)t, (double)r, (double)b, (double)padding_l, (double)padding_t, (double)padding_r, (double)padding_b);
     LAYX_DEBUG_PRINT(" PROP=%s|overflow-x:%s|overflow-y:%s",layx_get_layout_properties_string(layout_ctx, layout_id), overflow_x_str, overflow_y_str);
     bool fixed_width = item->flags & LAYX_SIZE_FIXED_WIDTH;
     bool fixed_height = item->flags & LAYX_SIZE_FIXED_HEIGHT;
-    LAYX_DEBUG_PRINT(" initial_w=%.1f initial_h=%.1f fixed_width:%s fixed_height=%s>\n",item->size[0],item->size[1], fixed_width ? "YES" : "NO", fixed_height ? "YES" : "NO");
+    LAYX_DEBUG_PRINT(" initial_w=%.1f initial_h=%.1f fixed_width:%s fixed_height=%s>\n",(double)item->size[0],(double)item->size[1], fixed_width ? "YES" : "NO", fixed_height ? "YES" : "NO");
     layx_id child = item->first_child;
     while (child != LAYX_INVALID_ID) {
         layx_dump_tree(layout_ctx, child, indent + 2);
@@ -138,31 +222,407 @@ void layx_dump_tree(layx_context *layout_ctx, layx_id layout_id, int indent){
         child = child_item->next_sibling;
     }
 }
+extern void layx_delta_release(layx_context *ctx);
+extern void layx_delta_on_create(layx_context *ctx, layx_id item);
+extern void layx_delta_on_destroy(layx_context *ctx, layx_id item);
+extern void layx_frames_release(layx_context *ctx);
+extern void layx_frames_invalidate(layx_context *ctx);
+extern void layx_frames_touch(layx_context *ctx, layx_id item, bool subtree);
+
 void layx_destroy_context(layx_context *ctx)
 {
-    if (ctx->items != NULL) {
+    // 先结束记录，下面的清理调用不写入日志
+    layx_record_end(ctx);
+    if (ctx->storage_kind != LAYX_STORAGE_OWNED) {
+        layx_snapshot_release(ctx);
+    } else if (ctx->items != NULL) {
         LAYX_FREE(ctx->items);
-        ctx->items = NULL;
-        ctx->rects = NULL;
+    }
+    ctx->items = NULL;
+    ctx->rects = NULL;
+    ctx->capacity = 0;
+    ctx->count = 0;
+    layx_delta_release(ctx);
+    layx_frames_release(ctx);
+    layx_trace_end(ctx);
+    LAYX_FREE(ctx->lines.lines);
+    LAYX_FREE(ctx->lines.items);
+    LAYX_FREE(ctx->boundaries.ids);
+    LAYX_MEMSET(&ctx->boundaries, 0, sizeof(layx_boundary_list));
+    LAYX_MEMSET(&ctx->lines, 0, sizeof(layx_flex_lines));
+    for (uint32_t i = 1; i < ctx->styles.count; ++i) {
+        LAYX_FREE(ctx->styles.records[i].user_ids);
+    }
+    LAYX_FREE(ctx->styles.records);
+    LAYX_FREE(ctx->styles.slots);
+    LAYX_MEMSET(&ctx->styles, 0, sizeof(layx_style_table));
+    for (uint32_t i = 0; i < ctx->grids.capacity; ++i) {
+        layx_grid *grid = ctx->grids.records + i;
+        for (int dim = 0; dim < 2; ++dim) {
+            LAYX_FREE(grid->tracks[dim]);
+            LAYX_FREE(grid->offsets[dim]);
+        }
+    }
+    LAYX_FREE(ctx->grids.records);
+    LAYX_FREE(ctx->grids.scratch);
+    LAYX_MEMSET(&ctx->grids, 0, sizeof(layx_grid_table));
+    layx_set_memo_capacity(ctx, 0);
+    LAYX_FREE(ctx->memo.roots);
+    LAYX_MEMSET(&ctx->memo, 0, sizeof(layx_memo_table));
+    LAYX_FREE(ctx->boxes.records);
+    LAYX_FREE(ctx->boxes.free);
+    LAYX_MEMSET(&ctx->boxes, 0, sizeof(layx_box_table));
+    LAYX_FREE(ctx->observers.records);
+    LAYX_FREE(ctx->observers.free);
+    LAYX_FREE(ctx->observers.queue);
+    LAYX_MEMSET(&ctx->observers, 0, sizeof(layx_observer_table));
+}
+
+// 清除与当前这棵树的 item id 绑定的状态（分步布局、flex 行、脏边界、grid 与缓存根的归属、
+// 盒模型与观察记录、样式引用计数），items 本身由调用者处理。layx_reset_context 与加载快照共用
+void layx_clear_tree_state(layx_context *ctx)
+{
+    ctx->step.phase = LAYX_PHASE_IDLE;
+    ctx->lines.count = 0;
+    ctx->boundaries.count = 0;
+    // grid 记录的轨道缓冲区保留给之后分配的记录复用
+    for (uint32_t i = 1; i < ctx->grids.count; ++i) {
+        ctx->grids.records[i].owner = LAYX_INVALID_ID;
+    }
+    // 缓存的结果与 item id 无关，重建的树仍可命中
+    for (uint32_t i = 1; i < ctx->memo.root_count; ++i) {
+        ctx->memo.roots[i].owner = LAYX_INVALID_ID;
+    }
+    if (ctx->boxes.count > 1) ctx->boxes.count = 1;
+    ctx->boxes.free_count = 0;
+    if (ctx->observers.count > 1) ctx->observers.count = 1;
+    ctx->observers.free_count = 0;
+    ctx->observers.queue_count = 0;
+    if (ctx->delta.enabled) {
+        layx_delta_request_keyframe(ctx);
+    }
+    // 修改记录引用旧的 id，之后每个槽位整帧复制一次
+    if (ctx->frames.enabled) {
+        layx_frames_invalidate(ctx);
+    }
+    // 样式记录保留，供重建的 item 继续引用
+    for (uint32_t i = 1; i < ctx->styles.count; ++i) {
+        ctx->styles.records[i].users = 0;
+        ctx->styles.records[i].user_count = 0;
+        ctx->styles.records[i].box = 0;     // 盒模型记录已随上面的表一起清空，下次共享时重新分配
     }
 }
 
 void layx_reset_context(layx_context *ctx)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_RESET, LAYX_INVALID_ID);
     ctx->count = 0;
     ctx->free_list_head = LAYX_INVALID_ID;
+    layx_clear_tree_state(ctx);
+}
+
+// 盒模型记录
+// 三组都为 0 的 item 没有记录；某组变为非 0 时分配，三组都回到 0 或 item 销毁时释放
+static uint32_t layx_box_alloc(layx_context *ctx)
+{
+    layx_box_table *table = &ctx->boxes;
+    uint32_t index;
+    if (table->free_count > 0) {
+        index = table->free[--table->free_count];
+    } else {
+        if (table->count == 0) table->count = 1;
+        if (table->count >= table->capacity) {
+            const uint32_t capacity = table->capacity < 1 ? 32 : table->capacity * 2;
+            LAYX_STATS_COUNT(ctx, grow_events);
+            table->records = (layx_box*)LAYX_REALLOC(table->records, capacity * sizeof(layx_box));
+            LAYX_MEMSET(table->records, 0, sizeof(layx_box));
+            table->capacity = capacity;
+        }
+        index = table->count++;
+    }
+    LAYX_MEMSET(table->records + index, 0, sizeof(layx_box));
+    return index;
+}
+
+// 引用共享样式且没有本地覆盖盒模型的 item 直接使用样式的记录（见 layx_style_share_box）
+static LAYX_FORCE_INLINE bool layx_box_shared(const layx_context *ctx, const layx_item_t *pitem)
+{
+    return pitem->box != 0 && pitem->style_id != LAYX_NO_STYLE && ctx->styles.records[pitem->style_id].box == pitem->box;
+}
+
+static void layx_box_release(layx_context *ctx, layx_item_t *pitem)
+{
+    layx_box_table *table = &ctx->boxes;
+    if (layx_box_shared(ctx, pitem)) {
+        pitem->box = 0;
+        pitem->box_mask = 0;
+        return;
+    }
+    if (table->free_count >= table->free_capacity) {
+        table->free_capacity = table->free_capacity < 1 ? 32 : table->free_capacity * 2;
+        LAYX_STATS_COUNT(ctx, grow_events);
+        table->free = (uint32_t*)LAYX_REALLOC(table->free, table->free_capacity * sizeof(uint32_t));
+    }
+    table->free[table->free_count++] = pitem->box;
+    pitem->box = 0;
+    pitem->box_mask = 0;
+}
+
+// 共享的记录换成本地副本，之后的修改只影响这个 item
+static void layx_box_unshare(layx_context *ctx, layx_item_t *pitem)
+{
+    const uint32_t shared = pitem->box;
+    pitem->box = 0;
+    if (pitem->box_mask == 0) return;
+    pitem->box = layx_box_alloc(ctx);
+    ctx->boxes.records[pitem->box] = ctx->boxes.records[shared];
+}
+
+static void layx_store_box(layx_context *ctx, layx_item_t *pitem, int kind, layx_vec4 value)
+{
+    const uint8_t bit = (uint8_t)(1u << kind);
+    if (layx_box_shared(ctx, pitem)) layx_box_unshare(ctx, pitem);
+    if (value[0] == 0 && value[1] == 0 && value[2] == 0 && value[3] == 0) {
+        if (!(pitem->box_mask & bit)) return;
+        pitem->box_mask &= (uint8_t)~bit;
+        if (pitem->box_mask == 0) {
+            layx_box_release(ctx, pitem);
+            return;
+        }
+    } else {
+        if (pitem->box_mask == 0) pitem->box = layx_box_alloc(ctx);
+        pitem->box_mask |= bit;
+    }
+    ctx->boxes.records[pitem->box].trbl[kind] = value;
+}
+
+// 尺寸观察记录：layx_observe 时分配，停止观察或 item 销毁时释放。
+// 释放的记录可能仍在待取队列中，取走时按 item 与 queued 跳过
+static uint32_t layx_observer_alloc(layx_context *ctx)
+{
+    layx_observer_table *table = &ctx->observers;
+    uint32_t index;
+    if (table->free_count > 0) {
+        index = table->free[--table->free_count];
+    } else {
+        if (table->count == 0) table->count = 1;
+        if (table->count >= table->capacity) {
+            const uint32_t capacity = table->capacity < 1 ? 32 : table->capacity * 2;
+            LAYX_STATS_COUNT(ctx, grow_events);
+            table->records = (layx_observer*)LAYX_REALLOC(table->records, capacity * sizeof(layx_observer));
+            LAYX_MEMSET(table->records, 0, sizeof(layx_observer));
+            table->records[0].item = LAYX_INVALID_ID;
+            table->capacity = capacity;
+        }
+        index = table->count++;
+    }
+    LAYX_MEMSET(table->records + index, 0, sizeof(layx_observer));
+    return index;
+}
+
+// item 及其所有缓存根祖先的 observed 计数加 delta
+static void layx_memo_observed_add(layx_context *ctx, layx_id item, int32_t delta)
+{
+    if (ctx->memo.root_count <= 1) return;
+    for (layx_id node = item; node != LAYX_INVALID_ID; node = ctx->items[node].parent) {
+        const uint32_t memo = ctx->items[node].memo;
+        if (memo != 0) ctx->memo.roots[memo].observed += (uint32_t)delta;
+    }
+}
+
+static void layx_observer_release(layx_context *ctx, layx_item_t *pitem)
+{
+    layx_memo_observed_add(ctx, (layx_id)(pitem - ctx->items), -1);
+    layx_observer_table *table = &ctx->observers;
+    if (table->free_count >= table->free_capacity) {
+        table->free_capacity = table->free_capacity < 1 ? 32 : table->free_capacity * 2;
+        LAYX_STATS_COUNT(ctx, grow_events);
+        table->free = (uint32_t*)LAYX_REALLOC(table->free, table->free_capacity * sizeof(uint32_t));
+    }
+    table->records[pitem->observer].item = LAYX_INVALID_ID;
+    table->free[table->free_count++] = pitem->observer;
+    pitem->observer = 0;
+}
+
+// Grid 记录
+// 按需为 grid 容器分配，item 销毁时释放（缓冲区留给下一个记录复用）
+static layx_grid *layx_grid_ensure(layx_context *ctx, layx_id item)
+{
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    if (pitem->grid != 0) {
+        return ctx->grids.records + pitem->grid;
+    }
+    layx_grid_table *table = &ctx->grids;
+    uint32_t index = 0;
+    for (uint32_t i = 1; i < table->count; ++i) {
+        if (table->records[i].owner == LAYX_INVALID_ID) {
+            index = i;
+            break;
+        }
+    }
+    if (index == 0) {
+        if (table->count == 0) table->count = 1;
+        if (table->count >= table->capacity) {
+            const uint32_t capacity = table->capacity < 1 ? 8 : table->capacity * 2;
+            LAYX_STATS_COUNT(ctx, grow_events);
+            table->records = (layx_grid*)LAYX_REALLOC(table->records, capacity * sizeof(layx_grid));
+            LAYX_MEMSET(table->records + table->capacity, 0, (capacity - table->capacity) * sizeof(layx_grid));
+            table->capacity = capacity;
+        }
+        index = table->count++;
+    }
+    layx_grid *grid = table->records + index;
+    grid->owner = item;
+    for (int dim = 0; dim < 2; ++dim) {
+        grid->track_count[dim] = 0;
+        grid->resolved_count[dim] = 0;
+        grid->cached[dim] = false;
+    }
+    grid->rows_cached = false;
+    pitem->grid = index;
+    return grid;
+}
+
+static void layx_grid_copy_tracks(layx_grid *grid, int dim, const layx_grid_track *tracks, uint32_t count)
+{
+    if (count > grid->track_capacity[dim]) {
+        grid->tracks[dim] = (layx_grid_track*)LAYX_REALLOC(grid->tracks[dim], count * sizeof(layx_grid_track));
+        grid->track_capacity[dim] = count;
+    }
+    if (count > 0) {
+        memcpy(grid->tracks[dim], tracks, count * sizeof(layx_grid_track));
+    }
+    grid->track_count[dim] = count;
+    grid->cached[dim] = false;
+    // 行数取决于列数和行定义
+    grid->rows_cached = false;
+}
+
+// 加载快照时恢复第 index 条 grid 记录（与快照中 item->grid 一致），调用前 layx_clear_tree_state 已释放全部记录
+void layx_grid_restore(layx_context *ctx, uint32_t index, layx_id owner, const layx_grid_track *const tracks[2], const uint32_t counts[2])
+{
+    layx_grid_table *table = &ctx->grids;
+    if (index >= table->capacity) {
+        uint32_t capacity = table->capacity < 1 ? 8 : table->capacity;
+        while (capacity <= index) capacity *= 2;
+        LAYX_STATS_COUNT(ctx, grow_events);
+        table->records = (layx_grid*)LAYX_REALLOC(table->records, capacity * sizeof(layx_grid));
+        LAYX_MEMSET(table->records + table->capacity, 0, (capacity - table->capacity) * sizeof(layx_grid));
+        table->capacity = capacity;
+    }
+    if (table->count <= index) {
+        for (uint32_t i = table->count; i < index; ++i) table->records[i].owner = LAYX_INVALID_ID;
+        table->count = index + 1;
+    }
+    layx_grid *grid = table->records + index;
+    grid->owner = owner;
+    for (int dim = 0; dim < 2; ++dim) {
+        layx_grid_copy_tracks(grid, dim, tracks[dim], counts[dim]);
+        grid->resolved_count[dim] = 0;
+    }
+}
+
+// 脏的 grid 在本轮布局前可能增删了子元素或改变了子元素的单元格，行数需要重新统计
+static LAYX_FORCE_INLINE void layx_grid_forget_rows(layx_context *ctx, const layx_item_t *pitem)
+{
+    if (pitem->grid != 0 && (pitem->flags & LAYX_ITEM_DIRTY)) {
+        ctx->grids.records[pitem->grid].rows_cached = false;
+    }
+}
+
+// 缓存根记录，与 grid 记录一样按需分配、销毁时释放
+static layx_memo_root *layx_memo_ensure(layx_context *ctx, layx_id item)
+{
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_memo_table *table = &ctx->memo;
+    if (pitem->memo != 0) {
+        return table->roots + pitem->memo;
+    }
+    uint32_t index = 0;
+    for (uint32_t i = 1; i < table->root_count; ++i) {
+        if (table->roots[i].owner == LAYX_INVALID_ID) {
+            index = i;
+            break;
+        }
+    }
+    if (index == 0) {
+        if (table->root_count == 0) table->root_count = 1;
+        if (table->root_count >= table->root_capacity) {
+            const uint32_t capacity = table->root_capacity < 1 ? 8 : table->root_capacity * 2;
+            LAYX_STATS_COUNT(ctx, grow_events);
+            table->roots = (layx_memo_root*)LAYX_REALLOC(table->roots, capacity * sizeof(layx_memo_root));
+            LAYX_MEMSET(table->roots + table->root_capacity, 0, (capacity - table->root_capacity) * sizeof(layx_memo_root));
+            table->root_capacity = capacity;
+        }
+        index = table->root_count++;
+    }
+    layx_memo_root *root = table->roots + index;
+    LAYX_MEMSET(root, 0, sizeof(layx_memo_root));
+    root->owner = item;
+    pitem->memo = index;
+    return root;
 }
 
 // Layout calculation declarations
+// 两者只处理单个 item：calc_size 按后序、arrange 按先序由遍历引擎驱动
 static void layx_calc_size(layx_context *ctx, layx_id item, int dim);
 static void layx_arrange(layx_context *ctx, layx_id item, int dim);
+static void layx_run_boundary(layx_context *ctx, layx_id item);
+static void layx_memo_calc(layx_context *ctx, layx_id item, int dim);
+static void layx_memo_arrange(layx_context *ctx, layx_id item, int dim);
+static void layx_stats_begin_run(layx_context *ctx);
+static void layx_stats_end_run(layx_context *ctx);
+static void layx_style_add_user(layx_context *ctx, layx_style_id style, layx_id item);
+
+// 布局边界：内部的变化不会影响边界之外的布局。
+// 绝对定位的 item 不参与父元素的布局；contain 的 item 按没有内容计算尺寸；
+// 宽高都固定且两个方向都不溢出显示的 item 尺寸本来就与内容无关
+static LAYX_FORCE_INLINE bool layx_item_is_layout_boundary(const layx_item_t *pitem)
+{
+    if (pitem->flags & (LAYX_ITEM_ABSOLUTE | LAYX_ITEM_CONTAIN)) return true;
+    return (pitem->flags & LAYX_SIZE_FIXED_MASK) == LAYX_SIZE_FIXED_MASK
+        && pitem->size[0] > 0 && pitem->size[1] > 0
+        && pitem->overflow_x != LAYX_OVERFLOW_VISIBLE && pitem->overflow_y != LAYX_OVERFLOW_VISIBLE;
+}
 
 void layx_run_context(layx_context *ctx)
 {
     LAYX_ASSERT(ctx != NULL);
+    LAYX_RECORD_CALL(ctx, LAYX_REC_RUN_CONTEXT, LAYX_INVALID_ID);
     if (ctx->count > 0) {
+        LAYX_RECORD_MUTE(ctx, 1);
         layx_run_item(ctx, 0);
+        LAYX_RECORD_MUTE(ctx, -1);
+    }
+    // 完整布局后，未完成的分步布局和登记的脏边界都不再需要
+    ctx->step.phase = LAYX_PHASE_IDLE;
+    ctx->boundaries.count = 0;
+}
+
+void layx_run_dirty(layx_context *ctx)
+{
+    LAYX_ASSERT(ctx != NULL);
+    LAYX_RECORD_CALL(ctx, LAYX_REC_RUN_DIRTY, LAYX_INVALID_ID);
+    if (ctx->count == 0) return;
+    if (ctx->items[0].flags & LAYX_ITEM_DIRTY) {
+        LAYX_RECORD_MUTE(ctx, 1);
+        layx_run_context(ctx);
+        LAYX_RECORD_MUTE(ctx, -1);
+        return;
+    }
+    // 已被销毁（或随 shrink_to_fit 截掉）、移出树、不再是边界或已经布局过的登记项直接跳过
+    layx_stats_begin_run(ctx);
+    const layx_boundary_list *boundaries = &ctx->boundaries;
+    for (uint32_t i = 0; i < boundaries->count; ++i) {
+        const layx_id item = boundaries->ids[i];
+        if (item >= ctx->count) continue;
+        const layx_item_t *pitem = ctx->items + item;
+        if ((pitem->flags & LAYX_ITEM_DIRTY) && pitem->parent != LAYX_INVALID_ID && layx_item_is_layout_boundary(pitem)) {
+            layx_run_boundary(ctx, item);
+        }
     }
+    ctx->boundaries.count = 0;
+    layx_stats_end_run(ctx);
 }
 
 
@@ -179,12 +639,14 @@ static void layx_update_scroll_fields(layx_context *ctx, layx_id item) {
     pitem->has_scrollbars = 0;
     
     // 2. 计算客户区尺寸（内容区域，不包含 padding 和 border）
+    const layx_vec4 padding = layx_item_box(ctx, pitem, LAYX_BOX_PADDING);
+    const layx_vec4 border = layx_item_box(ctx, pitem, LAYX_BOX_BORDER);
     layx_scalar client_width = rect[XYWH_WIDTH] - 
-                               pitem->padding_trbl[TRBL_LEFT] - pitem->padding_trbl[TRBL_RIGHT] -
-                               pitem->border_trbl[TRBL_LEFT] - pitem->border_trbl[TRBL_RIGHT];
+                               padding[TRBL_LEFT] - padding[TRBL_RIGHT] -
+                               border[TRBL_LEFT] - border[TRBL_RIGHT];
     layx_scalar client_height = rect[XYWH_HEIGHT] - 
-                                pitem->padding_trbl[TRBL_TOP] - pitem->padding_trbl[TRBL_BOTTOM] -
-                                pitem->border_trbl[TRBL_TOP] - pitem->border_trbl[TRBL_BOTTOM];
+                                padding[TRBL_TOP] - padding[TRBL_BOTTOM] -
+                                border[TRBL_TOP] - border[TRBL_BOTTOM];
     client_width = client_width > 0 ? client_width : 0;
     client_height = client_height > 0 ? client_height : 0;
     
@@ -198,8 +660,9 @@ static void layx_update_scroll_fields(layx_context *ctx, layx_id item) {
         layx_vec4 child_rect = ctx->rects[child];
         
         // 子元素相对于父元素的绝对位置 + 尺寸 + margin
-        layx_scalar child_right = child_rect[XYWH_X] + child_rect[XYWH_WIDTH] + pchild->margin_trbl[TRBL_RIGHT];
-        layx_scalar child_bottom = child_rect[XYWH_Y] + child_rect[XYWH_HEIGHT] + pchild->margin_trbl[TRBL_BOTTOM];
+        const layx_vec4 child_margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
+        layx_scalar child_right = child_rect[XYWH_X] + child_rect[XYWH_WIDTH] + child_margins[TRBL_RIGHT];
+        layx_scalar child_bottom = child_rect[XYWH_Y] + child_rect[XYWH_HEIGHT] + child_margins[TRBL_BOTTOM];
         
         // 取最大值作为内容尺寸
         if (child_right > content_width) content_width = child_right;
@@ -263,25 +726,418 @@ static void layx_update_scroll_fields(layx_context *ctx, layx_id item) {
     }
 }
 
+// 遍历不使用栈：借助 parent/next_sibling 链接即可求出后序/先序的下一个节点，
+// 因此分步布局只需在上下文中保存阶段与当前节点
+static LAYX_FORCE_INLINE layx_id layx_post_order_first(const layx_context *ctx, layx_id item)
+{
+    while (ctx->items[item].first_child != LAYX_INVALID_ID) {
+        item = ctx->items[item].first_child;
+    }
+    return item;
+}
+
+static LAYX_FORCE_INLINE layx_id layx_post_order_next(const layx_context *ctx, layx_id root, layx_id item)
+{
+    if (item == root) return LAYX_INVALID_ID;
+    const layx_item_t *pitem = ctx->items + item;
+    if (pitem->next_sibling != LAYX_INVALID_ID) {
+        return layx_post_order_first(ctx, pitem->next_sibling);
+    }
+    return pitem->parent;
+}
+
+// 先序遍历中跳过 item 的后代
+static LAYX_FORCE_INLINE layx_id layx_pre_order_skip(const layx_context *ctx, layx_id root, layx_id item)
+{
+    while (item != root) {
+        const layx_item_t *pitem = ctx->items + item;
+        if (pitem->next_sibling != LAYX_INVALID_ID) return pitem->next_sibling;
+        item = pitem->parent;
+    }
+    return LAYX_INVALID_ID;
+}
+
+static LAYX_FORCE_INLINE layx_id layx_pre_order_next(const layx_context *ctx, layx_id root, layx_id item)
+{
+    if (ctx->items[item].first_child != LAYX_INVALID_ID) {
+        return ctx->items[item].first_child;
+    }
+    return layx_pre_order_skip(ctx, root, item);
+}
+
+// 分步布局的遍历把缓存根当作叶子：它的后代由 layx_memo_calc / layx_memo_arrange 一起处理
+static LAYX_FORCE_INLINE bool layx_is_memo_root(const layx_context *ctx, layx_id item)
+{
+    return ctx->items[item].memo != 0 && ctx->memo.capacity > 0;
+}
+
+static LAYX_FORCE_INLINE layx_id layx_step_first(const layx_context *ctx, layx_id item)
+{
+    while (ctx->items[item].first_child != LAYX_INVALID_ID && !layx_is_memo_root(ctx, item)) {
+        item = ctx->items[item].first_child;
+    }
+    return item;
+}
+
+static LAYX_FORCE_INLINE layx_id layx_step_post_next(const layx_context *ctx, layx_id root, layx_id item)
+{
+    if (item == root) return LAYX_INVALID_ID;
+    const layx_item_t *pitem = ctx->items + item;
+    if (pitem->next_sibling != LAYX_INVALID_ID) {
+        return layx_step_first(ctx, pitem->next_sibling);
+    }
+    return pitem->parent;
+}
+
+static LAYX_FORCE_INLINE layx_id layx_step_pre_next(const layx_context *ctx, layx_id root, layx_id item)
+{
+    if (layx_is_memo_root(ctx, item)) return layx_pre_order_skip(ctx, root, item);
+    return layx_pre_order_next(ctx, root, item);
+}
+
+static LAYX_FORCE_INLINE uint32_t layx_observe_changes(const layx_observer *record, layx_vec4 rect)
+{
+    const layx_vec4 old = record->reported;
+    uint32_t changed = 0;
+    if (rect[0] != old[0] || rect[1] != old[1]) changed |= LAYX_OBSERVE_POSITION;
+    if (rect[2] != old[2] || rect[3] != old[3]) changed |= LAYX_OBSERVE_SIZE;
+    return changed & record->mask;
+}
+
+// 纵向排列 item 之后调用：此时它的 rect 已经确定，后续只会排列它的后代
+static void layx_observe_item(layx_context *ctx, layx_id item)
+{
+    layx_observer_table *table = &ctx->observers;
+    const uint32_t index = ctx->items[item].observer;
+    layx_observer *record = table->records + index;
+    if (record->queued || layx_observe_changes(record, ctx->rects[item]) == 0) return;
+    if (table->queue_count >= table->queue_capacity) {
+        table->queue_capacity = table->queue_capacity < 1 ? 32 : table->queue_capacity * 2;
+        LAYX_STATS_COUNT(ctx, grow_events);
+        table->queue = (uint32_t*)LAYX_REALLOC(table->queue, table->queue_capacity * sizeof(uint32_t));
+    }
+    table->queue[table->queue_count++] = index;
+    record->queued = 1;
+}
+
+static uint32_t layx_observed_in_subtree(const layx_context *ctx, layx_id item)
+{
+    const layx_observer_table *table = &ctx->observers;
+    if (table->count <= 1 + table->free_count) return 0;
+    uint32_t count = 0;
+    for (layx_id node = item; node != LAYX_INVALID_ID; node = layx_pre_order_next(ctx, item, node)) {
+        if (ctx->items[node].observer != 0) ++count;
+    }
+    return count;
+}
+
+// 子树插入 parent 之下（sign 为 1）或从中移出（sign 为 -1）后，修正 parent 一侧缓存根的计数
+static LAYX_FORCE_INLINE void layx_memo_observed_move(layx_context *ctx, layx_id parent, layx_id child, int32_t sign)
+{
+    if (ctx->memo.root_count <= 1) return;
+    const uint32_t count = layx_observed_in_subtree(ctx, child);
+    if (count != 0) layx_memo_observed_add(ctx, parent, sign * (int32_t)count);
+}
+
+// 缓存根的后代不经过遍历引擎，子树中没有被观察的 item 时不必遍历，找齐之后也不再继续
+static void layx_observe_subtree(layx_context *ctx, layx_id item)
+{
+    uint32_t remaining = ctx->memo.roots[ctx->items[item].memo].observed;
+    for (layx_id node = item; remaining != 0 && node != LAYX_INVALID_ID; node = layx_pre_order_next(ctx, item, node)) {
+        if (ctx->items[node].observer != 0) {
+            layx_observe_item(ctx, node);
+            --remaining;
+        }
+    }
+}
+
+static uint64_t layx_now_ns(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+#ifndef LAYX_STATS_NOW
+#define LAYX_STATS_NOW() layx_now_ns()
+#endif
+
+static LAYX_FORCE_INLINE uint64_t layx_stats_clock(const layx_context *ctx)
+{
+    return ctx->stats_enabled ? (uint64_t)LAYX_STATS_NOW() : 0;
+}
+
+// 一个阶段（或分步布局中阶段的一段）结束，phase 为 LAYX_PHASE_*
+static LAYX_FORCE_INLINE void layx_stats_phase(layx_context *ctx, int phase, uint64_t start, uint32_t visited)
+{
+    if (!ctx->stats_enabled) return;
+    ctx->stats.last_phase_time[phase - LAYX_PHASE_CALC_X] += (uint64_t)LAYX_STATS_NOW() - start;
+    ctx->stats.items_visited += visited;
+}
+
+static LAYX_FORCE_INLINE void layx_stats_container(layx_context *ctx, layx_id item)
+{
+    const layx_item_t *pitem = ctx->items + item;
+    if (pitem->first_child != LAYX_INVALID_ID) {
+        ctx->stats.containers[layx_get_display_from_flags(pitem->flags)]++;
+    }
+}
+
+static void layx_stats_begin_run(layx_context *ctx)
+{
+    if (!ctx->stats_enabled) return;
+    LAYX_MEMSET(ctx->stats.last_phase_time, 0, sizeof(ctx->stats.last_phase_time));
+}
+
+static void layx_stats_end_run(layx_context *ctx)
+{
+    if (!ctx->stats_enabled) return;
+    ctx->stats.runs++;
+    for (int i = 0; i < LAYX_STATS_PHASES; ++i) {
+        ctx->stats.phase_time[i] += ctx->stats.last_phase_time[i];
+    }
+}
+
+// 布局追踪的记录点（实现在 layx_trace.c），只在 ctx->tracer 非 NULL 时调用
+extern uint64_t layx_trace_clock(void);
+extern void layx_trace_reserve(layx_context *ctx);
+extern void layx_trace_phase(layx_context *ctx, int phase, uint64_t start);
+extern void layx_trace_post(layx_context *ctx, layx_id item, int phase, uint64_t start, bool descended);
+extern void layx_trace_pre(layx_context *ctx, layx_id root, layx_id item, int phase, uint64_t start, bool descended);
+
+// 新一轮布局从头开始，上一轮记录的 flex 行全部作废
+static void layx_step_begin(layx_context *ctx, layx_step_state *state, layx_id root)
+{
+    ctx->lines.count = 0;
+    state->root = root;
+    state->phase = LAYX_PHASE_CALC_X;
+    state->node = LAYX_INVALID_ID;
+    state->restart = false;
+}
+
+typedef struct layx_step_budget {
+    uint32_t remaining;
+    uint32_t since_clock;
+    uint64_t deadline_ns;
+} layx_step_budget;
+
+// 每处理 64 个 item 才读取一次时钟
+static LAYX_FORCE_INLINE bool layx_step_budget_spent(layx_step_budget *budget)
+{
+    if (--budget->remaining == 0) return true;
+    if (budget->deadline_ns > 0 && ++budget->since_clock >= 64) {
+        budget->since_clock = 0;
+        return layx_now_ns() >= budget->deadline_ns;
+    }
+    return false;
+}
+
+// 推进布局直到完成或预算用尽；budget_items 为 0 表示不限数量，deadline_ns 为 0 表示不限时间。
+// 返回 true 表示本轮布局已完成
+static bool layx_step_advance(layx_context *ctx, layx_step_state *state,
+                              uint32_t budget_items, uint64_t deadline_ns)
+{
+    const layx_id root = state->root;
+    layx_step_budget budget = { budget_items > 0 ? budget_items : UINT32_MAX, 0, deadline_ns };
+    const bool tracing = ctx->tracer != NULL;
+    if (tracing) layx_trace_reserve(ctx);
+
+    while (state->phase != LAYX_PHASE_IDLE) {
+        const int dim = (state->phase == LAYX_PHASE_CALC_X || state->phase == LAYX_PHASE_ARRANGE_X) ? 0 : 1;
+        const uint64_t start = layx_stats_clock(ctx);
+        const uint64_t trace_start = tracing ? layx_trace_clock() : 0;
+        uint32_t visited = 0;
+        switch (state->phase) {
+            case LAYX_PHASE_CALC_X:
+            case LAYX_PHASE_CALC_Y: {
+                const bool count_containers = ctx->stats_enabled && state->phase == LAYX_PHASE_CALC_X;
+                layx_id node = state->node == LAYX_INVALID_ID ? layx_step_first(ctx, root) : state->node;
+                while (node != LAYX_INVALID_ID) {
+                    if (count_containers) layx_stats_container(ctx, node);
+                    const uint64_t node_start = tracing ? layx_trace_clock() : 0;
+                    const bool memo_root = layx_is_memo_root(ctx, node);
+                    if (memo_root) {
+                        layx_memo_calc(ctx, node, dim);
+                    } else {
+                        layx_calc_size(ctx, node, dim);
+                    }
+                    if (tracing) {
+                        const bool descended = !memo_root && ctx->items[node].first_child != LAYX_INVALID_ID;
+                        layx_trace_post(ctx, node, state->phase, node_start, descended);
+                    }
+                    ++visited;
+                    node = layx_step_post_next(ctx, root, node);
+                    if (node != LAYX_INVALID_ID && layx_step_budget_spent(&budget)) {
+                        state->node = node;
+                        layx_stats_phase(ctx, state->phase, start, visited);
+                        if (tracing) layx_trace_phase(ctx, state->phase, trace_start);
+                        return false;
+                    }
+                }
+                break;
+            }
+            case LAYX_PHASE_ARRANGE_X:
+            case LAYX_PHASE_ARRANGE_Y: {
+                layx_id node = state->node == LAYX_INVALID_ID ? root : state->node;
+                while (node != LAYX_INVALID_ID) {
+                    const uint64_t node_start = tracing ? layx_trace_clock() : 0;
+                    const bool memo_root = layx_is_memo_root(ctx, node);
+                    if (memo_root) {
+                        layx_memo_arrange(ctx, node, dim);
+                        if (dim == 1) layx_observe_subtree(ctx, node);
+                    } else {
+                        layx_arrange(ctx, node, dim);
+                        if (dim == 1 && ctx->items[node].observer != 0) layx_observe_item(ctx, node);
+                    }
+                    if (tracing) {
+                        const bool descended = !memo_root && ctx->items[node].first_child != LAYX_INVALID_ID;
+                        layx_trace_pre(ctx, root, node, state->phase, node_start, descended);
+                    }
+                    ++visited;
+                    node = layx_step_pre_next(ctx, root, node);
+                    if (node != LAYX_INVALID_ID && layx_step_budget_spent(&budget)) {
+                        state->node = node;
+                        layx_stats_phase(ctx, state->phase, start, visited);
+                        if (tracing) layx_trace_phase(ctx, state->phase, trace_start);
+                        return false;
+                    }
+                }
+                break;
+            }
+            case LAYX_PHASE_SCROLL:
+                // 计算滚动相关字段
+                layx_update_scroll_fields(ctx, root);
+                break;
+            default:
+                break;
+        }
+        layx_stats_phase(ctx, state->phase, start, visited);
+        if (tracing) layx_trace_phase(ctx, state->phase, trace_start);
+        state->phase = state->phase == LAYX_PHASE_SCROLL ? LAYX_PHASE_IDLE : state->phase + 1;
+        state->node = LAYX_INVALID_ID;
+    }
+    if (ctx->frames.enabled) {
+        layx_frames_touch(ctx, root, true);
+    }
+    return true;
+}
+
+// 横向计算尺寸和排列，再纵向计算尺寸和排列（会递归计算内容尺寸和滚动条），最后更新滚动字段
+static void layx_layout_subtree(layx_context *ctx, layx_id item)
+{
+    layx_step_state state;
+    layx_step_begin(ctx, &state, item);
+    layx_step_advance(ctx, &state, 0, 0);
+}
+
 void layx_run_item(layx_context *ctx, layx_id item)
 {
     LAYX_ASSERT(ctx != NULL);
-    
-    // 横向计算尺寸和排列
-    layx_calc_size(ctx, item,0);
-    layx_arrange(ctx, item,0);
-    
-    // 纵向计算尺寸和排列（会递归计算内容尺寸和滚动条）
-    layx_calc_size(ctx, item,1);
-    layx_arrange(ctx, item,1);
-    
-    // 计算滚动相关字段
+    LAYX_RECORD_CALL(ctx, LAYX_REC_RUN_ITEM, item);
+    layx_stats_begin_run(ctx);
+    layx_layout_subtree(ctx, item);
+    layx_stats_end_run(ctx);
+}
+
+// 重新布局一个脏的布局边界。绝对定位的 item 由父元素的 rect 重新定位；
+// 在流中的边界自身没有变化，它的 rect 仍是父元素上次排列的结果，只重新布局内部
+static void layx_run_boundary(layx_context *ctx, layx_id item)
+{
+    if (ctx->items[item].flags & LAYX_ITEM_ABSOLUTE) {
+        layx_layout_subtree(ctx, item);
+        return;
+    }
+    const layx_vec4 rect = ctx->rects[item];
+    const bool tracing = ctx->tracer != NULL;
+    if (tracing) layx_trace_reserve(ctx);
+    ctx->lines.count = 0;
+    for (int dim = 0; dim < 2; ++dim) {
+        const bool count_containers = ctx->stats_enabled && dim == 0;
+        int phase = dim == 0 ? LAYX_PHASE_CALC_X : LAYX_PHASE_CALC_Y;
+        uint64_t start = layx_stats_clock(ctx);
+        uint64_t trace_start = tracing ? layx_trace_clock() : 0;
+        uint32_t visited = 0;
+        for (layx_id node = layx_post_order_first(ctx, item); node != LAYX_INVALID_ID;
+             node = layx_post_order_next(ctx, item, node)) {
+            if (count_containers) layx_stats_container(ctx, node);
+            const uint64_t node_start = tracing ? layx_trace_clock() : 0;
+            layx_calc_size(ctx, node, dim);
+            if (tracing) {
+                layx_trace_post(ctx, node, phase, node_start, ctx->items[node].first_child != LAYX_INVALID_ID);
+            }
+            ++visited;
+        }
+        layx_stats_phase(ctx, phase, start, visited);
+        if (tracing) layx_trace_phase(ctx, phase, trace_start);
+        ctx->rects[item][POINT_DIM(dim)] = rect[POINT_DIM(dim)];
+        ctx->rects[item][SIZE_DIM(dim)] = rect[SIZE_DIM(dim)];
+        phase = dim == 0 ? LAYX_PHASE_ARRANGE_X : LAYX_PHASE_ARRANGE_Y;
+        start = layx_stats_clock(ctx);
+        trace_start = tracing ? layx_trace_clock() : 0;
+        visited = 0;
+        for (layx_id node = item; node != LAYX_INVALID_ID; node = layx_pre_order_next(ctx, item, node)) {
+            const uint64_t node_start = tracing ? layx_trace_clock() : 0;
+            layx_arrange(ctx, node, dim);
+            if (dim == 1 && ctx->items[node].observer != 0) layx_observe_item(ctx, node);
+            if (tracing) {
+                layx_trace_pre(ctx, item, node, phase, node_start, ctx->items[node].first_child != LAYX_INVALID_ID);
+            }
+            ++visited;
+        }
+        layx_stats_phase(ctx, phase, start, visited);
+        if (tracing) layx_trace_phase(ctx, phase, trace_start);
+    }
+    const uint64_t start = layx_stats_clock(ctx);
+    const uint64_t trace_start = tracing ? layx_trace_clock() : 0;
     layx_update_scroll_fields(ctx, item);
+    layx_stats_phase(ctx, LAYX_PHASE_SCROLL, start, 0);
+    if (tracing) layx_trace_phase(ctx, LAYX_PHASE_SCROLL, trace_start);
+    if (ctx->frames.enabled) {
+        layx_frames_touch(ctx, item, true);
+    }
+}
+
+int layx_run_context_step(layx_context *ctx, uint32_t budget_items, uint64_t budget_ns)
+{
+    LAYX_ASSERT(ctx != NULL);
+    LAYX_RECORD_CALL(ctx, LAYX_REC_RUN_STEP, LAYX_INVALID_ID, budget_items,
+                     (uint32_t)budget_ns, (uint32_t)(budget_ns >> 32));
+    layx_step_state *state = &ctx->step;
+    if (ctx->count == 0) {
+        state->phase = LAYX_PHASE_IDLE;
+        return LAYX_STEP_DONE;
+    }
+    if (state->phase == LAYX_PHASE_IDLE || state->restart) {
+        if (state->phase == LAYX_PHASE_IDLE && !(ctx->items[0].flags & LAYX_ITEM_DIRTY)) {
+            // 只有布局边界为脏：子树通常很小，不拆分
+            LAYX_RECORD_MUTE(ctx, 1);
+            layx_run_dirty(ctx);
+            LAYX_RECORD_MUTE(ctx, -1);
+            return LAYX_STEP_DONE;
+        }
+        if (state->phase == LAYX_PHASE_IDLE) layx_stats_begin_run(ctx);
+        layx_step_begin(ctx, state, 0);
+    }
+    const uint64_t deadline = budget_ns > 0 ? layx_now_ns() + budget_ns : 0;
+    if (!layx_step_advance(ctx, state, budget_items, deadline)) {
+        return LAYX_STEP_IN_PROGRESS;
+    }
+    ctx->boundaries.count = 0;
+    layx_stats_end_run(ctx);
+    return LAYX_STEP_DONE;
+}
+
+bool layx_layout_complete(const layx_context *ctx)
+{
+    LAYX_ASSERT(ctx != NULL);
+    if (ctx->step.phase != LAYX_PHASE_IDLE || ctx->boundaries.count > 0) return false;
+    return ctx->count == 0 || !(ctx->items[0].flags & LAYX_ITEM_DIRTY);
 }
 
 void layx_clear_item_break(layx_context *ctx, layx_id item)
 {
     LAYX_ASSERT(ctx != NULL);
+    LAYX_RECORD_CALL(ctx, LAYX_REC_CLEAR_BREAK, item);
     layx_item_t *pitem = layx_get_item(ctx, item);
     pitem->flags = pitem->flags & ~LAYX_BREAK;
 }
@@ -322,13 +1178,10 @@ layx_id layx_item(layx_context *ctx)
         LAYX_MEMSET(&ctx->rects[idx], 0, sizeof(layx_vec4));
     } else {
         // 从数组末尾分配
+        LAYX_ASSERT(ctx->count < LAYX_MAX_ITEMS);
         idx = ctx->count++;
         if (idx >= ctx->capacity) {
-            ctx->capacity = ctx->capacity < 1 ? 32 : (ctx->capacity * 4);
-            const size_t item_size = sizeof(layx_item_t) + sizeof(layx_vec4);
-            ctx->items = (layx_item_t*)LAYX_REALLOC(ctx->items, ctx->capacity * item_size);
-            const layx_item_t *past_last = ctx->items + ctx->capacity;
-            ctx->rects = (layx_vec4*)past_last;
+            layx_grow_storage(ctx, ctx->capacity < 1 ? 32 : ((uint32_t)ctx->capacity * 4));
         }
         item = layx_get_item(ctx, idx);
         LAYX_MEMSET(item, 0, sizeof(layx_item_t));
@@ -342,9 +1195,84 @@ layx_id layx_item(layx_context *ctx)
         item->flex_basis = 0;
         LAYX_MEMSET(&ctx->rects[idx], 0, sizeof(layx_vec4));
     }
+    item->flags = LAYX_ITEM_DIRTY;
+    if (ctx->delta.enabled) {
+        layx_delta_on_create(ctx, idx);
+    }
+    if (ctx->frames.enabled) {
+        layx_frames_touch(ctx, idx, false);
+    }
+    LAYX_RECORD_CALL(ctx, LAYX_REC_ITEM, idx);
     return idx;
 }
 
+bool layx_is_layout_boundary(const layx_context *ctx, layx_id item)
+{
+    return layx_item_is_layout_boundary(layx_get_item(ctx, item));
+}
+
+// 标记 item 及其祖先为脏，到第一个布局边界为止：边界登记后由 layx_run_dirty 单独布局
+static void layx_mark_dirty_upward(layx_context *ctx, layx_id item)
+{
+    // 分步布局进行中的修改可能落在已处理过的部分，也可能使保存的遍历位置失效，下一次调用从头开始
+    if (ctx->step.phase != LAYX_PHASE_IDLE) ctx->step.restart = true;
+    while (item != LAYX_INVALID_ID) {
+        layx_item_t *pitem = ctx->items + item;
+        // 遇到已脏的祖先即停止：脏 item 的祖先必然也是脏的
+        if (pitem->flags & LAYX_ITEM_DIRTY) break;
+        pitem->flags |= LAYX_ITEM_DIRTY;
+        if (layx_item_is_layout_boundary(pitem)) {
+            layx_boundary_list *boundaries = &ctx->boundaries;
+            if (boundaries->count == boundaries->capacity) {
+                boundaries->capacity = boundaries->capacity < 1 ? 16 : boundaries->capacity * 2;
+                LAYX_STATS_COUNT(ctx, grow_events);
+                boundaries->ids = (layx_id*)LAYX_REALLOC(boundaries->ids, boundaries->capacity * sizeof(layx_id));
+            }
+            boundaries->ids[boundaries->count++] = item;
+            break;
+        }
+        item = pitem->parent;
+    }
+}
+
+// item 自身的属性变化：在流中的边界（contain 或固定尺寸）自身的变化仍会影响父元素，
+// 即使它已经因为内部的变化而为脏
+static void layx_invalidate(layx_context *ctx, layx_id item)
+{
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    if (!(pitem->flags & LAYX_ITEM_ABSOLUTE) && layx_item_is_layout_boundary(pitem)) {
+        if (ctx->step.phase != LAYX_PHASE_IDLE) ctx->step.restart = true;
+        pitem->flags |= LAYX_ITEM_DIRTY;
+        item = pitem->parent;
+    }
+    layx_mark_dirty_upward(ctx, item);
+}
+
+// 库内部的属性修改走 layx_invalidate，只有调用者直接标记脏时才记录
+void layx_mark_dirty(layx_context *ctx, layx_id item)
+{
+    LAYX_RECORD_CALL(ctx, LAYX_REC_MARK_DIRTY, item);
+    layx_invalidate(ctx, item);
+}
+
+// 插入或移除子元素后标记脏：对父元素来说是内部的变化；
+// 绝对定位的子元素不影响父元素的布局，只把它自身登记为脏边界
+static LAYX_FORCE_INLINE void layx_mark_child_changed(layx_context *ctx, layx_id parent, layx_id child)
+{
+    layx_item_t *pchild = ctx->items + child;
+    if (pchild->flags & LAYX_ITEM_ABSOLUTE) {
+        pchild->flags &= ~LAYX_ITEM_DIRTY;
+        layx_mark_dirty_upward(ctx, child);
+    } else {
+        layx_mark_dirty_upward(ctx, parent);
+    }
+}
+
+bool layx_is_dirty(const layx_context *ctx, layx_id item)
+{
+    return (layx_get_item(ctx, item)->flags & LAYX_ITEM_DIRTY) != 0;
+}
+
 static LAYX_FORCE_INLINE
 void layx_insert_after_by_ptr(
         layx_item_t *LAYX_RESTRICT pearlier,
@@ -373,12 +1301,15 @@ layx_id layx_last_child(const layx_context *ctx, layx_id parent)
 
 void layx_insert_after(layx_context *ctx, layx_id earlier, layx_id later)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_INSERT_AFTER, earlier, (uint32_t)later);
     LAYX_ASSERT(later != 0);
     LAYX_ASSERT(earlier != later);
     layx_item_t *LAYX_RESTRICT pearlier = layx_get_item(ctx, earlier);
     layx_item_t *LAYX_RESTRICT plater = layx_get_item(ctx, later);
     plater->parent = pearlier->parent;  // 设置parent，与earlier的parent相同
     layx_insert_after_by_ptr(pearlier, later, plater);
+    layx_memo_observed_move(ctx, plater->parent, later, 1);
+    layx_mark_child_changed(ctx, plater->parent, later);
 }
 
 int layx_is_inserted(layx_context *ctx, layx_id child){
@@ -389,6 +1320,7 @@ int layx_is_inserted(layx_context *ctx, layx_id child){
 
 void layx_append(layx_context *ctx, layx_id parent, layx_id child)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_APPEND, parent, (uint32_t)child);
     LAYX_ASSERT(child != 0);
     LAYX_ASSERT(parent != child);
     layx_item_t *LAYX_RESTRICT pparent = layx_get_item(ctx, parent);
@@ -408,10 +1340,13 @@ void layx_append(layx_context *ctx, layx_id parent, layx_id child)
         }
         layx_insert_after_by_ptr(pnext, child, pchild);
     }
+    layx_memo_observed_move(ctx, parent, child, 1);
+    layx_mark_child_changed(ctx, parent, child);
 }
 
 void layx_prepend(layx_context *ctx, layx_id parent, layx_id new_child)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_PREPEND, parent, (uint32_t)new_child);
     LAYX_ASSERT(new_child != 0);
     LAYX_ASSERT(parent != new_child);
     layx_item_t *LAYX_RESTRICT pparent = layx_get_item(ctx, parent);
@@ -422,11 +1357,14 @@ void layx_prepend(layx_context *ctx, layx_id parent, layx_id new_child)
     pparent->first_child = new_child;
     pchild->flags |= LAYX_ITEM_INSERTED;
     pchild->next_sibling = old_child;
+    layx_memo_observed_move(ctx, parent, new_child, 1);
+    layx_mark_child_changed(ctx, parent, new_child);
 }
 
 void layx_remove(layx_context *ctx, layx_id item)
 {
     LAYX_ASSERT(ctx != NULL);
+    LAYX_RECORD_CALL(ctx, LAYX_REC_REMOVE, item);
     LAYX_ASSERT(item != LAYX_INVALID_ID && item < ctx->count);
     
     layx_item_t *pitem = layx_get_item(ctx, item);
@@ -436,6 +1374,10 @@ void layx_remove(layx_context *ctx, layx_id item)
     if (parent_id == LAYX_INVALID_ID) {
         return;
     }
+    // 已布局的结果可能还没有发布，移出后父元素的布局不再覆盖这棵子树
+    if (ctx->frames.enabled) {
+        layx_frames_touch(ctx, item, true);
+    }
     
     layx_item_t *pparent = layx_get_item(ctx, parent_id);
     
@@ -462,12 +1404,16 @@ void layx_remove(layx_context *ctx, layx_id item)
     // 清除插入标志和重置父元素引用
     pitem->flags &= ~LAYX_ITEM_INSERTED;
     pitem->parent = LAYX_INVALID_ID;
+    layx_memo_observed_move(ctx, parent_id, item, -1);
+    layx_mark_child_changed(ctx, parent_id, item);
 }
 
 void layx_destroy_item(layx_context *ctx, layx_id item)
 {
     LAYX_ASSERT(ctx != NULL);
     LAYX_ASSERT(item != LAYX_INVALID_ID && item < ctx->count);
+    LAYX_RECORD_CALL(ctx, LAYX_REC_DESTROY, item);
+    LAYX_RECORD_MUTE(ctx, 1);
     
     layx_item_t *pitem = layx_get_item(ctx, item);
     
@@ -484,23 +1430,197 @@ void layx_destroy_item(layx_context *ctx, layx_id item)
         layx_destroy_item(ctx, child);
         child = next_child;
     }
+    LAYX_RECORD_MUTE(ctx, -1);
     
     // 将 item 加入空闲链表
     pitem->first_child = LAYX_INVALID_ID;
     pitem->next_sibling = ctx->free_list_head;
     pitem->parent = LAYX_INVALID_ID;
     pitem->flags = 0;
+    // 先释放盒模型记录：是否与样式共享要按 style_id 判断
+    if (pitem->box_mask != 0) {
+        layx_box_release(ctx, pitem);
+    }
+    if (pitem->style_id != LAYX_NO_STYLE) {
+        ctx->styles.records[pitem->style_id].users--;
+        pitem->style_id = LAYX_NO_STYLE;
+    }
+    if (pitem->grid != 0) {
+        ctx->grids.records[pitem->grid].owner = LAYX_INVALID_ID;
+        pitem->grid = 0;
+    }
+    if (pitem->memo != 0) {
+        ctx->memo.roots[pitem->memo].owner = LAYX_INVALID_ID;
+        pitem->memo = 0;
+    }
+    if (pitem->observer != 0) {
+        layx_observer_release(ctx, pitem);
+    }
+    // 空闲 id 的 rect 为零，与变更流消费端清零后的镜像一致
+    LAYX_MEMSET(&ctx->rects[item], 0, sizeof(layx_vec4));
     ctx->free_list_head = item;
+    if (ctx->delta.enabled) {
+        layx_delta_on_destroy(ctx, item);
+    }
+    if (ctx->frames.enabled) {
+        layx_frames_touch(ctx, item, false);
+    }
+}
+
+// 复制单个 item 数据，链接字段由调用者修正
+static LAYX_FORCE_INLINE
+void layx_clone_item_data(layx_context *ctx, layx_id src, layx_id dst)
+{
+    layx_item_t *pdst = ctx->items + dst;
+    *pdst = ctx->items[src];
+    pdst->first_child = LAYX_INVALID_ID;
+    pdst->next_sibling = LAYX_INVALID_ID;
+    ctx->rects[dst] = ctx->rects[src];
+}
+
+// 复制以 src_root 为根的子树，返回未插入的新根。
+// 新 item 按先序连续分配在数组末尾（不使用空闲链表），rects 中已计算的尺寸一并复制，
+// 因此相同输入的子树不需要重新测量。源子树本身 id 连续时整块复制后平移链接。
+layx_id layx_clone_subtree(layx_context *ctx, layx_id src_root)
+{
+    LAYX_ASSERT(ctx != NULL);
+    LAYX_ASSERT(src_root != LAYX_INVALID_ID && src_root < ctx->count);
+
+    // 第一遍：统计节点数，并检查先序遍历是否恰好是连续 id
+    layx_id n = 0;
+    bool contiguous = true;
+    layx_id node = src_root;
+    for (;;) {
+        if (node != src_root + n) contiguous = false;
+        ++n;
+        const layx_item_t *pnode = ctx->items + node;
+        if (pnode->first_child != LAYX_INVALID_ID) {
+            node = pnode->first_child;
+            continue;
+        }
+        while (node != src_root && ctx->items[node].next_sibling == LAYX_INVALID_ID) {
+            node = ctx->items[node].parent;
+        }
+        if (node == src_root) break;
+        node = ctx->items[node].next_sibling;
+    }
+
+    const layx_id base = ctx->count;
+    LAYX_ASSERT((uint32_t)base + n <= LAYX_MAX_ITEMS);
+    if ((uint32_t)base + n > ctx->capacity) {
+        uint32_t capacity = ctx->capacity < 1 ? 32 : ctx->capacity;
+        while (capacity < (uint32_t)base + n) capacity *= 4;
+        layx_grow_storage(ctx, capacity);
+    }
+    ctx->count += n;
+
+    if (contiguous) {
+        memcpy(ctx->items + base, ctx->items + src_root, n * sizeof(layx_item_t));
+        memcpy(ctx->rects + base, ctx->rects + src_root, n * sizeof(layx_vec4));
+        const layx_id shift = base - src_root;
+        for (layx_id i = base; i < base + n; ++i) {
+            layx_item_t *pitem = ctx->items + i;
+            if (pitem->first_child != LAYX_INVALID_ID) pitem->first_child += shift;
+            if (pitem->next_sibling != LAYX_INVALID_ID) pitem->next_sibling += shift;
+            if (pitem->parent != LAYX_INVALID_ID) pitem->parent += shift;
+        }
+    } else {
+        // 第二遍：按先序复制，借助已复制节点的 parent 链回溯，不需要额外的栈
+        layx_id src = src_root;
+        layx_id dst = base;
+        layx_id next = base + 1;
+        layx_clone_item_data(ctx, src, dst);
+        for (;;) {
+            if (ctx->items[src].first_child != LAYX_INVALID_ID) {
+                const layx_id parent = dst;
+                src = ctx->items[src].first_child;
+                dst = next++;
+                layx_clone_item_data(ctx, src, dst);
+                ctx->items[parent].first_child = dst;
+                ctx->items[dst].parent = parent;
+                continue;
+            }
+            while (src != src_root && ctx->items[src].next_sibling == LAYX_INVALID_ID) {
+                src = ctx->items[src].parent;
+                dst = ctx->items[dst].parent;
+            }
+            if (src == src_root) break;
+            const layx_id prev = dst;
+            src = ctx->items[src].next_sibling;
+            dst = next++;
+            layx_clone_item_data(ctx, src, dst);
+            ctx->items[prev].next_sibling = dst;
+            ctx->items[dst].parent = ctx->items[prev].parent;
+        }
+    }
+
+    layx_item_t *proot = ctx->items + base;
+    proot->parent = LAYX_INVALID_ID;
+    proot->next_sibling = LAYX_INVALID_ID;
+    proot->flags &= ~LAYX_ITEM_INSERTED;
+
+    // 实例与模板共享样式记录
+    for (layx_id i = base; i < base + n; ++i) {
+        layx_item_t *pitem = ctx->items + i;
+        pitem->flags |= LAYX_ITEM_DIRTY;
+        if (pitem->style_id != LAYX_NO_STYLE) {
+            layx_style_add_user(ctx, pitem->style_id, i);
+        }
+        // grid 记录不共享：实例各自缓存解析结果
+        if (pitem->grid != 0) {
+            const uint32_t src = pitem->grid;
+            pitem->grid = 0;
+            layx_grid *grid = layx_grid_ensure(ctx, i);
+            for (int dim = 0; dim < 2; ++dim) {
+                layx_grid_copy_tracks(grid, dim, ctx->grids.records[src].tracks[dim], ctx->grids.records[src].track_count[dim]);
+            }
+        }
+        // 盒模型记录每个实例一份，与样式共享的除外
+        if (pitem->box_mask != 0 && !layx_box_shared(ctx, pitem)) {
+            const uint32_t src = pitem->box;
+            pitem->box = layx_box_alloc(ctx);
+            ctx->boxes.records[pitem->box] = ctx->boxes.records[src];
+        }
+        // 实例同样是缓存根，与模板共享缓存的结果
+        if (pitem->memo != 0) {
+            pitem->memo = 0;
+            layx_memo_ensure(ctx, i);
+        }
+        pitem->observer = 0;
+    }
+
+    if (ctx->delta.enabled) {
+        for (layx_id i = base; i < base + n; ++i) {
+            layx_delta_on_create(ctx, i);
+        }
+    }
+    if (ctx->frames.enabled) {
+        layx_frames_touch(ctx, base, true);
+    }
+    LAYX_RECORD_CALL(ctx, LAYX_REC_CLONE, base, (uint32_t)src_root);
+    return base;
+}
+
+// 属性写入：标记为脏；item 引用共享样式时该属性组转为本地覆盖
+static LAYX_FORCE_INLINE
+void layx_touch(layx_context *ctx, layx_id item, layx_item_t *pitem, uint16_t group)
+{
+    if (pitem->style_id != LAYX_NO_STYLE) {
+        pitem->style_overrides |= group;
+    }
+    layx_invalidate(ctx, item);
 }
 
 // Display property
 void layx_set_display(layx_context *ctx, layx_id item, layx_display display)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_DISPLAY, item, (uint32_t)display);
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_DISPLAY);
     uint32_t flags = pitem->flags;
-    flags &= ~LAYX_DISPLAY_TYPE_MASK;
+    flags &= ~(LAYX_DISPLAY_TYPE_MASK | LAYX_DISPLAY_GRID_BIT);
     flags |= layx_display_to_flags(display);
-    pitem->flags = flags;
+    pitem->flags = layx_update_strategy(flags);
 }
 
 const char* layx_get_display_string(layx_display display) {
@@ -509,6 +1629,7 @@ const char* layx_get_display_string(layx_display display) {
         case LAYX_DISPLAY_FLEX: return "FLEX";
         case LAYX_DISPLAY_INLINE: return "INLINE";
         case LAYX_DISPLAY_INLINE_BLOCK: return "INLINE_BLOCK";
+        case LAYX_DISPLAY_GRID: return "GRID";
         default: return "UNKNOWN";
     }
 }
@@ -516,25 +1637,31 @@ const char* layx_get_display_string(layx_display display) {
 // Flex properties
 void layx_set_flex_direction(layx_context *ctx, layx_id item, layx_flex_direction direction)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_FLEX_DIRECTION, item, (uint32_t)direction);
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_FLEX_DIRECTION);
     uint32_t flags = pitem->flags;
     flags &= ~LAYX_FLEX_DIRECTION_MASK;
     flags |= layx_flex_direction_to_flags(direction);
-    pitem->flags = flags;
+    pitem->flags = layx_update_strategy(flags);
 }
 
 void layx_set_flex_wrap(layx_context *ctx, layx_id item, layx_flex_wrap wrap)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_FLEX_WRAP, item, (uint32_t)wrap);
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_FLEX_WRAP);
     uint32_t flags = pitem->flags;
     flags &= ~LAYX_FLEX_WRAP_MASK;
     flags |= layx_flex_wrap_to_flags(wrap);
-    pitem->flags = flags;
+    pitem->flags = layx_update_strategy(flags);
 }
 
 void layx_set_justify_content(layx_context *ctx, layx_id item, layx_justify_content justify)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_JUSTIFY_CONTENT, item, (uint32_t)justify);
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_JUSTIFY_CONTENT);
     uint32_t flags = pitem->flags;
     flags &= ~LAYX_JUSTIFY_CONTENT_MASK;
     flags |= layx_justify_content_to_flags(justify);
@@ -543,7 +1670,9 @@ void layx_set_justify_content(layx_context *ctx, layx_id item, layx_justify_cont
 
 void layx_set_align_items(layx_context *ctx, layx_id item, layx_align_items align)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_ALIGN_ITEMS, item, (uint32_t)align);
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_ALIGN_ITEMS);
     uint32_t flags = pitem->flags;
     flags &= ~LAYX_ALIGN_ITEMS_MASK;
     flags |= layx_align_items_to_flags(align);
@@ -552,7 +1681,9 @@ void layx_set_align_items(layx_context *ctx, layx_id item, layx_align_items alig
 
 void layx_set_align_content(layx_context *ctx, layx_id item, layx_align_content align)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_ALIGN_CONTENT, item, (uint32_t)align);
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_ALIGN_CONTENT);
     uint32_t flags = pitem->flags;
     flags &= ~LAYX_ALIGN_CONTENT_MASK;
     flags |= layx_align_content_to_flags(align);
@@ -632,7 +1763,9 @@ const char* layx_get_align_content_string(layx_align_content align) {
 // Size properties
 void layx_set_width(layx_context *ctx, layx_id item, layx_scalar width)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_WIDTH, item, layx_record_scalar(width));
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_SIZE);
     pitem->size[0] = width;
     uint32_t flags = pitem->flags;
     if (width == 0)
@@ -644,7 +1777,9 @@ void layx_set_width(layx_context *ctx, layx_id item, layx_scalar width)
 
 void layx_set_height(layx_context *ctx, layx_id item, layx_scalar height)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_HEIGHT, item, layx_record_scalar(height));
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_SIZE);
     pitem->size[1] = height;
     uint32_t flags = pitem->flags;
     if (height == 0)
@@ -656,13 +1791,17 @@ void layx_set_height(layx_context *ctx, layx_id item, layx_scalar height)
 
 void layx_set_min_width(layx_context *ctx, layx_id item, layx_scalar min_width)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_MIN_WIDTH, item, layx_record_scalar(min_width));
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_MIN_WIDTH);
     pitem->min_size[0] = min_width;
 }
 
 void layx_set_min_height(layx_context *ctx, layx_id item, layx_scalar min_height)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_MIN_HEIGHT, item, layx_record_scalar(min_height));
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_MIN_HEIGHT);
     pitem->min_size[1] = min_height;
 }
 
@@ -674,34 +1813,123 @@ void layx_set_min_size(layx_context *ctx, layx_id item, layx_scalar min_width, l
 
 void layx_set_max_width(layx_context *ctx, layx_id item, layx_scalar max_width)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_MAX_WIDTH, item, layx_record_scalar(max_width));
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_MAX_WIDTH);
     pitem->max_size[0] = max_width;
 }
 
 void layx_set_max_height(layx_context *ctx, layx_id item, layx_scalar max_height)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_MAX_HEIGHT, item, layx_record_scalar(max_height));
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_MAX_HEIGHT);
     pitem->max_size[1] = max_height;
 }
 
 void layx_set_position(layx_context *ctx, layx_id item, layx_scalar left, layx_scalar top, layx_scalar right, layx_scalar bottom)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_POSITION, item, layx_record_scalar(left), layx_record_scalar(top),
+                     layx_record_scalar(right), layx_record_scalar(bottom));
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, 0);
     pitem->position[0] = left;
     pitem->position[1] = top;
     pitem->position[2] = right;
     pitem->position[3] = bottom;
+    pitem->auto_flags |= POSITION_SET_LEFT | POSITION_SET_TOP | POSITION_SET_RIGHT | POSITION_SET_BOTTOM;
 }
 void layx_set_position_lt(layx_context *ctx, layx_id item, layx_scalar left, layx_scalar top){
+    LAYX_RECORD_CALL(ctx, LAYX_REC_POSITION_LT, item, layx_record_scalar(left), layx_record_scalar(top));
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, 0);
     pitem->position[0] = left;
     pitem->position[1] = top;
+    pitem->auto_flags |= POSITION_SET_LEFT | POSITION_SET_TOP;
 }
 
 void layx_set_position_rb(layx_context *ctx, layx_id item, layx_scalar right, layx_scalar bottom){
+    LAYX_RECORD_CALL(ctx, LAYX_REC_POSITION_RB, item, layx_record_scalar(right), layx_record_scalar(bottom));
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, 0);
     pitem->position[2] = right;
     pitem->position[3] = bottom;
+    pitem->auto_flags |= POSITION_SET_RIGHT | POSITION_SET_BOTTOM;
+}
+
+static void layx_set_position_side(layx_context *ctx, layx_id item, int index, uint32_t set_flag, layx_scalar value)
+{
+    LAYX_RECORD_CALL(ctx, LAYX_REC_POSITION_SIDE, item, (uint32_t)index, layx_record_scalar(value));
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, 0);
+    pitem->position[index] = value;
+    pitem->auto_flags |= set_flag;
+}
+
+void layx_set_left(layx_context *ctx, layx_id item, layx_scalar left)
+{
+    layx_set_position_side(ctx, item, 0, POSITION_SET_LEFT, left);
+}
+
+void layx_set_top(layx_context *ctx, layx_id item, layx_scalar top)
+{
+    layx_set_position_side(ctx, item, 1, POSITION_SET_TOP, top);
+}
+
+void layx_set_right(layx_context *ctx, layx_id item, layx_scalar right)
+{
+    layx_set_position_side(ctx, item, 2, POSITION_SET_RIGHT, right);
+}
+
+void layx_set_bottom(layx_context *ctx, layx_id item, layx_scalar bottom)
+{
+    layx_set_position_side(ctx, item, 3, POSITION_SET_BOTTOM, bottom);
+}
+
+// 四个偏移全部恢复为 auto
+void layx_clear_position(layx_context *ctx, layx_id item)
+{
+    LAYX_RECORD_CALL(ctx, LAYX_REC_CLEAR_POSITION, item);
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, 0);
+    pitem->position[0] = pitem->position[1] = pitem->position[2] = pitem->position[3] = 0;
+    pitem->auto_flags &= ~(uint32_t)(POSITION_SET_LEFT | POSITION_SET_TOP | POSITION_SET_RIGHT | POSITION_SET_BOTTOM);
+}
+
+void layx_set_position_type(layx_context *ctx, layx_id item, layx_position_type type)
+{
+    LAYX_RECORD_CALL(ctx, LAYX_REC_POSITION_TYPE, item, (uint32_t)type);
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    const uint32_t flags = type == LAYX_POSITION_ABSOLUTE ? (pitem->flags | LAYX_ITEM_ABSOLUTE)
+                                                          : (pitem->flags & ~LAYX_ITEM_ABSOLUTE);
+    if (flags == pitem->flags) return;
+    // 进出文档流会改变父元素的布局
+    if (pitem->parent != LAYX_INVALID_ID) {
+        layx_mark_dirty_upward(ctx, pitem->parent);
+    }
+    pitem->flags = flags;
+    layx_invalidate(ctx, item);
+}
+
+void layx_set_contain(layx_context *ctx, layx_id item, bool contain)
+{
+    LAYX_RECORD_CALL(ctx, LAYX_REC_CONTAIN, item, contain ? 1u : 0u);
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    const uint32_t flags = contain ? (pitem->flags | LAYX_ITEM_CONTAIN) : (pitem->flags & ~LAYX_ITEM_CONTAIN);
+    if (flags == pitem->flags) return;
+    // 先按修改前的状态向外传播：自身尺寸的计算方式变了
+    layx_invalidate(ctx, item);
+    pitem->flags = flags;
+}
+
+bool layx_get_contain(layx_context *ctx, layx_id item)
+{
+    return (layx_get_item(ctx, item)->flags & LAYX_ITEM_CONTAIN) != 0;
+}
+
+layx_position_type layx_get_position_type(layx_context *ctx, layx_id item)
+{
+    return (layx_get_item(ctx, item)->flags & LAYX_ITEM_ABSOLUTE) ? LAYX_POSITION_ABSOLUTE : LAYX_POSITION_STATIC;
 }
 
 void layx_get_position_ltrb(layx_context *ctx, layx_id item, layx_scalar *left, layx_scalar *top, layx_scalar *right, layx_scalar *bottom)
@@ -713,6 +1941,68 @@ void layx_get_position_ltrb(layx_context *ctx, layx_id item, layx_scalar *left,
     *bottom = pitem->position[3];
 }
 
+// Grid properties
+static void layx_set_grid_tracks(layx_context *ctx, layx_id item, int dim, const layx_grid_track *tracks, uint32_t count)
+{
+    LAYX_RECORD_BYTES(ctx, dim == 0 ? LAYX_REC_GRID_COLUMNS : LAYX_REC_GRID_ROWS, item, count,
+                      tracks, count * sizeof(layx_grid_track));
+    LAYX_ASSERT(tracks != NULL || count == 0);
+    layx_grid *grid = layx_grid_ensure(ctx, item);
+    layx_grid_copy_tracks(grid, dim, tracks, count);
+    layx_invalidate(ctx, item);
+}
+
+void layx_set_grid_columns(layx_context *ctx, layx_id item, const layx_grid_track *tracks, uint32_t count)
+{
+    layx_set_grid_tracks(ctx, item, 0, tracks, count);
+}
+
+void layx_set_grid_rows(layx_context *ctx, layx_id item, const layx_grid_track *tracks, uint32_t count)
+{
+    layx_set_grid_tracks(ctx, item, 1, tracks, count);
+}
+
+void layx_set_grid_cell(layx_context *ctx, layx_id item, uint32_t column, uint32_t row)
+{
+    LAYX_RECORD_CALL(ctx, LAYX_REC_GRID_CELL, item, column, row);
+    LAYX_ASSERT(column < UINT16_MAX && row < UINT16_MAX);
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    pitem->grid_cell[0] = (uint16_t)(column + 1);
+    pitem->grid_cell[1] = (uint16_t)(row + 1);
+    layx_invalidate(ctx, item);
+}
+
+void layx_set_grid_span(layx_context *ctx, layx_id item, uint32_t columns, uint32_t rows)
+{
+    LAYX_RECORD_CALL(ctx, LAYX_REC_GRID_SPAN, item, columns, rows);
+    LAYX_ASSERT(columns <= UINT8_MAX && rows <= UINT8_MAX);
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    pitem->grid_span[0] = (uint8_t)columns;
+    pitem->grid_span[1] = (uint8_t)rows;
+    layx_invalidate(ctx, item);
+}
+
+void layx_clear_grid_cell(layx_context *ctx, layx_id item)
+{
+    LAYX_RECORD_CALL(ctx, LAYX_REC_CLEAR_GRID_CELL, item);
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    pitem->grid_cell[0] = pitem->grid_cell[1] = 0;
+    layx_invalidate(ctx, item);
+}
+
+uint32_t layx_get_grid_track_offsets(layx_context *ctx, layx_id item, int dim, const float **offsets)
+{
+    LAYX_ASSERT(dim == 0 || dim == 1);
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    if (pitem->grid == 0) {
+        if (offsets) *offsets = NULL;
+        return 0;
+    }
+    const layx_grid *grid = ctx->grids.records + pitem->grid;
+    if (offsets) *offsets = grid->offsets[dim];
+    return grid->resolved_count[dim];
+}
+
 void layx_set_size(layx_context *ctx, layx_id item, layx_scalar width, layx_scalar height)
 {
     layx_set_width(ctx, item, width);
@@ -726,26 +2016,32 @@ layx_vec2 layx_get_size(layx_context *ctx, layx_id item)
 }
 
 // Flex item properties
-void layx_set_flex_grow(layx_context *ctx, layx_id item, layx_scalar grow)
+void layx_set_flex_grow(layx_context *ctx, layx_id item, float grow)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_FLEX_GROW, item, layx_record_float(grow));
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_FLEX_ITEM);
     pitem->flex_grow = grow;
 }
 
-void layx_set_flex_shrink(layx_context *ctx, layx_id item, layx_scalar shrink)
+void layx_set_flex_shrink(layx_context *ctx, layx_id item, float shrink)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_FLEX_SHRINK, item, layx_record_float(shrink));
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_FLEX_ITEM);
     pitem->flex_shrink = shrink;
 }
 
 void layx_set_flex_basis(layx_context *ctx, layx_id item, layx_scalar basis)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_FLEX_BASIS, item, layx_record_scalar(basis));
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_FLEX_ITEM);
     pitem->flex_basis = basis;
 }
 
 void layx_set_flex_properties(layx_context *ctx, layx_id item,
-                                 layx_scalar grow, layx_scalar shrink, layx_scalar basis)
+                                 float grow, float shrink, layx_scalar basis)
 {
     layx_set_flex_grow(ctx, item, grow);
     layx_set_flex_shrink(ctx, item, shrink);
@@ -753,9 +2049,40 @@ void layx_set_flex_properties(layx_context *ctx, layx_id item,
 }
 
 // Align self
+// Gap
+static void layx_set_gap_dim(layx_context *ctx, layx_id item, int dim, layx_scalar value)
+{
+    LAYX_RECORD_CALL(ctx, dim == 0 ? LAYX_REC_COLUMN_GAP : LAYX_REC_ROW_GAP, item, layx_record_scalar(value));
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    pitem->gap[dim] = value;
+    // grid 轨道起点包含间距
+    if (pitem->grid != 0) {
+        ctx->grids.records[pitem->grid].cached[dim] = false;
+    }
+    layx_invalidate(ctx, item);
+}
+
+void layx_set_gap(layx_context *ctx, layx_id item, layx_scalar row_gap, layx_scalar column_gap)
+{
+    layx_set_gap_dim(ctx, item, 1, row_gap);
+    layx_set_gap_dim(ctx, item, 0, column_gap);
+}
+
+void layx_set_row_gap(layx_context *ctx, layx_id item, layx_scalar row_gap)
+{
+    layx_set_gap_dim(ctx, item, 1, row_gap);
+}
+
+void layx_set_column_gap(layx_context *ctx, layx_id item, layx_scalar column_gap)
+{
+    layx_set_gap_dim(ctx, item, 0, column_gap);
+}
+
 void layx_set_align_self(layx_context *ctx, layx_id item, layx_align_self align)
 {
+    LAYX_RECORD_CALL(ctx, LAYX_REC_ALIGN_SELF, item, (uint32_t)align);
     layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_touch(ctx, item, pitem, LAYX_STYLE_ALIGN_SELF);
     uint32_t flags = pitem->flags;
     flags &= ~LAYX_ALIGN_SELF_MASK;
     flags |= layx_align_self_to_flags(align);
@@ -763,49 +2090,52 @@ void layx_set_align_self(layx_context *ctx, layx_id item, layx_align_self align)
 }
 
 /* 生成单个方向的设置函数 */
-#define LAYX_GEN_SIDE_SETTER(field, side, side_idx) \
+#define LAYX_GEN_SIDE_SETTER(field, kind, group, side, side_idx) \
 void layx_set_##field##_##side(layx_context *ctx, layx_id item, layx_scalar value) \
 { \
+    LAYX_RECORD_CALL(ctx, LAYX_REC_BOX_SIDE, item, kind, TRBL_##side_idx, layx_record_scalar(value)); \
     layx_item_t *pitem = layx_get_item(ctx, item); \
-    pitem->field##_trbl[TRBL_##side_idx] = value; \
+    layx_touch(ctx, item, pitem, group); \
+    layx_vec4 trbl = layx_item_box(ctx, pitem, kind); \
+    trbl[TRBL_##side_idx] = value; \
+    layx_store_box(ctx, pitem, kind, trbl); \
 }
 
 /* 生成完整的四个方向设置函数 */
-#define LAYX_GEN_ALL_SIDES(field) \
-    LAYX_GEN_SIDE_SETTER(field, top, TOP) \
-    LAYX_GEN_SIDE_SETTER(field, right, RIGHT) \
-    LAYX_GEN_SIDE_SETTER(field, bottom, BOTTOM) \
-    LAYX_GEN_SIDE_SETTER(field, left, LEFT) \
+#define LAYX_GEN_ALL_SIDES(field, kind, group) \
+    LAYX_GEN_SIDE_SETTER(field, kind, group, top, TOP) \
+    LAYX_GEN_SIDE_SETTER(field, kind, group, right, RIGHT) \
+    LAYX_GEN_SIDE_SETTER(field, kind, group, bottom, BOTTOM) \
+    LAYX_GEN_SIDE_SETTER(field, kind, group, left, LEFT) \
     void layx_set_##field(layx_context *ctx, layx_id item, layx_scalar value) \
     { \
+        LAYX_RECORD_CALL(ctx, LAYX_REC_BOX, item, kind, layx_record_scalar(value)); \
         layx_item_t *pitem = layx_get_item(ctx, item); \
-        pitem->field##_trbl[TRBL_LEFT]   = value; \
-        pitem->field##_trbl[TRBL_TOP]    = value; \
-        pitem->field##_trbl[TRBL_RIGHT]  = value; \
-        pitem->field##_trbl[TRBL_BOTTOM] = value; \
+        layx_touch(ctx, item, pitem, group); \
+        layx_store_box(ctx, pitem, kind, layx_vec4_xyzw(value, value, value, value)); \
     } \
     void layx_set_##field##_trbl(layx_context *ctx, layx_id item, \
                                layx_scalar top, \
                                layx_scalar right, layx_scalar bottom,layx_scalar left) \
     { \
+        LAYX_RECORD_CALL(ctx, LAYX_REC_BOX_TRBL, item, kind, layx_record_scalar(top), layx_record_scalar(right), \
+                         layx_record_scalar(bottom), layx_record_scalar(left)); \
         layx_item_t *pitem = layx_get_item(ctx, item); \
-        pitem->field##_trbl[TRBL_LEFT]   = left; \
-        pitem->field##_trbl[TRBL_TOP]    = top; \
-        pitem->field##_trbl[TRBL_RIGHT]  = right; \
-        pitem->field##_trbl[TRBL_BOTTOM] = bottom; \
+        layx_touch(ctx, item, pitem, group); \
+        layx_store_box(ctx, pitem, kind, layx_vec4_xyzw(top, right, bottom, left)); \
     }
 
 /* 生成三组函数 */
-LAYX_GEN_ALL_SIDES(margin)
-LAYX_GEN_ALL_SIDES(border)
-LAYX_GEN_ALL_SIDES(padding)
+LAYX_GEN_ALL_SIDES(margin, LAYX_BOX_MARGIN, LAYX_STYLE_MARGIN)
+LAYX_GEN_ALL_SIDES(border, LAYX_BOX_BORDER, LAYX_STYLE_BORDER)
+LAYX_GEN_ALL_SIDES(padding, LAYX_BOX_PADDING, LAYX_STYLE_PADDING)
 
 
 // Getters for box model
 void layx_get_margin_trbl(layx_context *ctx, layx_id item, layx_scalar *top, layx_scalar *right, layx_scalar *bottom,layx_scalar *left)
 {
     layx_item_t *pitem = layx_get_item(ctx, item);
-    layx_vec4 margins = pitem->margin_trbl;
+    layx_vec4 margins = layx_item_box(ctx, pitem, LAYX_BOX_MARGIN);
     *top = GET_TOP(margins);
     *right = GET_RIGHT(margins);
     *bottom = GET_BOTTOM(margins);
@@ -815,7 +2145,7 @@ void layx_get_margin_trbl(layx_context *ctx, layx_id item, layx_scalar *top, lay
 void layx_get_padding_trbl(layx_context *ctx, layx_id item,  layx_scalar *top, layx_scalar *right, layx_scalar *bottom,layx_scalar *left)
 {
     layx_item_t *pitem = layx_get_item(ctx, item);
-    layx_vec4 padding = pitem->padding_trbl;
+    layx_vec4 padding = layx_item_box(ctx, pitem, LAYX_BOX_PADDING);
     *top = GET_TOP(padding);
     *right = GET_RIGHT(padding);
     *bottom = GET_BOTTOM(padding);
@@ -825,97 +2155,463 @@ void layx_get_padding_trbl(layx_context *ctx, layx_id item,  layx_scalar *top, l
 void layx_get_border_trbl(layx_context *ctx, layx_id item, layx_scalar *top, layx_scalar *right, layx_scalar *bottom,layx_scalar *left)
 {
     layx_item_t *pitem = layx_get_item(ctx, item);
-    layx_vec4 border = pitem->border_trbl;
+    layx_vec4 border = layx_item_box(ctx, pitem, LAYX_BOX_BORDER);
     *top = GET_TOP(border);
     *right = GET_RIGHT(border);
     *bottom = GET_BOTTOM(border);
     *left = GET_LEFT(border);
 }
 
-// Style application
-void layx_style_reset(layx_style *style)
+// Style application
+void layx_style_reset(layx_style *style)
+{
+    LAYX_MEMSET(style, 0, sizeof(layx_style));
+}
+
+// 计算样式中需要应用的属性组：零值表示未设置
+static uint16_t layx_style_groups(const layx_style *style)
+{
+    uint16_t groups = 0;
+    if (style->display != 0) groups |= LAYX_STYLE_DISPLAY;
+    if (style->flex_direction != 0) groups |= LAYX_STYLE_FLEX_DIRECTION;
+    if (style->flex_wrap != 0) groups |= LAYX_STYLE_FLEX_WRAP;
+    if (style->justify_content != 0) groups |= LAYX_STYLE_JUSTIFY_CONTENT;
+    if (style->align_items != 0) groups |= LAYX_STYLE_ALIGN_ITEMS;
+    if (style->align_content != 0) groups |= LAYX_STYLE_ALIGN_CONTENT;
+    if (style->width != 0 || style->height != 0) groups |= LAYX_STYLE_SIZE;
+    if (style->min_width != 0) groups |= LAYX_STYLE_MIN_WIDTH;
+    if (style->min_height != 0) groups |= LAYX_STYLE_MIN_HEIGHT;
+    if (style->max_width != 0) groups |= LAYX_STYLE_MAX_WIDTH;
+    if (style->max_height != 0) groups |= LAYX_STYLE_MAX_HEIGHT;
+    if (style->margin_top != 0 || style->margin_right != 0 ||
+        style->margin_bottom != 0 || style->margin_left != 0) {
+        groups |= LAYX_STYLE_MARGIN;
+    }
+    if (style->padding_top != 0 || style->padding_right != 0 ||
+        style->padding_bottom != 0 || style->padding_left != 0) {
+        groups |= LAYX_STYLE_PADDING;
+    }
+    if (style->border_top != 0 || style->border_right != 0 ||
+        style->border_bottom != 0 || style->border_left != 0) {
+        groups |= LAYX_STYLE_BORDER;
+    }
+    if (style->flex_grow != 0 || style->flex_shrink != 0 || style->flex_basis != 0) {
+        groups |= LAYX_STYLE_FLEX_ITEM;
+    }
+    if (style->align_self != 0) groups |= LAYX_STYLE_ALIGN_SELF;
+    return groups;
+}
+
+static void layx_apply_style_groups(layx_context *ctx, layx_id item, const layx_style *style, uint16_t groups)
+{
+    // Display / flex container
+    if (groups & LAYX_STYLE_DISPLAY) layx_set_display(ctx, item, style->display);
+    if (groups & LAYX_STYLE_FLEX_DIRECTION) layx_set_flex_direction(ctx, item, style->flex_direction);
+    if (groups & LAYX_STYLE_FLEX_WRAP) layx_set_flex_wrap(ctx, item, style->flex_wrap);
+    if (groups & LAYX_STYLE_JUSTIFY_CONTENT) layx_set_justify_content(ctx, item, style->justify_content);
+    if (groups & LAYX_STYLE_ALIGN_ITEMS) layx_set_align_items(ctx, item, style->align_items);
+    if (groups & LAYX_STYLE_ALIGN_CONTENT) layx_set_align_content(ctx, item, style->align_content);
+
+    // Size properties
+    if (groups & LAYX_STYLE_SIZE) layx_set_size(ctx, item, style->width, style->height);
+    if (groups & LAYX_STYLE_MIN_WIDTH) layx_set_min_width(ctx, item, style->min_width);
+    if (groups & LAYX_STYLE_MIN_HEIGHT) layx_set_min_height(ctx, item, style->min_height);
+    if (groups & LAYX_STYLE_MAX_WIDTH) layx_set_max_width(ctx, item, style->max_width);
+    if (groups & LAYX_STYLE_MAX_HEIGHT) layx_set_max_height(ctx, item, style->max_height);
+
+    // Box model
+    if (groups & LAYX_STYLE_MARGIN) {
+        layx_set_margin_trbl(ctx, item, style->margin_top,
+                             style->margin_right, style->margin_bottom, style->margin_left);
+    }
+    if (groups & LAYX_STYLE_PADDING) {
+        layx_set_padding_trbl(ctx, item, style->padding_top,
+                              style->padding_right, style->padding_bottom, style->padding_left);
+    }
+    if (groups & LAYX_STYLE_BORDER) {
+        layx_set_border_trbl(ctx, item, style->border_top,
+                             style->border_right, style->border_bottom, style->border_left);
+    }
+
+    // Flex item properties
+    if (groups & LAYX_STYLE_FLEX_ITEM) {
+        layx_set_flex_properties(ctx, item, style->flex_grow, style->flex_shrink, style->flex_basis);
+    }
+    if (groups & LAYX_STYLE_ALIGN_SELF) layx_set_align_self(ctx, item, style->align_self);
+}
+
+void layx_apply_style(layx_context *ctx, layx_id item, const layx_style *style)
+{
+    layx_apply_style_groups(ctx, item, style, layx_style_groups(style));
+}
+
+layx_id layx_create_item_with_style(layx_context *ctx, const layx_style *style)
+{
+    layx_id item = layx_item(ctx);
+    layx_apply_style(ctx, item, style);
+    return item;
+}
+
+// Shared styles
+// 重置属性组时使用的默认值，与 layx_item 初始化一致
+static const layx_style layx_default_style = { .flex_shrink = 1 };
+
+// 按字段展开为 32 位键再做哈希与比较：整数标量模式下 layx_style 末尾有填充字节，
+// 调用者构造的样式中这些字节的内容不确定，不能直接按字节处理
+#define LAYX_STYLE_KEY_WORDS 28
+
+static uint32_t layx_scalar_key(layx_scalar value)
+{
+#if LAYX_FLOAT == 1
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+#else
+    return (uint16_t)value;
+#endif
+}
+
+static uint32_t layx_factor_key(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static void layx_style_key(const layx_style *style, uint32_t key[LAYX_STYLE_KEY_WORDS])
+{
+    uint32_t *k = key;
+    *k++ = (uint32_t)style->display;
+    *k++ = (uint32_t)style->flex_direction;
+    *k++ = (uint32_t)style->flex_wrap;
+    *k++ = (uint32_t)style->justify_content;
+    *k++ = (uint32_t)style->align_items;
+    *k++ = (uint32_t)style->align_content;
+    *k++ = layx_scalar_key(style->width);
+    *k++ = layx_scalar_key(style->height);
+    *k++ = layx_scalar_key(style->min_width);
+    *k++ = layx_scalar_key(style->min_height);
+    *k++ = layx_scalar_key(style->max_width);
+    *k++ = layx_scalar_key(style->max_height);
+    *k++ = layx_scalar_key(style->margin_top);
+    *k++ = layx_scalar_key(style->margin_right);
+    *k++ = layx_scalar_key(style->margin_bottom);
+    *k++ = layx_scalar_key(style->margin_left);
+    *k++ = layx_scalar_key(style->padding_top);
+    *k++ = layx_scalar_key(style->padding_right);
+    *k++ = layx_scalar_key(style->padding_bottom);
+    *k++ = layx_scalar_key(style->padding_left);
+    *k++ = layx_scalar_key(style->border_top);
+    *k++ = layx_scalar_key(style->border_right);
+    *k++ = layx_scalar_key(style->border_bottom);
+    *k++ = layx_scalar_key(style->border_left);
+    *k++ = (uint32_t)style->align_self;
+    *k++ = layx_factor_key(style->flex_grow);
+    *k++ = layx_factor_key(style->flex_shrink);
+    *k++ = layx_scalar_key(style->flex_basis);
+    LAYX_ASSERT(k == key + LAYX_STYLE_KEY_WORDS);
+}
+
+static uint32_t layx_style_hash(const layx_style *style)
+{
+    // FNV-1a
+    uint32_t key[LAYX_STYLE_KEY_WORDS];
+    layx_style_key(style, key);
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < LAYX_STYLE_KEY_WORDS; ++i) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            hash = (hash ^ ((key[i] >> shift) & 0xFF)) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+static bool layx_style_equal(const layx_style *a, const layx_style *b)
+{
+    uint32_t key_a[LAYX_STYLE_KEY_WORDS];
+    uint32_t key_b[LAYX_STYLE_KEY_WORDS];
+    layx_style_key(a, key_a);
+    layx_style_key(b, key_b);
+    return memcmp(key_a, key_b, sizeof(key_a)) == 0;
+}
+
+// 内容不同的属性组
+static uint16_t layx_style_diff(const layx_style *a, const layx_style *b)
+{
+    uint32_t key_a[LAYX_STYLE_KEY_WORDS];
+    uint32_t key_b[LAYX_STYLE_KEY_WORDS];
+    layx_style_key(a, key_a);
+    layx_style_key(b, key_b);
+    // 与 layx_style_key 的字段顺序对应
+    static const uint16_t groups[LAYX_STYLE_KEY_WORDS] = {
+        LAYX_STYLE_DISPLAY, LAYX_STYLE_FLEX_DIRECTION, LAYX_STYLE_FLEX_WRAP,
+        LAYX_STYLE_JUSTIFY_CONTENT, LAYX_STYLE_ALIGN_ITEMS, LAYX_STYLE_ALIGN_CONTENT,
+        LAYX_STYLE_SIZE, LAYX_STYLE_SIZE,
+        LAYX_STYLE_MIN_WIDTH, LAYX_STYLE_MIN_HEIGHT, LAYX_STYLE_MAX_WIDTH, LAYX_STYLE_MAX_HEIGHT,
+        LAYX_STYLE_MARGIN, LAYX_STYLE_MARGIN, LAYX_STYLE_MARGIN, LAYX_STYLE_MARGIN,
+        LAYX_STYLE_PADDING, LAYX_STYLE_PADDING, LAYX_STYLE_PADDING, LAYX_STYLE_PADDING,
+        LAYX_STYLE_BORDER, LAYX_STYLE_BORDER, LAYX_STYLE_BORDER, LAYX_STYLE_BORDER,
+        LAYX_STYLE_ALIGN_SELF,
+        LAYX_STYLE_FLEX_ITEM, LAYX_STYLE_FLEX_ITEM, LAYX_STYLE_FLEX_ITEM
+    };
+    uint16_t changed = 0;
+    for (int i = 0; i < LAYX_STYLE_KEY_WORDS; ++i) {
+        if (key_a[i] != key_b[i]) changed |= groups[i];
+    }
+    return changed;
+}
+
+// 引用者列表：解除引用时只减少 users，不从列表中删除，
+// 列表中可能留有已改用其他样式或已销毁的 id 以及重复的 id，使用前由 layx_style_compact_users 整理
+static int layx_compare_ids(const void *a, const void *b)
+{
+    const layx_id x = *(const layx_id*)a;
+    const layx_id y = *(const layx_id*)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static void layx_style_compact_users(layx_context *ctx, layx_style_id style)
+{
+    layx_style_record *record = ctx->styles.records + style;
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < record->user_count; ++i) {
+        const layx_id item = record->user_ids[i];
+        if (item < ctx->count && ctx->items[item].style_id == style) {
+            record->user_ids[n++] = item;
+        }
+    }
+    qsort(record->user_ids, n, sizeof(layx_id), layx_compare_ids);
+    uint32_t unique = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        if (unique == 0 || record->user_ids[unique - 1] != record->user_ids[i]) {
+            record->user_ids[unique++] = record->user_ids[i];
+        }
+    }
+    record->user_count = unique;
+}
+
+static void layx_style_add_user(layx_context *ctx, layx_style_id style, layx_id item)
+{
+    layx_style_record *record = ctx->styles.records + style;
+    record->users++;
+    if (record->user_count >= record->user_capacity) {
+        // 失效条目超过一半时先整理，反复切换样式不会让列表无限增长
+        if (record->user_count >= 32 && record->user_count >= 2 * (uint32_t)record->users) {
+            layx_style_compact_users(ctx, style);
+        }
+        if (record->user_count >= record->user_capacity) {
+            record->user_capacity = record->user_capacity < 1 ? 8 : record->user_capacity * 2;
+            LAYX_STATS_COUNT(ctx, grow_events);
+            record->user_ids = (layx_id*)LAYX_REALLOC(record->user_ids, record->user_capacity * sizeof(layx_id));
+        }
+    }
+    record->user_ids[record->user_count++] = item;
+}
+
+static void layx_style_slot_insert(layx_style_table *table, uint32_t hash, layx_style_id id)
+{
+    const uint32_t mask = table->slot_capacity - 1;
+    uint32_t slot = hash & mask;
+    while (table->slots[slot] != LAYX_NO_STYLE) {
+        slot = (slot + 1) & mask;
+    }
+    table->slots[slot] = id;
+    table->slot_used++;
+}
+
+// 为一次插入预留槽位。负载超过一半时扩容并按记录当前的 hash 重建，
+// 同时丢弃 layx_update_style 留下的旧槽位
+static void layx_style_slots_reserve(layx_style_table *table)
+{
+    if ((table->slot_used + 1) * 2 <= table->slot_capacity) return;
+    uint32_t capacity = table->slot_capacity < 1 ? 64 : table->slot_capacity;
+    while ((table->count + 1) * 2 > capacity) capacity *= 2;
+    LAYX_FREE(table->slots);
+    table->slots = (layx_style_id*)LAYX_REALLOC(NULL, capacity * sizeof(layx_style_id));
+    LAYX_MEMSET(table->slots, 0, capacity * sizeof(layx_style_id));
+    table->slot_capacity = capacity;
+    table->slot_used = 0;
+    for (uint32_t i = 1; i < table->count; ++i) {
+        layx_style_slot_insert(table, table->records[i].hash, i);
+    }
+}
+
+layx_style_id layx_intern_style(layx_context *ctx, const layx_style *style)
+{
+    LAYX_ASSERT(ctx != NULL && style != NULL);
+    layx_style_table *table = &ctx->styles;
+    const uint32_t hash = layx_style_hash(style);
+
+    if (table->slot_capacity > 0) {
+        const uint32_t mask = table->slot_capacity - 1;
+        for (uint32_t slot = hash & mask; table->slots[slot] != LAYX_NO_STYLE; slot = (slot + 1) & mask) {
+            const layx_style_record *record = table->records + table->slots[slot];
+            if (record->hash == hash && layx_style_equal(&record->style, style)) {
+                LAYX_RECORD_BYTES(ctx, LAYX_REC_INTERN_STYLE, (layx_id)table->slots[slot], 1, style, sizeof(layx_style));
+                return table->slots[slot];
+            }
+        }
+    }
+
+    if (table->count == 0) table->count = 1;  // records[0] 保留
+    layx_style_slots_reserve(table);
+    if (table->count >= table->capacity) {
+        table->capacity = table->capacity < 1 ? 16 : table->capacity * 2;
+        LAYX_STATS_COUNT(ctx, grow_events);
+        table->records = (layx_style_record*)LAYX_REALLOC(table->records, table->capacity * sizeof(layx_style_record));
+    }
+    const layx_style_id id = table->count++;
+    layx_style_record *record = table->records + id;
+    record->style = *style;
+    record->hash = hash;
+    record->set_mask = layx_style_groups(style);
+    record->box = 0;
+    record->users = 0;
+    record->user_ids = NULL;
+    record->user_count = 0;
+    record->user_capacity = 0;
+    layx_style_slot_insert(table, hash, id);
+    LAYX_RECORD_BYTES(ctx, LAYX_REC_INTERN_STYLE, (layx_id)id, 1, style, sizeof(layx_style));
+    return id;
+}
+
+#define LAYX_STYLE_BOX_GROUPS (LAYX_STYLE_MARGIN | LAYX_STYLE_PADDING | LAYX_STYLE_BORDER)
+
+// 属性组掩码中盒模型的部分换成 LAYX_BOX_* 位
+static LAYX_FORCE_INLINE uint8_t layx_style_box_mask(uint16_t groups)
+{
+    return (uint8_t)(((groups & LAYX_STYLE_MARGIN) ? 1u << LAYX_BOX_MARGIN : 0u)
+                   | ((groups & LAYX_STYLE_PADDING) ? 1u << LAYX_BOX_PADDING : 0u)
+                   | ((groups & LAYX_STYLE_BORDER) ? 1u << LAYX_BOX_BORDER : 0u));
+}
+
+// 把样式的 margin / padding / border 写入它的共享记录
+static void layx_style_fill_box(layx_context *ctx, const layx_style_record *record)
+{
+    const layx_style *style = &record->style;
+    layx_box *box = ctx->boxes.records + record->box;
+    box->trbl[LAYX_BOX_MARGIN] = layx_vec4_xyzw(style->margin_top, style->margin_right, style->margin_bottom, style->margin_left);
+    box->trbl[LAYX_BOX_PADDING] = layx_vec4_xyzw(style->padding_top, style->padding_right, style->padding_bottom, style->padding_left);
+    box->trbl[LAYX_BOX_BORDER] = layx_vec4_xyzw(style->border_top, style->border_right, style->border_bottom, style->border_left);
+}
+
+// item 改为指向样式的盒模型记录，本地记录释放
+static void layx_style_share_box(layx_context *ctx, layx_id item)
+{
+    layx_item_t *pitem = ctx->items + item;
+    layx_style_record *record = ctx->styles.records + pitem->style_id;
+    if (pitem->box_mask != 0 && !layx_box_shared(ctx, pitem)) layx_box_release(ctx, pitem);
+    const uint8_t mask = layx_style_box_mask(record->set_mask);
+    if (mask != 0 && record->box == 0) {
+        record->box = layx_box_alloc(ctx);
+        layx_style_fill_box(ctx, record);
+    }
+    pitem->box = mask != 0 ? record->box : 0;
+    pitem->box_mask = mask;
+}
+
+// 按共享记录重写 item：reset 中的属性组恢复默认值，apply 中的属性组取记录的值，
+// 本地覆盖的属性组保持不变。没有本地覆盖盒模型、也没有样式之外的盒模型值时，
+// 三组盒模型直接共享样式的记录，不逐个调用 setter
+static void layx_style_refresh(layx_context *ctx, layx_id item, const layx_style *style,
+                               uint16_t reset, uint16_t apply)
+{
+    layx_item_t *pitem = ctx->items + item;
+    const uint16_t overrides = pitem->style_overrides;
+    const uint16_t keep = (uint16_t)~overrides;
+    const uint8_t local = layx_box_shared(ctx, pitem)
+        ? 0 : (uint8_t)(pitem->box_mask & ~layx_style_box_mask(reset | ctx->styles.records[pitem->style_id].set_mask));
+    const bool share = (overrides & LAYX_STYLE_BOX_GROUPS) == 0 && local == 0;
+    const uint16_t setters = share ? (uint16_t)(keep & ~LAYX_STYLE_BOX_GROUPS) : keep;
+    LAYX_RECORD_MUTE(ctx, 1);
+    layx_apply_style_groups(ctx, item, &layx_default_style, reset & setters);
+    layx_apply_style_groups(ctx, item, style, apply & setters);
+    LAYX_RECORD_MUTE(ctx, -1);
+    pitem->style_overrides = overrides;
+    if (share) {
+        layx_style_share_box(ctx, item);
+        if ((reset | apply) & LAYX_STYLE_BOX_GROUPS) layx_invalidate(ctx, item);
+    }
+}
+
+void layx_set_style(layx_context *ctx, layx_id item, layx_style_id style)
+{
+    LAYX_RECORD_CALL(ctx, LAYX_REC_SET_STYLE, item, (uint32_t)style);
+    LAYX_ASSERT(ctx != NULL);
+    LAYX_ASSERT(style < ctx->styles.count || style == LAYX_NO_STYLE);
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    const layx_style_id old = pitem->style_id;
+    if (old == style) return;
+
+    // 与旧样式共享的盒模型记录先转为本地副本：解除引用后属性值保留，换用新样式时再重新共享
+    if (layx_box_shared(ctx, pitem)) layx_box_unshare(ctx, pitem);
+    uint16_t old_mask = 0;
+    if (old != LAYX_NO_STYLE) {
+        ctx->styles.records[old].users--;
+        old_mask = ctx->styles.records[old].set_mask;
+    }
+    pitem->style_id = style;
+    if (style == LAYX_NO_STYLE) {
+        // 解除引用：当前属性值全部转为本地值
+        pitem->style_overrides = 0;
+        return;
+    }
+
+    layx_style_add_user(ctx, style, item);
+    layx_style_record *record = ctx->styles.records + style;
+    layx_style_refresh(ctx, item, &record->style, old_mask & ~record->set_mask, record->set_mask);
+}
+
+layx_style_id layx_get_style(layx_context *ctx, layx_id item)
+{
+    return layx_get_item(ctx, item)->style_id;
+}
+
+const layx_style *layx_get_style_record(layx_context *ctx, layx_style_id style)
+{
+    LAYX_ASSERT(ctx != NULL);
+    if (style == LAYX_NO_STYLE || style >= ctx->styles.count) return NULL;
+    return &ctx->styles.records[style].style;
+}
+
+layx_id layx_style_users(layx_context *ctx, layx_style_id style)
 {
-    LAYX_MEMSET(style, 0, sizeof(layx_style));
+    LAYX_ASSERT(ctx != NULL && style != LAYX_NO_STYLE && style < ctx->styles.count);
+    return ctx->styles.records[style].users;
 }
 
-void layx_apply_style(layx_context *ctx, layx_id item, const layx_style *style)
+// 原地修改共享记录。旧内容的槽位保留到下次重建：查找时逐个比较内容，旧槽位不会误命中
+void layx_update_style(layx_context *ctx, layx_style_id style, const layx_style *values)
 {
-    // Display
-    if (style->display != 0) {
-        layx_set_display(ctx, item, style->display);
-    }
-    
-    // Flex properties
-    if (style->flex_direction != 0) {
-        layx_set_flex_direction(ctx, item, style->flex_direction);
-    }
-    if (style->flex_wrap != 0) {
-        layx_set_flex_wrap(ctx, item, style->flex_wrap);
-    }
-    if (style->justify_content != 0) {
-        layx_set_justify_content(ctx, item, style->justify_content);
-    }
-    if (style->align_items != 0) {
-        layx_set_align_items(ctx, item, style->align_items);
-    }
-    if (style->align_content != 0) {
-        layx_set_align_content(ctx, item, style->align_content);
-    }
-    
-    // Size properties
-    if (style->width != 0 || style->height != 0) {
-        layx_set_size(ctx, item, style->width, style->height);
-    }
-    if (style->min_width != 0) {
-        layx_set_min_width(ctx, item, style->min_width);
-    }
-    if (style->min_height != 0) {
-        layx_set_min_height(ctx, item, style->min_height);
-    }
-    if (style->max_width != 0) {
-        layx_set_max_width(ctx, item, style->max_width);
-    }
-    if (style->max_height != 0) {
-        layx_set_max_height(ctx, item, style->max_height);
-    }
-    
-    // Box model
-    if (style->margin_top != 0 || style->margin_right != 0 || 
-        style->margin_bottom != 0 || style->margin_left != 0) {
-        layx_set_margin_trbl(ctx, item,
-                             style->margin_top,
-                             style->margin_right, style->margin_bottom,style->margin_left);
-    }
-    if (style->padding_top != 0 || style->padding_right != 0 || 
-        style->padding_bottom != 0 || style->padding_left != 0) {
-        layx_set_padding_trbl(ctx, item,style->padding_top,
-                             style->padding_right, style->padding_bottom,
-                             style->padding_left);
-    }
-    if (style->border_top != 0 || style->border_right != 0 || 
-        style->border_bottom != 0 || style->border_left != 0) {
-        layx_set_border_trbl(ctx, item,
-                              style->border_top,
-                             style->border_right, style->border_bottom,style->border_left);
-    }
-    
-    // Flex item properties
-    if (style->flex_grow != 0 || style->flex_shrink != 0 || style->flex_basis != 0) {
-        layx_set_flex_properties(ctx, item, style->flex_grow, style->flex_shrink, style->flex_basis);
-    }
-    
-    // Align self
-    if (style->align_self != 0) {
-        layx_set_align_self(ctx, item, style->align_self);
+    LAYX_RECORD_BYTES(ctx, LAYX_REC_UPDATE_STYLE, (layx_id)style, 1, values, sizeof(layx_style));
+    LAYX_ASSERT(ctx != NULL && values != NULL);
+    LAYX_ASSERT(style != LAYX_NO_STYLE && style < ctx->styles.count);
+    layx_style_table *table = &ctx->styles;
+    layx_style_record *record = table->records + style;
+    if (layx_style_equal(&record->style, values)) return;
+
+    const uint16_t old_mask = record->set_mask;
+    const uint16_t changed = layx_style_diff(&record->style, values);
+    layx_style_slots_reserve(table);
+    record->style = *values;
+    record->hash = layx_style_hash(values);
+    record->set_mask = layx_style_groups(values);
+    layx_style_slot_insert(table, record->hash, style);
+    // 共享的盒模型记录只改这一份，引用者只需要标脏
+    if (record->box != 0) layx_style_fill_box(ctx, record);
+
+    // 只访问引用者，开销与上下文中的 item 总数无关；只重写内容变化的属性组
+    const uint16_t reset = old_mask & ~record->set_mask;
+    const uint16_t apply = record->set_mask & changed;
+    layx_style_compact_users(ctx, style);
+    LAYX_ASSERT(record->user_count == record->users);
+    for (uint32_t i = 0; i < record->user_count; ++i) {
+        layx_style_refresh(ctx, record->user_ids[i], &record->style, reset, apply);
     }
 }
 
-layx_id layx_create_item_with_style(layx_context *ctx, const layx_style *style)
-{
-    layx_id item = layx_item(ctx);
-    layx_apply_style(ctx, item, style);
-    return item;
-}
+// padding 或 border 不为 0 的 item 才需要从内容区扣除
+#define LAYX_BOX_FRAME_BITS ((1u << LAYX_BOX_PADDING) | (1u << LAYX_BOX_BORDER))
 
 // Helper function to get internal space available for children
 static LAYX_FORCE_INLINE
@@ -924,8 +2620,11 @@ layx_scalar layx_get_internal_space(
 {
     layx_item_t *pitem = layx_get_item(ctx, item);
     layx_vec4 rect = ctx->rects[item];
-    return rect[SIZE_DIM(dim)] - pitem->padding_trbl[START_SIDE(dim)] - pitem->border_trbl[START_SIDE(dim)] 
-                           - pitem->padding_trbl[END_SIDE(dim)] - pitem->border_trbl[END_SIDE(dim)];
+    if (!(pitem->box_mask & LAYX_BOX_FRAME_BITS)) return rect[SIZE_DIM(dim)];
+    const layx_vec4 padding = layx_item_box(ctx, pitem, LAYX_BOX_PADDING);
+    const layx_vec4 border = layx_item_box(ctx, pitem, LAYX_BOX_BORDER);
+    return rect[SIZE_DIM(dim)] - padding[START_SIDE(dim)] - border[START_SIDE(dim)] 
+                           - padding[END_SIDE(dim)] - border[END_SIDE(dim)];
 }
 
 // Helper function to get offset where children should be positioned
@@ -938,7 +2637,63 @@ layx_scalar layx_get_content_offset(
     layx_vec4 rect = ctx->rects[item]; // margin-boxing
 
     // dim 0 or 1: left or top
-    return rect[POINT_DIM(dim)] + pitem->padding_trbl[START_SIDE(dim)] + pitem->border_trbl[START_SIDE(dim)];
+    if (!(pitem->box_mask & LAYX_BOX_FRAME_BITS)) return rect[POINT_DIM(dim)];
+    return rect[POINT_DIM(dim)] + layx_item_box(ctx, pitem, LAYX_BOX_PADDING)[START_SIDE(dim)] + layx_item_box(ctx, pitem, LAYX_BOX_BORDER)[START_SIDE(dim)];
+}
+
+// 绝对定位的子元素不参与父元素的流式布局，尺寸计算和排列都跳过它们
+static LAYX_FORCE_INLINE layx_id layx_skip_out_of_flow(const layx_context *ctx, layx_id child)
+{
+    while (child != LAYX_INVALID_ID && (ctx->items[child].flags & LAYX_ITEM_ABSOLUTE)) {
+        child = ctx->items[child].next_sibling;
+    }
+    return child;
+}
+
+static LAYX_FORCE_INLINE layx_id layx_first_in_flow(const layx_context *ctx, const layx_item_t *pitem)
+{
+    return layx_skip_out_of_flow(ctx, pitem->first_child);
+}
+
+static LAYX_FORCE_INLINE layx_id layx_next_in_flow(const layx_context *ctx, const layx_item_t *pchild)
+{
+    return layx_skip_out_of_flow(ctx, pchild->next_sibling);
+}
+
+// 绝对定位：包含块为父元素的 padding-box。
+// 同时设置两侧偏移且未固定尺寸时拉伸；两侧都未设置时放在父元素内容区的起点（简化的静态位置）
+static LAYX_FORCE_INLINE void layx_arrange_absolute(layx_context *ctx, layx_id item, int dim)
+{
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    if (pitem->parent == LAYX_INVALID_ID) return;
+    const layx_item_t *pparent = layx_get_item(ctx, pitem->parent);
+    const layx_vec4 parent_rect = ctx->rects[pitem->parent];
+    const layx_vec4 parent_border = layx_item_box(ctx, pparent, LAYX_BOX_BORDER);
+    const layx_scalar start = parent_rect[POINT_DIM(dim)] + parent_border[START_SIDE(dim)];
+    const layx_scalar extent = parent_rect[SIZE_DIM(dim)] - parent_border[START_SIDE(dim)] - parent_border[END_SIDE(dim)];
+
+    // position 按 l t r b 存储
+    const bool has_start = (pitem->auto_flags & (dim == 0 ? POSITION_SET_LEFT : POSITION_SET_TOP)) != 0;
+    const bool has_end = (pitem->auto_flags & (dim == 0 ? POSITION_SET_RIGHT : POSITION_SET_BOTTOM)) != 0;
+    const layx_scalar offset_start = pitem->position[dim];
+    const layx_scalar offset_end = pitem->position[dim + 2];
+    const layx_vec4 margins = layx_item_box(ctx, pitem, LAYX_BOX_MARGIN);
+    const layx_scalar margin_start = margins[START_SIDE(dim)];
+    const layx_scalar margin_end = margins[END_SIDE(dim)];
+    const bool is_fixedsize = (pitem->flags & (dim == 0 ? LAYX_SIZE_FIXED_WIDTH : LAYX_SIZE_FIXED_HEIGHT)) && pitem->size[dim] > 0;
+
+    layx_vec4 rect = ctx->rects[item];
+    if (has_start && has_end && !is_fixedsize) {
+        rect[SIZE_DIM(dim)] = layx_scalar_max(0, extent - offset_start - offset_end - margin_start - margin_end);
+    }
+    if (has_start) {
+        rect[POINT_DIM(dim)] = start + offset_start + margin_start;
+    } else if (has_end) {
+        rect[POINT_DIM(dim)] = start + extent - offset_end - margin_end - rect[SIZE_DIM(dim)];
+    } else {
+        rect[POINT_DIM(dim)] = layx_get_content_offset(ctx, pitem->parent, dim) + margin_start;
+    }
+    ctx->rects[item] = rect;
 }
 
 // Helper to calculate overlayed size
@@ -948,17 +2703,18 @@ layx_scalar layx_calc_overlayed_size(
 {
     layx_item_t *LAYX_RESTRICT pitem = layx_get_item(ctx, item);
     layx_scalar need_size = 0;
-    layx_id child = pitem->first_child;
+    layx_id child = layx_first_in_flow(ctx, pitem);
     while (child != LAYX_INVALID_ID) {
         layx_item_t *pchild = layx_get_item(ctx, child);
         if(IS_AUTO_SIZE(pchild, dim)) {
             // TODO
         }
         layx_vec4 rect = ctx->rects[child];
+        const layx_vec4 margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
         // 只使用子元素的尺寸，不使用位置（位置在 arrange 阶段设置）
-        layx_scalar child_size = rect[SIZE_DIM(dim)] + pchild->margin_trbl[START_SIDE(dim)] + pchild->margin_trbl[END_SIDE(dim)];
+        layx_scalar child_size = rect[SIZE_DIM(dim)] + margins[START_SIDE(dim)] + margins[END_SIDE(dim)];
         need_size = layx_scalar_max(need_size, child_size);
-        child = pchild->next_sibling;
+        child = layx_next_in_flow(ctx, pchild);
     }
     return need_size;
 }
@@ -970,17 +2726,18 @@ layx_scalar layx_calc_stacked_size(
 {
     layx_item_t *pitem = layx_get_item(ctx, item);
     layx_scalar need_size = 0;
-    layx_id child = pitem->first_child;
+    layx_id child = layx_first_in_flow(ctx, pitem);
     layx_id prev_child = LAYX_INVALID_ID;
     
     const uint32_t item_flags = pitem->flags;
     bool is_flex_container = layx_is_flex_container(item_flags);
     bool is_vertical = (dim == 1);
+    const layx_scalar item_gap = pitem->gap[dim];
     
     while (child != LAYX_INVALID_ID) {
         layx_item_t *pchild = layx_get_item(ctx, child);
         layx_vec4 rect = ctx->rects[child];
-        const layx_vec4 margins = pchild->margin_trbl;
+        const layx_vec4 margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
         
         // 检查是否为inline元素
         bool is_inline = (pchild->flags & LAYX_DISPLAY_INLINE) != 0;
@@ -1006,7 +2763,8 @@ layx_scalar layx_calc_stacked_size(
                 need_size += margin_start;
             } else {
                 layx_item_t *pprev = layx_get_item(ctx, prev_child);
-                layx_scalar prev_margin_end = pprev->margin_trbl[END_SIDE(dim)];
+                layx_scalar prev_margin_end = layx_item_box(ctx, pprev, LAYX_BOX_MARGIN)[END_SIDE(dim)];
+                need_size += item_gap;
                 
                 if (is_flex_container) {
                     need_size += prev_margin_end + margin_start;
@@ -1024,7 +2782,7 @@ layx_scalar layx_calc_stacked_size(
             prev_child = child;
         }
         
-        child = pchild->next_sibling;
+        child = layx_next_in_flow(ctx, pchild);
     }
     
     // 最后一个元素的结束margin
@@ -1033,35 +2791,81 @@ layx_scalar layx_calc_stacked_size(
         bool is_inline = (plast->flags & LAYX_DISPLAY_INLINE) != 0;
         
         if (!is_inline || dim == 0) {  // inline元素只有水平margin
-            need_size += plast->margin_trbl[END_SIDE(dim)];
+            need_size += layx_item_box(ctx, plast, LAYX_BOX_MARGIN)[END_SIDE(dim)];
         }
     }
     
     return need_size;
 }
 
+// 开始为 item 记录 flex 行，之后的 layx_push_flex_line 追加到它的范围内
+static LAYX_FORCE_INLINE
+void layx_begin_flex_lines(layx_context *ctx, layx_item_t *pitem)
+{
+    pitem->line_first = ctx->lines.count;
+    pitem->line_count = 0;
+}
+
+static void layx_push_flex_line(layx_context *ctx, layx_item_t *pitem, layx_id first_child, layx_id end_child)
+{
+    layx_flex_lines *lines = &ctx->lines;
+    if (lines->count == lines->capacity) {
+        lines->capacity = lines->capacity < 1 ? 64 : lines->capacity * 2;
+        LAYX_STATS_COUNT(ctx, grow_events);
+        lines->lines = (layx_flex_line*)LAYX_REALLOC(lines->lines, lines->capacity * sizeof(layx_flex_line));
+    }
+    layx_flex_line *line = lines->lines + lines->count++;
+    LAYX_STATS_COUNT(ctx, flex_lines);
+    line->first_child = first_child;
+    line->end_child = end_child;
+    line->cross_size = 0;
+    pitem->line_count++;
+}
+
+// 返回 item 本轮记录的 flex 行。主轴排列之前（或单个子元素时）只按强制换行 LAYX_BREAK 分行
+static layx_flex_line *layx_get_flex_lines(layx_context *ctx, layx_id item, uint32_t *count)
+{
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    if (pitem->line_count == 0 && layx_first_in_flow(ctx, pitem) != LAYX_INVALID_ID) {
+        layx_begin_flex_lines(ctx, pitem);
+        layx_id start_child = layx_first_in_flow(ctx, pitem);
+        layx_id child = layx_next_in_flow(ctx, layx_get_item(ctx, start_child));
+        while (child != LAYX_INVALID_ID) {
+            layx_item_t *pchild = layx_get_item(ctx, child);
+            if (pchild->flags & LAYX_BREAK) {
+                layx_push_flex_line(ctx, pitem, start_child, child);
+                start_child = child;
+            }
+            child = layx_next_in_flow(ctx, pchild);
+        }
+        layx_push_flex_line(ctx, pitem, start_child, LAYX_INVALID_ID);
+    }
+    *count = pitem->line_count;
+    return ctx->lines.lines + pitem->line_first;
+}
+
 // Helper to calculate wrapped overlayed size
 static LAYX_FORCE_INLINE
 layx_scalar layx_calc_wrapped_overlayed_size(
         layx_context *ctx, layx_id item, int dim)
 {
-    layx_item_t *LAYX_RESTRICT pitem = layx_get_item(ctx, item);
-    layx_scalar need_size = 0;
-    layx_scalar need_size2 = 0;
-    layx_id child = pitem->first_child;
-    while (child != LAYX_INVALID_ID) {
-        layx_item_t *pchild = layx_get_item(ctx, child);
-        layx_vec4 rect = ctx->rects[child];
-        if (pchild->flags & LAYX_BREAK) {
-            need_size2 += need_size;
-            need_size = 0;
+    uint32_t line_count;
+    const layx_flex_line *lines = layx_get_flex_lines(ctx, item, &line_count);
+    layx_scalar need_size = line_count > 1 ? layx_get_item(ctx, item)->gap[dim] * (layx_scalar)(line_count - 1) : 0;
+    for (uint32_t i = 0; i < line_count; ++i) {
+        layx_scalar line_size = 0;
+        layx_id child = lines[i].first_child;
+        while (child != lines[i].end_child) {
+            layx_item_t *pchild = layx_get_item(ctx, child);
+            const layx_vec4 margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
+            // 只使用子元素的尺寸，不使用位置（位置在 arrange 阶段设置）
+            layx_scalar child_size = ctx->rects[child][SIZE_DIM(dim)] + margins[START_SIDE(dim)] + margins[END_SIDE(dim)];
+            line_size = layx_scalar_max(line_size, child_size);
+            child = layx_next_in_flow(ctx, pchild);
         }
-        // 只使用子元素的尺寸，不使用位置（位置在 arrange 阶段设置）
-        layx_scalar child_size = rect[SIZE_DIM(dim)] + pchild->margin_trbl[START_SIDE(dim)] + pchild->margin_trbl[END_SIDE(dim)];
-        need_size = layx_scalar_max(need_size, child_size);
-        child = pchild->next_sibling;
+        need_size += line_size;
     }
-    return need_size2 + need_size;
+    return need_size;
 }
 
 // Helper to calculate wrapped stacked size
@@ -1070,125 +2874,303 @@ layx_scalar layx_calc_wrapped_stacked_size(
         layx_context *ctx, layx_id item, int dim)
 {
     layx_item_t *LAYX_RESTRICT pitem = layx_get_item(ctx, item);
-    layx_scalar need_size = 0;
-    layx_scalar need_size2 = 0;
-    layx_id child = pitem->first_child;
-    layx_id prev_child = LAYX_INVALID_ID;  // 用于记录上一个子项，正确处理margin合并
-
     const uint32_t item_flags = pitem->flags;
     int is_flex_container = layx_is_flex_container(item_flags);
 
+    uint32_t line_count;
+    const layx_flex_line *lines = layx_get_flex_lines(ctx, item, &line_count);
+    layx_scalar need_size = 0;
+    for (uint32_t i = 0; i < line_count; ++i) {
+        layx_scalar line_size = 0;
+        layx_id child = lines[i].first_child;
+        layx_id prev_child = LAYX_INVALID_ID;  // 用于记录上一个子项，正确处理margin合并
+        while (child != lines[i].end_child) {
+            layx_item_t *pchild = layx_get_item(ctx, child);
+            const layx_vec4 margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
+
+            // 正确处理margin合并：
+            // 对于 flex 容器：margin 不合并，直接相加
+            // 对于 block 容器：margin 合并，取最大值
+            if (prev_child == LAYX_INVALID_ID) {
+                // 每行的第一个子项：累加其起始margin
+                line_size += margins[START_SIDE(dim)];
+            } else {
+                // 非第一个子项：累加与上一个子项之间的边距
+                layx_item_t *pprev = layx_get_item(ctx, prev_child);
+                layx_scalar gap;
+                if (is_flex_container) {
+                    // Flex 容器：margin 不合并，相邻 margin 相加
+                    gap = layx_item_box(ctx, pprev, LAYX_BOX_MARGIN)[END_SIDE(dim)] + margins[START_SIDE(dim)];
+                } else {
+                    // Block 容器：margin 合并，取最大值
+                    gap = layx_scalar_max(layx_item_box(ctx, pprev, LAYX_BOX_MARGIN)[END_SIDE(dim)], margins[START_SIDE(dim)]);
+                }
+                line_size += gap + pitem->gap[dim];
+            }
+
+            // 累加子项尺寸
+            line_size += ctx->rects[child][SIZE_DIM(dim)];
+
+            // 行内最后一个子项，累加其结束margin
+            if (layx_next_in_flow(ctx, pchild) == lines[i].end_child) {
+                line_size += margins[END_SIDE(dim)];
+            }
+
+            prev_child = child;
+            child = layx_next_in_flow(ctx, pchild);
+        }
+        need_size = layx_scalar_max(need_size, line_size);
+    }
+    return need_size;
+}
+
+// PHASE 1: Calculate size (first pass)
+// Grid 布局
+// 子元素按文档顺序放置：显式指定单元格的直接使用，其余从游标位置起按行优先依次填充，
+// 当前行放不下时换到下一行的起点。超出列数的显式列号被收回到最后几列
+static LAYX_FORCE_INLINE
+void layx_grid_place(const layx_item_t *pchild, uint32_t columns, uint32_t *cursor, uint32_t cell[2], uint32_t span[2])
+{
+    span[0] = pchild->grid_span[0] > 1 ? pchild->grid_span[0] : 1;
+    span[1] = pchild->grid_span[1] > 1 ? pchild->grid_span[1] : 1;
+    if (span[0] > columns) span[0] = columns;
+    if (pchild->grid_cell[0] != 0) {
+        cell[0] = pchild->grid_cell[0] - 1u;
+        cell[1] = pchild->grid_cell[1] - 1u;
+        if (cell[0] + span[0] > columns) cell[0] = columns - span[0];
+        return;
+    }
+    uint32_t column = *cursor % columns;
+    if (column + span[0] > columns) {
+        *cursor += columns - column;
+        column = 0;
+    }
+    cell[0] = column;
+    cell[1] = *cursor / columns;
+    *cursor += span[0];
+}
+
+static LAYX_FORCE_INLINE uint32_t layx_grid_column_count(const layx_grid *grid)
+{
+    return grid->track_count[0] > 0 ? grid->track_count[0] : 1;
+}
+
+// 定义的行数，或放置子元素实际用到的行数（多出来的是隐式 auto 行）。
+// 结果保存在 grid 记录中，尺寸计算和排列阶段共用，子元素或轨道变化后重新统计
+static uint32_t layx_grid_row_count(layx_context *ctx, const layx_item_t *pitem, layx_grid *grid)
+{
+    if (grid->rows_cached) return grid->rows;
+    const uint32_t columns = layx_grid_column_count(grid);
+    uint32_t rows = grid->track_count[1];
+    uint32_t cursor = 0;
+    uint32_t cell[2], span[2];
+    layx_id child = layx_first_in_flow(ctx, pitem);
     while (child != LAYX_INVALID_ID) {
-        layx_item_t *pchild = layx_get_item(ctx, child);
-        layx_vec4 rect = ctx->rects[child];
+        const layx_item_t *pchild = layx_get_item(ctx, child);
+        layx_grid_place(pchild, columns, &cursor, cell, span);
+        if (cell[1] + span[1] > rows) rows = cell[1] + span[1];
+        child = layx_next_in_flow(ctx, pchild);
+    }
+    grid->rows = rows;
+    grid->rows_cached = true;
+    return rows;
+}
+
+static LAYX_FORCE_INLINE float *layx_grid_reserve(float **buffer, uint32_t *capacity, uint32_t count)
+{
+    if (count > *capacity) {
+        uint32_t new_capacity = *capacity < 1 ? 8 : *capacity;
+        while (new_capacity < count) new_capacity *= 2;
+        *buffer = (float*)LAYX_REALLOC(*buffer, new_capacity * sizeof(float));
+        *capacity = new_capacity;
+    }
+    return *buffer;
+}
 
-        if (pchild->flags & LAYX_BREAK) {
-            need_size2 = layx_scalar_max(need_size2, need_size);
-            need_size = 0;
-            prev_child = LAYX_INVALID_ID;  // 换行后重置prev_child
+// 解析 dim 方向的 count 个轨道，以起点形式写入 sizes（count + 1 个）。
+// space 小于 0 表示可用空间还不确定（尺寸计算阶段），此时 fr 轨道和 auto 轨道一样由内容决定。
+// 返回结果是否依赖单元格内容
+static bool layx_grid_resolve_tracks(layx_context *ctx, const layx_item_t *pitem, const layx_grid *grid,
+                                     int dim, uint32_t count, float space, float *sizes)
+{
+    const layx_grid_track *tracks = grid->tracks[dim];
+    const uint32_t defined = grid->track_count[dim];
+
+    bool by_content = false;
+    float fr_total = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        const uint8_t kind = i < defined ? tracks[i].kind : LAYX_TRACK_AUTO;
+        sizes[i] = kind == LAYX_TRACK_FIXED ? tracks[i].value : 0;
+        if (kind == LAYX_TRACK_AUTO || (kind == LAYX_TRACK_FR && space < 0)) {
+            by_content = true;
+        } else if (kind == LAYX_TRACK_FR) {
+            fr_total += tracks[i].value;
         }
+    }
 
-        // 正确处理margin合并：
-        // 对于 flex 容器：margin 不合并，直接相加
-        // 对于 block 容器：margin 合并，取最大值
-        if (prev_child == LAYX_INVALID_ID) {
-            // 第一个子项（或换行后的第一个）：累加其起始margin
-            need_size += pchild->margin_trbl[START_SIDE(dim)];
-        } else {
-            // 非第一个子项：累加与上一个子项之间的边距
-            layx_item_t *pprev = layx_get_item(ctx, prev_child);
-            layx_scalar gap;
-            if (is_flex_container) {
-                // Flex 容器：margin 不合并，相邻 margin 相加
-                gap = pprev->margin_trbl[END_SIDE(dim)] + pchild->margin_trbl[START_SIDE(dim)];
-            } else {
-                // Block 容器：margin 合并，取最大值
-                gap = layx_scalar_max(pprev->margin_trbl[END_SIDE(dim)], pchild->margin_trbl[START_SIDE(dim)]);
+    if (by_content) {
+        // 只有占一个轨道的子元素参与
+        const uint32_t columns = layx_grid_column_count(grid);
+        uint32_t cursor = 0;
+        uint32_t cell[2], span[2];
+        layx_id child = layx_first_in_flow(ctx, pitem);
+        while (child != LAYX_INVALID_ID) {
+            const layx_item_t *pchild = layx_get_item(ctx, child);
+            layx_grid_place(pchild, columns, &cursor, cell, span);
+            const uint32_t index = cell[dim];
+            if (span[dim] == 1 && index < count) {
+                const uint8_t kind = index < defined ? tracks[index].kind : LAYX_TRACK_AUTO;
+                if (kind == LAYX_TRACK_AUTO || (kind == LAYX_TRACK_FR && space < 0)) {
+                    const layx_vec4 margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
+                    const float need = (float)(ctx->rects[child][SIZE_DIM(dim)]
+                                     + margins[START_SIDE(dim)] + margins[END_SIDE(dim)]);
+                    sizes[index] = layx_float_max(sizes[index], need);
+                }
             }
-            need_size += gap;
+            child = layx_next_in_flow(ctx, pchild);
         }
+    }
+
+    const float gap = (float)pitem->gap[dim];
+    if (space >= 0 && fr_total > 0) {
+        float used = count > 1 ? gap * (float)(count - 1) : 0;
+        for (uint32_t i = 0; i < count; ++i) used += sizes[i];
+        // 比例之和小于 1 时只分配相应比例的剩余空间
+        const float per_fr = layx_float_max(0, space - used) / layx_float_max(fr_total, 1.0f);
+        for (uint32_t i = 0; i < defined && i < count; ++i) {
+            if (tracks[i].kind == LAYX_TRACK_FR) sizes[i] = per_fr * tracks[i].value;
+        }
+    }
 
-        // 累加子项尺寸
-        need_size += rect[SIZE_DIM(dim)];
+    float run = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        const float size = sizes[i];
+        sizes[i] = run;
+        run += size + (i + 1 < count ? gap : 0);
+    }
+    sizes[count] = run;
+    return by_content;
+}
 
-        // 如果是最后一个子项或换行前的最后一个子项，累加其结束margin
-        if (pchild->next_sibling == LAYX_INVALID_ID || 
-            (layx_get_item(ctx, pchild->next_sibling)->flags & LAYX_BREAK)) {
-            need_size += pchild->margin_trbl[END_SIDE(dim)];
+static layx_scalar layx_calc_grid_size(layx_context *ctx, layx_id item, int dim)
+{
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    // 固定尺寸由调用者直接使用，不需要解析轨道
+    if ((pitem->flags & (dim == 0 ? LAYX_SIZE_FIXED_WIDTH : LAYX_SIZE_FIXED_HEIGHT)) && pitem->size[dim] > 0) {
+        return pitem->size[dim];
+    }
+    layx_grid *grid = layx_grid_ensure(ctx, item);
+    const uint32_t count = dim == 0 ? layx_grid_column_count(grid) : layx_grid_row_count(ctx, pitem, grid);
+
+    // 全部是固定轨道时总长度就是定义之和，不扫描子元素，也不影响排列阶段的缓存
+    if (count == grid->track_count[dim]) {
+        float total = 0;
+        uint32_t i = 0;
+        for (; i < count && grid->tracks[dim][i].kind == LAYX_TRACK_FIXED; ++i) {
+            total += grid->tracks[dim][i].value;
+        }
+        if (i == count) {
+            return count > 1 ? (layx_scalar)total + pitem->gap[dim] * (layx_scalar)(count - 1) : (layx_scalar)total;
         }
-        
-        prev_child = child;
-        child = pchild->next_sibling;
     }
-    return layx_scalar_max(need_size2, need_size);
+    // 解析到共用的暂存区，排列阶段缓存的结果保持不变
+    layx_grid_table *table = &ctx->grids;
+    float *sizes = layx_grid_reserve(&table->scratch, &table->scratch_capacity, count + 1);
+    layx_grid_resolve_tracks(ctx, pitem, table->records + pitem->grid, dim, count, -1.0f, sizes);
+    return (layx_scalar)sizes[count];
 }
 
-// PHASE 1: Calculate size (first pass)
-static void layx_calc_size(layx_context *ctx, layx_id item, int dim)
+// 子元素拉伸到所在单元格（扣除 margin）；固定尺寸的一维保持原尺寸，靠单元格起点放置
+static void layx_arrange_grid(layx_context *ctx, layx_id item, int dim)
 {
     layx_item_t *pitem = layx_get_item(ctx, item);
-    uint32_t flags = pitem->flags;
+    layx_grid *grid = layx_grid_ensure(ctx, item);
+    const float offset = (float)layx_get_content_offset(ctx, item, dim);
+    const float space = layx_float_max(0, (float)layx_get_internal_space(ctx, item, dim));
+    const uint32_t columns = layx_grid_column_count(grid);
+    const uint32_t count = dim == 0 ? columns : layx_grid_row_count(ctx, pitem, grid);
+
+    if (!grid->cached[dim] || grid->resolved_count[dim] != count || grid->cached_space[dim] != space) {
+        float *sizes = layx_grid_reserve(&grid->offsets[dim], &grid->resolved_capacity[dim], count + 1);
+        grid->cached[dim] = !layx_grid_resolve_tracks(ctx, pitem, grid, dim, count, space, sizes);
+        grid->cached_space[dim] = space;
+        grid->resolved_count[dim] = count;
+    }
+    const float *offsets = grid->offsets[dim];
+    const float gap = (float)pitem->gap[dim];
+    const uint32_t fixed_flag = dim == 0 ? LAYX_SIZE_FIXED_WIDTH : LAYX_SIZE_FIXED_HEIGHT;
 
-    layx_id child = pitem->first_child;
+    uint32_t cursor = 0;
+    uint32_t cell[2], span[2];
+    layx_id child = layx_first_in_flow(ctx, pitem);
     while (child != LAYX_INVALID_ID) {
-        layx_calc_size(ctx, child, dim);
-        child = layx_next_sibling(ctx, child);
+        layx_item_t *pchild = layx_get_item(ctx, child);
+        layx_grid_place(pchild, columns, &cursor, cell, span);
+        const uint32_t first = cell[dim] < count ? cell[dim] : count;
+        const uint32_t last = cell[dim] + span[dim] < count ? cell[dim] + span[dim] : count;
+        const layx_vec4 margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
+        const layx_scalar margin_start = margins[START_SIDE(dim)];
+        const layx_scalar margin_end = margins[END_SIDE(dim)];
+
+        layx_vec4 child_rect = ctx->rects[child];
+        // 轨道起点之差包含结束轨道之后的间距
+        const float extent = offsets[last] - offsets[first] - (last < count && last > first ? gap : 0);
+        child_rect[POINT_DIM(dim)] = (layx_scalar)(offset + offsets[first]) + margin_start;
+        if (!(pchild->flags & fixed_flag) || pchild->size[dim] <= 0) {
+            child_rect[SIZE_DIM(dim)] = layx_scalar_max(0, (layx_scalar)extent - margin_start - margin_end);
+        }
+        ctx->rects[child] = child_rect;
+        child = layx_next_in_flow(ctx, pchild);
     }
+}
 
-    ctx->rects[item][SIZE_DIM(dim)] = pitem->margin_trbl[START_SIDE(dim)];
+static LAYX_FORCE_INLINE void layx_calc_size_dim(layx_context *ctx, layx_id item, const int dim, const layx_strategy strategy)
+{
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    layx_grid_forget_rows(ctx, pitem);
+    uint32_t flags = pitem->flags;
+    pitem->flags = flags & ~LAYX_ITEM_DIRTY;
+    if (dim == 0) {
+        // 每轮的第一个阶段：flex 行要等主轴排列后重新记录
+        pitem->line_count = 0;
+    }
 
-        layx_scalar cal_size;
-        layx_flex_direction direction = (layx_flex_direction)(flags & LAYX_FLEX_DIRECTION_MASK);
-        layx_display display = layx_get_display_from_flags(flags);
-        layx_flex_wrap wrap = (layx_flex_wrap)(flags & LAYX_FLEX_WRAP_MASK);
-        
-        if (display == LAYX_DISPLAY_FLEX) {
-            bool is_wrapped = (wrap != LAYX_FLEX_WRAP_NOWRAP);
-            bool is_row_direction = (direction == LAYX_FLEX_DIRECTION_ROW || direction == LAYX_FLEX_DIRECTION_ROW_REVERSE);
-            
-            if (is_wrapped) {
-                if (is_row_direction) {
-                    if (dim == 0)
-                        cal_size = layx_calc_wrapped_stacked_size(ctx, item, 0);
-                    else
-                        cal_size = layx_calc_wrapped_overlayed_size(ctx, item, 1);
-                } else {
-                    if (dim == 1)
-                        cal_size = layx_calc_wrapped_stacked_size(ctx, item,1);
-                    else
-                        cal_size = layx_calc_wrapped_overlayed_size(ctx, item, 0);
-                }
-            } else {
-                if ((is_row_direction && dim == 0) || (!is_row_direction && dim == 1)) {
-                    cal_size = layx_calc_stacked_size(ctx, item, dim);
-                } else {
-                    cal_size = layx_calc_overlayed_size(ctx, item, dim);
-                }
-            }
-        } else if (display == LAYX_DISPLAY_BLOCK || display == LAYX_DISPLAY_INLINE_BLOCK) {
-            // DISPLAY_BLOCK 和 DISPLAY_INLINE_BLOCK: 子元素在水平方向上叠加，在垂直方向上堆叠
-            if (dim == 1) {
-                // Y 轴（垂直方向）：使用 stacked（堆叠）
-                cal_size = layx_calc_stacked_size(ctx, item, dim);
-            } else {
-                // X 轴（水平方向）：使用 overlay（叠加）
-                cal_size = layx_calc_overlayed_size(ctx, item, dim);
-            }
-        } else if (display == LAYX_DISPLAY_INLINE) {
+    ctx->rects[item][POINT_DIM(dim)] = layx_item_box(ctx, pitem, LAYX_BOX_MARGIN)[START_SIDE(dim)];
+
+    layx_scalar cal_size;
+    if (flags & LAYX_ITEM_CONTAIN) {
+        // 尺寸包含：按没有内容计算，内部的变化不会改变自身尺寸
+        cal_size = 0;
+    } else {
+        switch (strategy) {
+        case LAYX_STRATEGY_FLEX_ROW:
+            cal_size = dim == 0 ? layx_calc_stacked_size(ctx, item, dim) : layx_calc_overlayed_size(ctx, item, dim);
+            break;
+        case LAYX_STRATEGY_FLEX_COLUMN:
+            cal_size = dim == 1 ? layx_calc_stacked_size(ctx, item, dim) : layx_calc_overlayed_size(ctx, item, dim);
+            break;
+        case LAYX_STRATEGY_FLEX_ROW_WRAP:
+            cal_size = dim == 0 ? layx_calc_wrapped_stacked_size(ctx, item, dim) : layx_calc_wrapped_overlayed_size(ctx, item, dim);
+            break;
+        case LAYX_STRATEGY_FLEX_COLUMN_WRAP:
+            cal_size = dim == 1 ? layx_calc_wrapped_stacked_size(ctx, item, dim) : layx_calc_wrapped_overlayed_size(ctx, item, dim);
+            break;
+        case LAYX_STRATEGY_GRID:
+            cal_size = layx_calc_grid_size(ctx, item, dim);
+            break;
+        case LAYX_STRATEGY_INLINE:
             // DISPLAY_INLINE: 宽度和高度都使用 overlayed size（取最大值）
             // inline元素的内容在同一行上，尺寸由最大的子元素决定
             cal_size = layx_calc_overlayed_size(ctx, item, dim);
-        } else {
-            // 默认情况，使用 block 布局
-            if (dim == 1) {
-                cal_size = layx_calc_stacked_size(ctx, item, dim);
-            } else {
-                cal_size = layx_calc_overlayed_size(ctx, item, dim);
-            }
+            break;
+        case LAYX_STRATEGY_INLINE_BLOCK:
+        case LAYX_STRATEGY_BLOCK:
+        default:
+            // BLOCK 和 INLINE_BLOCK: 子元素在水平方向上叠加（overlay），在垂直方向上堆叠（stacked）
+            cal_size = dim == 1 ? layx_calc_stacked_size(ctx, item, dim) : layx_calc_overlayed_size(ctx, item, dim);
+            break;
         }
-
-        
-    
+    }
 
     layx_scalar result_size;
     bool is_fixedsize = pitem->flags & (dim==0?LAYX_SIZE_FIXED_WIDTH:LAYX_SIZE_FIXED_HEIGHT);
@@ -1214,14 +3196,17 @@ static void layx_calc_size(layx_context *ctx, layx_id item, int dim)
             result_size = pitem->max_size[1];
         }
     }
-    result_size += pitem->padding_trbl[START_SIDE(dim)] + pitem->border_trbl[START_SIDE(dim)] 
-                 + pitem->padding_trbl[END_SIDE(dim)] + pitem->border_trbl[END_SIDE(dim)];
+    if (pitem->box_mask & LAYX_BOX_FRAME_BITS) {
+        const layx_vec4 padding = layx_item_box(ctx, pitem, LAYX_BOX_PADDING);
+        const layx_vec4 border = layx_item_box(ctx, pitem, LAYX_BOX_BORDER);
+        result_size += padding[START_SIDE(dim)] + border[START_SIDE(dim)] 
+                     + padding[END_SIDE(dim)] + border[END_SIDE(dim)];
+    }
 
     ctx->rects[item][SIZE_DIM(dim)] = result_size;
     // DEBUG: 打印尺寸设置信息
-    layx_id first_child = pitem->first_child;
     LAYX_DEBUG_PRINT("DEBUG: layx_calc_size(item=%d, dim=%d, has_child=%d, size[%.1f,%.1f]) -> rect[%d]=%.1f\n",
-           item, dim, first_child != LAYX_INVALID_ID, pitem->size[0], pitem->size[1], SIZE_DIM(dim), result_size);
+           item, dim, layx_first_in_flow(ctx, pitem) != LAYX_INVALID_ID, (double)pitem->size[0], (double)pitem->size[1], SIZE_DIM(dim), (double)result_size);
 }
 
 // Helper to arrange a single child in a flex container (with justify-content support)
@@ -1235,10 +3220,10 @@ void layx_arrange_flex_container_single_child(
     layx_scalar space = layx_get_internal_space(ctx, item, dim);
     layx_scalar content_offset = layx_get_content_offset(ctx, item, dim);
 
-    layx_id child = pitem->first_child;
+    layx_id child = layx_first_in_flow(ctx, pitem);
     if (child != LAYX_INVALID_ID) {
         layx_item_t *pchild = layx_get_item(ctx, child);
-        const layx_vec4 child_margins = pchild->margin_trbl;
+        const layx_vec4 child_margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
         layx_vec4 child_rect = ctx->rects[child];
         
         // 获取子元素尺寸
@@ -1289,6 +3274,91 @@ void layx_arrange_flex_container_single_child(
     }
 }
 
+// 解析一行内的弹性长度（CSS Flexbox §9.7 Resolving Flexible Lengths）。
+// free_space 为主轴空间减去行内全部 margin；items 中 target 为假设尺寸，返回时为最终尺寸。
+// 每轮至少冻结一个项目，循环不超过 count + 1 次
+static void layx_resolve_flexible_lengths(layx_flex_item *items, uint32_t count, float free_space)
+{
+    float hypothetical = 0.0f;
+    for (uint32_t i = 0; i < count; ++i) {
+        hypothetical += items[i].target;
+    }
+    const bool growing = hypothetical < free_space;
+
+    // 不可伸缩的项目直接冻结在假设尺寸上
+    float frozen_size = 0.0f;
+    float base_size = 0.0f;
+    for (uint32_t i = 0; i < count; ++i) {
+        layx_flex_item *fi = items + i;
+        fi->frozen = fi->factor <= 0.0f
+            || (growing && fi->base > fi->target)
+            || (!growing && fi->base < fi->target);
+        if (fi->frozen) frozen_size += fi->target;
+        else base_size += fi->base;
+    }
+    const float initial_free = free_space - frozen_size - base_size;
+
+    for (uint32_t round = 0; round <= count; ++round) {
+        float factors = 0.0f;
+        float flexes = 0.0f;
+        frozen_size = 0.0f;
+        base_size = 0.0f;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (items[i].frozen) {
+                frozen_size += items[i].target;
+            } else {
+                base_size += items[i].base;
+                factors += items[i].factor;
+                flexes += items[i].flex;
+            }
+        }
+        if (factors <= 0.0f) break;
+
+        float remaining = free_space - frozen_size - base_size;
+        // flex-grow / flex-shrink 之和（不按 base 加权）小于 1 时只分配对应比例的初始剩余空间
+        if (flexes < 1.0f && layx_float_abs(initial_free * flexes) < layx_float_abs(remaining)) {
+            remaining = initial_free * flexes;
+        }
+
+        float violation = 0.0f;
+        for (uint32_t i = 0; i < count; ++i) {
+            layx_flex_item *fi = items + i;
+            if (fi->frozen) continue;
+            float target = fi->base + remaining * (fi->factor / factors);
+            float clamped = layx_float_max(fi->min, layx_float_min(fi->max, target));
+            fi->violation = clamped - target;
+            fi->target = clamped;
+            violation += fi->violation;
+        }
+
+        // 没有越界则全部冻结；否则只冻结越界方向与总量一致的项目，重新分配
+        for (uint32_t i = 0; i < count; ++i) {
+            layx_flex_item *fi = items + i;
+            if (fi->frozen) continue;
+            if (violation == 0.0f
+                || (violation > 0.0f && fi->violation > 0.0f)
+                || (violation < 0.0f && fi->violation < 0.0f)) {
+                fi->frozen = true;
+            }
+        }
+        if (violation == 0.0f) break;
+    }
+}
+
+// 确保暂存可容纳一行中的 count 个项目
+static LAYX_FORCE_INLINE layx_flex_item *layx_reserve_flex_items(layx_context *ctx, uint32_t count)
+{
+    layx_flex_lines *lines = &ctx->lines;
+    if (count > lines->item_capacity) {
+        uint32_t capacity = lines->item_capacity < 1 ? 32 : lines->item_capacity;
+        while (capacity < count) capacity *= 2;
+        LAYX_STATS_COUNT(ctx, grow_events);
+        lines->items = (layx_flex_item*)LAYX_REALLOC(lines->items, capacity * sizeof(layx_flex_item));
+        lines->item_capacity = capacity;
+    }
+    return lines->items;
+}
+
 // Helper to arrange multiple children in a flex container (with flex-wrap and justify-content)
 static LAYX_FORCE_INLINE
 void layx_arrange_flex_container_multiple_children(
@@ -1299,85 +3369,108 @@ void layx_arrange_flex_container_multiple_children(
     layx_scalar space = layx_get_internal_space(ctx, item, dim);
     layx_scalar content_offset = layx_get_content_offset(ctx, item, dim);
     float max_x2 = (float)(content_offset + space);
+    // 间距与 margin 一样是行内不可伸缩的空间
+    const float item_gap = (float)pitem->gap[dim];
+
+    // 分行结果记录下来，交叉轴的尺寸计算和排列不再重新扫描子元素
+    if (wrap) {
+        layx_begin_flex_lines(ctx, pitem);
+    }
 
-    layx_id start_child = pitem->first_child;
+    layx_id start_child = layx_first_in_flow(ctx, pitem);
     while (start_child != LAYX_INVALID_ID) {
-        layx_scalar used = 0;
-        uint32_t count = 0;
+        float used = 0.0f;
+        float margins = 0.0f;
         uint32_t total = 0;
         bool hardbreak = false;
-        float total_shrink_factor = 0.0f;
 
+        // 收集一行：flex base size 与假设尺寸（受 min/max 约束），按假设的外尺寸分行
         layx_id child = start_child;
         layx_id end_child = LAYX_INVALID_ID;
         while (child != LAYX_INVALID_ID) {
             layx_item_t *pchild = layx_get_item(ctx, child);
             const uint32_t child_flags = pchild->flags;
-            const layx_vec4 child_margins = pchild->margin_trbl;
-            layx_vec4 child_rect = ctx->rects[child];
-
-            int has_flex_grow = (pchild->flex_grow > 0);
-
-            layx_scalar extend = used;
-            if (has_flex_grow) {
-                ++count;
-                extend += child_rect[SIZE_DIM(dim)];
-            } else {
-                extend += child_rect[SIZE_DIM(dim)];
-                if (pchild->flex_shrink > 0.0f) {
-                    total_shrink_factor += pchild->flex_shrink;
-                }
-            }
-
-            if (wrap && (total && ((extend > space) || (child_flags & LAYX_BREAK)))) {
+            const layx_vec4 child_padding = layx_item_box(ctx, pchild, LAYX_BOX_PADDING);
+            const layx_vec4 child_border = layx_item_box(ctx, pchild, LAYX_BOX_BORDER);
+            const layx_vec4 child_margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
+            const float frame = (float)(child_padding[START_SIDE(dim)] + child_padding[END_SIDE(dim)]
+                              + child_border[START_SIDE(dim)] + child_border[END_SIDE(dim)]);
+            const float child_margin = (float)(child_margins[START_SIDE(dim)] + child_margins[END_SIDE(dim)]);
+
+            // flex-basis 为 0 时视为 auto，使用 calc_size 得到的尺寸
+            float base = pchild->flex_basis > 0 ? (float)pchild->flex_basis + frame
+                                                : (float)ctx->rects[child][SIZE_DIM(dim)];
+            float min = frame + (pchild->min_size[dim] > 0 ? (float)pchild->min_size[dim] : 0.0f);
+            float max = pchild->max_size[dim] > 0 ? frame + (float)pchild->max_size[dim] : LAYX_FLEX_NO_MAX;
+            float hypothetical = layx_float_max(min, layx_float_min(max, base));
+            const float lead = total ? item_gap : 0.0f;
+
+            if (wrap && total && ((used + lead + hypothetical + child_margin > space) || (child_flags & LAYX_BREAK))) {
                 end_child = child;
                 hardbreak = (child_flags & LAYX_BREAK) == LAYX_BREAK;
-                pchild->flags = child_flags | LAYX_BREAK;
                 break;
-            } else {
-                used = extend;
-                child = pchild->next_sibling;
             }
+
+            layx_flex_item *fi = layx_reserve_flex_items(ctx, total + 1) + total;
+            fi->base = base;
+            fi->target = hypothetical;
+            fi->min = min;
+            fi->max = max;
+            used += lead + hypothetical + child_margin;
+            margins += lead + child_margin;
             ++total;
+            child = layx_next_in_flow(ctx, pchild);
+        }
+        if (wrap) {
+            layx_push_flex_line(ctx, pitem, start_child, end_child);
+        }
+
+        // 按剩余空间的正负选择 flex-grow 或 flex-shrink（按 base 加权）
+        layx_flex_item *items = ctx->lines.items;
+        const bool growing = used < (float)space;
+        child = start_child;
+        for (uint32_t i = 0; i < total; ++i) {
+            const layx_item_t *pchild = layx_get_item(ctx, child);
+            items[i].flex = growing ? (float)pchild->flex_grow : (float)pchild->flex_shrink;
+            items[i].factor = items[i].flex * (growing ? 1.0f : items[i].base);
+            child = layx_next_in_flow(ctx, pchild);
         }
+        layx_resolve_flexible_lengths(items, total, (float)space - margins);
 
-        layx_scalar extra_space = space - used;
-        float filler = 0.0f;
+        float resolved = margins;
+        for (uint32_t i = 0; i < total; ++i) {
+            resolved += items[i].target;
+        }
+        float extra_space = (float)space - resolved;
         float spacer = 0.0f;
         float extra_margin = 0.0f;
 
         if (extra_space > 0) {
-            if (count > 0)
-                filler = (float)extra_space / (float)count;
-            else if (total > 0) {
-                layx_justify_content justify = (layx_justify_content)(item_flags & LAYX_JUSTIFY_CONTENT_MASK);
-                switch (justify) {
-                case LAYX_JUSTIFY_SPACE_BETWEEN:
-                    if (!wrap || ((end_child != LAYX_INVALID_ID) && !hardbreak)) {
-                        if (total > 1) {
-                            spacer = (float)extra_space / (float)(total - 1);
-                        } else {
-                            spacer = 0.0f;
-                        }
+            layx_justify_content justify = (layx_justify_content)(item_flags & LAYX_JUSTIFY_CONTENT_MASK);
+            switch (justify) {
+            case LAYX_JUSTIFY_SPACE_BETWEEN:
+                if (!wrap || ((end_child != LAYX_INVALID_ID) && !hardbreak)) {
+                    if (total > 1) {
+                        spacer = extra_space / (float)(total - 1);
+                    } else {
+                        spacer = 0.0f;
                     }
-                    break;
-                case LAYX_JUSTIFY_FLEX_START:
-                    break;
-                case LAYX_JUSTIFY_FLEX_END:
-                    extra_margin = extra_space;
-                    break;
-                case LAYX_JUSTIFY_CENTER:
-                    extra_margin = extra_space / 2.0f;
-                    break;
-                case LAYX_JUSTIFY_SPACE_AROUND:
-                    if (total > 0)
-                        spacer = (float)extra_space / (float)total;
-                    break;
-                case LAYX_JUSTIFY_SPACE_EVENLY:
-                    if (total > 0)
-                        spacer = (float)extra_space / (float)(total + 1);
-                    break;
                 }
+                break;
+            case LAYX_JUSTIFY_FLEX_START:
+                break;
+            case LAYX_JUSTIFY_FLEX_END:
+                extra_margin = extra_space;
+                break;
+            case LAYX_JUSTIFY_CENTER:
+                extra_margin = extra_space / 2.0f;
+                break;
+            case LAYX_JUSTIFY_SPACE_AROUND:
+                spacer = extra_space / (float)total;
+                break;
+            case LAYX_JUSTIFY_SPACE_EVENLY:
+                spacer = extra_space / (float)(total + 1);
+                break;
             }
         }
 
@@ -1385,7 +3478,7 @@ void layx_arrange_flex_container_multiple_children(
         layx_id prev_child = LAYX_INVALID_ID;
 
         child = start_child;
-        while (child != end_child) {
+        for (uint32_t i = 0; i < total; ++i) {
             if (spacer != 0 && child == start_child) {
                 layx_justify_content justify = (layx_justify_content)(item_flags & LAYX_JUSTIFY_CONTENT_MASK);
                 if (justify == LAYX_JUSTIFY_SPACE_AROUND) {
@@ -1397,28 +3490,19 @@ void layx_arrange_flex_container_multiple_children(
 
             layx_scalar ix0, ix1, x1;
             layx_item_t *pchild = layx_get_item(ctx, child);
-            const layx_vec4 child_margins = pchild->margin_trbl;
+            const layx_vec4 child_margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
             layx_vec4 child_rect = ctx->rects[child];
-            child_rect[POINT_DIM(dim)] = 0;
-
-            int has_flex_grow = (pchild->flex_grow > 0);
 
             // Flex 容器：margin 不合并，相邻 margin 相加
             if (prev_child == LAYX_INVALID_ID) {
                 ix0 = (layx_scalar)(x + child_margins[START_SIDE(dim)]);
             } else {
                 layx_item_t *pprev = layx_get_item(ctx, prev_child);
-                layx_scalar gap = pprev->margin_trbl[END_SIDE(dim)] + child_margins[START_SIDE(dim)];
-                ix0 = (layx_scalar)(x + gap);
+                layx_scalar gap = layx_item_box(ctx, pprev, LAYX_BOX_MARGIN)[END_SIDE(dim)] + child_margins[START_SIDE(dim)];
+                ix0 = (layx_scalar)(x + item_gap + gap);
             }
 
-            if (has_flex_grow) {
-                x1 = ix0 + filler;
-            } else {
-                layx_scalar child_size = (float)child_rect[SIZE_DIM(dim)];
-                float constrained_size = (float)child_size;
-                x1 = ix0 + constrained_size;
-            }
+            x1 = (layx_scalar)(ix0 + items[i].target);
 
             if (wrap)
                 ix1 = (layx_scalar)layx_float_min(max_x2 - (float)child_margins[END_SIDE(dim)], x1);
@@ -1431,7 +3515,7 @@ void layx_arrange_flex_container_multiple_children(
 
             x = x1;
             prev_child = child;
-            child = pchild->next_sibling;
+            child = layx_next_in_flow(ctx, pchild);
             extra_margin = spacer;
         }
 
@@ -1448,12 +3532,12 @@ void layx_arrange_block_container_single_child(
     layx_scalar space = layx_get_internal_space(ctx, item, dim);
     layx_scalar content_offset = layx_get_content_offset(ctx, item, dim);
 
-    LAYX_DEBUG_PRINT("DEBUG layx_arrange_block_container_single_child(item=%d, dim=%d): space=%.1f, content_offset=%.1f\n", item, dim, space, content_offset);
+    LAYX_DEBUG_PRINT("DEBUG layx_arrange_block_container_single_child(item=%d, dim=%d): space=%.1f, content_offset=%.1f\n", item, dim, (double)space, (double)content_offset);
 
-    layx_id child = pitem->first_child;
+    layx_id child = layx_first_in_flow(ctx, pitem);
     if (child != LAYX_INVALID_ID) {
         layx_item_t *pchild = layx_get_item(ctx, child);
-        const layx_vec4 child_margins = pchild->margin_trbl;
+        const layx_vec4 child_margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
         layx_vec4 child_rect = ctx->rects[child];
         child_rect[POINT_DIM(dim)] = 0;
 
@@ -1461,7 +3545,7 @@ void layx_arrange_block_container_single_child(
         layx_scalar ix0 = (layx_scalar)(x + child_margins[START_SIDE(dim)]);
 
         LAYX_DEBUG_PRINT("DEBUG set single child position: child=%d, x=%.1f, margin_start=%.1f, ix0=%.1f\n",
-               child, x, child_margins[START_SIDE(dim)], ix0);
+               child, (double)x, (double)child_margins[START_SIDE(dim)], (double)ix0);
 
         float final_size = (float)child_rect[SIZE_DIM(dim)];
         child_rect[POINT_DIM(dim)] = ix0;
@@ -1482,14 +3566,16 @@ void layx_arrange_block_container_multiple_children(
     
     // 跟踪上一个元素的结束margin（用于合并）
     layx_scalar prev_margin_end = 0;
+    const layx_scalar item_gap = pitem->gap[dim];
     
-    layx_id child = pitem->first_child;
+    const layx_id first_child = layx_first_in_flow(ctx, pitem);
+    layx_id child = first_child;
     layx_scalar current_y = content_offset;
     
     while (child != LAYX_INVALID_ID) {
         layx_item_t *pchild = layx_get_item(ctx, child);
         layx_vec4 child_rect = ctx->rects[child];
-        const layx_vec4 margins = pchild->margin_trbl;
+        const layx_vec4 margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
         
         // 计算当前元素的起点
         layx_scalar margin_start = margins[START_SIDE(dim)];
@@ -1497,18 +3583,19 @@ void layx_arrange_block_container_multiple_children(
         
         if (vertical) {
             // 垂直方向：处理margin合并
-            if (child == pitem->first_child) {
+            if (child == first_child) {
                 // 第一个子元素：可能与父元素的margin-top合并
                 // 这里简化处理，实际更复杂
                 current_y += margin_start;
             } else {
-                // 与前一个元素的margin合并
+                // 与前一个元素的margin合并，间距不参与合并
                 layx_scalar collapsed_margin = layx_scalar_max(prev_margin_end, margin_start);
-                current_y += collapsed_margin - prev_margin_end;
+                current_y += collapsed_margin - prev_margin_end + item_gap;
             }
         } else {
             // 水平方向：不合并，直接相加
             current_y += margin_start;
+            if (child != first_child) current_y += item_gap;
         }
         
         // 设置子元素位置
@@ -1533,7 +3620,7 @@ void layx_arrange_block_container_multiple_children(
             // ... 换行逻辑
         }
         
-        child = pchild->next_sibling;
+        child = layx_next_in_flow(ctx, pchild);
     }
 }
 
@@ -1546,11 +3633,11 @@ void layx_arrange_stacked(layx_context *ctx, layx_id item, int dim, bool wrap)
     int is_flex_container = layx_is_flex_container(item_flags);
 
     // 判断子元素数量
-    layx_id first_child = pitem->first_child;
+    layx_id first_child = layx_first_in_flow(ctx, pitem);
     layx_id second_child = LAYX_INVALID_ID;
     if (first_child != LAYX_INVALID_ID) {
         layx_item_t *pfirst_child = layx_get_item(ctx, first_child);
-        second_child = pfirst_child->next_sibling;
+        second_child = layx_next_in_flow(ctx, pfirst_child);
     }
     bool has_single_child = (second_child == LAYX_INVALID_ID);
 
@@ -1575,13 +3662,13 @@ void layx_arrange_stacked(layx_context *ctx, layx_id item, int dim, bool wrap)
     }
 }
 
-static void layx_align_baseline(layx_context *ctx, layx_id container, int dim)
+static LAYX_FORCE_INLINE void layx_align_baseline(layx_context *ctx, layx_id container, int dim)
 {
     layx_item_t *pcontainer = layx_get_item(ctx, container);
     float max_baseline = 0;
     
     // 第一步：收集所有子项的基线信息
-    layx_id child = pcontainer->first_child;
+    layx_id child = layx_first_in_flow(ctx, pcontainer);
     while (child != LAYX_INVALID_ID) {
         layx_item_t *pchild = layx_get_item(ctx, child);
         
@@ -1593,11 +3680,11 @@ static void layx_align_baseline(layx_context *ctx, layx_id container, int dim)
                                          ctx->rects[child][3] * 0.8f); // 80%高度
         }
         
-        child = layx_next_sibling(ctx, child);
+        child = layx_next_in_flow(ctx, pchild);
     }
     
     // 第二步：根据基线对齐调整位置
-    child = pcontainer->first_child;
+    child = layx_first_in_flow(ctx, pcontainer);
     while (child != LAYX_INVALID_ID) {
         layx_item_t *pchild = layx_get_item(ctx, child);
         layx_vec4 rect = ctx->rects[child];
@@ -1610,7 +3697,7 @@ static void layx_align_baseline(layx_context *ctx, layx_id container, int dim)
         rect[1] += adjustment;  // 调整Y位置
         
         ctx->rects[child] = rect;
-        child = layx_next_sibling(ctx, child);
+        child = layx_next_in_flow(ctx, pchild);
     }
 }
 // Helper to arrange overlay items (cross-axis alignment)
@@ -1622,16 +3709,16 @@ void layx_arrange_overlay(layx_context *ctx, layx_id item, int dim)
     const layx_scalar offset = layx_get_content_offset(ctx, item, dim);
     const layx_scalar space = layx_get_internal_space(ctx, item, dim);
 
-    LAYX_DEBUG_PRINT("DEBUG layx_arrange_overlay: item=%d, dim=%d=%d, offset=%.1f, space=%.1f\n",
-                   item, dim, offset, space);
+    LAYX_DEBUG_PRINT("DEBUG layx_arrange_overlay: item=%d, dim=%d, offset=%.1f, space=%.1f\n",
+                   item, dim, (double)offset, (double)space);
 
     // Get align-items for cross-axis alignment
     layx_align_items align_items = (layx_align_items)(pitem->flags & LAYX_ALIGN_ITEMS_MASK);
 
-    layx_id child = pitem->first_child;
+    layx_id child = layx_first_in_flow(ctx, pitem);
     while (child != LAYX_INVALID_ID) {
         layx_item_t *pchild = layx_get_item(ctx, child);
-        const layx_vec4 child_margins = pchild->margin_trbl;
+        const layx_vec4 child_margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
         layx_vec4 child_rect = ctx->rects[child];
 
         // Check if child has explicit align-self
@@ -1652,7 +3739,7 @@ void layx_arrange_overlay(layx_context *ctx, layx_id item, int dim)
                     child_rect[POINT_DIM(dim)] = offset + child_margins[START_SIDE(dim)] + 
                         (space - child_margins[START_SIDE(dim)] - child_margins[END_SIDE(dim)] - child_rect[SIZE_DIM(dim)]) / 2;
                     LAYX_DEBUG_PRINT("DEBUG CENTER (align-self): item=%d, child=%d, offset=%.1f, space=%.1f, child_h=%.1f, margin_top=%.1f, margin_bottom=%.1f\n",
-                                   item, child, offset, space, child_rect[SIZE_DIM(dim)], child_margins[START_SIDE(dim)], child_margins[END_SIDE(dim)]);
+                                   item, child, (double)offset, (double)space, (double)child_rect[SIZE_DIM(dim)], (double)child_margins[START_SIDE(dim)], (double)child_margins[END_SIDE(dim)]);
                     break;
                 case LAYX_ALIGN_SELF_FLEX_END:
                     child_rect[POINT_DIM(dim)] = offset + space - child_margins[END_SIDE(dim)] - child_rect[SIZE_DIM(dim)];
@@ -1679,7 +3766,7 @@ void layx_arrange_overlay(layx_context *ctx, layx_id item, int dim)
                     child_rect[POINT_DIM(dim)] = offset + child_margins[START_SIDE(dim)] + 
                         (space - child_margins[START_SIDE(dim)] - child_margins[END_SIDE(dim)] - child_rect[SIZE_DIM(dim)]) / 2;
                     LAYX_DEBUG_PRINT("DEBUG CENTER (align-items): item=%d, child=%d, offset=%.1f, space=%.1f, child_h=%.1f, margin_top=%.1f, margin_bottom=%.1f\n",
-                                   item, child, offset, space, child_rect[SIZE_DIM(dim)], child_margins[START_SIDE(dim)], child_margins[END_SIDE(dim)]);
+                                   item, child, (double)offset, (double)space, (double)child_rect[SIZE_DIM(dim)], (double)child_margins[START_SIDE(dim)], (double)child_margins[END_SIDE(dim)]);
                     break;
                 case LAYX_ALIGN_ITEMS_FLEX_END:
                     child_rect[POINT_DIM(dim)] = offset + space - child_margins[END_SIDE(dim)] - child_rect[SIZE_DIM(dim)];
@@ -1701,7 +3788,7 @@ void layx_arrange_overlay(layx_context *ctx, layx_id item, int dim)
             }
         }
         ctx->rects[child] = child_rect;
-        child = pchild->next_sibling;
+        child = layx_next_in_flow(ctx, pchild);
     }
 }
 // Helper to arrange overlay squeezed range
@@ -1714,13 +3801,13 @@ void layx_arrange_overlay_squeezed_range(
     layx_id item = start_item;
     while (item != end_item) {
         layx_item_t *pitem = layx_get_item(ctx, item);
-        const layx_vec4 margins = pitem->margin_trbl;
+        const layx_vec4 margins = layx_item_box(ctx, pitem, LAYX_BOX_MARGIN);
         layx_vec4 rect = ctx->rects[item];
         layx_scalar min_size = layx_scalar_max(0, space - rect[POINT_DIM(dim)] - margins[END_SIDE(dim)]);
         rect[SIZE_DIM(dim)] = layx_scalar_min(rect[SIZE_DIM(dim)], min_size);
         rect[POINT_DIM(dim)] += offset;
         ctx->rects[item] = rect;
-        item = pitem->next_sibling;
+        item = layx_next_in_flow(ctx, pitem);
     }
 }
 
@@ -1737,59 +3824,29 @@ layx_scalar layx_arrange_wrapped_overlay_squeezed(
     layx_scalar offset = layx_get_content_offset(ctx, item, dim);
     const layx_scalar space = layx_get_internal_space(ctx, item, dim);
     
-    // Collect all rows to apply align-content later
-    struct {
-        layx_id start_child;
-        layx_id end_child;
-        layx_scalar row_size;
-        layx_scalar row_offset;
-    } rows[32];
-    int row_count = 0;
-    
-    layx_id child = pitem->first_child;
-    layx_id start_child = child;
-    layx_scalar need_size = 0;
-    
-    // Phase 1: Collect row information
-    while (child != LAYX_INVALID_ID && row_count < 32) {
-        layx_item_t *pchild = layx_get_item(ctx, child);
-        if (pchild->flags & LAYX_BREAK || row_count == 0) {
-            // Save previous row (except for first row)
-            if (row_count > 0) {
-                rows[row_count - 1].end_child = child;
-                rows[row_count - 1].row_size = need_size;
-            }
-            
-            // Start new row
-            rows[row_count].start_child = child;
-            rows[row_count].end_child = LAYX_INVALID_ID;
-            rows[row_count].row_size = 0;
-            rows[row_count].row_offset = offset + (row_count > 0 ? rows[row_count - 1].row_size : 0);
-            
-            need_size = 0;
-        }
-        
-        const layx_vec4 rect = ctx->rects[child];
-        layx_scalar child_size = rect[POINT_DIM(dim)] + rect[SIZE_DIM(dim)] + pchild->margin_trbl[END_SIDE(dim)];
-        need_size = layx_scalar_max(need_size, child_size);
-        
-        child = pchild->next_sibling;
-        
-        // If this was the last child, save the final row
-        if (child == LAYX_INVALID_ID) {
-            rows[row_count].end_child = child;
-            rows[row_count].row_size = need_size;
+    // Phase 1: 每行的交叉轴尺寸，行由主轴排列时记录
+    uint32_t row_count;
+    layx_flex_line *rows = layx_get_flex_lines(ctx, item, &row_count);
+    layx_scalar total_rows_height = 0;
+    for (uint32_t i = 0; i < row_count; i++) {
+        layx_scalar need_size = 0;
+        layx_id child = rows[i].first_child;
+        while (child != rows[i].end_child) {
+            layx_item_t *pchild = layx_get_item(ctx, child);
+            const layx_vec4 rect = ctx->rects[child];
+            layx_scalar child_size = rect[POINT_DIM(dim)] + rect[SIZE_DIM(dim)] + layx_item_box(ctx, pchild, LAYX_BOX_MARGIN)[END_SIDE(dim)];
+            need_size = layx_scalar_max(need_size, child_size);
+            child = layx_next_in_flow(ctx, pchild);
         }
-        
-        row_count++;
+        rows[i].cross_size = need_size;
+        total_rows_height += need_size;
     }
-    
-    // Phase 2: Apply align-content to position rows
-    layx_scalar total_rows_height = 0;
-    for (int i = 0; i < row_count; i++) {
-        total_rows_height += rows[i].row_size;
+    const layx_scalar line_gap = pitem->gap[dim];
+    if (row_count > 1) {
+        total_rows_height += line_gap * (layx_scalar)(row_count - 1);
     }
-    
+
+    // Phase 2: Apply align-content to position rows
     layx_scalar available_space_for_rows = space - total_rows_height;
     layx_scalar row_start_offset = offset;
     
@@ -1815,10 +3872,13 @@ layx_scalar layx_arrange_wrapped_overlay_squeezed(
             break;
     }
     
-    // Phase 3: Position rows with align-content spacing
+    // Phase 3: Position rows with align-content spacing, then apply align-items/align-self to each row
     layx_scalar current_offset = row_start_offset;
-    for (int i = 0; i < row_count; i++) {
-        rows[i].row_offset = current_offset;
+    for (uint32_t i = 0; i < row_count; i++) {
+        layx_scalar row_size = rows[i].cross_size;
+        if (i > 0) {
+            current_offset += line_gap;
+        }
         
         // Calculate spacing for this row based on align-content
         if (align_content == LAYX_ALIGN_CONTENT_SPACE_BETWEEN) {
@@ -1826,26 +3886,17 @@ layx_scalar layx_arrange_wrapped_overlay_squeezed(
                 layx_scalar gap = available_space_for_rows / (layx_scalar)(row_count - 1);
                 current_offset += gap;
             }
-            rows[i].row_offset = current_offset;
         } else if (align_content == LAYX_ALIGN_CONTENT_SPACE_AROUND) {
             layx_scalar gap = available_space_for_rows / (layx_scalar)row_count;
             current_offset += gap;
-            rows[i].row_offset = current_offset;
         } else if (align_content == LAYX_ALIGN_CONTENT_STRETCH) {
             // Stretch rows to fill available space
-            if (row_count > 0) {
-                layx_scalar stretched_row_height = space / (layx_scalar)row_count;
-                rows[i].row_size = layx_scalar_max(rows[i].row_size, stretched_row_height);
-            }
+            layx_scalar stretched_row_height = (space - line_gap * (layx_scalar)(row_count - 1)) / (layx_scalar)row_count;
+            row_size = layx_scalar_max(row_size, stretched_row_height);
         }
         
-        current_offset += rows[i].row_size;
-    }
-    
-    // Phase 4: Apply align-items/align-self to each row
-    for (int i = 0; i < row_count; i++) {
-        // Apply alignment to children in this row
-        layx_arrange_overlay_squeezed_range(ctx, dim, rows[i].start_child, rows[i].end_child, rows[i].row_offset, rows[i].row_size);
+        layx_arrange_overlay_squeezed_range(ctx, dim, rows[i].first_child, rows[i].end_child, current_offset, row_size);
+        current_offset += row_size;
     }
     
     return offset + total_rows_height + available_space_for_rows;
@@ -1853,7 +3904,7 @@ layx_scalar layx_arrange_wrapped_overlay_squeezed(
 
 // 独立的 block 布局函数
 // BLOCK: 元素独占一行，子元素在水平方向上叠加，在垂直方向上堆叠
-static void layx_arrange_block(layx_context *ctx, layx_id item, int dim)
+static LAYX_FORCE_INLINE void layx_arrange_block(layx_context *ctx, layx_id item, int dim)
 {
     layx_item_t *pitem = layx_get_item(ctx, item);
 
@@ -1866,15 +3917,15 @@ static void layx_arrange_block(layx_context *ctx, layx_id item, int dim)
         const layx_scalar offset = layx_get_content_offset(ctx, item, dim);
         const layx_scalar space = layx_get_internal_space(ctx, item, dim);
 
-        LAYX_DEBUG_PRINT("DEBUG layx_arrange_block(item=%d, dim=0): offset=%.1f, space=%.1f\n", item, offset, space);
+        LAYX_DEBUG_PRINT("DEBUG layx_arrange_block(item=%d, dim=0): offset=%.1f, space=%.1f\n", item, (double)offset, (double)space);
 
-        layx_id child = pitem->first_child;
+        layx_id child = layx_first_in_flow(ctx, pitem);
         while (child != LAYX_INVALID_ID) {
             layx_item_t *pchild = layx_get_item(ctx, child);
             layx_vec4 child_rect = ctx->rects[child];
-            const layx_vec4 child_margins = pchild->margin_trbl;
-            const layx_vec4 child_padding = pchild->padding_trbl;
-            const layx_vec4 child_border = pchild->border_trbl;
+            const layx_vec4 child_margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
+            const layx_vec4 child_padding = layx_item_box(ctx, pchild, LAYX_BOX_PADDING);
+            const layx_vec4 child_border = layx_item_box(ctx, pchild, LAYX_BOX_BORDER);
 
             // 子元素左对齐
             child_rect[POINT_DIM(dim)] = offset + child_margins[START_SIDE(dim)];
@@ -1885,25 +3936,25 @@ static void layx_arrange_block(layx_context *ctx, layx_id item, int dim)
                 // 如果子元素有固定宽度，保持原宽度
                 // child_rect[2] 已经在 layx_calc_size 中设置了
                 LAYX_DEBUG_PRINT("DEBUG layx_arrange_block: child %d has fixed width %.1f\n",
-                       child, child_rect[2]);
+                       child, (double)child_rect[2]);
             } else {
                 // 如果子元素没有固定宽度，填充可用空间
                 layx_scalar available_width = space - child_margins[START_SIDE(dim)] - child_margins[END_SIDE(dim)];
                 child_rect[2] = available_width;
                 LAYX_DEBUG_PRINT("DEBUG layx_arrange_block: child %d set width to %.1f (space=%.1f, margins=[%.1f,%.1f])\n",
-                       child, available_width, space, child_margins[START_SIDE(dim)], child_margins[END_SIDE(dim)]);
+                       child, (double)available_width, (double)space, (double)child_margins[START_SIDE(dim)], (double)child_margins[END_SIDE(dim)]);
             }
 
             ctx->rects[child] = child_rect;
 
-            child = pchild->next_sibling;
+            child = layx_next_in_flow(ctx, pchild);
         }
     }
 }
 
 // Inline 布局函数
 // INLINE: 元素在一行内排列，宽度由内容决定
-static void layx_arrange_inline(layx_context *ctx, layx_id item, int dim)
+static LAYX_FORCE_INLINE void layx_arrange_inline(layx_context *ctx, layx_id item, int dim)
 {
     layx_item_t *pitem = layx_get_item(ctx, item);
 
@@ -1919,11 +3970,11 @@ static void layx_arrange_inline(layx_context *ctx, layx_id item, int dim)
         float max_line_width = 0.0f;
         layx_id prev_child = LAYX_INVALID_ID;  // 用于记录上一个子项，正确处理margin合并
 
-        layx_id child = pitem->first_child;
+        layx_id child = layx_first_in_flow(ctx, pitem);
         while (child != LAYX_INVALID_ID) {
             layx_item_t *pchild = layx_get_item(ctx, child);
             layx_vec4 child_rect = ctx->rects[child];
-            const layx_vec4 child_margins = pchild->margin_trbl;
+            const layx_vec4 child_margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
 
             // 计算子元素的占用宽度（包含margin）
             float child_content_width = (float)child_rect[2];
@@ -1938,11 +3989,11 @@ static void layx_arrange_inline(layx_context *ctx, layx_id item, int dim)
             } else {
                 // 非第一个子项：与上一个子项之间的边距取最大值
                 layx_item_t *pprev = layx_get_item(ctx, prev_child);
-                margin_left = layx_float_max((float)pprev->margin_trbl[END_SIDE(dim)], (float)child_margins[START_SIDE(dim)]);
+                margin_left = layx_float_max((float)layx_item_box(ctx, pprev, LAYX_BOX_MARGIN)[END_SIDE(dim)], (float)child_margins[START_SIDE(dim)]);
             }
 
             // 如果是最后一个子项，使用完整的右margin
-            layx_id next_child = pchild->next_sibling;
+            layx_id next_child = layx_next_in_flow(ctx, pchild);
             if (next_child == LAYX_INVALID_ID || (layx_get_item(ctx, next_child)->flags & LAYX_BREAK)) {
                 margin_right = (float)child_margins[END_SIDE(dim)];
             }
@@ -1965,7 +4016,7 @@ static void layx_arrange_inline(layx_context *ctx, layx_id item, int dim)
 
             ctx->rects[child] = child_rect;
             prev_child = child;
-            child = pchild->next_sibling;
+            child = layx_next_in_flow(ctx, pchild);
         }
     } else {
         // Y 轴（垂直方向）：使用 overlay（叠加）
@@ -1975,7 +4026,7 @@ static void layx_arrange_inline(layx_context *ctx, layx_id item, int dim)
 
 // Inline-block 布局函数
 // INLINE_BLOCK: 元素在一行内排列，但可以设置宽高
-static void layx_arrange_inline_block(layx_context *ctx, layx_id item, int dim)
+static LAYX_FORCE_INLINE void layx_arrange_inline_block(layx_context *ctx, layx_id item, int dim)
 {
     layx_item_t *pitem = layx_get_item(ctx, item);
 
@@ -1990,11 +4041,11 @@ static void layx_arrange_inline_block(layx_context *ctx, layx_id item, int dim)
         float max_line_width = 0.0f;
         layx_id prev_child = LAYX_INVALID_ID;  // 用于记录上一个子项，正确处理margin合并
 
-        layx_id child = pitem->first_child;
+        layx_id child = layx_first_in_flow(ctx, pitem);
         while (child != LAYX_INVALID_ID) {
             layx_item_t *pchild = layx_get_item(ctx, child);
             layx_vec4 child_rect = ctx->rects[child];
-            const layx_vec4 child_margins = pchild->margin_trbl;
+            const layx_vec4 child_margins = layx_item_box(ctx, pchild, LAYX_BOX_MARGIN);
 
             // 计算子元素的占用宽度（包含margin）
             float child_content_width = (float)child_rect[2];
@@ -2009,11 +4060,11 @@ static void layx_arrange_inline_block(layx_context *ctx, layx_id item, int dim)
             } else {
                 // 非第一个子项：与上一个子项之间的边距取最大值
                 layx_item_t *pprev = layx_get_item(ctx, prev_child);
-                margin_left = layx_float_max((float)pprev->margin_trbl[END_SIDE(dim)], (float)child_margins[START_SIDE(dim)]);
+                margin_left = layx_float_max((float)layx_item_box(ctx, pprev, LAYX_BOX_MARGIN)[END_SIDE(dim)], (float)child_margins[START_SIDE(dim)]);
             }
 
             // 如果是最后一个子项，使用完整的右margin
-            layx_id next_child = pchild->next_sibling;
+            layx_id next_child = layx_next_in_flow(ctx, pchild);
             if (next_child == LAYX_INVALID_ID || (layx_get_item(ctx, next_child)->flags & LAYX_BREAK)) {
                 margin_right = (float)child_margins[END_SIDE(dim)];
             }
@@ -2036,7 +4087,7 @@ static void layx_arrange_inline_block(layx_context *ctx, layx_id item, int dim)
 
             ctx->rects[child] = child_rect;
             prev_child = child;
-            child = pchild->next_sibling;
+            child = layx_next_in_flow(ctx, pchild);
         }
     } else {
         // Y 轴（垂直方向）：使用 overlay（叠加）
@@ -2045,68 +4096,728 @@ static void layx_arrange_inline_block(layx_context *ctx, layx_id item, int dim)
 }
 
 // PHASE 2: Arrange items (second pass)
-static void layx_arrange(layx_context *ctx, layx_id item, int dim)
+static LAYX_FORCE_INLINE void layx_arrange_dim(layx_context *ctx, layx_id item, const int dim, const layx_strategy strategy)
 {
     layx_item_t *pitem = layx_get_item(ctx, item);
 
-    const uint32_t flags = pitem->flags;
-    layx_display display = layx_get_display_from_flags(flags);
-    layx_flex_direction direction = (layx_flex_direction)(flags & LAYX_FLEX_DIRECTION_MASK);
-    layx_flex_wrap wrap = (layx_flex_wrap)(flags & LAYX_FLEX_WRAP_MASK);
-    
-    // 根据不同的 display 类型调用不同的布局函数
-    switch (display) {
-       
-        case LAYX_DISPLAY_INLINE:
-            layx_arrange_inline(ctx, item, dim);
-            LAYX_DEBUG_PRINT("DEBUG: layx_arrange_inline(item=%d, dim=%d, display=%d) \n", item, dim, display);
-            break;
-        case LAYX_DISPLAY_INLINE_BLOCK:
-            layx_arrange_inline_block(ctx, item,dim);
-            LAYX_DEBUG_PRINT("DEBUG: layx_arrange_inline_block(item=%d, dim=%d, display=%d) \n", item, dim, display);
-            break;
-        case LAYX_DISPLAY_FLEX: {
-            bool is_row_direction = (direction == LAYX_FLEX_DIRECTION_ROW || direction == LAYX_FLEX_DIRECTION_ROW_REVERSE);
-            bool is_wrapped = (wrap != LAYX_FLEX_WRAP_NOWRAP);
-            
-            if (is_wrapped) {
-                if (is_row_direction) {
-                    if (dim == 0) {
-                        layx_arrange_stacked(ctx, item, 0, true);
-                    } else {
-                        layx_arrange_wrapped_overlay_squeezed(ctx, item,1);
-                    }
-                } else {
-                    if (dim == 1) {
-                        layx_arrange_stacked(ctx, item, 1, true);
-                        layx_arrange_wrapped_overlay_squeezed(ctx, item,0);
-                    } else {
-                        layx_arrange_wrapped_overlay_squeezed(ctx, item,0);
-                    }
+    // 父元素已排列过（先序），此时包含块已确定
+    if (pitem->flags & LAYX_ITEM_ABSOLUTE) {
+        layx_arrange_absolute(ctx, item, dim);
+    }
+
+    switch (strategy) {
+    case LAYX_STRATEGY_INLINE:
+        layx_arrange_inline(ctx, item, dim);
+        LAYX_DEBUG_PRINT("DEBUG: layx_arrange_inline(item=%d, dim=%d, display=%d) \n", item, dim, layx_get_display_from_flags(pitem->flags));
+        break;
+    case LAYX_STRATEGY_INLINE_BLOCK:
+        layx_arrange_inline_block(ctx, item, dim);
+        LAYX_DEBUG_PRINT("DEBUG: layx_arrange_inline_block(item=%d, dim=%d, display=%d) \n", item, dim, layx_get_display_from_flags(pitem->flags));
+        break;
+    case LAYX_STRATEGY_GRID:
+        layx_arrange_grid(ctx, item, dim);
+        break;
+    case LAYX_STRATEGY_FLEX_ROW:
+        if (dim == 0) {
+            layx_arrange_stacked(ctx, item, dim, false);
+        } else {
+            // 交叉轴按 align-items 对齐
+            layx_arrange_overlay(ctx, item, dim);
+        }
+        break;
+    case LAYX_STRATEGY_FLEX_COLUMN:
+        if (dim == 1) {
+            layx_arrange_stacked(ctx, item, dim, false);
+        } else {
+            layx_arrange_overlay(ctx, item, dim);
+        }
+        break;
+    case LAYX_STRATEGY_FLEX_ROW_WRAP:
+        if (dim == 0) {
+            layx_arrange_stacked(ctx, item, dim, true);
+        } else {
+            layx_arrange_wrapped_overlay_squeezed(ctx, item, dim);
+        }
+        break;
+    case LAYX_STRATEGY_FLEX_COLUMN_WRAP:
+        if (dim == 1) {
+            layx_arrange_stacked(ctx, item, 1, true);
+        }
+        layx_arrange_wrapped_overlay_squeezed(ctx, item, 0);
+        break;
+    case LAYX_STRATEGY_BLOCK:
+    default:
+        layx_arrange_block(ctx, item, dim);
+        LAYX_DEBUG_PRINT("DEBUG: layx_arrange_block(item=%d, dim=%d, display=%d) \n", item, dim, layx_get_display_from_flags(pitem->flags));
+        break;
+    }
+}
+
+// 每种策略的尺寸计算与排列内核按维度各生成一份：策略和 dim 都是编译期常量，
+// START_SIDE / END_SIDE / POINT_DIM / SIZE_DIM 以及对 display、方向、换行的判断在编译时折叠。
+// 布局时按 flags 中缓存的策略查表，每个容器只有一次间接调用
+#define LAYX_DEFINE_STRATEGY_KERNELS(name, strategy) \
+    static void layx_calc_size_##name##_x(layx_context *ctx, layx_id item) { layx_calc_size_dim(ctx, item, DIM_WIDTH, strategy); } \
+    static void layx_calc_size_##name##_y(layx_context *ctx, layx_id item) { layx_calc_size_dim(ctx, item, DIM_HEIGHT, strategy); } \
+    static void layx_arrange_##name##_x(layx_context *ctx, layx_id item) { layx_arrange_dim(ctx, item, DIM_WIDTH, strategy); } \
+    static void layx_arrange_##name##_y(layx_context *ctx, layx_id item) { layx_arrange_dim(ctx, item, DIM_HEIGHT, strategy); }
+
+LAYX_DEFINE_STRATEGY_KERNELS(block, LAYX_STRATEGY_BLOCK)
+LAYX_DEFINE_STRATEGY_KERNELS(inline, LAYX_STRATEGY_INLINE)
+LAYX_DEFINE_STRATEGY_KERNELS(inline_block, LAYX_STRATEGY_INLINE_BLOCK)
+LAYX_DEFINE_STRATEGY_KERNELS(grid, LAYX_STRATEGY_GRID)
+LAYX_DEFINE_STRATEGY_KERNELS(flex_row, LAYX_STRATEGY_FLEX_ROW)
+LAYX_DEFINE_STRATEGY_KERNELS(flex_column, LAYX_STRATEGY_FLEX_COLUMN)
+LAYX_DEFINE_STRATEGY_KERNELS(flex_row_wrap, LAYX_STRATEGY_FLEX_ROW_WRAP)
+LAYX_DEFINE_STRATEGY_KERNELS(flex_column_wrap, LAYX_STRATEGY_FLEX_COLUMN_WRAP)
+
+typedef void (*layx_kernel)(layx_context *ctx, layx_id item);
+
+typedef struct layx_strategy_kernels {
+    layx_kernel calc_size[2];
+    layx_kernel arrange[2];
+} layx_strategy_kernels;
+
+#define LAYX_STRATEGY_KERNELS(name) \
+    { { layx_calc_size_##name##_x, layx_calc_size_##name##_y }, { layx_arrange_##name##_x, layx_arrange_##name##_y } }
+
+static const layx_strategy_kernels layx_kernels[LAYX_STRATEGY_COUNT] = {
+    LAYX_STRATEGY_KERNELS(block),
+    LAYX_STRATEGY_KERNELS(inline),
+    LAYX_STRATEGY_KERNELS(inline_block),
+    LAYX_STRATEGY_KERNELS(grid),
+    LAYX_STRATEGY_KERNELS(flex_row),
+    LAYX_STRATEGY_KERNELS(flex_column),
+    LAYX_STRATEGY_KERNELS(flex_row_wrap),
+    LAYX_STRATEGY_KERNELS(flex_column_wrap),
+};
+
+static void layx_calc_size(layx_context *ctx, layx_id item, int dim)
+{
+    layx_kernels[layx_get_strategy(ctx->items[item].flags)].calc_size[dim](ctx, item);
+}
+
+static void layx_arrange(layx_context *ctx, layx_id item, int dim)
+{
+    layx_kernels[layx_get_strategy(ctx->items[item].flags)].arrange[dim](ctx, item);
+}
+
+// Subtree memoisation
+enum {
+    LAYX_MEMO_LAID_OUT_X = 0x1,     // 后代本轮已完成横向的 calc 与 arrange
+    LAYX_MEMO_LAID_OUT_Y = 0x2,     // 后代本轮已完成纵向的 calc
+    LAYX_MEMO_CALCED_X   = 0x4,     // 后代本轮已完成横向的 calc
+};
+
+// 按 32 位字混合的 FNV-1a，size 必须是 4 的倍数
+static LAYX_FORCE_INLINE uint64_t layx_memo_mix(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i += 4) {
+        uint32_t word;
+        memcpy(&word, bytes + i, 4);
+        hash = (hash ^ word) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// 先序遍历子树，每个 item 的布局输入加上"是否有子元素 / 是否有下一个兄弟"即可唯一确定结构。
+// 运行时状态（脏标记、滚动条标志）、没有 API 写入的基线字段和 item id 不参与
+static uint64_t layx_memo_hash(const layx_context *ctx, layx_id root, uint32_t *node_count)
+{
+    const uint32_t runtime_flags = LAYX_ITEM_DIRTY | LAYX_HAS_VSCROLL | LAYX_HAS_HSCROLL;
+    uint64_t hash = 0xcbf29ce484222325ull;
+    uint32_t count = 0;
+    for (layx_id node = root; node != LAYX_INVALID_ID; node = layx_pre_order_next(ctx, root, node)) {
+        const layx_item_t *pitem = ctx->items + node;
+        const uint32_t words[5] = {
+            pitem->flags & ~runtime_flags,
+            pitem->auto_flags,
+            (uint32_t)(pitem->first_child != LAYX_INVALID_ID) | (uint32_t)(node != root && pitem->next_sibling != LAYX_INVALID_ID) << 1
+                | (uint32_t)pitem->overflow_x << 8 | (uint32_t)pitem->overflow_y << 16,
+            (uint32_t)pitem->grid_cell[0] | (uint32_t)pitem->grid_cell[1] << 16,
+            (uint32_t)pitem->grid_span[0] | (uint32_t)pitem->grid_span[1] << 8,
+        };
+        hash = layx_memo_mix(hash, words, sizeof(words));
+        // 哈希盒模型的值而不是记录下标，记录复用后下标会变化
+        for (int kind = LAYX_BOX_MARGIN; kind <= LAYX_BOX_BORDER; ++kind) {
+            const layx_vec4 box = layx_item_box(ctx, pitem, kind);
+            hash = layx_memo_mix(hash, &box, sizeof(layx_vec4));
+        }
+        hash = layx_memo_mix(hash, &pitem->size, sizeof(layx_vec2));
+        hash = layx_memo_mix(hash, &pitem->min_size, sizeof(layx_vec2));
+        hash = layx_memo_mix(hash, &pitem->max_size, sizeof(layx_vec2));
+        hash = layx_memo_mix(hash, &pitem->position, sizeof(layx_vec4));
+        // 单个标量在整数模式下只有 2 字节，统一转为 float 混合
+        const float factors[3] = { pitem->flex_grow, pitem->flex_shrink, (float)pitem->flex_basis };
+        hash = layx_memo_mix(hash, factors, sizeof(factors));
+        hash = layx_memo_mix(hash, &pitem->gap, sizeof(layx_vec2));
+        if (pitem->grid != 0) {
+            const layx_grid *grid = ctx->grids.records + pitem->grid;
+            for (int dim = 0; dim < 2; ++dim) {
+                hash = layx_memo_mix(hash, &grid->track_count[dim], sizeof(uint32_t));
+                for (uint32_t i = 0; i < grid->track_count[dim]; ++i) {
+                    const float track[2] = { (float)grid->tracks[dim][i].kind, grid->tracks[dim][i].value };
+                    hash = layx_memo_mix(hash, track, sizeof(track));
                 }
-            } else {
-                if ((is_row_direction && dim == 0) || (!is_row_direction && dim == 1)) {
-                    layx_arrange_stacked(ctx, item, dim, false);
-                } else {
-                    // Use layx_arrange_overlay for cross-axis alignment (align-items)
-                    layx_arrange_overlay(ctx, item,dim);
+            }
+        }
+        ++count;
+    }
+    *node_count = count;
+    return hash;
+}
+
+// width/height 小于 0 表示不比较
+static layx_memo_entry *layx_memo_lookup(layx_memo_table *memo, const layx_memo_root *root, layx_scalar width, layx_scalar height)
+{
+    uint32_t index = memo->buckets[(uint32_t)root->hash & memo->bucket_mask];
+    while (index != 0) {
+        layx_memo_entry *entry = memo->entries + index;
+        if (entry->hash == root->hash && entry->node_count == root->node_count
+            && (width < 0 || entry->size[0] == width)
+            && (height < 0 || entry->size[1] == height)) {
+            return entry;
+        }
+        index = entry->next;
+    }
+    return NULL;
+}
+
+// 查找并标记为使用过；写入结果时的查找不算使用，插入后没有命中过的记录最先被淘汰
+static layx_memo_entry *layx_memo_find(layx_memo_table *memo, const layx_memo_root *root, layx_scalar width, layx_scalar height)
+{
+    layx_memo_entry *entry = layx_memo_lookup(memo, root, width, height);
+    if (entry != NULL) entry->referenced = 1;
+    return entry;
+}
+
+static void layx_memo_unlink(layx_memo_table *memo, uint32_t index)
+{
+    uint32_t *link = memo->buckets + ((uint32_t)memo->entries[index].hash & memo->bucket_mask);
+    while (*link != index) {
+        link = &memo->entries[*link].next;
+    }
+    *link = memo->entries[index].next;
+}
+
+// 时钟淘汰：指针经过的记录如果使用过就清除标记再给一次机会，停在第一条没有使用过的记录上。
+// 最多绕一圈，代价均摊到每次插入是常数
+static uint32_t layx_memo_victim(layx_memo_table *memo)
+{
+    uint32_t hand = memo->hand >= 1 && memo->hand < memo->count ? memo->hand : 1;
+    while (memo->entries[hand].referenced) {
+        memo->entries[hand].referenced = 0;
+        if (++hand >= memo->count) hand = 1;
+    }
+    memo->hand = hand + 1 < memo->count ? hand + 1 : 1;
+    return hand;
+}
+
+// 记录子树当前的结果：子树根排列后的宽度已确定，with_height 时纵向结果也已确定
+static void layx_memo_store(layx_context *ctx, layx_id item, const layx_memo_root *root, bool with_height)
+{
+    layx_memo_table *memo = &ctx->memo;
+    const layx_vec4 origin = ctx->rects[item];
+    layx_memo_entry *entry = layx_memo_lookup(memo, root, origin[2], -1);
+    if (entry == NULL) {
+        uint32_t index;
+        if (memo->count <= memo->capacity) {
+            index = memo->count++;
+        } else {
+            index = layx_memo_victim(memo);
+            layx_memo_unlink(memo, index);
+            memo->stats.evictions++;
+        }
+        entry = memo->entries + index;
+        entry->hash = root->hash;
+        entry->node_count = root->node_count;
+        uint32_t *bucket = memo->buckets + ((uint32_t)root->hash & memo->bucket_mask);
+        entry->next = *bucket;
+        *bucket = index;
+        entry->referenced = 0;
+    }
+    entry->calc_size = root->calc_size;
+    entry->size[0] = origin[2];
+    entry->size[1] = with_height ? origin[3] : -1.0f;
+
+    const uint32_t count = root->node_count - 1;
+    if (count > entry->rect_capacity) {
+        entry->rects = (layx_vec4*)LAYX_REALLOC(entry->rects, count * sizeof(layx_vec4));
+        entry->rect_capacity = count;
+    }
+    uint32_t i = 0;
+    for (layx_id node = layx_pre_order_next(ctx, item, item); node != LAYX_INVALID_ID;
+         node = layx_pre_order_next(ctx, item, node)) {
+        layx_vec4 rect = ctx->rects[node];
+        rect[0] -= origin[0];
+        rect[1] -= origin[1];
+        entry->rects[i++] = rect;
+    }
+}
+
+// 命中：按子树根的位置还原后代的 rect，后代的状态与完整布局后一致（不再为脏，flex 行需重新记录）
+static void layx_memo_restore(layx_context *ctx, layx_id item, const layx_memo_entry *entry)
+{
+    const layx_vec4 origin = ctx->rects[item];
+    uint32_t i = 0;
+    for (layx_id node = layx_pre_order_next(ctx, item, item); node != LAYX_INVALID_ID;
+         node = layx_pre_order_next(ctx, item, node)) {
+        layx_vec4 rect = entry->rects[i++];
+        rect[0] += origin[0];
+        rect[1] += origin[1];
+        ctx->rects[node] = rect;
+        layx_item_t *pnode = ctx->items + node;
+        layx_grid_forget_rows(ctx, pnode);
+        pnode->flags &= ~LAYX_ITEM_DIRTY;
+        pnode->line_count = 0;
+    }
+}
+
+// 不经过缓存计算整个子树的尺寸，返回子树根的 calc 结果；子树根的 rect 保持父元素排列的结果
+static layx_scalar layx_memo_calc_subtree(layx_context *ctx, layx_id item, int dim)
+{
+    const layx_vec4 rect = ctx->rects[item];
+    for (layx_id node = layx_post_order_first(ctx, item); node != LAYX_INVALID_ID;
+         node = layx_post_order_next(ctx, item, node)) {
+        layx_calc_size(ctx, node, dim);
+    }
+    const layx_scalar size = ctx->rects[item][SIZE_DIM(dim)];
+    ctx->rects[item] = rect;
+    return size;
+}
+
+static void layx_memo_arrange_subtree(layx_context *ctx, layx_id item, int dim)
+{
+    for (layx_id node = item; node != LAYX_INVALID_ID; node = layx_pre_order_next(ctx, item, node)) {
+        layx_arrange(ctx, node, dim);
+    }
+}
+
+// 纵向的计算依赖横向排列的结果（包括 flex 行记录），因此后代总是先完成横向布局
+static void layx_memo_layout_x(layx_context *ctx, layx_id item, layx_memo_root *root)
+{
+    if (root->state & LAYX_MEMO_LAID_OUT_X) return;
+    if (!(root->state & LAYX_MEMO_CALCED_X)) {
+        layx_memo_calc_subtree(ctx, item, 0);
+    }
+    layx_memo_arrange_subtree(ctx, item, 0);
+    root->state |= LAYX_MEMO_CALCED_X | LAYX_MEMO_LAID_OUT_X;
+}
+
+// 缓存根的 calc：横向尺寸只取决于子树本身，纵向尺寸还取决于排列后的宽度
+static void layx_memo_calc(layx_context *ctx, layx_id item, int dim)
+{
+    layx_item_t *pitem = ctx->items + item;
+    layx_memo_table *memo = &ctx->memo;
+    layx_memo_root *root = memo->roots + pitem->memo;
+    if (dim == 0) {
+        root->hash = layx_memo_hash(ctx, item, &root->node_count);
+        root->state = 0;
+        // 同一哈希的记录横向 calc 结果都相同，取哪一条都不算使用
+        const layx_memo_entry *entry = layx_memo_lookup(memo, root, -1, -1);
+        if (entry != NULL) {
+            root->calc_size[0] = entry->calc_size[0];
+            pitem->line_count = 0;
+        } else {
+            root->calc_size[0] = layx_memo_calc_subtree(ctx, item, 0);
+            root->state |= LAYX_MEMO_CALCED_X;
+        }
+    } else {
+        const layx_memo_entry *entry = layx_memo_find(memo, root, ctx->rects[item][2], -1);
+        if (entry != NULL) {
+            root->calc_size[1] = entry->calc_size[1];
+        } else {
+            layx_memo_layout_x(ctx, item, root);
+            root->calc_size[1] = layx_memo_calc_subtree(ctx, item, 1);
+            root->state |= LAYX_MEMO_LAID_OUT_Y;
+            // 先记录横向结果和纵向尺寸，同一轮中相同宽度的实例不再重复计算
+            layx_memo_store(ctx, item, root, false);
+        }
+    }
+    layx_grid_forget_rows(ctx, pitem);
+    pitem->flags &= ~LAYX_ITEM_DIRTY;
+    ctx->rects[item][POINT_DIM(dim)] = layx_item_box(ctx, pitem, LAYX_BOX_MARGIN)[START_SIDE(dim)];
+    ctx->rects[item][SIZE_DIM(dim)] = root->calc_size[dim];
+}
+
+// 缓存根的 arrange：子树根的宽高在纵向排列时才全部确定，后代在这时一起还原或重新布局
+static void layx_memo_arrange(layx_context *ctx, layx_id item, int dim)
+{
+    if (ctx->items[item].flags & LAYX_ITEM_ABSOLUTE) {
+        layx_arrange_absolute(ctx, item, dim);
+    }
+    if (dim == 0) return;
+
+    layx_memo_table *memo = &ctx->memo;
+    layx_memo_root *root = memo->roots + ctx->items[item].memo;
+    if (!(root->state & LAYX_MEMO_LAID_OUT_Y)) {
+        const layx_memo_entry *entry = layx_memo_find(memo, root, ctx->rects[item][2], ctx->rects[item][3]);
+        if (entry != NULL) {
+            layx_memo_restore(ctx, item, entry);
+            memo->stats.hits++;
+            LAYX_STATS_COUNT(ctx, memo_hits);
+            return;
+        }
+        layx_memo_layout_x(ctx, item, root);
+        layx_memo_calc_subtree(ctx, item, 1);
+    }
+    layx_memo_arrange_subtree(ctx, item, 1);
+    memo->stats.misses++;
+    LAYX_STATS_COUNT(ctx, memo_misses);
+    layx_memo_store(ctx, item, root, true);
+}
+
+void layx_set_memo_capacity(layx_context *ctx, uint32_t capacity)
+{
+    LAYX_ASSERT(ctx != NULL);
+    LAYX_RECORD_CALL(ctx, LAYX_REC_MEMO_CAPACITY, LAYX_INVALID_ID, capacity);
+    layx_memo_table *memo = &ctx->memo;
+    for (uint32_t i = 0; i < memo->count; ++i) {
+        LAYX_FREE(memo->entries[i].rects);
+    }
+    LAYX_FREE(memo->entries);
+    LAYX_FREE(memo->buckets);
+    memo->entries = NULL;
+    memo->buckets = NULL;
+    memo->count = 0;
+    memo->capacity = capacity;
+    memo->bucket_mask = 0;
+    if (capacity == 0) return;
+
+    uint32_t buckets = 16;
+    while (buckets < capacity * 2) buckets *= 2;
+    memo->entries = (layx_memo_entry*)LAYX_REALLOC(NULL, (capacity + 1) * sizeof(layx_memo_entry));
+    LAYX_MEMSET(memo->entries, 0, (capacity + 1) * sizeof(layx_memo_entry));
+    memo->buckets = (uint32_t*)LAYX_REALLOC(NULL, buckets * sizeof(uint32_t));
+    LAYX_MEMSET(memo->buckets, 0, buckets * sizeof(uint32_t));
+    memo->bucket_mask = buckets - 1;
+    memo->count = 1;
+    memo->hand = 1;
+}
+
+// 丢弃缓存的结果，保留已分配的缓冲区
+void layx_clear_memo(layx_context *ctx)
+{
+    LAYX_ASSERT(ctx != NULL);
+    LAYX_RECORD_CALL(ctx, LAYX_REC_CLEAR_MEMO, LAYX_INVALID_ID);
+    layx_memo_table *memo = &ctx->memo;
+    if (memo->capacity == 0) return;
+    LAYX_MEMSET(memo->buckets, 0, (memo->bucket_mask + 1) * sizeof(uint32_t));
+    memo->count = 1;
+    memo->hand = 1;
+}
+
+void layx_set_memoize(layx_context *ctx, layx_id item, bool memoize)
+{
+    LAYX_RECORD_CALL(ctx, LAYX_REC_MEMOIZE, item, memoize ? 1u : 0u);
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    if (memoize) {
+        if (pitem->memo == 0) layx_memo_ensure(ctx, item)->observed = layx_observed_in_subtree(ctx, item);
+    } else if (pitem->memo != 0) {
+        ctx->memo.roots[pitem->memo].owner = LAYX_INVALID_ID;
+        pitem->memo = 0;
+    }
+}
+
+bool layx_get_memoize(layx_context *ctx, layx_id item)
+{
+    return layx_get_item(ctx, item)->memo != 0;
+}
+
+void layx_get_memo_stats(const layx_context *ctx, layx_memo_stats *stats)
+{
+    LAYX_ASSERT(ctx != NULL && stats != NULL);
+    *stats = ctx->memo.stats;
+    stats->entries = ctx->memo.count > 0 ? ctx->memo.count - 1 : 0;
+}
+
+void layx_reset_memo_stats(layx_context *ctx)
+{
+    LAYX_ASSERT(ctx != NULL);
+    LAYX_MEMSET(&ctx->memo.stats, 0, sizeof(layx_memo_stats));
+}
+
+// Layout statistics
+void layx_set_stats_enabled(layx_context *ctx, bool enable)
+{
+    LAYX_ASSERT(ctx != NULL);
+    ctx->stats_enabled = enable;
+}
+
+void layx_get_stats(const layx_context *ctx, layx_stats *stats)
+{
+    LAYX_ASSERT(ctx != NULL && stats != NULL);
+    *stats = ctx->stats;
+}
+
+void layx_reset_stats(layx_context *ctx)
+{
+    LAYX_ASSERT(ctx != NULL);
+    LAYX_MEMSET(&ctx->stats, 0, sizeof(layx_stats));
+}
+
+// Memory usage
+extern size_t layx_delta_memory(const layx_context *ctx);
+extern void layx_delta_shrink(layx_context *ctx);
+extern size_t layx_frames_memory(const layx_context *ctx);
+extern void layx_frames_shrink(layx_context *ctx);
+
+// 按空闲链表标记 [0, count) 中已销毁的 item，返回的数组由调用者释放
+static uint8_t *layx_mark_free_items(const layx_context *ctx, layx_id *free_count)
+{
+    uint8_t *is_free = (uint8_t*)LAYX_REALLOC(NULL, ctx->count > 0 ? ctx->count : 1);
+    LAYX_MEMSET(is_free, 0, ctx->count);
+    layx_id count = 0;
+    for (layx_id id = ctx->free_list_head; id != LAYX_INVALID_ID; id = ctx->items[id].next_sibling) {
+        is_free[id] = 1;
+        ++count;
+    }
+    *free_count = count;
+    return is_free;
+}
+
+void layx_get_memory_stats(const layx_context *ctx, layx_memory_stats *stats)
+{
+    LAYX_ASSERT(ctx != NULL && stats != NULL);
+    LAYX_MEMSET(stats, 0, sizeof(layx_memory_stats));
+    layx_id free_count;
+    uint8_t *is_free = layx_mark_free_items(ctx, &free_count);
+    stats->item_capacity = ctx->capacity;
+    stats->item_count = ctx->count;
+    stats->free_items = free_count;
+    stats->live_items = (layx_id)(ctx->count - free_count);
+    stats->item_bytes = (size_t)ctx->capacity * sizeof(layx_item_t);
+    stats->rect_bytes = (size_t)ctx->capacity * sizeof(layx_vec4);
+    stats->unused_bytes = ((size_t)ctx->capacity - stats->live_items) * (sizeof(layx_item_t) + sizeof(layx_vec4));
+
+    const layx_box_table *boxes = &ctx->boxes;
+    stats->box_bytes = (size_t)boxes->capacity * sizeof(layx_box) + (size_t)boxes->free_capacity * sizeof(uint32_t);
+    const layx_style_table *styles = &ctx->styles;
+    stats->style_bytes = (size_t)styles->capacity * sizeof(layx_style_record) +
+                         (size_t)styles->slot_capacity * sizeof(layx_style_id);
+    for (uint32_t i = 1; i < styles->count; ++i) {
+        stats->style_bytes += (size_t)styles->records[i].user_capacity * sizeof(layx_id);
+    }
+    const layx_grid_table *grids = &ctx->grids;
+    stats->grid_bytes = (size_t)grids->capacity * sizeof(layx_grid);
+    for (uint32_t i = 0; i < grids->capacity; ++i) {
+        const layx_grid *grid = grids->records + i;
+        for (int dim = 0; dim < 2; ++dim) {
+            stats->grid_bytes += (size_t)grid->track_capacity[dim] * sizeof(layx_grid_track) +
+                                 (size_t)grid->resolved_capacity[dim] * sizeof(float);
+        }
+    }
+    const layx_memo_table *memo = &ctx->memo;
+    stats->cache_bytes = (size_t)memo->root_capacity * sizeof(layx_memo_root);
+    if (memo->capacity > 0) {
+        stats->cache_bytes += (size_t)(memo->capacity + 1) * sizeof(layx_memo_entry) +
+                              (size_t)(memo->bucket_mask + 1) * sizeof(uint32_t);
+        for (uint32_t i = 0; i <= memo->capacity; ++i) {
+            stats->cache_bytes += (size_t)memo->entries[i].rect_capacity * sizeof(layx_vec4);
+        }
+    }
+    stats->scratch_bytes = (size_t)ctx->lines.capacity * sizeof(layx_flex_line) +
+                           (size_t)ctx->lines.item_capacity * sizeof(layx_flex_item) +
+                           (size_t)ctx->boundaries.capacity * sizeof(layx_id) +
+                           (size_t)grids->scratch_capacity * sizeof(float);
+    stats->delta_bytes = layx_delta_memory(ctx);
+    stats->frame_bytes = layx_frames_memory(ctx);
+    const layx_observer_table *observers = &ctx->observers;
+    stats->observer_bytes = (size_t)observers->capacity * sizeof(layx_observer) +
+                            ((size_t)observers->free_capacity + observers->queue_capacity) * sizeof(uint32_t);
+    stats->total_bytes = stats->item_bytes + stats->rect_bytes + stats->box_bytes + stats->style_bytes +
+                         stats->grid_bytes + stats->cache_bytes + stats->scratch_bytes +
+                         stats->delta_bytes + stats->frame_bytes + stats->observer_bytes;
+
+    // 从每个根（未插入的存活 item）先序遍历，数出 id 不连续的步数
+    uint32_t steps = 0, jumps = 0;
+    layx_id previous = LAYX_INVALID_ID;
+    for (layx_id root = 0; root < ctx->count; ++root) {
+        if (is_free[root] || ctx->items[root].parent != LAYX_INVALID_ID) continue;
+        for (layx_id item = root; item != LAYX_INVALID_ID; item = layx_pre_order_next(ctx, root, item)) {
+            if (previous != LAYX_INVALID_ID) {
+                ++steps;
+                if (item != previous + 1) ++jumps;
+            }
+            previous = item;
+        }
+    }
+    stats->fragmentation = steps > 0 ? (float)jumps / (float)steps : 0.0f;
+    LAYX_FREE(is_free);
+}
+
+// 缩小为 count 个元素，count 为 0 时释放
+static void *layx_shrink_array(void *block, uint32_t count, size_t size)
+{
+    if (count == 0) {
+        LAYX_FREE(block);
+        return NULL;
+    }
+    return LAYX_REALLOC(block, count * size);
+}
+
+// items 与 rects 共用一块内存，先把 rects 搬到新的起点再缩小
+static void layx_shrink_storage(layx_context *ctx, layx_id capacity)
+{
+    if (capacity == 0) {
+        LAYX_FREE(ctx->items);
+        ctx->items = NULL;
+        ctx->rects = NULL;
+        ctx->capacity = 0;
+        return;
+    }
+    memmove(ctx->items + capacity, ctx->rects, capacity * sizeof(layx_vec4));
+    ctx->items = (layx_item_t*)LAYX_REALLOC(ctx->items, capacity * (sizeof(layx_item_t) + sizeof(layx_vec4)));
+    ctx->capacity = capacity;
+    ctx->rects = (layx_vec4*)(ctx->items + capacity);
+}
+
+// 按存活 item 的 id 顺序重新编号，去掉空闲记录
+static void layx_compact_boxes(layx_context *ctx)
+{
+    layx_box_table *table = &ctx->boxes;
+    const uint32_t live = table->count > 0 ? table->count - 1 - table->free_count : 0;
+    layx_box *records = NULL;
+    if (live > 0) {
+        records = (layx_box*)LAYX_REALLOC(NULL, (live + 1) * sizeof(layx_box));
+        LAYX_MEMSET(records, 0, sizeof(layx_box));
+        uint32_t next = 1;
+        // 样式的共享记录先编号，引用者随样式一起改写；最高位暂时标记已改写的引用者
+        for (uint32_t i = 1; i < ctx->styles.count; ++i) {
+            layx_style_record *style = ctx->styles.records + i;
+            if (style->box == 0) continue;
+            const uint32_t old = style->box;
+            records[next] = table->records[old];
+            style->box = next++;
+            for (uint32_t k = 0; k < style->user_count; ++k) {
+                const layx_id user = style->user_ids[k];
+                if (user < ctx->count && ctx->items[user].style_id == i && ctx->items[user].box == old) {
+                    ctx->items[user].box = style->box | 0x80000000u;
                 }
             }
-            break;
         }
-        default:
-        case LAYX_DISPLAY_BLOCK:
-           layx_arrange_block(ctx, item, dim);
-           LAYX_DEBUG_PRINT("DEBUG: layx_arrange_block(item=%d, dim=%d, display=%d) \n", item, dim, display);
-           break;
+        for (layx_id i = 0; i < ctx->count; ++i) {
+            layx_item_t *pitem = ctx->items + i;
+            if (pitem->box == 0) continue;
+            if (pitem->box & 0x80000000u) {
+                pitem->box &= ~0x80000000u;
+                continue;
+            }
+            records[next] = table->records[pitem->box];
+            pitem->box = next++;
+        }
     }
-    
-    // 递归处理子项
-    layx_id child = pitem->first_child;
-    while (child != LAYX_INVALID_ID) {
-        layx_arrange(ctx, child, dim);
-        child = layx_next_sibling(ctx, child);
+    LAYX_FREE(table->records);
+    LAYX_FREE(table->free);
+    LAYX_MEMSET(table, 0, sizeof(layx_box_table));
+    if (live > 0) {
+        table->records = records;
+        table->count = live + 1;
+        table->capacity = live + 1;
+    }
+}
+
+// 空闲的 grid 记录释放轨道缓冲区，末尾的空闲记录截掉
+static void layx_shrink_grids(layx_context *ctx)
+{
+    layx_grid_table *table = &ctx->grids;
+    for (uint32_t i = 1; i < table->count; ++i) {
+        layx_grid *grid = table->records + i;
+        if (grid->owner != LAYX_INVALID_ID) continue;
+        for (int dim = 0; dim < 2; ++dim) {
+            LAYX_FREE(grid->tracks[dim]);
+            LAYX_FREE(grid->offsets[dim]);
+            grid->tracks[dim] = NULL;
+            grid->offsets[dim] = NULL;
+            grid->track_capacity[dim] = 0;
+            grid->resolved_capacity[dim] = 0;
+        }
     }
+    while (table->count > 1 && table->records[table->count - 1].owner == LAYX_INVALID_ID) --table->count;
+    if (table->count <= 1) table->count = 0;
+    table->capacity = table->count;
+    table->records = (layx_grid*)layx_shrink_array(table->records, table->count, sizeof(layx_grid));
+    LAYX_FREE(table->scratch);
+    table->scratch = NULL;
+    table->scratch_capacity = 0;
+}
+
+static void layx_shrink_memo(layx_context *ctx)
+{
+    layx_memo_table *memo = &ctx->memo;
+    while (memo->root_count > 1 && memo->roots[memo->root_count - 1].owner == LAYX_INVALID_ID) --memo->root_count;
+    if (memo->root_count <= 1) memo->root_count = 0;
+    memo->root_capacity = memo->root_count;
+    memo->roots = (layx_memo_root*)layx_shrink_array(memo->roots, memo->root_count, sizeof(layx_memo_root));
+    // 缓存记录的数量由 layx_set_memo_capacity 决定，这里只释放被清空的记录保留的 rects
+    for (uint32_t i = memo->count; i <= memo->capacity && memo->capacity > 0; ++i) {
+        LAYX_FREE(memo->entries[i].rects);
+        memo->entries[i].rects = NULL;
+        memo->entries[i].rect_capacity = 0;
+    }
+}
+
+void layx_shrink_to_fit(layx_context *ctx)
+{
+    LAYX_ASSERT(ctx != NULL);
+    LAYX_RECORD_CALL(ctx, LAYX_REC_SHRINK, LAYX_INVALID_ID);
+
+    // 截到最大的存活 id，空闲链表去掉截掉的部分并保持原来的顺序
+    layx_id free_count;
+    uint8_t *is_free = layx_mark_free_items(ctx, &free_count);
+    layx_id count = ctx->count;
+    while (count > 0 && is_free[count - 1]) --count;
+    LAYX_FREE(is_free);
+    layx_id *link = &ctx->free_list_head;
+    while (*link != LAYX_INVALID_ID) {
+        if (*link >= count) {
+            *link = ctx->items[*link].next_sibling;
+        } else {
+            link = &ctx->items[*link].next_sibling;
+        }
+    }
+    ctx->count = count;
+    if (ctx->storage_kind == LAYX_STORAGE_OWNED && ctx->capacity > count) {
+        layx_shrink_storage(ctx, count);
+    }
+
+    layx_compact_boxes(ctx);
+    layx_shrink_grids(ctx);
+    layx_shrink_memo(ctx);
+    layx_style_table *styles = &ctx->styles;
+    for (uint32_t i = 1; i < styles->count; ++i) {
+        layx_style_record *record = styles->records + i;
+        layx_style_compact_users(ctx, (layx_style_id)i);
+        record->user_capacity = record->user_count;
+        record->user_ids = (layx_id*)layx_shrink_array(record->user_ids, record->user_count, sizeof(layx_id));
+    }
+    styles->capacity = styles->count;
+    styles->records = (layx_style_record*)layx_shrink_array(styles->records, styles->count, sizeof(layx_style_record));
+    layx_flex_lines *lines = &ctx->lines;
+    lines->capacity = lines->count;
+    lines->lines = (layx_flex_line*)layx_shrink_array(lines->lines, lines->count, sizeof(layx_flex_line));
+    LAYX_FREE(lines->items);
+    lines->items = NULL;
+    lines->item_capacity = 0;
+    // 截掉的 id 已被销毁，登记项不再有效
+    layx_boundary_list *boundaries = &ctx->boundaries;
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < boundaries->count; ++i) {
+        if (boundaries->ids[i] < count) boundaries->ids[kept++] = boundaries->ids[i];
+    }
+    boundaries->count = kept;
+    boundaries->capacity = boundaries->count;
+    boundaries->ids = (layx_id*)layx_shrink_array(boundaries->ids, boundaries->count, sizeof(layx_id));
+    layx_observer_table *observers = &ctx->observers;
+    observers->capacity = observers->count;
+    observers->records = (layx_observer*)layx_shrink_array(observers->records, observers->count, sizeof(layx_observer));
+    observers->free_capacity = observers->free_count;
+    observers->free = (uint32_t*)layx_shrink_array(observers->free, observers->free_count, sizeof(uint32_t));
+    observers->queue_capacity = observers->queue_count;
+    observers->queue = (uint32_t*)layx_shrink_array(observers->queue, observers->queue_count, sizeof(uint32_t));
+    layx_delta_shrink(ctx);
+    layx_frames_shrink(ctx);
 }
 
 // Debug functions
@@ -2124,6 +4835,7 @@ const char* layx_get_layout_properties_string(layx_context *ctx, layx_id item)
         case LAYX_DISPLAY_FLEX: len += snprintf(buf + len, sizeof(buf) - len, "display:FLEX"); break;
         case LAYX_DISPLAY_INLINE_BLOCK: len += snprintf(buf + len, sizeof(buf) - len, "display:INLINE_BLOCK"); break;
         case LAYX_DISPLAY_INLINE: len += snprintf(buf + len, sizeof(buf) - len, "display:INLINE"); break;
+        case LAYX_DISPLAY_GRID: len += snprintf(buf + len, sizeof(buf) - len, "display:GRID"); break;
         default: len += snprintf(buf + len, sizeof(buf) - len, "display:INVALID(%d)", display); break;
     }
     
@@ -2221,10 +4933,124 @@ void layx_set_item_measure_callback(
     void *user_data
 ) {
     layx_item_t *pitem = layx_get_item(ctx, item_id);
+    layx_invalidate(ctx, item_id);
     pitem->measure_text_fn = fn;
     pitem->measure_text_user_data = user_data;
 }
 
+// 宿主数据不参与布局，不标脏也不记录
+void layx_set_user_data(layx_context *ctx, layx_id item, void *user_data)
+{
+    layx_get_item(ctx, item)->user_data = user_data;
+    if (ctx->frames.enabled) {
+        layx_frames_touch(ctx, item, false);
+    }
+}
+
+void layx_set_tag(layx_context *ctx, layx_id item, uint32_t tag)
+{
+    layx_get_item(ctx, item)->tag = tag;
+    if (ctx->frames.enabled) {
+        layx_frames_touch(ctx, item, false);
+    }
+}
+
+// 返回子树中包含点 (x, y) 的最上层 item；坐标已变换到 item 所在的滚动空间
+static layx_id layx_hit_test_subtree(const layx_context *ctx, layx_id item, layx_scalar x, layx_scalar y)
+{
+    const layx_item_t *pitem = ctx->items + item;
+    const bool inside = layx_point_in_rect(x, y, ctx->rects[item]) != 0;
+    const bool clips = pitem->overflow_x != LAYX_OVERFLOW_VISIBLE || pitem->overflow_y != LAYX_OVERFLOW_VISIBLE;
+    if (clips && !inside) return LAYX_INVALID_ID;
+
+    // 内容向上滚动 scroll_offset 后绘制，转换到子元素 rect 所在的坐标
+    const layx_scalar child_x = x + pitem->scroll_offset[0];
+    const layx_scalar child_y = y + pitem->scroll_offset[1];
+    layx_id hit = LAYX_INVALID_ID;
+    for (layx_id child = pitem->first_child; child != LAYX_INVALID_ID; child = ctx->items[child].next_sibling) {
+        const layx_id found = layx_hit_test_subtree(ctx, child, child_x, child_y);
+        if (found != LAYX_INVALID_ID) hit = found;
+    }
+    if (hit != LAYX_INVALID_ID) return hit;
+    return inside ? item : LAYX_INVALID_ID;
+}
+
+layx_hit layx_hit_test_item(const layx_context *ctx, layx_id root, layx_scalar screen_x, layx_scalar screen_y)
+{
+    LAYX_ASSERT(ctx != NULL);
+    LAYX_ASSERT(root != LAYX_INVALID_ID && root < ctx->count);
+    layx_scalar x = screen_x;
+    layx_scalar y = screen_y;
+    if (ctx->screen_to_local_fn) {
+        layx_vec2 local_pos = ctx->screen_to_local_fn((layx_vec2){screen_x, screen_y});
+        x = local_pos[0];
+        y = local_pos[1];
+    }
+    layx_hit hit = { LAYX_INVALID_ID, 0, NULL };
+    hit.item = layx_hit_test_subtree(ctx, root, x, y);
+    if (hit.item != LAYX_INVALID_ID) {
+        hit.tag = ctx->items[hit.item].tag;
+        hit.user_data = ctx->items[hit.item].user_data;
+    }
+    return hit;
+}
+
+// 尺寸观察不影响布局，不标脏也不记录
+void layx_observe(layx_context *ctx, layx_id item, uint32_t mask)
+{
+    layx_item_t *pitem = layx_get_item(ctx, item);
+    mask &= LAYX_OBSERVE_SIZE | LAYX_OBSERVE_POSITION;
+    if (mask == 0) {
+        if (pitem->observer != 0) layx_observer_release(ctx, pitem);
+        return;
+    }
+    if (pitem->observer == 0) {
+        pitem->observer = layx_observer_alloc(ctx);
+        layx_observer *record = ctx->observers.records + pitem->observer;
+        record->item = item;
+        record->reported = ctx->rects[item];
+        layx_memo_observed_add(ctx, item, 1);
+    }
+    ctx->observers.records[pitem->observer].mask = (uint8_t)mask;
+}
+
+uint32_t layx_observed_mask(const layx_context *ctx, layx_id item)
+{
+    const layx_item_t *pitem = layx_get_item(ctx, item);
+    return pitem->observer != 0 ? ctx->observers.records[pitem->observer].mask : 0;
+}
+
+uint32_t layx_take_resize_events(layx_context *ctx, layx_resize_event *events, uint32_t capacity)
+{
+    LAYX_ASSERT(ctx != NULL && (events != NULL || capacity == 0));
+    layx_observer_table *table = &ctx->observers;
+    uint32_t written = 0;
+    uint32_t i = 0;
+    for (; i < table->queue_count && written < capacity; ++i) {
+        layx_observer *record = table->records + table->queue[i];
+        if (record->item == LAYX_INVALID_ID || !record->queued) continue;
+        record->queued = 0;
+        const layx_vec4 rect = ctx->rects[record->item];
+        const uint32_t changed = layx_observe_changes(record, rect);
+        if (changed == 0) continue;
+        const layx_item_t *pitem = ctx->items + record->item;
+        layx_resize_event *event = events + written++;
+        event->item = record->item;
+        event->changed = changed;
+        event->tag = pitem->tag;
+        event->user_data = pitem->user_data;
+        event->old_rect = record->reported;
+        event->rect = rect;
+        record->reported = rect;
+    }
+    // 未取走的部分移到队首
+    table->queue_count -= i;
+    if (table->queue_count > 0) {
+        memmove(table->queue, table->queue + i, table->queue_count * sizeof(uint32_t));
+    }
+    return written;
+}
+
 // Web标准 API 实现
 
 // clientWidth/clientHeight: 绘制区域（内容+内边距，无滚动条）
@@ -2233,7 +5059,8 @@ layx_scalar layx_get_client_width(layx_context *ctx, layx_id item) {
     layx_item_t *pitem = layx_get_item(ctx, item);
 
     // 计算绘制区域宽度：rect宽度 - 边框宽度
-    layx_scalar client_width = rect[2] - pitem->border_trbl[START_SIDE(DIM_WIDTH)] - pitem->border_trbl[END_SIDE(DIM_WIDTH)];
+    const layx_vec4 border = layx_item_box(ctx, pitem, LAYX_BOX_BORDER);
+    layx_scalar client_width = rect[2] - border[START_SIDE(DIM_WIDTH)] - border[END_SIDE(DIM_WIDTH)];
 
     // 如果有垂直滚动条，减去滚动条宽度
     if (pitem->has_scrollbars & LAYX_HAS_VSCROLL) {
@@ -2249,7 +5076,8 @@ layx_scalar layx_get_client_height(layx_context *ctx, layx_id item) {
     layx_item_t *pitem = layx_get_item(ctx, item);
 
     // 计算绘制区域高度：rect高度 - 边框高度
-    layx_scalar client_height = rect[3] - pitem->border_trbl[START_SIDE(DIM_HEIGHT)] - pitem->border_trbl[END_SIDE(DIM_HEIGHT)];
+    const layx_vec4 border = layx_item_box(ctx, pitem, LAYX_BOX_BORDER);
+    layx_scalar client_height = rect[3] - border[START_SIDE(DIM_HEIGHT)] - border[END_SIDE(DIM_HEIGHT)];
     
     // 如果有水平滚动条，减去滚动条高度
     if (pitem->has_scrollbars & LAYX_HAS_HSCROLL) {
@@ -1,6 +1,13 @@
 #ifndef LAYX_INCLUDE_HEADER
 #define LAYX_INCLUDE_HEADER
+
+// 标量类型：LAYX_FLOAT=1（默认）使用 float；LAYX_FLOAT=0 使用 16 位整数像素，
+// rect 从 16 字节减为 8 字节，适合没有 FPU 或 FPU 很慢的嵌入式平台。
+// 整数模式下长度按像素截断（坐标范围 ±32767），伸缩系数（flex-grow/shrink）与按比例分配空间的中间结果仍是 float。
+// 库与使用者必须使用相同的定义（CMake 中链接 layx_int16 即可）
+#ifndef LAYX_FLOAT
 #define LAYX_FLOAT 1
+#endif
 
 // Users of this library can define LAYX_IMPLEMENTATION in exactly one C or C++ file
 // before you include layx.h.
@@ -11,6 +18,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifndef LAYX_EXPORT
 #define LAYX_EXPORT extern
@@ -36,6 +44,12 @@
 #define LAYX_DEBUG_PRINT(fmt, ...) ((void)0)
 #endif
 
+// API 调用记录：LAYX_RECORD=1 编译的库在修改上下文的公开 API 中插入记录点（见 layx_record_begin），
+// 默认 0，记录点编译为空。只影响库本身的编译，使用者不需要相同的定义（CMake 中链接 layx_record 即可）
+#ifndef LAYX_RECORD
+#define LAYX_RECORD 0
+#endif
+
 // 'static inline' for things we always want inlined
 #if defined(__GNUC__) || defined(__clang__)
 #define LAYX_STATIC_INLINE __attribute__((always_inline)) static inline
@@ -45,14 +59,38 @@
 #define LAYX_STATIC_INLINE inline static
 #endif
 
+// id 位宽：LAYX_ID_BITS=32（默认）或 16。16 位时 first_child / next_sibling / parent
+// 共占 6 字节，适合不超过 65534 个 item 的小型上下文（组件、卡片、弹窗）。
+// 与 LAYX_FLOAT 一样，库与使用者必须使用相同的定义（CMake 中链接 layx_id16 即可）
+#ifndef LAYX_ID_BITS
+#define LAYX_ID_BITS 32
+#endif
+
+#if LAYX_ID_BITS == 16
+typedef uint16_t layx_id;
+#elif LAYX_ID_BITS == 32
 typedef uint32_t layx_id;
+#else
+#error "LAYX_ID_BITS must be 16 or 32"
+#endif
 #if LAYX_FLOAT == 1
 typedef float layx_scalar;
 #else
 typedef int16_t layx_scalar;
 #endif
 
+#if LAYX_ID_BITS == 16
+#define LAYX_INVALID_ID UINT16_MAX
+#else
 #define LAYX_INVALID_ID UINT32_MAX
+#endif
+
+// 单个上下文最多容纳的 item 数量：有效 id 为 0 到 LAYX_INVALID_ID - 1
+#define LAYX_MAX_ITEMS ((uint32_t)LAYX_INVALID_ID)
+
+// 共享样式记录 id（见 layx_intern_style），0 表示未引用共享样式
+typedef uint32_t layx_style_id;
+#define LAYX_NO_STYLE 0
 
 // Text measurement callback type
 // 注意：user_data 由调用端设置，通常包含字体和文本信息
@@ -78,7 +116,7 @@ typedef void (*layx_measure_text_fn)(
 #define GET_LEFT(v)       ((v)[TRBL_LEFT])
 // Vector types
 #if defined(__GNUC__) || defined(__clang__)
-#ifdef LAYX_FLOAT
+#if LAYX_FLOAT == 1
 typedef float layx_vec4 __attribute__ ((__vector_size__ (16), aligned(4)));
 typedef float layx_vec2 __attribute__ ((__vector_size__ (8), aligned(4)));
 #else
@@ -104,21 +142,55 @@ struct layx_vec2 {
 
 // Item structure
 typedef struct layx_item_t {
+    // 字段按对齐从大到小分组：4 字节字段、layx_id、16 位字段、8 位字段，最后是随标量类型变化的
+    // layx_scalar 与指针。这样 16 位 id 与 int16 标量模式下组之间没有填充，item 按位宽等比例变小
     uint32_t flags;
     uint32_t auto_flags;
+    // 盒模型：margin / padding / border 大多为 0，不为 0 时才在 ctx->boxes 中分配记录。
+    // box_mask 按 LAYX_BOX_* 记录哪几组不为 0，对应位为 0 时不访问记录；读取统一用 layx_item_box
+    uint32_t box;
+    float flex_grow;             // 伸缩系数是比例而不是长度，整数标量模式下同样用 float
+    float flex_shrink;
+    float baseline;              // 基线偏移（从项目顶部算起）
+
+    // 共享样式：style_id 指向上下文中的样式记录，style_overrides 记录本地覆盖的属性组
+    layx_style_id style_id;
+
+    // wrap 容器的 flex 行在 ctx->lines 中的范围；本轮布局尚未记录时 line_count 为 0
+    uint32_t line_first;
+    uint32_t line_count;
+
+    // grid 容器在 ctx->grids 中的记录（0 表示没有）
+    uint32_t grid;
+
+    // 子树布局结果缓存的根在 ctx->memo.roots 中的记录（0 表示不缓存）
+    uint32_t memo;
+    uint32_t tag;                // 宿主自定义标签，布局不读取（见 layx_set_tag）
+    uint32_t observer;           // ctx->observers 中的观察记录（0 表示未被观察，见 layx_observe）
+
     layx_id first_child;
     layx_id next_sibling;
     layx_id parent;
-    layx_vec4 margin_trbl; // t r b l
-    layx_vec4 padding_trbl; // t r b l
-    layx_vec4 border_trbl; // t r b l
+
+    uint16_t style_overrides;    // LAYX_STYLE_* 位掩码，这些属性组不再跟随共享样式
+    // 作为 grid 子元素时的单元格（按维度：0 为列，1 为行），为 0 表示自动放置，否则为下标 + 1
+    uint16_t grid_cell[2];
+
+    uint8_t grid_span[2];        // 0 与 1 都表示占一个轨道
+    uint8_t box_mask;            // 见 box
+
+    // 滚动条标志位：几个小字段共用一个字节，给 tag / observer 让出空间
+    uint8_t overflow_x : 2;      // overflow-x 属性（layx_overflow）
+    uint8_t overflow_y : 2;      // overflow-y 属性
+    uint8_t has_scrollbars : 2;  // 标志位：是否有滚动条 (bit0=v, bit1=h)
+    uint8_t has_baseline : 1;    // 是否有有效的基线信息
+
     layx_vec2 size;
     layx_vec2 min_size;
     layx_vec2 max_size;
     layx_vec4 position; // l t r b
-    layx_scalar flex_grow;
-    layx_scalar flex_shrink;
     layx_scalar flex_basis;
+    layx_vec2 gap;               // 容器内相邻子元素（及 flex 行、grid 轨道）之间的间距：[0]=column-gap, [1]=row-gap
     
     // 滚动状态
     layx_vec2 scroll_offset;     // [0]=scrollLeft, [1]=scrollTop
@@ -127,19 +199,291 @@ typedef struct layx_item_t {
     // 内容实际尺寸（用于计算滚动范围）
     layx_vec2 content_size;      // [0]=contentWidth, [1]=contentHeight
     
-    // 滚动条标志位
-    uint8_t overflow_x;          // overflow-x 属性
-    uint8_t overflow_y;          // overflow-y 属性
-    uint8_t has_scrollbars;      // 标志位：是否有滚动条 (bit0=v, bit1=h)
-
-    float baseline;          // 基线偏移（从项目顶部算起）
-    uint8_t has_baseline;    // 是否有有效的基线信息
-    
     // ============ 新增：文本测量相关字段 ============
     layx_measure_text_fn measure_text_fn;  // NULL 表示不是文本节点
     void *measure_text_user_data;          // 用户数据（通常指向 ui_component）
+    void *user_data;             // 宿主对象（通常是 widget），由命中测试与发布的帧直接返回
 } layx_item_t;
 typedef layx_vec2 (*layx_screen_to_local_fn)(layx_vec2 screen_pos);
+
+// 变更流记录状态（实现在 layx_delta.c）
+// 记录自上次 layx_delta_write 以来创建/销毁的 id，以及上次写出时的 rects 镜像
+typedef struct layx_delta_tracker {
+    bool enabled;
+    bool keyframe;              // 下一次写出完整关键帧（并置 RESET 标志）
+    bool tags;                  // 变更记录附带 tag（LAYX_DELTA_FLAG_TAGS）
+    uint32_t frame;             // 已写出的帧序号
+    layx_vec4 *prev_rects;      // 上次写出时的 rects
+    uint32_t *prev_tags;        // 上次写出时的 tag，仅 tags 开启时分配
+    layx_id prev_capacity;
+    layx_id *created;
+    uint32_t created_count;     // 事件计数，16 位 id 模式下也可能超过 id 范围
+    uint32_t created_capacity;
+    layx_id *destroyed;
+    uint32_t destroyed_count;
+    uint32_t destroyed_capacity;
+} layx_delta_tracker;
+
+typedef struct layx_style_table {
+    struct layx_style_record *records; // records[0] 保留给 LAYX_NO_STYLE
+    uint32_t count;
+    uint32_t capacity;
+    layx_style_id *slots;       // 开放寻址哈希表，0 表示空槽
+    uint32_t slot_capacity;
+    uint32_t slot_used;
+} layx_style_table;
+
+// 已发布的一帧布局结果（实现在 layx_frames.c），按 item id 索引
+typedef struct layx_frame {
+    uint32_t frame;             // 发布序号，从 1 开始；0 表示尚未发布
+    layx_id count;
+    uint32_t capacity;
+    layx_vec4 *rects;
+    layx_vec2 *scroll_offset;
+    layx_vec2 *scroll_max;
+    layx_vec2 *content_size;
+    uint8_t *has_scrollbars;
+    uint32_t *tags;
+    void **user_data;
+} layx_frame;
+
+// 发布之间输出可能变化的 item：布局过的子树根、新建/销毁/移出树的 item、修改了 tag 等宿主数据的 item
+typedef struct layx_frame_change {
+    uint32_t frame;             // 包含该修改的发布序号（记录时为 published + 1）
+    layx_id item;
+    bool subtree;               // 是否包含整棵子树
+} layx_frame_change;
+
+// 三缓冲交换：布局线程持有 back，渲染线程持有 front，中间槽位通过 shared 原子交换
+typedef struct layx_frame_exchange {
+    bool enabled;
+    layx_frame slots[3];
+    uint32_t back;
+    uint32_t front;
+    uint32_t shared;            // 低 2 位为槽位下标，LAYX_FRAME_FRESH 表示尚未被读取
+    uint32_t published;         // 布局线程写入，其他线程用 layx_published_frames 读取
+    // 修改记录按发布序号递增，覆盖 change_base 及之后的发布；
+    // back 槽位的帧不早于 change_base - 1 时只补上之后的修改，否则整帧复制
+    layx_frame_change *changes;
+    uint32_t change_count;
+    uint32_t change_capacity;
+    uint32_t change_base;
+    layx_id copied;             // 上一次发布复制的 item 数量
+} layx_frame_exchange;
+
+// 分步布局的遍历状态（见 layx_run_context_step）
+enum {
+    LAYX_PHASE_IDLE = 0,        // 没有进行中的布局
+    LAYX_PHASE_CALC_X,
+    LAYX_PHASE_ARRANGE_X,
+    LAYX_PHASE_CALC_Y,
+    LAYX_PHASE_ARRANGE_Y,
+    LAYX_PHASE_SCROLL,
+};
+
+typedef struct layx_step_state {
+    uint8_t phase;
+    bool restart;               // 进行中修改了树或属性，下一次调用从头开始
+    layx_id root;
+    layx_id node;               // 当前阶段下一个要处理的 item，LAYX_INVALID_ID 表示阶段起点
+} layx_step_state;
+
+// wrap 容器在主轴排列时记录的 flex 行，交叉轴的尺寸计算和 align-content 直接使用
+typedef struct layx_flex_line {
+    layx_id first_child;
+    layx_id end_child;          // 下一行的第一个子元素，最后一行为 LAYX_INVALID_ID
+    layx_scalar cross_size;     // 交叉轴排列时的行高
+} layx_flex_line;
+
+// 主轴伸缩计算时一行内每个项目的暂存状态（border-box 尺寸）
+typedef struct layx_flex_item {
+    float base;                 // flex base size
+    float target;               // 假设尺寸，计算结束后为最终尺寸
+    float min, max;
+    float factor;               // flex-grow，或 flex-shrink * base
+    float flex;                 // 未加权的 flex-grow 或 flex-shrink，判断因子之和是否小于 1
+    float violation;
+    bool frozen;
+} layx_flex_item;
+
+// lines 每轮布局开始时清空；两者的容量都在多轮之间复用
+typedef struct layx_flex_lines {
+    layx_flex_line *lines;
+    uint32_t count;
+    uint32_t capacity;
+    layx_flex_item *items;      // 当前行的暂存，按行复用
+    uint32_t item_capacity;
+} layx_flex_lines;
+
+// 脏的布局边界（绝对定位的 item）：脏标记传播到这里为止，由 layx_run_dirty 单独重新布局
+typedef struct layx_boundary_list {
+    layx_id *ids;
+    uint32_t count;
+    uint32_t capacity;
+} layx_boundary_list;
+
+// grid 轨道类型
+typedef enum layx_track_kind {
+    LAYX_TRACK_AUTO = 0,        // 由放在该轨道内的单元格内容决定
+    LAYX_TRACK_FIXED = 1,
+    LAYX_TRACK_FR = 2,          // 按比例分配剩余空间
+} layx_track_kind;
+
+typedef struct layx_grid_track {
+    uint8_t kind;
+    float value;                // FIXED 为长度，FR 为比例（int16 模式下同样可以是小数），AUTO 不使用
+} layx_grid_track;
+
+// grid 容器的轨道定义与解析结果，按维度索引：0 为列，1 为行
+typedef struct layx_grid {
+    layx_id owner;              // LAYX_INVALID_ID 表示空闲记录
+    layx_grid_track *tracks[2];
+    uint32_t track_count[2];
+    uint32_t track_capacity[2];
+    // 解析后各轨道相对内容区的起点，共 resolved_count + 1 个，最后一个是轨道总长度
+    float *offsets[2];
+    uint32_t resolved_count[2];
+    uint32_t resolved_capacity[2];
+    // 不含 auto 轨道（包括隐式轨道）时解析结果只取决于可用空间，
+    // 单元格内容变化后直接复用，不需要再扫描子元素
+    bool cached[2];
+    float cached_space[2];
+    // 定义的行数加上自动放置追加的隐式行；轨道定义变化或 grid 重新变脏时重新统计
+    bool rows_cached;
+    uint32_t rows;
+} layx_grid;
+
+typedef struct layx_grid_table {
+    layx_grid *records;         // records[0] 保留，item->grid 为 0 表示没有
+    uint32_t count;
+    uint32_t capacity;
+    float *scratch;             // 尺寸计算阶段的轨道暂存，不影响各记录缓存的结果
+    uint32_t scratch_capacity;
+} layx_grid_table;
+
+// 盒模型记录，按 LAYX_BOX_* 索引，item 中为 0 的组在记录里同样保持为 0
+enum {
+    LAYX_BOX_MARGIN = 0,
+    LAYX_BOX_PADDING = 1,
+    LAYX_BOX_BORDER = 2,
+};
+
+typedef struct layx_box {
+    layx_vec4 trbl[3];          // t r b l
+} layx_box;
+
+// 尺寸观察记录（见 layx_observe），分配方式与盒模型记录相同
+typedef struct layx_observer {
+    layx_id item;               // LAYX_INVALID_ID 表示空闲
+    uint8_t mask;               // LAYX_OBSERVE_*
+    uint8_t queued;             // 已在待取队列中
+    layx_vec4 reported;         // 上次取走事件（或开始观察）时的 rect
+} layx_observer;
+
+typedef struct layx_observer_table {
+    layx_observer *records;     // records[0] 保留，item->observer 为 0 表示未被观察
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t *free;
+    uint32_t free_count;
+    uint32_t free_capacity;
+    uint32_t *queue;            // 布局中 rect 变化、尚未取走的记录下标
+    uint32_t queue_count;
+    uint32_t queue_capacity;
+} layx_observer_table;
+
+typedef struct layx_box_table {
+    layx_box *records;          // records[0] 保留，item->box 为 0 表示没有
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t *free;             // 已释放的记录下标，分配时优先复用
+    uint32_t free_count;
+    uint32_t free_capacity;
+} layx_box_table;
+
+// 子树布局结果缓存
+// 一条记录对应一次子树布局：按子树输入的哈希与子树根的宽度查找，
+// 保存子树根在 calc 阶段的尺寸和所有后代（先序）相对子树根的 rect
+typedef struct layx_memo_entry {
+    uint64_t hash;
+    uint32_t node_count;        // 子树的 item 数（含根），与哈希一起比较
+    uint32_t next;              // 同一哈希桶中的下一条记录，0 表示没有
+    uint8_t referenced;         // 上次时钟指针经过后是否被使用过，满时跳过并清除一次（second chance）
+    layx_vec2 calc_size;        // [0] 与宽度无关，[1] 对应 size[0]
+    layx_vec2 size;             // 子树根排列后的宽高，size[1] < 0 表示还没有纵向结果
+    layx_vec4 *rects;
+    uint32_t rect_capacity;
+} layx_memo_entry;
+
+// 缓存子树根在本轮布局中的状态
+typedef struct layx_memo_root {
+    layx_id owner;              // LAYX_INVALID_ID 表示空闲
+    uint32_t node_count;
+    uint64_t hash;
+    layx_vec2 calc_size;
+    uint8_t state;              // LAYX_MEMO_LAID_OUT_* 位：后代本轮已按该方向布局
+    uint32_t observed;          // 子树中（含自身）被观察的 item 数，为 0 时命中缓存后不遍历子树
+} layx_memo_root;
+
+typedef struct layx_memo_stats {
+    uint64_t hits;              // 直接复制了缓存结果的子树
+    uint64_t misses;            // 需要重新布局的子树
+    uint64_t evictions;
+    uint32_t entries;           // 当前缓存的记录数
+} layx_memo_stats;
+
+typedef struct layx_memo_table {
+    layx_memo_root *roots;      // roots[0] 保留，item->memo 为 0 表示不缓存
+    uint32_t root_count;
+    uint32_t root_capacity;
+    layx_memo_entry *entries;   // entries[0] 保留，作为桶链表的结束
+    uint32_t count;
+    uint32_t capacity;          // 最多缓存的记录数，0 表示关闭
+    uint32_t *buckets;
+    uint32_t bucket_mask;
+    uint32_t hand;              // 时钟指针：满时从这里开始找第一条没有再被使用的记录淘汰
+    layx_memo_stats stats;
+} layx_memo_table;
+
+// 布局统计（见 layx_set_stats_enabled），阶段按 LAYX_PHASE_CALC_X .. LAYX_PHASE_SCROLL 的顺序索引
+#define LAYX_STATS_PHASES 5
+#define LAYX_STATS_DISPLAYS 6     // LAYX_DISPLAY_NONE .. LAYX_DISPLAY_GRID
+
+typedef struct layx_stats {
+    uint64_t runs;                              // 完成的布局轮数，包括只重新布局脏边界的轮次
+    uint64_t phase_time[LAYX_STATS_PHASES];      // 各阶段累计耗时，默认单位为纳秒（见 LAYX_STATS_NOW）
+    uint64_t last_phase_time[LAYX_STATS_PHASES]; // 最近一轮（或进行中的分步布局）各阶段耗时
+    uint64_t items_visited;                     // 遍历中执行 calc_size / arrange 的次数，缓存命中的子树不计
+    uint64_t containers[LAYX_STATS_DISPLAYS];    // 横向尺寸计算时遇到的有子元素的 item，按 layx_display 分类
+    uint64_t memo_hits;                         // 同 layx_memo_stats，但随 layx_reset_stats 清零
+    uint64_t memo_misses;
+    uint64_t flex_lines;                        // wrap 容器记录的 flex 行
+    uint64_t grow_events;                       // 上下文内部数组的扩容次数
+} layx_stats;
+
+// 内存占用（见 layx_get_memory_stats），字节数都按已分配的容量计算
+typedef struct layx_memory_stats {
+    layx_id item_capacity;      // items / rects 已分配的槽位
+    layx_id item_count;         // 已使用过的槽位（最大 id + 1），包括空闲链表中的 item
+    layx_id live_items;
+    layx_id free_items;         // 空闲链表长度
+    size_t item_bytes;          // items 数组
+    size_t rect_bytes;          // rects 数组
+    size_t box_bytes;           // 盒模型记录与空闲表
+    size_t style_bytes;         // 共享样式记录与哈希表
+    size_t grid_bytes;          // grid 记录与各自的轨道缓冲区
+    size_t cache_bytes;         // 子树缓存：根记录、缓存记录及其 rects、哈希桶
+    size_t scratch_bytes;       // flex 行与行内暂存、脏边界列表、grid 轨道暂存
+    size_t delta_bytes;         // 变更流的 rects 镜像与 id 列表
+    size_t frame_bytes;         // 双缓冲的三个槽位
+    size_t observer_bytes;      // 尺寸观察记录与待取队列
+    size_t total_bytes;         // 以上之和
+    size_t unused_bytes;        // items / rects 中未使用的容量与空闲 item 占用的部分
+    // 先序遍历中相邻两个 item 的 id 不相邻的比例：0 表示整棵树在数组中按遍历顺序连续，
+    // 接近 1 表示遍历几乎每一步都跳到数组的其他位置
+    float fragmentation;
+} layx_memory_stats;
+
 // Context structure
 typedef struct layx_context {
     layx_item_t *items;
@@ -154,15 +498,42 @@ typedef struct layx_context {
     layx_id count;
     layx_screen_to_local_fn screen_to_local_fn;
     layx_id free_list_head;  // 空闲链表头，用于回收已销毁的 item
+    layx_delta_tracker delta;
+    layx_style_table styles;
+    layx_frame_exchange frames;
+    layx_step_state step;
+    layx_flex_lines lines;
+    layx_boundary_list boundaries;
+    layx_grid_table grids;
+    layx_memo_table memo;
+    layx_box_table boxes;
+    layx_observer_table observers;
+    bool stats_enabled;
+    layx_stats stats;
+    struct layx_tracer *tracer;     // 见 layx_trace_begin，NULL 表示未在记录
+    struct layx_recorder *recorder; // 见 layx_record_begin，NULL 表示未在记录
+    // items/rects 的存储来源；非 OWNED 时指向快照映射，不能 realloc/free（见 layx_snapshot.c）
+    uint8_t storage_kind;
+    void *storage_base;
+    size_t storage_size;
 } layx_context;
 
+// layx_context.storage_kind
+enum {
+    LAYX_STORAGE_OWNED = 0,     // LAYX_REALLOC 分配
+    LAYX_STORAGE_EXTERNAL,      // 调用者提供的缓冲区
+    LAYX_STORAGE_MAPPED,        // mmap 映射的快照文件
+    LAYX_STORAGE_HEAP,          // 读入堆内存的快照文件（不支持 mmap 的平台）
+};
+
 // Display property
 typedef enum layx_display {
     LAYX_DISPLAY_NONE = 0,
     LAYX_DISPLAY_BLOCK = 1,
     LAYX_DISPLAY_FLEX = 2,
     LAYX_DISPLAY_INLINE = 3,
-    LAYX_DISPLAY_INLINE_BLOCK = 4
+    LAYX_DISPLAY_INLINE_BLOCK = 4,
+    LAYX_DISPLAY_GRID = 5
 } layx_display;
 
 // Flex direction
@@ -181,6 +552,12 @@ typedef enum layx_flex_wrap {
     LAYX_FLEX_WRAP_WRAP_REVERSE = 2 << 4  // 0x0020
 } layx_flex_wrap;
 
+// position 属性
+typedef enum layx_position_type {
+    LAYX_POSITION_STATIC = 0,
+    LAYX_POSITION_ABSOLUTE,     // 相对父元素的 padding-box 定位，不影响兄弟元素
+} layx_position_type;
+
 // Justify content (bits 6-8)
 // alignment along the main-axis
 typedef enum layx_justify_content {
@@ -246,9 +623,25 @@ typedef struct layx_style {
     layx_scalar padding_top, padding_right, padding_bottom, padding_left;
     layx_scalar border_top, border_right, border_bottom, border_left;
     layx_align_self align_self;
-    layx_scalar flex_grow, flex_shrink, flex_basis;
+    float flex_grow, flex_shrink;
+    layx_scalar flex_basis;
 } layx_style;
 
+// 共享样式记录，style 中非零的属性组预先算入 set_mask
+typedef struct layx_style_record {
+    layx_style style;
+    uint32_t hash;
+    uint16_t set_mask;          // LAYX_STYLE_* 位掩码
+    // margin / padding / border 在 ctx->boxes 中的共享记录：没有本地覆盖的引用者直接指向它，
+    // 第一次共享时分配，0 表示还没有
+    uint32_t box;
+    layx_id users;              // 引用该样式的 item 数量
+    // 引用者 id，layx_update_style 只重写这些 item；解除引用时不删除，整理前可能含失效或重复的 id
+    layx_id *user_ids;
+    uint32_t user_count;
+    uint32_t user_capacity;
+} layx_style_record;
+
 // Bit masks for internal use
 // Bit layout:
 // Bits 0-1: FLEX_DIRECTION (0x0003)
@@ -264,6 +657,10 @@ typedef struct layx_style {
 // Bit 21: BREAK (0x200000)
 // Bit 22: HAS_VSCROLL (0x400000)
 // Bit 23: HAS_HSCROLL (0x800000)
+// Bit 24: ITEM_DIRTY (0x1000000)
+// Bit 25: ITEM_ABSOLUTE (0x2000000)
+// Bit 26: DISPLAY_GRID (0x4000000)
+// Bit 27: ITEM_CONTAIN (0x8000000)
 
 #define LAYX_FLEX_DIRECTION_MASK    0x0003
 #define LAYX_DISPLAY_TYPE_MASK     0x000C
@@ -279,14 +676,49 @@ enum {
     LAYX_SIZE_FIXED_WIDTH = 0x80000,
     LAYX_SIZE_FIXED_HEIGHT = 0x100000,
     LAYX_SIZE_FIXED_MASK = LAYX_SIZE_FIXED_WIDTH | LAYX_SIZE_FIXED_HEIGHT,
-    LAYX_BREAK = 0x200000,
+    LAYX_BREAK = 0x200000,        // wrap 容器中强制在该子元素前换行；布局计算不会写入此位
     
     // 滚动条标志位 (在flags中使用)
     LAYX_HAS_VSCROLL = 0x400000,  // 垂直滚动条
     LAYX_HAS_HSCROLL = 0x800000,  // 水平滚动条
     LAYX_HAS_SCROLLBARS = LAYX_HAS_VSCROLL | LAYX_HAS_HSCROLL,
+
+    // 自身或后代的布局输入自上次布局以来发生了变化
+    LAYX_ITEM_DIRTY = 0x1000000,
+
+    // position: absolute，不参与父元素的流式布局，同时是脏标记传播的边界
+    LAYX_ITEM_ABSOLUTE = 0x2000000,
+
+    // display: grid；两位的 display 字段已经放不下，单独占一位，优先于 display 字段
+    LAYX_DISPLAY_GRID_BIT = 0x4000000,
+
+    // contain: layout size，按没有内容计算尺寸，是脏标记传播的边界
+    LAYX_ITEM_CONTAIN = 0x8000000,
+
+    // 由 display / flex-direction / flex-wrap 推导出的布局策略（3 位），属性修改时更新
+    LAYX_ITEM_STRATEGY_MASK = 0x70000000,
+};
+
+// 样式属性组（layx_style_record.set_mask / layx_item_t.style_overrides）
+enum {
+    LAYX_STYLE_DISPLAY         = 0x0001,
+    LAYX_STYLE_FLEX_DIRECTION  = 0x0002,
+    LAYX_STYLE_FLEX_WRAP       = 0x0004,
+    LAYX_STYLE_JUSTIFY_CONTENT = 0x0008,
+    LAYX_STYLE_ALIGN_ITEMS     = 0x0010,
+    LAYX_STYLE_ALIGN_CONTENT   = 0x0020,
+    LAYX_STYLE_SIZE            = 0x0040,  // width 与 height 一起应用
+    LAYX_STYLE_MIN_WIDTH       = 0x0080,
+    LAYX_STYLE_MIN_HEIGHT      = 0x0100,
+    LAYX_STYLE_MAX_WIDTH       = 0x0200,
+    LAYX_STYLE_MAX_HEIGHT      = 0x0400,
+    LAYX_STYLE_MARGIN          = 0x0800,
+    LAYX_STYLE_PADDING         = 0x1000,
+    LAYX_STYLE_BORDER          = 0x2000,
+    LAYX_STYLE_FLEX_ITEM       = 0x4000,  // grow/shrink/basis
+    LAYX_STYLE_ALIGN_SELF      = 0x8000,
 };
-/* Auto 标志位（16位）*/
+/* Auto 标志位（auto_flags）*/
 enum {
     AUTO_WIDTH           = 0x0001,
     AUTO_HEIGHT          = 0x0002,
@@ -303,6 +735,12 @@ enum {
     AUTO_BORDER_RIGHT    = 0x0800,
     AUTO_BORDER_TOP      = 0x1000,
     AUTO_BORDER_BOTTOM   = 0x2000,
+
+    // 定位偏移已设置；未设置的一侧视为 auto
+    POSITION_SET_LEFT    = 0x4000,
+    POSITION_SET_TOP     = 0x8000,
+    POSITION_SET_RIGHT   = 0x10000,
+    POSITION_SET_BOTTOM  = 0x20000,
 };
 
 /* 使用宏简化检查 */
@@ -325,6 +763,35 @@ LAYX_EXPORT void layx_run_context(layx_context *ctx);
 LAYX_EXPORT void layx_run_item(layx_context *ctx, layx_id item);
 LAYX_EXPORT void layx_clear_item_break(layx_context *ctx, layx_id item);
 
+// Time-sliced layout
+// 每次调用最多处理 budget_items 个 item 或运行 budget_ns 纳秒（0 表示不限），
+// 未完成时返回 LAYX_STEP_IN_PROGRESS，遍历位置保存在 ctx->step 中供下一次继续。
+// 进行中修改树结构或属性会让下一次调用重新开始。
+enum {
+    LAYX_STEP_DONE = 0,
+    LAYX_STEP_IN_PROGRESS = 1,
+};
+LAYX_EXPORT int layx_run_context_step(layx_context *ctx, uint32_t budget_items, uint64_t budget_ns);
+LAYX_EXPORT bool layx_layout_complete(const layx_context *ctx);
+
+// Incremental layout
+// 布局边界内部的修改不会标记边界之外的祖先为脏。边界包括：
+// - 绝对定位的 item；
+// - 设置了 contain 的 item（尺寸按没有内容计算，通常需要配合固定尺寸或由父元素拉伸）；
+// - 宽高都固定且 overflow-x/overflow-y 都不是 visible 的 item（自动识别）。
+// 在流中的边界自身的属性变化仍会影响父元素。
+// layx_run_dirty 在根为脏时等同于 layx_run_context；否则只重新布局登记的脏边界的内部，
+// 每个边界的开销只取决于它自身子树的大小
+LAYX_EXPORT void layx_run_dirty(layx_context *ctx);
+LAYX_EXPORT void layx_set_contain(layx_context *ctx, layx_id item, bool contain);
+LAYX_EXPORT bool layx_get_contain(layx_context *ctx, layx_id item);
+LAYX_EXPORT bool layx_is_layout_boundary(const layx_context *ctx, layx_id item);
+
+// Dirty tracking
+// setter 与树结构修改会标记 item 及其祖先为脏，布局计算后清除
+LAYX_EXPORT void layx_mark_dirty(layx_context *ctx, layx_id item);
+LAYX_EXPORT bool layx_is_dirty(const layx_context *ctx, layx_id item);
+
 // Item management
 LAYX_EXPORT layx_id layx_items_count(layx_context *ctx);
 LAYX_EXPORT layx_id layx_items_capacity(layx_context *ctx);
@@ -335,6 +802,60 @@ LAYX_EXPORT void layx_insert_after(layx_context *ctx, layx_id earlier, layx_id l
 LAYX_EXPORT void layx_prepend(layx_context *ctx, layx_id parent, layx_id new_child);
 LAYX_EXPORT void layx_remove(layx_context *ctx, layx_id item);
 LAYX_EXPORT void layx_destroy_item(layx_context *ctx, layx_id item);
+LAYX_EXPORT layx_id layx_clone_subtree(layx_context *ctx, layx_id src_root);
+
+// Subtree memoisation
+// 对重复出现的子树（相同结构的卡片、列表行）复用布局结果。标记为缓存根的 item，
+// 每轮布局先对整个子树的布局输入（结构、盒模型、尺寸约束、flags、grid 轨道）求哈希：
+// 与已缓存的子树相同且子树根的宽高相同时，直接按子树根的位置复制后代的 rect，
+// 不再执行后代的 calc_size 与 arrange。缓存满时按时钟算法淘汰近期没有命中的记录，capacity 为 0 时关闭（默认）。
+// 命中的后代不会更新派生状态（flex 行记录、grid 轨道起点），缓存根内部嵌套的缓存根随外层一起布局。
+LAYX_EXPORT void layx_set_memo_capacity(layx_context *ctx, uint32_t capacity);
+LAYX_EXPORT void layx_clear_memo(layx_context *ctx);
+LAYX_EXPORT void layx_set_memoize(layx_context *ctx, layx_id item, bool memoize);
+LAYX_EXPORT bool layx_get_memoize(layx_context *ctx, layx_id item);
+LAYX_EXPORT void layx_get_memo_stats(const layx_context *ctx, layx_memo_stats *stats);
+LAYX_EXPORT void layx_reset_memo_stats(layx_context *ctx);
+
+// Layout statistics
+// 默认关闭；打开后每个阶段读两次时钟，其余都是计数器自增，可以在发布版本中保持打开。
+// 时钟默认为 timespec_get；编译库时定义 LAYX_STATS_NOW() 可以换成 __rdtsc() 等，phase_time 的单位随之改变。
+// layx_get_stats 复制当前值，导出指标后调用 layx_reset_stats 开始新的统计周期
+LAYX_EXPORT void layx_set_stats_enabled(layx_context *ctx, bool enable);
+LAYX_EXPORT void layx_get_stats(const layx_context *ctx, layx_stats *stats);
+LAYX_EXPORT void layx_reset_stats(layx_context *ctx);
+
+// Memory usage
+// layx_get_memory_stats 遍历整棵树与各内部表，开销与 item 数成正比，适合周期性采样而不是每帧调用。
+// layx_shrink_to_fit 释放关闭大文档后留下的容量：items / rects 截到最大的存活 id，
+// 盒模型记录重新压紧，各表与暂存缓冲区按当前使用量缩小。存活 item 的 id 不变，
+// 分步布局进行中也可以调用；快照映射的 items / rects 与渲染线程可能持有的结果槽位不受影响
+LAYX_EXPORT void layx_get_memory_stats(const layx_context *ctx, layx_memory_stats *stats);
+LAYX_EXPORT void layx_shrink_to_fit(layx_context *ctx);
+
+// Resize observation
+// 被观察的 item 在布局中 rect 变化时进入待取队列，宿主在布局后用 layx_take_resize_events 取走，
+// 不需要自己比较所有 item 的 rects。检查在纵向排列时顺带完成，只涉及本轮实际布局的 item：
+// layx_run_dirty 不访问脏边界之外的子树，命中缓存的子树只在上下文中有被观察的 item 时遍历。
+// 取走之前的多次变化合并为一条事件，old_rect 为上次取走（或开始观察）时的 rect；
+// 变化后又恢复原值的 item 不产生事件。新建 item 的 rect 为 0，开始观察后第一次布局即产生事件。
+#define LAYX_OBSERVE_SIZE       0x1u    // 宽或高变化
+#define LAYX_OBSERVE_POSITION   0x2u    // x 或 y 变化
+
+typedef struct layx_resize_event {
+    layx_id item;
+    uint32_t changed;           // 实际变化的 LAYX_OBSERVE_* 位（只含观察的部分）
+    uint32_t tag;
+    void *user_data;
+    layx_vec4 old_rect;
+    layx_vec4 rect;
+} layx_resize_event;
+
+// mask 为 0 表示停止观察；修改已观察 item 的 mask 不重置 old_rect。销毁 item 时自动停止，克隆出的 item 不被观察
+LAYX_EXPORT void layx_observe(layx_context *ctx, layx_id item, uint32_t mask);
+LAYX_EXPORT uint32_t layx_observed_mask(const layx_context *ctx, layx_id item);
+// 返回写入的事件数；未取走的事件留到下一次调用
+LAYX_EXPORT uint32_t layx_take_resize_events(layx_context *ctx, layx_resize_event *events, uint32_t capacity);
 
 // Display property
 LAYX_EXPORT void layx_set_display(layx_context *ctx, layx_id item, layx_display display);
@@ -342,6 +863,7 @@ LAYX_EXPORT const char* layx_get_display_string(layx_display display);
 
 // Display helper functions (internal use, but needed by scroll_utils.c)
 LAYX_STATIC_INLINE layx_display layx_get_display_from_flags(uint32_t flags) {
+    if (flags & LAYX_DISPLAY_GRID_BIT) return LAYX_DISPLAY_GRID;
     return (layx_display)((flags & LAYX_DISPLAY_TYPE_MASK) >> 2);
 }
 
@@ -398,19 +920,63 @@ LAYX_EXPORT void layx_set_min_size(layx_context *ctx, layx_id item, layx_scalar
 LAYX_EXPORT layx_vec2 layx_get_size(layx_context *ctx, layx_id item);
 
 // Position properties
+// 偏移只对 LAYX_POSITION_ABSOLUTE 的 item 生效：设置 left 和 right（或 top 和 bottom）且未固定尺寸时，
+// 尺寸由包含块减去两侧偏移得到；都未设置时保持在父元素内容区的起点
+LAYX_EXPORT void layx_set_position_type(layx_context *ctx, layx_id item, layx_position_type type);
+LAYX_EXPORT layx_position_type layx_get_position_type(layx_context *ctx, layx_id item);
+LAYX_EXPORT void layx_set_position(layx_context *ctx, layx_id item, layx_scalar left, layx_scalar top, layx_scalar right, layx_scalar bottom);
 LAYX_EXPORT void layx_set_position_lt(layx_context *ctx, layx_id item, layx_scalar left, layx_scalar top);
 LAYX_EXPORT void layx_set_position_rb(layx_context *ctx, layx_id item, layx_scalar right, layx_scalar bottom);
 LAYX_EXPORT void layx_set_left(layx_context *ctx, layx_id item, layx_scalar left);
 LAYX_EXPORT void layx_set_right(layx_context *ctx, layx_id item, layx_scalar right);
 LAYX_EXPORT void layx_set_top(layx_context *ctx, layx_id item, layx_scalar top);
 LAYX_EXPORT void layx_set_bottom(layx_context *ctx, layx_id item, layx_scalar bottom);
+LAYX_EXPORT void layx_clear_position(layx_context *ctx, layx_id item);
+
+// Grid properties
+// 轨道定义只对 LAYX_DISPLAY_GRID 的 item 生效。未定义列时只有一列；
+// 放不下的子元素按行优先自动放置，超出定义的行数时追加隐式的 auto 行。
+// 自动放置不会避开显式放置的单元格，跨多个轨道的子元素不参与 auto 轨道的尺寸计算。
+// 子元素默认拉伸到单元格大小，固定尺寸的一维保持原尺寸并靠起点对齐。
+LAYX_EXPORT void layx_set_grid_columns(layx_context *ctx, layx_id item, const layx_grid_track *tracks, uint32_t count);
+LAYX_EXPORT void layx_set_grid_rows(layx_context *ctx, layx_id item, const layx_grid_track *tracks, uint32_t count);
+LAYX_EXPORT void layx_set_grid_cell(layx_context *ctx, layx_id item, uint32_t column, uint32_t row);
+LAYX_EXPORT void layx_set_grid_span(layx_context *ctx, layx_id item, uint32_t columns, uint32_t rows);
+LAYX_EXPORT void layx_clear_grid_cell(layx_context *ctx, layx_id item);
+// 最近一次布局解析出的轨道起点（相对内容区），返回轨道数，offsets 可为 NULL
+LAYX_EXPORT uint32_t layx_get_grid_track_offsets(layx_context *ctx, layx_id item, int dim, const float **offsets);
+
+LAYX_STATIC_INLINE layx_grid_track layx_track_fixed(layx_scalar length)
+{
+    layx_grid_track track = { LAYX_TRACK_FIXED, (float)length };
+    return track;
+}
+
+LAYX_STATIC_INLINE layx_grid_track layx_track_fr(float fraction)
+{
+    layx_grid_track track = { LAYX_TRACK_FR, fraction };
+    return track;
+}
+
+LAYX_STATIC_INLINE layx_grid_track layx_track_auto(void)
+{
+    layx_grid_track track = { LAYX_TRACK_AUTO, 0 };
+    return track;
+}
 
 // Flex item properties
-LAYX_EXPORT void layx_set_flex_grow(layx_context *ctx, layx_id item, layx_scalar grow);
-LAYX_EXPORT void layx_set_flex_shrink(layx_context *ctx, layx_id item, layx_scalar shrink);
+LAYX_EXPORT void layx_set_flex_grow(layx_context *ctx, layx_id item, float grow);
+LAYX_EXPORT void layx_set_flex_shrink(layx_context *ctx, layx_id item, float shrink);
 LAYX_EXPORT void layx_set_flex_basis(layx_context *ctx, layx_id item, layx_scalar basis);
 LAYX_EXPORT void layx_set_flex_properties(layx_context *ctx, layx_id item,
-                                         layx_scalar grow, layx_scalar shrink, layx_scalar basis);
+                                         float grow, float shrink, layx_scalar basis);
+
+// Gap
+// 容器属性：主轴上相邻子元素之间、wrap 容器的相邻行之间、grid 相邻轨道之间的固定间距，
+// 不与 margin 合并。block 容器在垂直方向使用 row-gap
+LAYX_EXPORT void layx_set_gap(layx_context *ctx, layx_id item, layx_scalar row_gap, layx_scalar column_gap);
+LAYX_EXPORT void layx_set_row_gap(layx_context *ctx, layx_id item, layx_scalar row_gap);
+LAYX_EXPORT void layx_set_column_gap(layx_context *ctx, layx_id item, layx_scalar column_gap);
 
 // Align self
 LAYX_EXPORT void layx_set_align_self(layx_context *ctx, layx_id item, layx_align_self align);
@@ -454,6 +1020,24 @@ LAYX_EXPORT void layx_style_reset(layx_style *style);
 LAYX_EXPORT void layx_apply_style(layx_context *ctx, layx_id item, const layx_style *style);
 LAYX_EXPORT layx_id layx_create_item_with_style(layx_context *ctx, const layx_style *style);
 
+// Shared styles
+//
+// layx_intern_style 对样式去重后返回共享记录 id，相同内容总是得到同一个 id。
+// item 仍保存解析后的属性供布局读取，共享记录是这些属性的来源：
+// - layx_set_style 让 item 引用记录，并写入记录中非零的属性组；
+// - 对引用了记录的 item 调用 setter 会把该属性组标记为本地覆盖（写时复制），
+//   之后不再跟随共享记录；
+// - layx_update_style 原地修改记录，只重写其 user 未覆盖的属性组并标记它们为脏，
+//   开销取决于引用者数量，其他 item 不受影响。
+// 共享记录只省去重复的 setter 调用，不减少 item 的内存：每个 item 另外保存 style_id 与 style_overrides。
+// 样式按字段比较，layx_style 中的填充字节不影响去重。
+LAYX_EXPORT layx_style_id layx_intern_style(layx_context *ctx, const layx_style *style);
+LAYX_EXPORT void layx_set_style(layx_context *ctx, layx_id item, layx_style_id style);
+LAYX_EXPORT layx_style_id layx_get_style(layx_context *ctx, layx_id item);
+LAYX_EXPORT const layx_style *layx_get_style_record(layx_context *ctx, layx_style_id style);
+LAYX_EXPORT void layx_update_style(layx_context *ctx, layx_style_id style, const layx_style *values);
+LAYX_EXPORT layx_id layx_style_users(layx_context *ctx, layx_style_id style);
+
 // Inline helpers
 LAYX_STATIC_INLINE layx_vec4 layx_vec4_xyzw(layx_scalar x, layx_scalar y, layx_scalar z, layx_scalar w)
 {
@@ -475,6 +1059,15 @@ LAYX_STATIC_INLINE layx_item_t *layx_get_item(const layx_context *ctx, layx_id i
     return ctx->items + id;
 }
 
+// 盒模型向量（kind 为 LAYX_BOX_*）：box_mask 对应位为 0 时直接返回 0，不访问记录
+LAYX_STATIC_INLINE layx_vec4 layx_item_box(const layx_context *ctx, const layx_item_t *pitem, int kind)
+{
+    if (pitem->box_mask & (1u << kind)) {
+        return ctx->boxes.records[pitem->box].trbl[kind];
+    }
+    return layx_vec4_xyzw(0, 0, 0, 0);
+}
+
 LAYX_STATIC_INLINE layx_id layx_first_child(const layx_context *ctx, layx_id id)
 {
     const layx_item_t *pitem = layx_get_item(ctx, id);
@@ -575,14 +1168,42 @@ LAYX_STATIC_INLINE int layx_hit_test(const layx_context *ctx, layx_id root_id, l
     return layx_point_in_rect(test_x, test_y, rect);
 }
 
+// 宿主数据：每个 item 带一个 user_data 指针和一个 32 位 tag，布局不读取，设置时不标脏。
+// 命中测试、发布的帧与变更流（LAYX_DELTA_FLAG_TAGS）直接带出它们，宿主不需要再维护 id 到 widget 的映射。
+// 新建与复用的 item 为 NULL / 0；克隆时与测量回调一样原样复制；快照保留 tag，user_data 清零。
+LAYX_EXPORT void layx_set_user_data(layx_context *ctx, layx_id item, void *user_data);
+LAYX_EXPORT void layx_set_tag(layx_context *ctx, layx_id item, uint32_t tag);
+
+LAYX_STATIC_INLINE void *layx_get_user_data(const layx_context *ctx, layx_id id)
+{
+    return layx_get_item(ctx, id)->user_data;
+}
+
+LAYX_STATIC_INLINE uint32_t layx_get_tag(const layx_context *ctx, layx_id id)
+{
+    return layx_get_item(ctx, id)->tag;
+}
+
+typedef struct layx_hit {
+    layx_id item;               // LAYX_INVALID_ID 表示没有命中
+    uint32_t tag;
+    void *user_data;
+} layx_hit;
+
+// 返回 root 子树中位于屏幕坐标 (screen_x, screen_y) 最上层的 item：
+// 后绘制的兄弟（链表中靠后）优先，子元素优先于父元素。
+// overflow 不为 visible 的 item 裁剪子元素，点不在其 rect 内时不再向下查找；
+// 其子元素按 rect 减去 scroll_offset 的位置参与测试。先应用 screen_to_local_fn。
+LAYX_EXPORT layx_hit layx_hit_test_item(const layx_context *ctx, layx_id root, layx_scalar screen_x, layx_scalar screen_y);
+
 LAYX_STATIC_INLINE void layx_get_rect_inner_xywh(
         const layx_context *ctx, layx_id id,
         layx_scalar *x, layx_scalar *y, layx_scalar *width, layx_scalar *height)
 {
     LAYX_ASSERT(id != LAYX_INVALID_ID && id < ctx->count);
     layx_vec4 rect = ctx->rects[id];
-    layx_vec4 padding = ctx->items[id].padding_trbl;
-    layx_vec4 borders = ctx->items[id].border_trbl;
+    layx_vec4 padding = layx_item_box(ctx, ctx->items + id, LAYX_BOX_PADDING);
+    layx_vec4 borders = layx_item_box(ctx, ctx->items + id, LAYX_BOX_BORDER);
 
     *x = rect[0] + padding[TRBL_LEFT] + borders[TRBL_LEFT];
     *y = rect[1] + padding[TRBL_TOP] + borders[TRBL_TOP];
@@ -610,6 +1231,350 @@ void layx_get_scroll_offset_xy(layx_context *ctx, layx_id item, layx_scalar *x,
 LAYX_EXPORT void layx_get_scroll_max(layx_context *ctx, layx_id item, layx_vec2 *max);
 LAYX_EXPORT void layx_get_content_size(layx_context *ctx, layx_id item, layx_vec2 *size);
 
+// Delta stream (implemented in layx_delta.c)
+//
+// 每次布局后输出紧凑的变更缓冲区，供进程外渲染器维护一份镜像 rects。
+// 格式版本 1，所有字段均为小端序，可直接写入共享内存环形缓冲区：
+//
+//   offset  size  field
+//   0       4     magic      'L' 'X' 'D' '1'
+//   4       2     version    LAYX_DELTA_VERSION
+//   6       2     flags      LAYX_DELTA_FLAG_*
+//   8       4     frame      帧序号，每次成功写出加一
+//   12      4     id_limit   镜像数组至少需要容纳的 rect 数量
+//   16      4     created    C: 新建 id 数量
+//   20      4     destroyed  D: 销毁 id 数量
+//   24      4     changed    N: 变更记录数量
+//   28      4     reserved   0
+//   32      4*C   新建 id (u32)
+//           4*D   销毁 id (u32)
+//           20*N  变更记录 { u32 id; f32 x, y, width, height }
+//           24*N  （flags 含 TAGS 时）{ u32 id; u32 tag; f32 x, y, width, height }
+//
+// 消费端按顺序处理：RESET 时清空镜像，销毁的 id 置零，新建的 id 置零，
+// 最后写入变更记录。rect 始终以 IEEE float 传输，与 layx_scalar 类型无关。
+// layx_delta_include_tags 开启后只改变了 tag 的 item 也会写出变更记录，开关时下一帧为关键帧。
+#define LAYX_DELTA_MAGIC        0x3144584Cu  // "LXD1"
+#define LAYX_DELTA_VERSION      1
+#define LAYX_DELTA_HEADER_SIZE  32
+#define LAYX_DELTA_RECORD_SIZE  20
+#define LAYX_DELTA_FLAG_RESET   0x0001  // 关键帧：消费端应先清空整个镜像
+#define LAYX_DELTA_FLAG_TAGS    0x0002  // 变更记录带 tag，记录长度为 LAYX_DELTA_TAGGED_RECORD_SIZE
+#define LAYX_DELTA_TAGGED_RECORD_SIZE 24
+
+typedef struct layx_delta_info {
+    uint16_t version;
+    uint16_t flags;
+    uint32_t frame;
+    uint32_t id_limit;
+    uint32_t created_count;
+    uint32_t destroyed_count;
+    uint32_t changed_count;
+} layx_delta_info;
+
+LAYX_EXPORT void layx_delta_enable(layx_context *ctx, bool enable);
+LAYX_EXPORT void layx_delta_request_keyframe(layx_context *ctx);
+LAYX_EXPORT void layx_delta_include_tags(layx_context *ctx, bool enable);
+LAYX_EXPORT size_t layx_delta_bound(const layx_context *ctx);
+LAYX_EXPORT size_t layx_delta_write(layx_context *ctx, void *buffer, size_t capacity);
+LAYX_EXPORT int layx_delta_read_header(const void *buffer, size_t size, layx_delta_info *info);
+LAYX_EXPORT int layx_delta_apply(const void *buffer, size_t size, float *mirror_xywh, uint32_t mirror_count);
+// 同 layx_delta_apply，另外维护 tag 镜像（不带 TAGS 的缓冲区只按新建/销毁清零）
+LAYX_EXPORT int layx_delta_apply_tags(const void *buffer, size_t size, float *mirror_xywh,
+                                      uint32_t *mirror_tags, uint32_t mirror_count);
+
+// Double-buffered results (implemented in layx_frames.c)
+//
+// 启用后布局仍写入上下文自身的 rects 与滚动字段，它们只属于布局线程。
+// layx_publish 把本帧结果写入布局线程持有的槽位并原子地交换出去；
+// 渲染线程用 layx_acquire_frame 取得最新发布的完整帧，读取期间不受后续布局与发布影响。
+// 支持一个布局线程与一个渲染线程，双方都不加锁。
+// 发布只复制槽位中那一帧之后重新布局过的子树和修改过的 item（只重新布局脏边界时只复制边界内部），
+// 修改记录过长、重置上下文或加载快照后整帧复制。
+#define LAYX_FRAME_FRESH 0x4u
+
+LAYX_EXPORT void layx_set_double_buffered(layx_context *ctx, bool enable);
+LAYX_EXPORT void layx_publish(layx_context *ctx);
+// 返回的帧在同一线程下一次调用 layx_acquire_frame 前保持有效
+LAYX_EXPORT const layx_frame *layx_acquire_frame(layx_context *ctx);
+LAYX_EXPORT uint32_t layx_published_frames(const layx_context *ctx);
+
+// Command buffer (implemented in layx_commands.c)
+//
+// 生产者线程把树修改记录到各自的命令缓冲区，不需要访问上下文，也不需要加锁；
+// 布局线程用 layx_apply_commands 一次回放。缓冲区内 layx_cmd_create 返回本地 handle
+// （最高位为 1），仅在同一缓冲区的后续命令中有效；已存在的 item 直接使用真实 id。
+// 回放时同一 item 的同一属性只写入最后一次的值，setter 照常标记脏。
+// 设置 LAYX_PROP_STYLE 与销毁 item 前会先写入之前积累的属性，保持与直接调用相同的结果。
+// 真实 id 的最高位必须为 0：接收命令缓冲区的上下文最多容纳 LAYX_CMD_MAX_ITEMS 个 item
+// （16 位 id 模式下为 32768），layx_apply_commands 与命令记录函数对此断言。
+#define LAYX_CMD_LOCAL_BIT ((layx_id)1 << (sizeof(layx_id) * 8 - 1))
+#define LAYX_CMD_MAX_ITEMS ((uint32_t)LAYX_CMD_LOCAL_BIT)
+
+typedef enum layx_property {
+    LAYX_PROP_DISPLAY,          // uint：layx_display
+    LAYX_PROP_FLEX_DIRECTION,   // uint：layx_flex_direction
+    LAYX_PROP_FLEX_WRAP,        // uint：layx_flex_wrap
+    LAYX_PROP_JUSTIFY_CONTENT,  // uint：layx_justify_content
+    LAYX_PROP_ALIGN_ITEMS,      // uint：layx_align_items
+    LAYX_PROP_ALIGN_CONTENT,    // uint：layx_align_content
+    LAYX_PROP_ALIGN_SELF,       // uint：layx_align_self
+    LAYX_PROP_OVERFLOW_X,       // uint：layx_overflow
+    LAYX_PROP_OVERFLOW_Y,       // uint：layx_overflow
+    LAYX_PROP_STYLE,            // uint：layx_style_id
+    LAYX_PROP_WIDTH,            // scalar
+    LAYX_PROP_HEIGHT,
+    LAYX_PROP_MIN_WIDTH,
+    LAYX_PROP_MIN_HEIGHT,
+    LAYX_PROP_MAX_WIDTH,
+    LAYX_PROP_MAX_HEIGHT,
+    LAYX_PROP_FLEX_GROW,        // float：layx_cmd_set_factor，经 layx_cmd_set_scalar 写入时转为 float
+    LAYX_PROP_FLEX_SHRINK,      // float
+    LAYX_PROP_FLEX_BASIS,       // scalar
+    LAYX_PROP_ROW_GAP,
+    LAYX_PROP_COLUMN_GAP,
+    LAYX_PROP_MARGIN,           // trbl
+    LAYX_PROP_PADDING,          // trbl
+    LAYX_PROP_BORDER,           // trbl
+    LAYX_PROP_POSITION,         // l t r b
+    LAYX_PROP_COUNT
+} layx_property;
+
+typedef struct layx_command_buffer {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    layx_id local_count;        // 已分配的本地 handle 数量
+} layx_command_buffer;
+
+LAYX_EXPORT void layx_cmd_init(layx_command_buffer *buf);
+LAYX_EXPORT void layx_cmd_free(layx_command_buffer *buf);
+LAYX_EXPORT void layx_cmd_clear(layx_command_buffer *buf);
+LAYX_EXPORT layx_id layx_cmd_create(layx_command_buffer *buf);
+LAYX_EXPORT void layx_cmd_destroy(layx_command_buffer *buf, layx_id item);
+LAYX_EXPORT void layx_cmd_append(layx_command_buffer *buf, layx_id parent, layx_id child);
+LAYX_EXPORT void layx_cmd_prepend(layx_command_buffer *buf, layx_id parent, layx_id child);
+LAYX_EXPORT void layx_cmd_insert_after(layx_command_buffer *buf, layx_id earlier, layx_id later);
+LAYX_EXPORT void layx_cmd_remove(layx_command_buffer *buf, layx_id item);
+LAYX_EXPORT void layx_cmd_set_uint(layx_command_buffer *buf, layx_id item, layx_property prop, uint32_t value);
+LAYX_EXPORT void layx_cmd_set_scalar(layx_command_buffer *buf, layx_id item, layx_property prop, layx_scalar value);
+// 伸缩系数（LAYX_PROP_FLEX_GROW / LAYX_PROP_FLEX_SHRINK）按 float 保存，整数标量模式下小数不会被截断
+LAYX_EXPORT void layx_cmd_set_factor(layx_command_buffer *buf, layx_id item, layx_property prop, float value);
+LAYX_EXPORT void layx_cmd_set_trbl(layx_command_buffer *buf, layx_id item, layx_property prop,
+                                   layx_scalar top, layx_scalar right, layx_scalar bottom, layx_scalar left);
+// 按顺序回放 count 个缓冲区，返回回放的命令数；缓冲区内容保持不变
+LAYX_EXPORT size_t layx_apply_commands(layx_context *ctx, const layx_command_buffer *bufs, size_t count);
+
+// Layout trace (implemented in layx_trace.c)
+//
+// 把布局过程写成 Chrome trace_event JSON（chrome://tracing、ui.perfetto.dev 均可直接打开）。
+// 每个阶段一条 span；每个容器在尺寸计算与排列阶段各一条 span，覆盖它的整棵子树，
+// args 中记录 item id、display、子元素数量和 tag 回调返回的标签。
+// threshold_ns 大于 0 时只写出耗时不少于该值的容器 span（阶段 span 总是写出），
+// 用于在大树上只保留热点；未开始记录时布局循环只多一次指针判断。
+typedef void (*layx_trace_write_fn)(void *user_data, const char *data, size_t size);
+typedef const char *(*layx_trace_tag_fn)(void *user_data, layx_id item);
+
+typedef struct layx_trace_config {
+    layx_trace_write_fn write;  // 输出回调；为 NULL 时写入 path 指定的文件
+    const char *path;
+    void *user_data;            // 传给 write 与 tag
+    layx_trace_tag_fn tag;      // 可选，返回 NULL 表示没有标签
+    uint64_t threshold_ns;      // 容器 span 的最小耗时，0 表示全部写出
+} layx_trace_config;
+
+// 成功返回 0；文件无法打开返回 -1。已在记录时先结束之前的记录
+LAYX_EXPORT int layx_trace_begin(layx_context *ctx, const layx_trace_config *config);
+// 写出 JSON 结尾并关闭文件，返回写出的容器 span 数量
+LAYX_EXPORT uint64_t layx_trace_end(layx_context *ctx);
+LAYX_EXPORT bool layx_trace_active(const layx_context *ctx);
+
+// API call recording (implemented in layx_record.c)
+//
+// 用 LAYX_RECORD=1 编译的库可以把修改上下文的公开 API 调用按顺序写入二进制日志，
+// layx_replay_step 在另一个上下文中逐条重新执行，用于离线复现性能问题（见 layx_replay 工具）。
+// 组合调用（layx_set_size、layx_set_flex、layx_apply_commands 等）记录为它们内部的基本调用；
+// 查询函数、输出相关的调用（delta、双缓冲、追踪、统计）、宿主数据（user_data、tag）、尺寸观察和快照加载不记录。
+// 日志使用本机字节序与结构布局，头部之后的每条调用以 32 位字编码：
+//
+//   word0  op | payload_words << 16
+//   word1  item（创建类调用为返回的 id）
+//   word2… payload（id、uint 或按位保存的 layx_scalar / float；样式与轨道按原始字节保存）
+//
+//   offset  size  field
+//   0       4     magic        'L' 'X' 'R' '1'
+//   4       2     version      LAYX_RECORD_VERSION
+//   6       2     header_size  LAYX_RECORD_HEADER_SIZE
+//   8       1     scalar_type  LAYX_SNAPSHOT_SCALAR_*
+//   9       1     id_bits      sizeof(layx_id) * 8
+//   10      2     byte_order   0x0102（按本机字节序写入）
+//   12      4     style_size   sizeof(layx_style)
+//   16      4     track_size   sizeof(layx_grid_track)
+//   20      12    reserved
+#define LAYX_RECORD_MAGIC           0x3152584Cu  // "LXR1"
+#define LAYX_RECORD_VERSION         1
+#define LAYX_RECORD_HEADER_SIZE     32
+
+// 调用编号只追加，不重排
+typedef enum layx_record_op {
+    LAYX_REC_END = 0,               // layx_replay_step 到达日志末尾
+    LAYX_REC_RESERVE,               // payload: count
+    LAYX_REC_RESET,
+    LAYX_REC_RUN_CONTEXT,
+    LAYX_REC_RUN_ITEM,
+    LAYX_REC_RUN_STEP,              // payload: budget_items, budget_ns 低 32 位, 高 32 位
+    LAYX_REC_RUN_DIRTY,
+    LAYX_REC_CLEAR_BREAK,
+    LAYX_REC_CONTAIN,               // payload: bool
+    LAYX_REC_MARK_DIRTY,
+    LAYX_REC_ITEM,
+    LAYX_REC_APPEND,                // payload: child
+    LAYX_REC_INSERT_AFTER,          // payload: later
+    LAYX_REC_PREPEND,               // payload: child
+    LAYX_REC_REMOVE,
+    LAYX_REC_DESTROY,
+    LAYX_REC_CLONE,                 // payload: 源子树根
+    LAYX_REC_MEMO_CAPACITY,         // payload: capacity
+    LAYX_REC_CLEAR_MEMO,
+    LAYX_REC_MEMOIZE,               // payload: bool
+    LAYX_REC_DISPLAY,               // payload: 枚举值
+    LAYX_REC_FLEX_DIRECTION,
+    LAYX_REC_FLEX_WRAP,
+    LAYX_REC_JUSTIFY_CONTENT,
+    LAYX_REC_ALIGN_ITEMS,
+    LAYX_REC_ALIGN_CONTENT,
+    LAYX_REC_ALIGN_SELF,
+    LAYX_REC_WIDTH,                 // payload: scalar
+    LAYX_REC_HEIGHT,
+    LAYX_REC_MIN_WIDTH,
+    LAYX_REC_MIN_HEIGHT,
+    LAYX_REC_MAX_WIDTH,
+    LAYX_REC_MAX_HEIGHT,
+    LAYX_REC_FLEX_GROW,             // payload: float
+    LAYX_REC_FLEX_SHRINK,
+    LAYX_REC_FLEX_BASIS,            // payload: scalar
+    LAYX_REC_ROW_GAP,               // payload: scalar
+    LAYX_REC_COLUMN_GAP,
+    LAYX_REC_POSITION_TYPE,         // payload: 枚举值
+    LAYX_REC_POSITION,              // payload: left, top, right, bottom
+    LAYX_REC_POSITION_LT,           // payload: left, top
+    LAYX_REC_POSITION_RB,           // payload: right, bottom
+    LAYX_REC_POSITION_SIDE,         // payload: 0..3（left, top, right, bottom）, scalar
+    LAYX_REC_CLEAR_POSITION,
+    LAYX_REC_GRID_COLUMNS,          // payload: count, count 个 layx_grid_track
+    LAYX_REC_GRID_ROWS,
+    LAYX_REC_GRID_CELL,             // payload: column, row
+    LAYX_REC_GRID_SPAN,             // payload: columns, rows
+    LAYX_REC_CLEAR_GRID_CELL,
+    LAYX_REC_BOX,                   // payload: LAYX_BOX_*, scalar（layx_set_margin 等四边同值的调用）
+    LAYX_REC_BOX_TRBL,              // payload: LAYX_BOX_*, top, right, bottom, left
+    LAYX_REC_BOX_SIDE,              // payload: LAYX_BOX_*, TRBL 下标, scalar
+    LAYX_REC_INTERN_STYLE,          // item 为返回的样式 id，payload: 1, layx_style
+    LAYX_REC_SET_STYLE,             // payload: 样式 id
+    LAYX_REC_UPDATE_STYLE,          // item 为样式 id，payload: 1, layx_style
+    LAYX_REC_OVERFLOW_X,            // payload: 枚举值
+    LAYX_REC_OVERFLOW_Y,
+    LAYX_REC_SCROLL_TO,             // payload: x, y
+    LAYX_REC_SHRINK,                // layx_shrink_to_fit，之后新建 item 的 id 取决于它
+    LAYX_REC_COUNT
+} layx_record_op;
+
+// 回放游标：layx_replay_open 检查头部，之后每次 layx_replay_step 执行一条调用
+typedef struct layx_replay_cursor {
+    const uint8_t *data;
+    size_t size;
+    size_t offset;
+    uint64_t calls;             // 已执行的调用数
+    uint64_t id_mismatches;     // 创建类调用返回的 id 与记录不同的次数，非 0 说明回放的上下文与记录时不一致
+} layx_replay_cursor;
+
+// 成功返回 0；库未用 LAYX_RECORD=1 编译返回 -2，文件无法打开返回 -1。已在记录时先结束之前的记录。
+// 应在新建（或 reset 后）的上下文上开始，回放从空上下文执行日志
+LAYX_EXPORT int layx_record_begin(layx_context *ctx, const char *path);
+// 写出缓冲的调用并关闭文件，返回记录的调用数
+LAYX_EXPORT uint64_t layx_record_end(layx_context *ctx);
+// 0 成功；-1 不是调用日志；-2 标量类型、id 位宽、字节序或结构大小与本库不一致
+LAYX_EXPORT int layx_replay_open(layx_replay_cursor *cursor, const void *data, size_t size);
+// 执行下一条调用并返回它的 layx_record_op；日志结束返回 LAYX_REC_END，日志损坏返回 -1
+LAYX_EXPORT int layx_replay_step(layx_context *ctx, layx_replay_cursor *cursor);
+
+// 记录点（库内部使用）。LAYX_RECORD_CALL 的第一个可变参数为 item，其后为 payload 字；
+// 内部嵌套调用其他公开 API 的函数用 LAYX_RECORD_MUTE 包住嵌套调用，每次调用只记录一次
+#if LAYX_RECORD
+LAYX_EXPORT void layx_record_call(layx_context *ctx, uint32_t op, const uint32_t *words, uint32_t count);
+LAYX_EXPORT void layx_record_bytes(layx_context *ctx, uint32_t op, layx_id item, uint32_t head,
+                                   const void *bytes, size_t size);
+LAYX_EXPORT void layx_record_mute(layx_context *ctx, int delta);
+#define LAYX_RECORD_CALL(_ctx, _op, ...) \
+    do { \
+        if ((_ctx)->recorder != NULL) { \
+            const uint32_t _words[] = { __VA_ARGS__ }; \
+            layx_record_call((_ctx), (_op), _words, (uint32_t)(sizeof(_words) / sizeof(uint32_t))); \
+        } \
+    } while (0)
+#define LAYX_RECORD_BYTES(_ctx, _op, _item, _head, _bytes, _size) \
+    do { if ((_ctx)->recorder != NULL) layx_record_bytes((_ctx), (_op), (_item), (_head), (_bytes), (_size)); } while (0)
+#define LAYX_RECORD_MUTE(_ctx, _delta) \
+    do { if ((_ctx)->recorder != NULL) layx_record_mute((_ctx), (_delta)); } while (0)
+#else
+#define LAYX_RECORD_CALL(_ctx, _op, ...) ((void)0)
+#define LAYX_RECORD_BYTES(_ctx, _op, _item, _head, _bytes, _size) ((void)0)
+#define LAYX_RECORD_MUTE(_ctx, _delta) ((void)0)
+#endif
+
+LAYX_STATIC_INLINE uint32_t layx_record_scalar(layx_scalar value)
+{
+    union { uint32_t u; layx_scalar s; } bits = { 0 };   // 16 位标量时高位为 0
+    bits.s = value;
+    return bits.u;
+}
+
+LAYX_STATIC_INLINE uint32_t layx_record_float(float value)
+{
+    union { uint32_t u; float f; } bits;
+    bits.f = value;
+    return bits.u;
+}
+
+// Binary snapshot (implemented in layx_snapshot.c)
+//
+// 快照是 items 与 rects 数组的位置无关镜像：64 字节头部之后依次是
+// count 个 layx_item_t 和 count 个 layx_vec4，与上下文内部的存储布局一致，
+// 因此加载时直接把 ctx->items/ctx->rects 指向映射内存，不做逐项修正。
+// 其后是 box_count 个盒模型记录（写入时按 item 顺序压紧）和 grid_count 条 grid 记录
+// （owner、列数、行数与轨道定义，共 grid_size 字节），加载时复制到上下文自有的表中。
+// 指针字段（measure_text_fn、user_data 等）在保存时清零，加载后需重新设置，tag 原样保存；
+// 共享样式引用与尺寸观察同样清除，item 中解析后的属性保持不变。
+// 快照使用本机字节序与结构布局，头部记录版本、标量类型、id 位宽和
+// sizeof(layx_item_t)，任一不匹配时拒绝加载。
+//
+//   offset  size  field
+//   0       4     magic        'L' 'X' 'S' '1'
+//   4       2     version      LAYX_SNAPSHOT_VERSION
+//   6       2     header_size  LAYX_SNAPSHOT_HEADER_SIZE
+//   8       1     scalar_type  LAYX_SNAPSHOT_SCALAR_*
+//   9       1     id_bits      sizeof(layx_id) * 8
+//   10      2     byte_order   0x0102（按本机字节序写入）
+//   12      4     item_size    sizeof(layx_item_t)
+//   16      4     count
+//   20      4     free_list_head
+//   24      4     box_count    之后跟随的 layx_box 记录数（含保留的 0 号记录）
+//   28      4     grid_count   之后跟随的 grid 记录数
+//   32      4     grid_size    grid 记录的总字节数
+//   36      28    reserved
+#define LAYX_SNAPSHOT_MAGIC         0x3153584Cu  // "LXS1"
+#define LAYX_SNAPSHOT_VERSION       5    // layx_item_t 字段顺序或快照内容变化时递增
+#define LAYX_SNAPSHOT_HEADER_SIZE   64
+#define LAYX_SNAPSHOT_SCALAR_FLOAT32 1
+#define LAYX_SNAPSHOT_SCALAR_INT16   2
+
+LAYX_EXPORT size_t layx_snapshot_size(const layx_context *ctx);
+LAYX_EXPORT size_t layx_write_snapshot(const layx_context *ctx, void *buffer, size_t capacity);
+LAYX_EXPORT int layx_save_snapshot(const layx_context *ctx, const char *path);
+// buffer 需 16 字节对齐且在上下文销毁前保持有效；布局会写入其中的 rects 与 items
+LAYX_EXPORT int layx_load_snapshot_buffer(layx_context *ctx, void *buffer, size_t size);
+LAYX_EXPORT int layx_load_snapshot(layx_context *ctx, const char *path);
+
 // Web标准 API 命名 (遵循浏览器 DOM 属性规范)
 //
 // clientWidth/clientHeight: 绘制区域（内容+内边距，无滚动条）
@@ -0,0 +1,387 @@
+#include "layx.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef LAYX_REALLOC
+#define LAYX_REALLOC(_block, _size) realloc(_block, _size)
+#define LAYX_FREE(_block) free(_block)
+#endif
+
+// 命令以 32 位字编码：
+//   word0  op | prop << 8 | payload_words << 16
+//   word1  item（真实 id 或本地 handle）
+//   word2… payload（id、uint、按位保存的 layx_scalar，伸缩系数为按位保存的 float）
+enum {
+    LAYX_CMD_CREATE = 1,
+    LAYX_CMD_DESTROY,
+    LAYX_CMD_APPEND,
+    LAYX_CMD_PREPEND,
+    LAYX_CMD_INSERT_AFTER,
+    LAYX_CMD_REMOVE,
+    LAYX_CMD_SET,
+};
+
+#define LAYX_CMD_MAX_PAYLOAD 4
+
+// 最高位为 1 的 id 必须是本缓冲区发出的本地 handle；真实 id 达到 LAYX_CMD_LOCAL_BIT 时会被误认为 handle
+static void layx_cmd_check_id(const layx_command_buffer *buf, layx_id id)
+{
+    LAYX_ASSERT(id == LAYX_INVALID_ID || !(id & LAYX_CMD_LOCAL_BIT) ||
+                (layx_id)(id & ~LAYX_CMD_LOCAL_BIT) < buf->local_count);
+    (void)buf;
+    (void)id;
+}
+
+static void layx_cmd_push(layx_command_buffer *buf, uint32_t op, uint32_t prop, layx_id item,
+                          const uint32_t *payload, uint32_t payload_words)
+{
+    layx_cmd_check_id(buf, item);
+    const size_t bytes = (2 + (size_t)payload_words) * sizeof(uint32_t);
+    if (buf->size + bytes > buf->capacity) {
+        size_t capacity = buf->capacity < 1 ? 256 : buf->capacity * 2;
+        while (capacity < buf->size + bytes) capacity *= 2;
+        buf->data = (uint8_t*)LAYX_REALLOC(buf->data, capacity);
+        buf->capacity = capacity;
+    }
+    uint32_t *out = (uint32_t*)(buf->data + buf->size);
+    out[0] = op | (prop << 8) | (payload_words << 16);
+    out[1] = (uint32_t)item;
+    for (uint32_t i = 0; i < payload_words; ++i) out[2 + i] = payload[i];
+    buf->size += bytes;
+}
+
+static uint32_t layx_cmd_scalar_bits(layx_scalar value)
+{
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(value));
+    return bits;
+}
+
+static layx_scalar layx_cmd_bits_scalar(uint32_t bits)
+{
+    layx_scalar value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// 伸缩系数在整数标量模式下同样是 float，不能经过 layx_scalar 截断
+static uint32_t layx_cmd_float_bits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float layx_cmd_bits_float(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static bool layx_cmd_is_factor(layx_property prop)
+{
+    return prop == LAYX_PROP_FLEX_GROW || prop == LAYX_PROP_FLEX_SHRINK;
+}
+
+void layx_cmd_init(layx_command_buffer *buf)
+{
+    LAYX_ASSERT(buf != NULL);
+    memset(buf, 0, sizeof(layx_command_buffer));
+}
+
+void layx_cmd_free(layx_command_buffer *buf)
+{
+    LAYX_ASSERT(buf != NULL);
+    LAYX_FREE(buf->data);
+    memset(buf, 0, sizeof(layx_command_buffer));
+}
+
+void layx_cmd_clear(layx_command_buffer *buf)
+{
+    LAYX_ASSERT(buf != NULL);
+    buf->size = 0;
+    buf->local_count = 0;
+}
+
+layx_id layx_cmd_create(layx_command_buffer *buf)
+{
+    LAYX_ASSERT(buf != NULL);
+    const layx_id handle = LAYX_CMD_LOCAL_BIT | buf->local_count++;
+    layx_cmd_push(buf, LAYX_CMD_CREATE, 0, handle, NULL, 0);
+    return handle;
+}
+
+void layx_cmd_destroy(layx_command_buffer *buf, layx_id item)
+{
+    layx_cmd_push(buf, LAYX_CMD_DESTROY, 0, item, NULL, 0);
+}
+
+void layx_cmd_append(layx_command_buffer *buf, layx_id parent, layx_id child)
+{
+    layx_cmd_check_id(buf, child);
+    const uint32_t payload = (uint32_t)child;
+    layx_cmd_push(buf, LAYX_CMD_APPEND, 0, parent, &payload, 1);
+}
+
+void layx_cmd_prepend(layx_command_buffer *buf, layx_id parent, layx_id child)
+{
+    layx_cmd_check_id(buf, child);
+    const uint32_t payload = (uint32_t)child;
+    layx_cmd_push(buf, LAYX_CMD_PREPEND, 0, parent, &payload, 1);
+}
+
+void layx_cmd_insert_after(layx_command_buffer *buf, layx_id earlier, layx_id later)
+{
+    layx_cmd_check_id(buf, later);
+    const uint32_t payload = (uint32_t)later;
+    layx_cmd_push(buf, LAYX_CMD_INSERT_AFTER, 0, earlier, &payload, 1);
+}
+
+void layx_cmd_remove(layx_command_buffer *buf, layx_id item)
+{
+    layx_cmd_push(buf, LAYX_CMD_REMOVE, 0, item, NULL, 0);
+}
+
+void layx_cmd_set_uint(layx_command_buffer *buf, layx_id item, layx_property prop, uint32_t value)
+{
+    LAYX_ASSERT(prop <= LAYX_PROP_STYLE);
+    layx_cmd_push(buf, LAYX_CMD_SET, (uint32_t)prop, item, &value, 1);
+}
+
+void layx_cmd_set_scalar(layx_command_buffer *buf, layx_id item, layx_property prop, layx_scalar value)
+{
+    LAYX_ASSERT(prop >= LAYX_PROP_WIDTH && prop <= LAYX_PROP_COLUMN_GAP);
+    const uint32_t payload = layx_cmd_is_factor(prop) ? layx_cmd_float_bits((float)value) : layx_cmd_scalar_bits(value);
+    layx_cmd_push(buf, LAYX_CMD_SET, (uint32_t)prop, item, &payload, 1);
+}
+
+void layx_cmd_set_factor(layx_command_buffer *buf, layx_id item, layx_property prop, float value)
+{
+    LAYX_ASSERT(layx_cmd_is_factor(prop));
+    const uint32_t payload = layx_cmd_float_bits(value);
+    layx_cmd_push(buf, LAYX_CMD_SET, (uint32_t)prop, item, &payload, 1);
+}
+
+void layx_cmd_set_trbl(layx_command_buffer *buf, layx_id item, layx_property prop,
+                       layx_scalar top, layx_scalar right, layx_scalar bottom, layx_scalar left)
+{
+    LAYX_ASSERT(prop >= LAYX_PROP_MARGIN && prop < LAYX_PROP_COUNT);
+    const uint32_t payload[4] = {
+        layx_cmd_scalar_bits(top), layx_cmd_scalar_bits(right),
+        layx_cmd_scalar_bits(bottom), layx_cmd_scalar_bits(left),
+    };
+    layx_cmd_push(buf, LAYX_CMD_SET, (uint32_t)prop, item, payload, 4);
+}
+
+// 回放状态：本地 handle 映射与待写入的属性
+typedef struct layx_cmd_pending {
+    layx_id item;
+    uint32_t prop;
+    uint32_t words[LAYX_CMD_MAX_PAYLOAD];
+} layx_cmd_pending;
+
+typedef struct layx_cmd_replay {
+    layx_context *ctx;
+    layx_id *locals;
+    layx_id locals_capacity;
+    layx_cmd_pending *pending;      // 按首次写入顺序排列
+    uint32_t pending_count;
+    uint32_t pending_capacity;
+    uint32_t *slots;                // (item, prop) → pending 下标 + 1，0 表示空槽
+    uint32_t slot_capacity;
+} layx_cmd_replay;
+
+static void layx_cmd_write_property(layx_context *ctx, layx_id item, uint32_t prop, const uint32_t *w)
+{
+    switch (prop) {
+        case LAYX_PROP_DISPLAY: layx_set_display(ctx, item, (layx_display)w[0]); break;
+        case LAYX_PROP_FLEX_DIRECTION: layx_set_flex_direction(ctx, item, (layx_flex_direction)w[0]); break;
+        case LAYX_PROP_FLEX_WRAP: layx_set_flex_wrap(ctx, item, (layx_flex_wrap)w[0]); break;
+        case LAYX_PROP_JUSTIFY_CONTENT: layx_set_justify_content(ctx, item, (layx_justify_content)w[0]); break;
+        case LAYX_PROP_ALIGN_ITEMS: layx_set_align_items(ctx, item, (layx_align_items)w[0]); break;
+        case LAYX_PROP_ALIGN_CONTENT: layx_set_align_content(ctx, item, (layx_align_content)w[0]); break;
+        case LAYX_PROP_ALIGN_SELF: layx_set_align_self(ctx, item, (layx_align_self)w[0]); break;
+        case LAYX_PROP_OVERFLOW_X: layx_set_overflow_x(ctx, item, (layx_overflow)w[0]); break;
+        case LAYX_PROP_OVERFLOW_Y: layx_set_overflow_y(ctx, item, (layx_overflow)w[0]); break;
+        case LAYX_PROP_STYLE: layx_set_style(ctx, item, (layx_style_id)w[0]); break;
+        case LAYX_PROP_WIDTH: layx_set_width(ctx, item, layx_cmd_bits_scalar(w[0])); break;
+        case LAYX_PROP_HEIGHT: layx_set_height(ctx, item, layx_cmd_bits_scalar(w[0])); break;
+        case LAYX_PROP_MIN_WIDTH: layx_set_min_width(ctx, item, layx_cmd_bits_scalar(w[0])); break;
+        case LAYX_PROP_MIN_HEIGHT: layx_set_min_height(ctx, item, layx_cmd_bits_scalar(w[0])); break;
+        case LAYX_PROP_MAX_WIDTH: layx_set_max_width(ctx, item, layx_cmd_bits_scalar(w[0])); break;
+        case LAYX_PROP_MAX_HEIGHT: layx_set_max_height(ctx, item, layx_cmd_bits_scalar(w[0])); break;
+        case LAYX_PROP_FLEX_GROW: layx_set_flex_grow(ctx, item, layx_cmd_bits_float(w[0])); break;
+        case LAYX_PROP_FLEX_SHRINK: layx_set_flex_shrink(ctx, item, layx_cmd_bits_float(w[0])); break;
+        case LAYX_PROP_FLEX_BASIS: layx_set_flex_basis(ctx, item, layx_cmd_bits_scalar(w[0])); break;
+        case LAYX_PROP_ROW_GAP: layx_set_row_gap(ctx, item, layx_cmd_bits_scalar(w[0])); break;
+        case LAYX_PROP_COLUMN_GAP: layx_set_column_gap(ctx, item, layx_cmd_bits_scalar(w[0])); break;
+        case LAYX_PROP_MARGIN:
+            layx_set_margin_trbl(ctx, item, layx_cmd_bits_scalar(w[0]), layx_cmd_bits_scalar(w[1]),
+                                 layx_cmd_bits_scalar(w[2]), layx_cmd_bits_scalar(w[3]));
+            break;
+        case LAYX_PROP_PADDING:
+            layx_set_padding_trbl(ctx, item, layx_cmd_bits_scalar(w[0]), layx_cmd_bits_scalar(w[1]),
+                                  layx_cmd_bits_scalar(w[2]), layx_cmd_bits_scalar(w[3]));
+            break;
+        case LAYX_PROP_BORDER:
+            layx_set_border_trbl(ctx, item, layx_cmd_bits_scalar(w[0]), layx_cmd_bits_scalar(w[1]),
+                                 layx_cmd_bits_scalar(w[2]), layx_cmd_bits_scalar(w[3]));
+            break;
+        case LAYX_PROP_POSITION:
+            layx_set_position_lt(ctx, item, layx_cmd_bits_scalar(w[0]), layx_cmd_bits_scalar(w[1]));
+            layx_set_position_rb(ctx, item, layx_cmd_bits_scalar(w[2]), layx_cmd_bits_scalar(w[3]));
+            break;
+        default:
+            LAYX_ASSERT(0 && "unknown layx_property");
+            break;
+    }
+}
+
+static void layx_cmd_flush(layx_cmd_replay *replay)
+{
+    for (uint32_t i = 0; i < replay->pending_count; ++i) {
+        const layx_cmd_pending *p = replay->pending + i;
+        layx_cmd_write_property(replay->ctx, p->item, p->prop, p->words);
+    }
+    replay->pending_count = 0;
+    if (replay->slot_capacity > 0) {
+        memset(replay->slots, 0, replay->slot_capacity * sizeof(uint32_t));
+    }
+}
+
+static uint32_t layx_cmd_key_hash(layx_id item, uint32_t prop)
+{
+    return ((uint32_t)item * 2654435761u) ^ (prop * 40503u);
+}
+
+static void layx_cmd_slot_insert(layx_cmd_replay *replay, uint32_t index)
+{
+    const layx_cmd_pending *p = replay->pending + index;
+    const uint32_t mask = replay->slot_capacity - 1;
+    uint32_t slot = layx_cmd_key_hash(p->item, p->prop) & mask;
+    while (replay->slots[slot] != 0) slot = (slot + 1) & mask;
+    replay->slots[slot] = index + 1;
+}
+
+static void layx_cmd_defer(layx_cmd_replay *replay, layx_id item, uint32_t prop,
+                           const uint32_t *words, uint32_t nwords)
+{
+    // 已有相同 (item, prop) 时覆盖其值，保持首次写入的位置
+    if (replay->slot_capacity > 0) {
+        const uint32_t mask = replay->slot_capacity - 1;
+        for (uint32_t slot = layx_cmd_key_hash(item, prop) & mask; replay->slots[slot] != 0; slot = (slot + 1) & mask) {
+            layx_cmd_pending *p = replay->pending + replay->slots[slot] - 1;
+            if (p->item == item && p->prop == prop) {
+                memcpy(p->words, words, nwords * sizeof(uint32_t));
+                return;
+            }
+        }
+    }
+
+    if (replay->pending_count >= replay->pending_capacity) {
+        replay->pending_capacity = replay->pending_capacity < 1 ? 64 : replay->pending_capacity * 2;
+        replay->pending = (layx_cmd_pending*)LAYX_REALLOC(replay->pending,
+                                                          replay->pending_capacity * sizeof(layx_cmd_pending));
+    }
+    const uint32_t index = replay->pending_count++;
+    layx_cmd_pending *p = replay->pending + index;
+    p->item = item;
+    p->prop = prop;
+    memcpy(p->words, words, nwords * sizeof(uint32_t));
+
+    if (replay->pending_count * 2 > replay->slot_capacity) {
+        replay->slot_capacity = replay->slot_capacity < 1 ? 128 : replay->slot_capacity * 2;
+        LAYX_FREE(replay->slots);
+        replay->slots = (uint32_t*)LAYX_REALLOC(NULL, replay->slot_capacity * sizeof(uint32_t));
+        memset(replay->slots, 0, replay->slot_capacity * sizeof(uint32_t));
+        for (uint32_t i = 0; i < replay->pending_count; ++i) layx_cmd_slot_insert(replay, i);
+    } else {
+        layx_cmd_slot_insert(replay, index);
+    }
+}
+
+static layx_id layx_cmd_resolve(const layx_cmd_replay *replay, uint32_t id)
+{
+    if ((layx_id)id == LAYX_INVALID_ID) return (layx_id)id;
+    if (!((layx_id)id & LAYX_CMD_LOCAL_BIT)) {
+        LAYX_ASSERT((layx_id)id < replay->ctx->count);
+        return (layx_id)id;
+    }
+    const layx_id local = (layx_id)id & ~LAYX_CMD_LOCAL_BIT;
+    LAYX_ASSERT(local < replay->locals_capacity);
+    return replay->locals[local];
+}
+
+size_t layx_apply_commands(layx_context *ctx, const layx_command_buffer *bufs, size_t count)
+{
+    LAYX_ASSERT(ctx != NULL && (bufs != NULL || count == 0));
+    // 已有的 id 都不带 LAYX_CMD_LOCAL_BIT，回放中新建的 id 在 CREATE 处检查
+    LAYX_ASSERT(ctx->count <= LAYX_CMD_MAX_ITEMS);
+    layx_cmd_replay replay;
+    memset(&replay, 0, sizeof(replay));
+    replay.ctx = ctx;
+
+    size_t applied = 0;
+    for (size_t b = 0; b < count; ++b) {
+        const layx_command_buffer *buf = bufs + b;
+        if (buf->local_count > replay.locals_capacity) {
+            replay.locals_capacity = buf->local_count;
+            replay.locals = (layx_id*)LAYX_REALLOC(replay.locals, replay.locals_capacity * sizeof(layx_id));
+        }
+
+        const uint32_t *w = (const uint32_t*)buf->data;
+        const uint32_t *end = (const uint32_t*)(buf->data + buf->size);
+        while (w < end) {
+            const uint32_t op = w[0] & 0xFF;
+            const uint32_t prop = (w[0] >> 8) & 0xFF;
+            const uint32_t nwords = w[0] >> 16;
+            const uint32_t *payload = w + 2;
+            switch (op) {
+                case LAYX_CMD_CREATE: {
+                    const layx_id item = layx_item(ctx);
+                    LAYX_ASSERT(!(item & LAYX_CMD_LOCAL_BIT));
+                    replay.locals[(layx_id)w[1] & ~LAYX_CMD_LOCAL_BIT] = item;
+                    break;
+                }
+                case LAYX_CMD_DESTROY:
+                    // 销毁后 id 可能被后续 CREATE 复用，先写入积累的属性
+                    layx_cmd_flush(&replay);
+                    layx_destroy_item(ctx, layx_cmd_resolve(&replay, w[1]));
+                    break;
+                case LAYX_CMD_APPEND:
+                    layx_append(ctx, layx_cmd_resolve(&replay, w[1]), layx_cmd_resolve(&replay, payload[0]));
+                    break;
+                case LAYX_CMD_PREPEND:
+                    layx_prepend(ctx, layx_cmd_resolve(&replay, w[1]), layx_cmd_resolve(&replay, payload[0]));
+                    break;
+                case LAYX_CMD_INSERT_AFTER:
+                    layx_insert_after(ctx, layx_cmd_resolve(&replay, w[1]), layx_cmd_resolve(&replay, payload[0]));
+                    break;
+                case LAYX_CMD_REMOVE:
+                    layx_remove(ctx, layx_cmd_resolve(&replay, w[1]));
+                    break;
+                case LAYX_CMD_SET:
+                    if (prop == LAYX_PROP_STYLE) {
+                        // 样式与本地覆盖的先后顺序会影响结果，不能合并
+                        layx_cmd_flush(&replay);
+                        layx_cmd_write_property(ctx, layx_cmd_resolve(&replay, w[1]), prop, payload);
+                    } else {
+                        layx_cmd_defer(&replay, layx_cmd_resolve(&replay, w[1]), prop, payload, nwords);
+                    }
+                    break;
+                default:
+                    LAYX_ASSERT(0 && "corrupt command buffer");
+                    break;
+            }
+            w += 2 + nwords;
+            ++applied;
+        }
+    }
+    layx_cmd_flush(&replay);
+
+    LAYX_FREE(replay.locals);
+    LAYX_FREE(replay.pending);
+    LAYX_FREE(replay.slots);
+    return applied;
+}
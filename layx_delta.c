@@ -0,0 +1,350 @@
+#include "layx.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef LAYX_REALLOC
+#define LAYX_REALLOC(_block, _size) realloc(_block, _size)
+#define LAYX_FREE(_block) free(_block)
+#endif
+
+// 小端序读写，与主机字节序无关
+static void layx_delta_put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void layx_delta_put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+    p[2] = (uint8_t)((v >> 16) & 0xFF);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void layx_delta_put_f32(uint8_t *p, float v)
+{
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    layx_delta_put_u32(p, bits);
+}
+
+static uint16_t layx_delta_get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t layx_delta_get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static float layx_delta_get_f32(const uint8_t *p)
+{
+    uint32_t bits = layx_delta_get_u32(p);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static void layx_delta_push_id(layx_id **list, uint32_t *count, uint32_t *capacity, layx_id id)
+{
+    if (*count >= *capacity) {
+        *capacity = *capacity < 1 ? 32 : (*capacity * 2);
+        *list = (layx_id*)LAYX_REALLOC(*list, *capacity * sizeof(layx_id));
+    }
+    (*list)[(*count)++] = id;
+}
+
+static void layx_delta_shrink_list(void **list, uint32_t count, size_t size)
+{
+    if (count == 0) {
+        LAYX_FREE(*list);
+        *list = NULL;
+    } else {
+        *list = LAYX_REALLOC(*list, count * size);
+    }
+}
+
+void layx_delta_release(layx_context *ctx)
+{
+    layx_delta_tracker *delta = &ctx->delta;
+    LAYX_FREE(delta->prev_rects);
+    LAYX_FREE(delta->prev_tags);
+    LAYX_FREE(delta->created);
+    LAYX_FREE(delta->destroyed);
+    memset(delta, 0, sizeof(layx_delta_tracker));
+}
+
+// 镜像截到当前的 count，id 列表缩小到当前长度；之后增长的部分按零矩形处理
+void layx_delta_shrink(layx_context *ctx)
+{
+    layx_delta_tracker *delta = &ctx->delta;
+    if (delta->prev_capacity > ctx->count) {
+        delta->prev_capacity = ctx->count;
+        layx_delta_shrink_list((void**)&delta->prev_rects, ctx->count, sizeof(layx_vec4));
+        if (delta->prev_tags != NULL) {
+            layx_delta_shrink_list((void**)&delta->prev_tags, ctx->count, sizeof(uint32_t));
+        }
+    }
+    delta->created_capacity = delta->created_count;
+    layx_delta_shrink_list((void**)&delta->created, delta->created_count, sizeof(layx_id));
+    delta->destroyed_capacity = delta->destroyed_count;
+    layx_delta_shrink_list((void**)&delta->destroyed, delta->destroyed_count, sizeof(layx_id));
+}
+
+size_t layx_delta_memory(const layx_context *ctx)
+{
+    const layx_delta_tracker *delta = &ctx->delta;
+    return (size_t)delta->prev_capacity * (sizeof(layx_vec4) + (delta->prev_tags != NULL ? sizeof(uint32_t) : 0))
+         + ((size_t)delta->created_capacity + delta->destroyed_capacity) * sizeof(layx_id);
+}
+
+// 消费端应用新建/销毁列表时把对应镜像清零，这里同步清零上次写出的值，
+// 使复用的 id 即使落在与旧 item 相同的 rect 上也会写出变更记录
+static void layx_delta_forget(layx_delta_tracker *delta, layx_id item)
+{
+    if (item >= delta->prev_capacity) return;
+    memset(&delta->prev_rects[item], 0, sizeof(layx_vec4));
+    if (delta->prev_tags != NULL) delta->prev_tags[item] = 0;
+}
+
+void layx_delta_on_create(layx_context *ctx, layx_id item)
+{
+    layx_delta_tracker *delta = &ctx->delta;
+    layx_delta_push_id(&delta->created, &delta->created_count, &delta->created_capacity, item);
+    layx_delta_forget(delta, item);
+}
+
+void layx_delta_on_destroy(layx_context *ctx, layx_id item)
+{
+    layx_delta_tracker *delta = &ctx->delta;
+    layx_delta_push_id(&delta->destroyed, &delta->destroyed_count, &delta->destroyed_capacity, item);
+    layx_delta_forget(delta, item);
+}
+
+void layx_delta_enable(layx_context *ctx, bool enable)
+{
+    LAYX_ASSERT(ctx != NULL);
+    if (!enable) {
+        layx_delta_release(ctx);
+        return;
+    }
+    if (!ctx->delta.enabled) {
+        ctx->delta.enabled = true;
+        ctx->delta.keyframe = true;
+    }
+}
+
+void layx_delta_request_keyframe(layx_context *ctx)
+{
+    LAYX_ASSERT(ctx != NULL);
+    ctx->delta.keyframe = true;
+    ctx->delta.created_count = 0;
+    ctx->delta.destroyed_count = 0;
+}
+
+// 切换会改变记录格式，消费端的镜像需要从关键帧重建
+void layx_delta_include_tags(layx_context *ctx, bool enable)
+{
+    LAYX_ASSERT(ctx != NULL);
+    layx_delta_tracker *delta = &ctx->delta;
+    if (delta->tags == enable) return;
+    delta->tags = enable;
+    if (!enable) {
+        LAYX_FREE(delta->prev_tags);
+        delta->prev_tags = NULL;
+    }
+    layx_delta_request_keyframe(ctx);
+}
+
+static size_t layx_delta_record_size(uint32_t flags)
+{
+    return (flags & LAYX_DELTA_FLAG_TAGS) ? LAYX_DELTA_TAGGED_RECORD_SIZE : LAYX_DELTA_RECORD_SIZE;
+}
+
+size_t layx_delta_bound(const layx_context *ctx)
+{
+    LAYX_ASSERT(ctx != NULL);
+    const layx_delta_tracker *delta = &ctx->delta;
+    return LAYX_DELTA_HEADER_SIZE
+         + 4 * ((size_t)delta->created_count + delta->destroyed_count)
+         + layx_delta_record_size(delta->tags ? LAYX_DELTA_FLAG_TAGS : 0) * (size_t)ctx->count;
+}
+
+static bool layx_delta_rect_changed(const layx_delta_tracker *delta, const layx_context *ctx, layx_id id)
+{
+    if (delta->keyframe) return true;
+    if (delta->tags && ctx->items[id].tag != delta->prev_tags[id]) return true;
+    layx_vec4 a = ctx->rects[id];
+    layx_vec4 b = delta->prev_rects[id];
+    return a[0] != b[0] || a[1] != b[1] || a[2] != b[2] || a[3] != b[3];
+}
+
+size_t layx_delta_write(layx_context *ctx, void *buffer, size_t capacity)
+{
+    LAYX_ASSERT(ctx != NULL && buffer != NULL);
+    layx_delta_tracker *delta = &ctx->delta;
+    if (!delta->enabled) return 0;
+
+    // 镜像容量跟随 count 增长，新增部分视为零矩形
+    if (ctx->count > delta->prev_capacity) {
+        layx_id new_capacity = ctx->count;
+        delta->prev_rects = (layx_vec4*)LAYX_REALLOC(delta->prev_rects, new_capacity * sizeof(layx_vec4));
+        memset(delta->prev_rects + delta->prev_capacity, 0,
+               (new_capacity - delta->prev_capacity) * sizeof(layx_vec4));
+        if (delta->prev_tags != NULL) {
+            delta->prev_tags = (uint32_t*)LAYX_REALLOC(delta->prev_tags, new_capacity * sizeof(uint32_t));
+            memset(delta->prev_tags + delta->prev_capacity, 0,
+                   (new_capacity - delta->prev_capacity) * sizeof(uint32_t));
+        }
+        delta->prev_capacity = new_capacity;
+    }
+    if (delta->tags && delta->prev_tags == NULL && delta->prev_capacity > 0) {
+        delta->prev_tags = (uint32_t*)LAYX_REALLOC(NULL, delta->prev_capacity * sizeof(uint32_t));
+        memset(delta->prev_tags, 0, delta->prev_capacity * sizeof(uint32_t));
+    }
+    const uint16_t flags = (uint16_t)((delta->keyframe ? LAYX_DELTA_FLAG_RESET : 0) |
+                                      (delta->tags ? LAYX_DELTA_FLAG_TAGS : 0));
+    const size_t record_size = layx_delta_record_size(flags);
+
+    const size_t ids_size = 4 * ((size_t)delta->created_count + delta->destroyed_count);
+    if (capacity < layx_delta_bound(ctx)) {
+        // 空间不足以容纳最坏情况时先精确计数，避免写到一半失败
+        size_t changed = 0;
+        for (layx_id i = 0; i < ctx->count; ++i) {
+            if (layx_delta_rect_changed(delta, ctx, i)) ++changed;
+        }
+        if (capacity < LAYX_DELTA_HEADER_SIZE + ids_size + changed * record_size) {
+            return 0;
+        }
+    }
+
+    uint8_t *out = (uint8_t*)buffer;
+    uint8_t *p = out + LAYX_DELTA_HEADER_SIZE;
+    for (uint32_t i = 0; i < delta->created_count; ++i, p += 4) {
+        layx_delta_put_u32(p, (uint32_t)delta->created[i]);
+    }
+    for (uint32_t i = 0; i < delta->destroyed_count; ++i, p += 4) {
+        layx_delta_put_u32(p, (uint32_t)delta->destroyed[i]);
+    }
+
+    uint32_t changed = 0;
+    for (layx_id i = 0; i < ctx->count; ++i) {
+        if (!layx_delta_rect_changed(delta, ctx, i)) continue;
+        layx_vec4 rect = ctx->rects[i];
+        layx_delta_put_u32(p, (uint32_t)i);
+        uint8_t *r = p + 4;
+        if (delta->tags) {
+            const uint32_t tag = ctx->items[i].tag;
+            layx_delta_put_u32(r, tag);
+            delta->prev_tags[i] = tag;
+            r += 4;
+        }
+        layx_delta_put_f32(r, (float)rect[0]);
+        layx_delta_put_f32(r + 4, (float)rect[1]);
+        layx_delta_put_f32(r + 8, (float)rect[2]);
+        layx_delta_put_f32(r + 12, (float)rect[3]);
+        p += record_size;
+        delta->prev_rects[i] = rect;
+        ++changed;
+    }
+
+    layx_delta_put_u32(out + 0, LAYX_DELTA_MAGIC);
+    layx_delta_put_u16(out + 4, LAYX_DELTA_VERSION);
+    layx_delta_put_u16(out + 6, flags);
+    layx_delta_put_u32(out + 8, delta->frame);
+    layx_delta_put_u32(out + 12, (uint32_t)ctx->count);
+    layx_delta_put_u32(out + 16, (uint32_t)delta->created_count);
+    layx_delta_put_u32(out + 20, (uint32_t)delta->destroyed_count);
+    layx_delta_put_u32(out + 24, changed);
+    layx_delta_put_u32(out + 28, 0);
+
+    delta->frame++;
+    delta->keyframe = false;
+    delta->created_count = 0;
+    delta->destroyed_count = 0;
+    return (size_t)(p - out);
+}
+
+int layx_delta_read_header(const void *buffer, size_t size, layx_delta_info *info)
+{
+    const uint8_t *in = (const uint8_t*)buffer;
+    if (buffer == NULL || size < LAYX_DELTA_HEADER_SIZE) return -1;
+    if (layx_delta_get_u32(in) != LAYX_DELTA_MAGIC) return -1;
+    info->version = layx_delta_get_u16(in + 4);
+    if (info->version != LAYX_DELTA_VERSION) return -1;
+    info->flags = layx_delta_get_u16(in + 6);
+    info->frame = layx_delta_get_u32(in + 8);
+    info->id_limit = layx_delta_get_u32(in + 12);
+    info->created_count = layx_delta_get_u32(in + 16);
+    info->destroyed_count = layx_delta_get_u32(in + 20);
+    info->changed_count = layx_delta_get_u32(in + 24);
+
+    uint64_t need = LAYX_DELTA_HEADER_SIZE
+                  + 4 * ((uint64_t)info->created_count + info->destroyed_count)
+                  + (uint64_t)layx_delta_record_size(info->flags) * info->changed_count;
+    return need <= size ? 0 : -1;
+}
+
+// 返回应用的变更记录数，格式错误或镜像容量不足时返回 -1；mirror_tags 可以为 NULL
+static int layx_delta_apply_mirrors(const void *buffer, size_t size, float *mirror_xywh,
+                                    uint32_t *mirror_tags, uint32_t mirror_count)
+{
+    layx_delta_info info;
+    if (layx_delta_read_header(buffer, size, &info) != 0) return -1;
+    if (info.id_limit > mirror_count) return -1;
+
+    if (info.flags & LAYX_DELTA_FLAG_RESET) {
+        memset(mirror_xywh, 0, (size_t)mirror_count * 4 * sizeof(float));
+        if (mirror_tags != NULL) memset(mirror_tags, 0, (size_t)mirror_count * sizeof(uint32_t));
+    }
+
+    const uint8_t *p = (const uint8_t*)buffer + LAYX_DELTA_HEADER_SIZE;
+    const uint8_t *created = p;
+    const uint8_t *destroyed = created + 4 * (size_t)info.created_count;
+    const uint8_t *records = destroyed + 4 * (size_t)info.destroyed_count;
+    const size_t record_size = layx_delta_record_size(info.flags);
+    const bool tagged = (info.flags & LAYX_DELTA_FLAG_TAGS) != 0;
+
+    for (uint32_t i = 0; i < info.destroyed_count; ++i) {
+        uint32_t id = layx_delta_get_u32(destroyed + 4 * (size_t)i);
+        if (id >= mirror_count) return -1;
+        memset(mirror_xywh + 4 * (size_t)id, 0, 4 * sizeof(float));
+        if (mirror_tags != NULL) mirror_tags[id] = 0;
+    }
+    for (uint32_t i = 0; i < info.created_count; ++i) {
+        uint32_t id = layx_delta_get_u32(created + 4 * (size_t)i);
+        if (id >= mirror_count) return -1;
+        memset(mirror_xywh + 4 * (size_t)id, 0, 4 * sizeof(float));
+        if (mirror_tags != NULL) mirror_tags[id] = 0;
+    }
+    for (uint32_t i = 0; i < info.changed_count; ++i) {
+        const uint8_t *r = records + record_size * i;
+        uint32_t id = layx_delta_get_u32(r);
+        if (id >= mirror_count) return -1;
+        r += 4;
+        if (tagged) {
+            if (mirror_tags != NULL) mirror_tags[id] = layx_delta_get_u32(r);
+            r += 4;
+        }
+        float *dst = mirror_xywh + 4 * (size_t)id;
+        dst[0] = layx_delta_get_f32(r);
+        dst[1] = layx_delta_get_f32(r + 4);
+        dst[2] = layx_delta_get_f32(r + 8);
+        dst[3] = layx_delta_get_f32(r + 12);
+    }
+    return (int)info.changed_count;
+}
+
+int layx_delta_apply(const void *buffer, size_t size, float *mirror_xywh, uint32_t mirror_count)
+{
+    return layx_delta_apply_mirrors(buffer, size, mirror_xywh, NULL, mirror_count);
+}
+
+int layx_delta_apply_tags(const void *buffer, size_t size, float *mirror_xywh,
+                          uint32_t *mirror_tags, uint32_t mirror_count)
+{
+    return layx_delta_apply_mirrors(buffer, size, mirror_xywh, mirror_tags, mirror_count);
+}
@@ -0,0 +1,247 @@
+#include "layx.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef LAYX_REALLOC
+#define LAYX_REALLOC(_block, _size) realloc(_block, _size)
+#define LAYX_FREE(_block) free(_block)
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define layx_atomic_exchange(_p, _v) ((uint32_t)_InterlockedExchange((volatile long*)(_p), (long)(_v)))
+#define layx_atomic_load(_p) ((uint32_t)_InterlockedCompareExchange((volatile long*)(_p), 0, 0))
+#define layx_atomic_store(_p, _v) ((void)_InterlockedExchange((volatile long*)(_p), (long)(_v)))
+#else
+#define layx_atomic_exchange(_p, _v) __atomic_exchange_n((_p), (_v), __ATOMIC_ACQ_REL)
+#define layx_atomic_load(_p) __atomic_load_n((_p), __ATOMIC_ACQUIRE)
+#define layx_atomic_store(_p, _v) __atomic_store_n((_p), (_v), __ATOMIC_RELEASE)
+#endif
+
+#define LAYX_FRAME_SLOT_MASK 0x3u
+
+static void layx_frame_free(layx_frame *frame)
+{
+    LAYX_FREE(frame->rects);
+    LAYX_FREE(frame->scroll_offset);
+    LAYX_FREE(frame->scroll_max);
+    LAYX_FREE(frame->content_size);
+    LAYX_FREE(frame->has_scrollbars);
+    LAYX_FREE(frame->tags);
+    LAYX_FREE(frame->user_data);
+    memset(frame, 0, sizeof(layx_frame));
+}
+
+// 只会扩容布局线程持有的 back 槽位，渲染线程可能正在读的槽位不受影响
+static void layx_frame_reserve(layx_frame *frame, layx_id count)
+{
+    if (count <= frame->capacity) return;
+    uint32_t capacity = frame->capacity < 1 ? 32 : frame->capacity;
+    while (capacity < count) capacity *= 2;
+    frame->rects = (layx_vec4*)LAYX_REALLOC(frame->rects, capacity * sizeof(layx_vec4));
+    frame->scroll_offset = (layx_vec2*)LAYX_REALLOC(frame->scroll_offset, capacity * sizeof(layx_vec2));
+    frame->scroll_max = (layx_vec2*)LAYX_REALLOC(frame->scroll_max, capacity * sizeof(layx_vec2));
+    frame->content_size = (layx_vec2*)LAYX_REALLOC(frame->content_size, capacity * sizeof(layx_vec2));
+    frame->has_scrollbars = (uint8_t*)LAYX_REALLOC(frame->has_scrollbars, capacity * sizeof(uint8_t));
+    frame->tags = (uint32_t*)LAYX_REALLOC(frame->tags, capacity * sizeof(uint32_t));
+    frame->user_data = (void**)LAYX_REALLOC(frame->user_data, capacity * sizeof(void*));
+    frame->capacity = capacity;
+}
+
+void layx_frames_release(layx_context *ctx)
+{
+    layx_frame_exchange *frames = &ctx->frames;
+    for (int i = 0; i < 3; ++i) {
+        layx_frame_free(&frames->slots[i]);
+    }
+    LAYX_FREE(frames->changes);
+    memset(frames, 0, sizeof(layx_frame_exchange));
+}
+
+// 丢弃修改记录：此后每个槽位都要整帧复制一次，之后才能再按记录补齐
+void layx_frames_invalidate(layx_context *ctx)
+{
+    layx_frame_exchange *frames = &ctx->frames;
+    frames->change_count = 0;
+    frames->change_base = frames->published + 2;
+}
+
+// 记录下一次发布前输出可能变化的 item，只在启用双缓冲时调用
+void layx_frames_touch(layx_context *ctx, layx_id item, bool subtree)
+{
+    layx_frame_exchange *frames = &ctx->frames;
+    // 记录比 item 还多时整帧复制更便宜
+    if (frames->change_count >= 64 && frames->change_count >= (uint32_t)ctx->count) {
+        layx_frames_invalidate(ctx);
+    }
+    if (frames->change_count >= frames->change_capacity) {
+        frames->change_capacity = frames->change_capacity < 1 ? 64 : frames->change_capacity * 2;
+        frames->changes = (layx_frame_change*)LAYX_REALLOC(frames->changes,
+                                                           frames->change_capacity * sizeof(layx_frame_change));
+    }
+    layx_frame_change *change = frames->changes + frames->change_count++;
+    change->frame = frames->published + 1;
+    change->item = item;
+    change->subtree = subtree;
+}
+
+// back 槽位只由布局线程持有，内容在下一次发布时整体重写，可以直接释放；
+// 修改记录一并释放，其他槽位之后同样整帧复制
+void layx_frames_shrink(layx_context *ctx)
+{
+    layx_frame_exchange *frames = &ctx->frames;
+    if (!frames->enabled) return;
+    layx_frame_free(&frames->slots[frames->back]);
+    layx_frames_invalidate(ctx);
+    LAYX_FREE(frames->changes);
+    frames->changes = NULL;
+    frames->change_capacity = 0;
+}
+
+size_t layx_frames_memory(const layx_context *ctx)
+{
+    const size_t slot_size = sizeof(layx_vec4) + 3 * sizeof(layx_vec2) + sizeof(uint8_t)
+                           + sizeof(uint32_t) + sizeof(void*);
+    size_t bytes = (size_t)ctx->frames.change_capacity * sizeof(layx_frame_change);
+    for (int i = 0; i < 3; ++i) {
+        bytes += (size_t)ctx->frames.slots[i].capacity * slot_size;
+    }
+    return bytes;
+}
+
+// 关闭时释放全部槽位，调用者需保证渲染线程已不再读取
+void layx_set_double_buffered(layx_context *ctx, bool enable)
+{
+    LAYX_ASSERT(ctx != NULL);
+    if (!enable) {
+        layx_frames_release(ctx);
+        return;
+    }
+    if (ctx->frames.enabled) return;
+    layx_frame_exchange *frames = &ctx->frames;
+    memset(frames, 0, sizeof(layx_frame_exchange));
+    frames->enabled = true;
+    frames->back = 0;
+    frames->shared = 1;
+    frames->front = 2;
+    frames->change_base = 1;
+}
+
+static void layx_frame_copy_item(layx_frame *frame, const layx_context *ctx, layx_id i)
+{
+    const layx_item_t *pitem = ctx->items + i;
+    frame->rects[i] = ctx->rects[i];
+    frame->scroll_offset[i] = pitem->scroll_offset;
+    frame->scroll_max[i] = pitem->scroll_max;
+    frame->content_size[i] = pitem->content_size;
+    frame->has_scrollbars[i] = pitem->has_scrollbars;
+    frame->tags[i] = pitem->tag;
+    frame->user_data[i] = pitem->user_data;
+}
+
+// 先序复制 item 的整棵子树，返回复制的数量
+static layx_id layx_frame_copy_subtree(layx_frame *frame, const layx_context *ctx, layx_id root)
+{
+    layx_id copied = 0;
+    layx_id item = root;
+    while (item != LAYX_INVALID_ID) {
+        layx_frame_copy_item(frame, ctx, item);
+        ++copied;
+        const layx_item_t *pitem = ctx->items + item;
+        if (pitem->first_child != LAYX_INVALID_ID) {
+            item = pitem->first_child;
+            continue;
+        }
+        while (item != root && ctx->items[item].next_sibling == LAYX_INVALID_ID) {
+            item = ctx->items[item].parent;
+        }
+        item = item == root ? LAYX_INVALID_ID : ctx->items[item].next_sibling;
+    }
+    return copied;
+}
+
+// 第一条发布序号大于 frame 的修改记录
+static uint32_t layx_frames_first_change(const layx_frame_exchange *frames, uint32_t frame)
+{
+    uint32_t lo = 0, hi = frames->change_count;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (frames->changes[mid].frame <= frame) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// 丢弃所有槽位都已包含的修改记录；还要整帧复制的槽位不需要记录
+static void layx_frames_prune(layx_frame_exchange *frames)
+{
+    uint32_t oldest = UINT32_MAX;
+    for (int i = 0; i < 3; ++i) {
+        const uint32_t frame = frames->slots[i].frame;
+        if (frame != 0 && frame + 1 >= frames->change_base && frame < oldest) oldest = frame;
+    }
+    if (oldest == UINT32_MAX) return;
+    const uint32_t first = layx_frames_first_change(frames, oldest);
+    if (first == 0) return;
+    frames->change_count -= first;
+    memmove(frames->changes, frames->changes + first, frames->change_count * sizeof(layx_frame_change));
+}
+
+void layx_publish(layx_context *ctx)
+{
+    LAYX_ASSERT(ctx != NULL);
+    layx_frame_exchange *frames = &ctx->frames;
+    if (!frames->enabled) return;
+
+    layx_frame *frame = &frames->slots[frames->back];
+    const layx_id count = ctx->count;
+    const uint32_t next = frames->published + 1;
+    // 槽位中那一帧之后的修改都在记录中时只补齐这些 item；新建的 item 同样有记录
+    const bool incremental = frame->frame != 0 && frame->frame + 1 >= frames->change_base;
+    layx_frame_reserve(frame, count);
+    layx_id copied = 0;
+    if (incremental) {
+        for (uint32_t i = layx_frames_first_change(frames, frame->frame); i < frames->change_count; ++i) {
+            const layx_frame_change *change = frames->changes + i;
+            if (change->item >= count) continue;
+            if (change->subtree) {
+                copied += layx_frame_copy_subtree(frame, ctx, change->item);
+            } else {
+                layx_frame_copy_item(frame, ctx, change->item);
+                ++copied;
+            }
+        }
+    } else {
+        for (layx_id i = 0; i < count; ++i) {
+            layx_frame_copy_item(frame, ctx, i);
+        }
+        copied = count;
+    }
+    frame->count = count;
+    frame->frame = next;
+    frames->copied = copied;
+    layx_atomic_store(&frames->published, next);
+    layx_frames_prune(frames);
+
+    // 写入完成后再交换，渲染线程拿到的槽位总是完整的一帧
+    const uint32_t previous = layx_atomic_exchange(&frames->shared, frames->back | LAYX_FRAME_FRESH);
+    frames->back = previous & LAYX_FRAME_SLOT_MASK;
+}
+
+const layx_frame *layx_acquire_frame(layx_context *ctx)
+{
+    LAYX_ASSERT(ctx != NULL);
+    layx_frame_exchange *frames = &ctx->frames;
+    if (!frames->enabled) return NULL;
+    if (layx_atomic_load(&frames->shared) & LAYX_FRAME_FRESH) {
+        const uint32_t previous = layx_atomic_exchange(&frames->shared, frames->front);
+        frames->front = previous & LAYX_FRAME_SLOT_MASK;
+    }
+    return &frames->slots[frames->front];
+}
+
+uint32_t layx_published_frames(const layx_context *ctx)
+{
+    LAYX_ASSERT(ctx != NULL);
+    return layx_atomic_load(&((layx_context*)ctx)->frames.published);
+}
@@ -0,0 +1,343 @@
+#include "layx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef LAYX_REALLOC
+#define LAYX_REALLOC(_block, _size) realloc(_block, _size)
+#define LAYX_FREE(_block) free(_block)
+#endif
+
+#define LAYX_RECORD_BYTE_ORDER  0x0102
+#define LAYX_RECORD_BUFFER_SIZE 16384
+
+typedef struct layx_record_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint8_t scalar_type;
+    uint8_t id_bits;
+    uint16_t byte_order;
+    uint32_t style_size;
+    uint32_t track_size;
+    uint8_t reserved[12];
+} layx_record_header;
+
+typedef struct layx_recorder {
+    FILE *file;
+    uint64_t calls;
+    int muted;                  // 大于 0 时处在另一个已记录调用的内部
+    size_t length;
+    uint8_t buffer[LAYX_RECORD_BUFFER_SIZE];
+} layx_recorder;
+
+static void layx_record_fill_header(layx_record_header *header)
+{
+    memset(header, 0, sizeof(layx_record_header));
+    header->magic = LAYX_RECORD_MAGIC;
+    header->version = LAYX_RECORD_VERSION;
+    header->header_size = LAYX_RECORD_HEADER_SIZE;
+#if LAYX_FLOAT == 1
+    header->scalar_type = LAYX_SNAPSHOT_SCALAR_FLOAT32;
+#else
+    header->scalar_type = LAYX_SNAPSHOT_SCALAR_INT16;
+#endif
+    header->id_bits = (uint8_t)(sizeof(layx_id) * 8);
+    header->byte_order = LAYX_RECORD_BYTE_ORDER;
+    header->style_size = (uint32_t)sizeof(layx_style);
+    header->track_size = (uint32_t)sizeof(layx_grid_track);
+}
+
+#if LAYX_RECORD
+static void layx_record_flush(layx_recorder *rec)
+{
+    if (rec->length == 0) return;
+    fwrite(rec->buffer, 1, rec->length, rec->file);
+    rec->length = 0;
+}
+
+// 超过缓冲区的数据（很长的轨道列表）直接写入文件
+static void layx_record_put(layx_recorder *rec, const void *data, size_t size)
+{
+    if (rec->length + size > LAYX_RECORD_BUFFER_SIZE) {
+        layx_record_flush(rec);
+        if (size > LAYX_RECORD_BUFFER_SIZE) {
+            fwrite(data, 1, size, rec->file);
+            return;
+        }
+    }
+    memcpy(rec->buffer + rec->length, data, size);
+    rec->length += size;
+}
+#endif
+
+int layx_record_begin(layx_context *ctx, const char *path)
+{
+    LAYX_ASSERT(ctx != NULL && path != NULL);
+#if LAYX_RECORD
+    if (ctx->recorder != NULL) layx_record_end(ctx);
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) return -1;
+
+    layx_recorder *rec = (layx_recorder*)LAYX_REALLOC(NULL, sizeof(layx_recorder));
+    rec->file = file;
+    rec->calls = 0;
+    rec->muted = 0;
+    rec->length = 0;
+    layx_record_header header;
+    layx_record_fill_header(&header);
+    layx_record_put(rec, &header, sizeof(header));
+    ctx->recorder = rec;
+    return 0;
+#else
+    (void)ctx;
+    (void)path;
+    return -2;
+#endif
+}
+
+uint64_t layx_record_end(layx_context *ctx)
+{
+    LAYX_ASSERT(ctx != NULL);
+#if LAYX_RECORD
+    layx_recorder *rec = ctx->recorder;
+    if (rec == NULL) return 0;
+    layx_record_flush(rec);
+    fclose(rec->file);
+    const uint64_t calls = rec->calls;
+    LAYX_FREE(rec);
+    ctx->recorder = NULL;
+    return calls;
+#else
+    // 未编入记录时 layx_record_begin 不会创建记录器
+    return 0;
+#endif
+}
+
+#if LAYX_RECORD
+// words[0] 为 item，其后为 payload
+void layx_record_call(layx_context *ctx, uint32_t op, const uint32_t *words, uint32_t count)
+{
+    layx_recorder *rec = ctx->recorder;
+    if (rec->muted > 0) return;
+    const uint32_t head = op | ((count - 1) << 16);
+    layx_record_put(rec, &head, sizeof(head));
+    layx_record_put(rec, words, count * sizeof(uint32_t));
+    rec->calls++;
+}
+
+// payload 为 head 加上按 4 字节补齐的原始字节
+void layx_record_bytes(layx_context *ctx, uint32_t op, layx_id item, uint32_t head,
+                       const void *bytes, size_t size)
+{
+    layx_recorder *rec = ctx->recorder;
+    if (rec->muted > 0) return;
+    const size_t padded = (size + 3) & ~(size_t)3;
+    LAYX_ASSERT(1 + padded / sizeof(uint32_t) <= 0xFFFF);
+    const uint32_t words[3] = { op | (uint32_t)((1 + padded / sizeof(uint32_t)) << 16), (uint32_t)item, head };
+    layx_record_put(rec, words, sizeof(words));
+    if (size > 0) layx_record_put(rec, bytes, size);
+    const uint32_t zero = 0;
+    if (padded > size) layx_record_put(rec, &zero, padded - size);
+    rec->calls++;
+}
+
+void layx_record_mute(layx_context *ctx, int delta)
+{
+    ctx->recorder->muted += delta;
+}
+#endif
+
+int layx_replay_open(layx_replay_cursor *cursor, const void *data, size_t size)
+{
+    LAYX_ASSERT(cursor != NULL && (data != NULL || size == 0));
+    memset(cursor, 0, sizeof(layx_replay_cursor));
+    layx_record_header header;
+    if (size < sizeof(header)) return -1;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != LAYX_RECORD_MAGIC || header.version != LAYX_RECORD_VERSION ||
+        header.header_size != LAYX_RECORD_HEADER_SIZE) {
+        return -1;
+    }
+    layx_record_header expected;
+    layx_record_fill_header(&expected);
+    if (header.scalar_type != expected.scalar_type || header.id_bits != expected.id_bits ||
+        header.byte_order != expected.byte_order || header.style_size != expected.style_size ||
+        header.track_size != expected.track_size) {
+        return -2;
+    }
+    cursor->data = (const uint8_t*)data;
+    cursor->size = size;
+    cursor->offset = LAYX_RECORD_HEADER_SIZE;
+    return 0;
+}
+
+static layx_scalar layx_replay_scalar(uint32_t bits)
+{
+    union { uint32_t u; layx_scalar s; } value;
+    value.u = bits;
+    return value.s;
+}
+
+static float layx_replay_float(uint32_t bits)
+{
+    union { uint32_t u; float f; } value;
+    value.u = bits;
+    return value.f;
+}
+
+typedef void (*layx_replay_scalar_fn)(layx_context *ctx, layx_id item, layx_scalar value);
+
+static const layx_replay_scalar_fn layx_replay_box_sides[3][4] = {
+    { layx_set_margin_top, layx_set_margin_right, layx_set_margin_bottom, layx_set_margin_left },
+    { layx_set_padding_top, layx_set_padding_right, layx_set_padding_bottom, layx_set_padding_left },
+    { layx_set_border_top, layx_set_border_right, layx_set_border_bottom, layx_set_border_left },
+};
+
+static const layx_replay_scalar_fn layx_replay_boxes[3] = {
+    layx_set_margin, layx_set_padding, layx_set_border,
+};
+
+static const layx_replay_scalar_fn layx_replay_position_sides[4] = {
+    layx_set_left, layx_set_top, layx_set_right, layx_set_bottom,
+};
+
+static void layx_replay_box_trbl(layx_context *ctx, layx_id item, uint32_t kind, const uint32_t *w)
+{
+    const layx_scalar t = layx_replay_scalar(w[0]), r = layx_replay_scalar(w[1]);
+    const layx_scalar b = layx_replay_scalar(w[2]), l = layx_replay_scalar(w[3]);
+    switch (kind) {
+        case LAYX_BOX_MARGIN: layx_set_margin_trbl(ctx, item, t, r, b, l); break;
+        case LAYX_BOX_PADDING: layx_set_padding_trbl(ctx, item, t, r, b, l); break;
+        default: layx_set_border_trbl(ctx, item, t, r, b, l); break;
+    }
+}
+
+// 创建类调用：返回的 id 与记录不同说明回放的上下文与记录时不一致
+static void layx_replay_expect(layx_replay_cursor *cursor, uint32_t recorded, uint32_t actual)
+{
+    if (recorded != actual) cursor->id_mismatches++;
+}
+
+int layx_replay_step(layx_context *ctx, layx_replay_cursor *cursor)
+{
+    LAYX_ASSERT(ctx != NULL && cursor != NULL);
+    if (cursor->offset + 2 * sizeof(uint32_t) > cursor->size) {
+        return cursor->offset == cursor->size ? LAYX_REC_END : -1;
+    }
+    // 调用日志按 4 字节对齐写入，data 需至少 4 字节对齐（malloc 返回的内存即可）
+    const uint32_t *w = (const uint32_t*)(cursor->data + cursor->offset);
+    const uint32_t op = w[0] & 0xFFFF;
+    const uint32_t nwords = w[0] >> 16;
+    if (cursor->offset + (2 + (size_t)nwords) * sizeof(uint32_t) > cursor->size) return -1;
+    const layx_id item = (layx_id)w[1];
+    const uint32_t *p = w + 2;
+
+    switch (op) {
+        case LAYX_REC_RESERVE: layx_reserve_items_capacity(ctx, (layx_id)p[0]); break;
+        case LAYX_REC_RESET: layx_reset_context(ctx); break;
+        case LAYX_REC_RUN_CONTEXT: layx_run_context(ctx); break;
+        case LAYX_REC_RUN_ITEM: layx_run_item(ctx, item); break;
+        case LAYX_REC_RUN_STEP: layx_run_context_step(ctx, p[0], (uint64_t)p[1] | ((uint64_t)p[2] << 32)); break;
+        case LAYX_REC_RUN_DIRTY: layx_run_dirty(ctx); break;
+        case LAYX_REC_CLEAR_BREAK: layx_clear_item_break(ctx, item); break;
+        case LAYX_REC_CONTAIN: layx_set_contain(ctx, item, p[0] != 0); break;
+        case LAYX_REC_MARK_DIRTY: layx_mark_dirty(ctx, item); break;
+        case LAYX_REC_ITEM: layx_replay_expect(cursor, (uint32_t)item, (uint32_t)layx_item(ctx)); break;
+        case LAYX_REC_APPEND: layx_append(ctx, item, (layx_id)p[0]); break;
+        case LAYX_REC_INSERT_AFTER: layx_insert_after(ctx, item, (layx_id)p[0]); break;
+        case LAYX_REC_PREPEND: layx_prepend(ctx, item, (layx_id)p[0]); break;
+        case LAYX_REC_REMOVE: layx_remove(ctx, item); break;
+        case LAYX_REC_DESTROY: layx_destroy_item(ctx, item); break;
+        case LAYX_REC_CLONE:
+            layx_replay_expect(cursor, (uint32_t)item, (uint32_t)layx_clone_subtree(ctx, (layx_id)p[0]));
+            break;
+        case LAYX_REC_MEMO_CAPACITY: layx_set_memo_capacity(ctx, p[0]); break;
+        case LAYX_REC_CLEAR_MEMO: layx_clear_memo(ctx); break;
+        case LAYX_REC_MEMOIZE: layx_set_memoize(ctx, item, p[0] != 0); break;
+        case LAYX_REC_DISPLAY: layx_set_display(ctx, item, (layx_display)p[0]); break;
+        case LAYX_REC_FLEX_DIRECTION: layx_set_flex_direction(ctx, item, (layx_flex_direction)p[0]); break;
+        case LAYX_REC_FLEX_WRAP: layx_set_flex_wrap(ctx, item, (layx_flex_wrap)p[0]); break;
+        case LAYX_REC_JUSTIFY_CONTENT: layx_set_justify_content(ctx, item, (layx_justify_content)p[0]); break;
+        case LAYX_REC_ALIGN_ITEMS: layx_set_align_items(ctx, item, (layx_align_items)p[0]); break;
+        case LAYX_REC_ALIGN_CONTENT: layx_set_align_content(ctx, item, (layx_align_content)p[0]); break;
+        case LAYX_REC_ALIGN_SELF: layx_set_align_self(ctx, item, (layx_align_self)p[0]); break;
+        case LAYX_REC_WIDTH: layx_set_width(ctx, item, layx_replay_scalar(p[0])); break;
+        case LAYX_REC_HEIGHT: layx_set_height(ctx, item, layx_replay_scalar(p[0])); break;
+        case LAYX_REC_MIN_WIDTH: layx_set_min_width(ctx, item, layx_replay_scalar(p[0])); break;
+        case LAYX_REC_MIN_HEIGHT: layx_set_min_height(ctx, item, layx_replay_scalar(p[0])); break;
+        case LAYX_REC_MAX_WIDTH: layx_set_max_width(ctx, item, layx_replay_scalar(p[0])); break;
+        case LAYX_REC_MAX_HEIGHT: layx_set_max_height(ctx, item, layx_replay_scalar(p[0])); break;
+        case LAYX_REC_FLEX_GROW: layx_set_flex_grow(ctx, item, layx_replay_float(p[0])); break;
+        case LAYX_REC_FLEX_SHRINK: layx_set_flex_shrink(ctx, item, layx_replay_float(p[0])); break;
+        case LAYX_REC_FLEX_BASIS: layx_set_flex_basis(ctx, item, layx_replay_scalar(p[0])); break;
+        case LAYX_REC_ROW_GAP: layx_set_row_gap(ctx, item, layx_replay_scalar(p[0])); break;
+        case LAYX_REC_COLUMN_GAP: layx_set_column_gap(ctx, item, layx_replay_scalar(p[0])); break;
+        case LAYX_REC_POSITION_TYPE: layx_set_position_type(ctx, item, (layx_position_type)p[0]); break;
+        case LAYX_REC_POSITION:
+            layx_set_position(ctx, item, layx_replay_scalar(p[0]), layx_replay_scalar(p[1]),
+                              layx_replay_scalar(p[2]), layx_replay_scalar(p[3]));
+            break;
+        case LAYX_REC_POSITION_LT:
+            layx_set_position_lt(ctx, item, layx_replay_scalar(p[0]), layx_replay_scalar(p[1]));
+            break;
+        case LAYX_REC_POSITION_RB:
+            layx_set_position_rb(ctx, item, layx_replay_scalar(p[0]), layx_replay_scalar(p[1]));
+            break;
+        case LAYX_REC_POSITION_SIDE:
+            if (p[0] > 3) return -1;
+            layx_replay_position_sides[p[0]](ctx, item, layx_replay_scalar(p[1]));
+            break;
+        case LAYX_REC_CLEAR_POSITION: layx_clear_position(ctx, item); break;
+        case LAYX_REC_GRID_COLUMNS:
+        case LAYX_REC_GRID_ROWS: {
+            if ((size_t)p[0] * sizeof(layx_grid_track) > (nwords - 1) * sizeof(uint32_t)) return -1;
+            const layx_grid_track *tracks = (const layx_grid_track*)(p + 1);
+            if (op == LAYX_REC_GRID_COLUMNS) {
+                layx_set_grid_columns(ctx, item, tracks, p[0]);
+            } else {
+                layx_set_grid_rows(ctx, item, tracks, p[0]);
+            }
+            break;
+        }
+        case LAYX_REC_GRID_CELL: layx_set_grid_cell(ctx, item, p[0], p[1]); break;
+        case LAYX_REC_GRID_SPAN: layx_set_grid_span(ctx, item, p[0], p[1]); break;
+        case LAYX_REC_CLEAR_GRID_CELL: layx_clear_grid_cell(ctx, item); break;
+        case LAYX_REC_BOX:
+            if (p[0] > LAYX_BOX_BORDER) return -1;
+            layx_replay_boxes[p[0]](ctx, item, layx_replay_scalar(p[1]));
+            break;
+        case LAYX_REC_BOX_TRBL:
+            if (p[0] > LAYX_BOX_BORDER) return -1;
+            layx_replay_box_trbl(ctx, item, p[0], p + 1);
+            break;
+        case LAYX_REC_BOX_SIDE:
+            if (p[0] > LAYX_BOX_BORDER || p[1] > TRBL_LEFT) return -1;
+            layx_replay_box_sides[p[0]][p[1]](ctx, item, layx_replay_scalar(p[2]));
+            break;
+        case LAYX_REC_INTERN_STYLE:
+        case LAYX_REC_UPDATE_STYLE: {
+            layx_style style;
+            if (sizeof(style) > (nwords - 1) * sizeof(uint32_t)) return -1;
+            memcpy(&style, p + 1, sizeof(style));
+            if (op == LAYX_REC_INTERN_STYLE) {
+                layx_replay_expect(cursor, (uint32_t)item, (uint32_t)layx_intern_style(ctx, &style));
+            } else {
+                layx_update_style(ctx, (layx_style_id)item, &style);
+            }
+            break;
+        }
+        case LAYX_REC_SET_STYLE: layx_set_style(ctx, item, (layx_style_id)p[0]); break;
+        case LAYX_REC_OVERFLOW_X: layx_set_overflow_x(ctx, item, (layx_overflow)p[0]); break;
+        case LAYX_REC_OVERFLOW_Y: layx_set_overflow_y(ctx, item, (layx_overflow)p[0]); break;
+        case LAYX_REC_SCROLL_TO:
+            layx_scroll_to(ctx, item, layx_replay_scalar(p[0]), layx_replay_scalar(p[1]));
+            break;
+        case LAYX_REC_SHRINK: layx_shrink_to_fit(ctx); break;
+        default:
+            return -1;
+    }
+    cursor->offset += (2 + (size_t)nwords) * sizeof(uint32_t);
+    cursor->calls++;
+    return (int)op;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file layx_replay.c
+ * @brief 回放 API 调用日志（见 layx_record_begin）并计时，用于离线复现性能问题
+ *
+ * 用法：layx_replay <日志文件> [轮数]
+ * 每轮在新的上下文中执行整个日志，布局调用（run_*）与其余修改调用分开计时。
+ * 日志的标量类型与 id 位数须与链接的库一致。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "layx.h"
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void *read_file(const char *path, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+    fseek(file, 0, SEEK_END);
+    const long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    // malloc 的内存满足日志的 4 字节对齐要求
+    void *data = malloc(length > 0 ? (size_t)length : 1);
+    *size = fread(data, 1, (size_t)length, file);
+    fclose(file);
+    return data;
+}
+
+static bool is_run_op(int op)
+{
+    return op == LAYX_REC_RUN_CONTEXT || op == LAYX_REC_RUN_ITEM ||
+           op == LAYX_REC_RUN_STEP || op == LAYX_REC_RUN_DIRTY;
+}
+
+typedef struct replay_round {
+    uint64_t run_ns;
+    uint64_t mutate_ns;
+    uint64_t runs;
+    uint64_t calls;
+    uint64_t id_mismatches;
+    layx_id items;
+} replay_round;
+
+// 执行一轮；日志损坏返回 false
+static bool replay_once(const void *data, size_t size, replay_round *round)
+{
+    memset(round, 0, sizeof(replay_round));
+    layx_replay_cursor cursor;
+    layx_replay_open(&cursor, data, size);
+    layx_context ctx;
+    layx_init_context(&ctx);
+
+    bool ok = true;
+    for (;;) {
+        const uint64_t start = bench_now_ns();
+        const int op = layx_replay_step(&ctx, &cursor);
+        const uint64_t elapsed = bench_now_ns() - start;
+        if (op <= LAYX_REC_END) {
+            ok = op == LAYX_REC_END;
+            break;
+        }
+        if (is_run_op(op)) {
+            round->run_ns += elapsed;
+            round->runs++;
+        } else {
+            round->mutate_ns += elapsed;
+        }
+    }
+    round->calls = cursor.calls;
+    round->id_mismatches = cursor.id_mismatches;
+    round->items = layx_items_count(&ctx);
+    layx_destroy_context(&ctx);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <log> [rounds]\n", argv[0]);
+        return 2;
+    }
+    const int rounds = argc > 2 ? atoi(argv[2]) : 20;
+
+    size_t size = 0;
+    void *data = read_file(argv[1], &size);
+    if (data == NULL) {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+    layx_replay_cursor cursor;
+    const int status = layx_replay_open(&cursor, data, size);
+    if (status != 0) {
+        fprintf(stderr, status == -2 ? "log was recorded with a different scalar type or id width\n"
+                                     : "not a layx call log\n");
+        free(data);
+        return 1;
+    }
+
+    replay_round round;
+    if (!replay_once(data, size, &round)) {     // 预热，同时检查日志完整
+        fprintf(stderr, "log is corrupt after %llu calls\n", (unsigned long long)round.calls);
+        free(data);
+        return 1;
+    }
+    uint64_t best_run = UINT64_MAX, best_total = UINT64_MAX, run_total = 0, all_total = 0;
+    for (int r = 0; r < rounds; r++) {
+        replay_once(data, size, &round);
+        const uint64_t total = round.run_ns + round.mutate_ns;
+        run_total += round.run_ns;
+        all_total += total;
+        if (round.run_ns < best_run) best_run = round.run_ns;
+        if (total < best_total) best_total = total;
+    }
+
+    printf("scalar: %s, id: %d bits\n", LAYX_FLOAT == 1 ? "float" : "int16", LAYX_ID_BITS);
+    printf("log: %.1f KiB, %llu calls, %llu layout runs, %u items at end\n", (double)size / 1024.0,
+           (unsigned long long)round.calls, (unsigned long long)round.runs, (unsigned)round.items);
+    if (round.id_mismatches > 0) {
+        printf("warning: %llu created ids differ from the recording\n", (unsigned long long)round.id_mismatches);
+    }
+    if (rounds > 0) {
+        printf("layout: best %.3f ms, mean %.3f ms\n", (double)best_run / 1e6, (double)run_total / rounds / 1e6);
+        printf("replay: best %.3f ms, mean %.3f ms (%d rounds)\n",
+               (double)best_total / 1e6, (double)all_total / rounds / 1e6, rounds);
+    }
+
+    free(data);
+    return 0;
+}
@@ -0,0 +1,327 @@
+#include "layx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LAYX_SNAPSHOT_HAVE_MMAP 1
+#else
+#define LAYX_SNAPSHOT_HAVE_MMAP 0
+#endif
+
+#ifndef LAYX_REALLOC
+#define LAYX_REALLOC(_block, _size) realloc(_block, _size)
+#define LAYX_FREE(_block) free(_block)
+#endif
+
+#define LAYX_SNAPSHOT_BYTE_ORDER 0x0102
+
+typedef struct layx_snapshot_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint8_t scalar_type;
+    uint8_t id_bits;
+    uint16_t byte_order;
+    uint32_t item_size;
+    uint32_t count;
+    uint32_t free_list_head;
+    uint32_t box_count;
+    uint32_t grid_count;
+    uint32_t grid_size;
+    uint8_t reserved[28];
+} layx_snapshot_header;
+
+// grid 记录跟在盒模型记录之后，按 item 顺序逐条写入：
+// owner、列数、行数，随后是列与行的 layx_grid_track
+typedef struct layx_snapshot_grid {
+    uint32_t owner;
+    uint32_t track_count[2];
+} layx_snapshot_grid;
+
+static uint8_t layx_snapshot_scalar_type(void)
+{
+#if LAYX_FLOAT == 1
+    return LAYX_SNAPSHOT_SCALAR_FLOAT32;
+#else
+    return LAYX_SNAPSHOT_SCALAR_INT16;
+#endif
+}
+
+// 释放快照存储，items/rects 由调用者负责置空或替换
+void layx_snapshot_release(layx_context *ctx)
+{
+    switch (ctx->storage_kind) {
+#if LAYX_SNAPSHOT_HAVE_MMAP
+        case LAYX_STORAGE_MAPPED:
+            munmap(ctx->storage_base, ctx->storage_size);
+            break;
+#endif
+        case LAYX_STORAGE_HEAP:
+            LAYX_FREE(ctx->storage_base);
+            break;
+        default:
+            break;
+    }
+    ctx->storage_kind = LAYX_STORAGE_OWNED;
+    ctx->storage_base = NULL;
+    ctx->storage_size = 0;
+}
+
+// 每个带盒模型的 item 一条记录（与样式共享的记录也各写一份）加上保留的 0 号记录
+static uint32_t layx_snapshot_box_count(const layx_context *ctx)
+{
+    uint32_t count = 1;
+    for (layx_id i = 0; i < ctx->count; ++i) {
+        if (ctx->items[i].box_mask != 0) ++count;
+    }
+    return count;
+}
+
+// 使用中的 grid 记录写入后占用的字节数
+static size_t layx_snapshot_grid_size(const layx_context *ctx, uint32_t *grid_count)
+{
+    size_t size = 0;
+    uint32_t count = 0;
+    for (uint32_t i = 1; i < ctx->grids.count; ++i) {
+        const layx_grid *grid = ctx->grids.records + i;
+        if (grid->owner == LAYX_INVALID_ID) continue;
+        size += sizeof(layx_snapshot_grid) + (size_t)(grid->track_count[0] + grid->track_count[1]) * sizeof(layx_grid_track);
+        ++count;
+    }
+    if (grid_count != NULL) *grid_count = count;
+    return size;
+}
+
+size_t layx_snapshot_size(const layx_context *ctx)
+{
+    LAYX_ASSERT(ctx != NULL);
+    return LAYX_SNAPSHOT_HEADER_SIZE + (size_t)ctx->count * (sizeof(layx_item_t) + sizeof(layx_vec4)) +
+           (size_t)layx_snapshot_box_count(ctx) * sizeof(layx_box) + layx_snapshot_grid_size(ctx, NULL);
+}
+
+size_t layx_write_snapshot(const layx_context *ctx, void *buffer, size_t capacity)
+{
+    LAYX_ASSERT(ctx != NULL && buffer != NULL);
+    const size_t size = layx_snapshot_size(ctx);
+    if (capacity < size) return 0;
+
+    layx_snapshot_header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = LAYX_SNAPSHOT_MAGIC;
+    header.version = LAYX_SNAPSHOT_VERSION;
+    header.header_size = LAYX_SNAPSHOT_HEADER_SIZE;
+    header.scalar_type = layx_snapshot_scalar_type();
+    header.id_bits = (uint8_t)(sizeof(layx_id) * 8);
+    header.byte_order = LAYX_SNAPSHOT_BYTE_ORDER;
+    header.item_size = (uint32_t)sizeof(layx_item_t);
+    header.count = (uint32_t)ctx->count;
+    header.free_list_head = (uint32_t)ctx->free_list_head;
+    header.box_count = layx_snapshot_box_count(ctx);
+    header.grid_size = (uint32_t)layx_snapshot_grid_size(ctx, &header.grid_count);
+
+    uint8_t *out = (uint8_t*)buffer;
+    memcpy(out, &header, sizeof(header));
+
+    layx_item_t *items = (layx_item_t*)(out + LAYX_SNAPSHOT_HEADER_SIZE);
+    memcpy(items, ctx->items, ctx->count * sizeof(layx_item_t));
+    memcpy(items + ctx->count, ctx->rects, ctx->count * sizeof(layx_vec4));
+
+    // 盒模型记录紧跟在 rects 之后，不保证对齐，逐条 memcpy
+    uint8_t *boxes = out + LAYX_SNAPSHOT_HEADER_SIZE + (size_t)ctx->count * (sizeof(layx_item_t) + sizeof(layx_vec4));
+    memset(boxes, 0, sizeof(layx_box));
+    uint32_t box_count = 1;
+    uint8_t *grids = boxes + (size_t)header.box_count * sizeof(layx_box);
+    uint32_t grid_count = 0;
+
+    // 指针在另一个进程中无意义
+    for (layx_id i = 0; i < ctx->count; ++i) {
+        items[i].measure_text_fn = NULL;
+        items[i].measure_text_user_data = NULL;
+        items[i].user_data = NULL;
+        items[i].style_id = LAYX_NO_STYLE;
+        items[i].style_overrides = 0;
+        items[i].memo = 0;
+        items[i].observer = 0;
+        items[i].line_first = 0;    // flex 行在加载后的布局中重新记录
+        items[i].line_count = 0;
+        // 空闲记录不写入，使用中的记录按 item 顺序重新编号
+        if (items[i].box_mask != 0) {
+            memcpy(boxes + (size_t)box_count * sizeof(layx_box), ctx->boxes.records + items[i].box, sizeof(layx_box));
+            items[i].box = box_count++;
+        }
+        // grid 记录同样按 item 顺序重新编号，轨道定义紧跟在记录之后
+        if (items[i].grid != 0) {
+            const layx_grid *grid = ctx->grids.records + items[i].grid;
+            const layx_snapshot_grid record = { (uint32_t)i, { grid->track_count[0], grid->track_count[1] } };
+            memcpy(grids, &record, sizeof(record));
+            grids += sizeof(record);
+            for (int dim = 0; dim < 2; ++dim) {
+                const size_t bytes = grid->track_count[dim] * sizeof(layx_grid_track);
+                if (bytes > 0) memcpy(grids, grid->tracks[dim], bytes);
+                grids += bytes;
+            }
+            items[i].grid = ++grid_count;
+        }
+    }
+    LAYX_ASSERT(box_count == header.box_count && grid_count == header.grid_count);
+    LAYX_ASSERT(grids == out + size);
+    return size;
+}
+
+int layx_save_snapshot(const layx_context *ctx, const char *path)
+{
+    LAYX_ASSERT(ctx != NULL && path != NULL);
+    const size_t size = layx_snapshot_size(ctx);
+    void *buffer = LAYX_REALLOC(NULL, size);
+    if (buffer == NULL) return -1;
+    layx_write_snapshot(ctx, buffer, size);
+
+    int result = -1;
+    FILE *file = fopen(path, "wb");
+    if (file != NULL) {
+        if (fwrite(buffer, 1, size, file) == size) result = 0;
+        if (fclose(file) != 0) result = -1;
+    }
+    LAYX_FREE(buffer);
+    return result;
+}
+
+static int layx_snapshot_validate(const void *buffer, size_t size, layx_snapshot_header *header)
+{
+    if (buffer == NULL || size < LAYX_SNAPSHOT_HEADER_SIZE) return -1;
+    memcpy(header, buffer, sizeof(*header));
+    if (header->magic != LAYX_SNAPSHOT_MAGIC ||
+        header->version != LAYX_SNAPSHOT_VERSION ||
+        header->header_size != LAYX_SNAPSHOT_HEADER_SIZE ||
+        header->scalar_type != layx_snapshot_scalar_type() ||
+        header->id_bits != sizeof(layx_id) * 8 ||
+        header->byte_order != LAYX_SNAPSHOT_BYTE_ORDER ||
+        header->item_size != sizeof(layx_item_t)) {
+        return -1;
+    }
+    const uint64_t grids = LAYX_SNAPSHOT_HEADER_SIZE +
+                           (uint64_t)header->count * (sizeof(layx_item_t) + sizeof(layx_vec4)) +
+                           (uint64_t)header->box_count * sizeof(layx_box);
+    if (header->box_count < 1 || grids + header->grid_size > size) return -1;
+
+    // grid 记录的长度可变，逐条检查不越界、owner 存在且引用的正是这条记录
+    const uint8_t *base = (const uint8_t*)buffer;
+    const layx_item_t *items = (const layx_item_t*)(base + LAYX_SNAPSHOT_HEADER_SIZE);
+    uint64_t offset = 0;
+    for (uint32_t k = 1; k <= header->grid_count; ++k) {
+        layx_snapshot_grid record;
+        if (offset + sizeof(record) > header->grid_size) return -1;
+        memcpy(&record, base + grids + offset, sizeof(record));
+        offset += sizeof(record) + ((uint64_t)record.track_count[0] + record.track_count[1]) * sizeof(layx_grid_track);
+        if (offset > header->grid_size || record.owner >= header->count || items[record.owner].grid != k) return -1;
+    }
+    return offset == header->grid_size ? 0 : -1;
+}
+
+extern void layx_clear_tree_state(layx_context *ctx);
+extern void layx_grid_restore(layx_context *ctx, uint32_t index, layx_id owner,
+                              const layx_grid_track *const tracks[2], const uint32_t counts[2]);
+
+// 让上下文直接使用快照内存，不复制也不逐项修正
+static int layx_snapshot_attach(layx_context *ctx, void *buffer, size_t size, uint8_t kind)
+{
+    layx_snapshot_header header;
+    if (layx_snapshot_validate(buffer, size, &header) != 0) return -1;
+
+    if (ctx->storage_kind != LAYX_STORAGE_OWNED) {
+        layx_snapshot_release(ctx);
+    } else if (ctx->items != NULL) {
+        LAYX_FREE(ctx->items);
+    }
+
+    layx_item_t *items = (layx_item_t*)((uint8_t*)buffer + LAYX_SNAPSHOT_HEADER_SIZE);
+    ctx->items = items;
+    ctx->rects = (layx_vec4*)(items + header.count);
+    ctx->count = (layx_id)header.count;
+    ctx->capacity = (layx_id)header.count;
+    ctx->free_list_head = (layx_id)header.free_list_head;
+    ctx->storage_kind = kind;
+    ctx->storage_base = buffer;
+    ctx->storage_size = size;
+    // 上一棵树登记的脏边界、未完成的分步布局等引用旧的 id，一并清除；
+    // 快照中的 item 不引用共享样式与缓存记录，也没有观察记录
+    layx_clear_tree_state(ctx);
+    // 盒模型记录复制到上下文自有的表中，之后的修改不需要扩容映射内存
+    layx_box_table *table = &ctx->boxes;
+    if (header.box_count > table->capacity) {
+        table->records = (layx_box*)LAYX_REALLOC(table->records, header.box_count * sizeof(layx_box));
+        table->capacity = header.box_count;
+    }
+    const uint8_t *boxes = (const uint8_t*)(ctx->rects + header.count);
+    memcpy(table->records, boxes, header.box_count * sizeof(layx_box));
+    table->count = header.box_count;
+    // grid 轨道定义同样复制出来，item->grid 已在保存时按记录顺序编号
+    const uint8_t *grids = boxes + (size_t)header.box_count * sizeof(layx_box);
+    for (uint32_t k = 1; k <= header.grid_count; ++k) {
+        layx_snapshot_grid record;
+        memcpy(&record, grids, sizeof(record));
+        grids += sizeof(record);
+        const layx_grid_track *tracks[2] = {
+            (const layx_grid_track*)grids,
+            (const layx_grid_track*)grids + record.track_count[0]
+        };
+        layx_grid_restore(ctx, k, (layx_id)record.owner, tracks, record.track_count);
+        grids += (size_t)(record.track_count[0] + record.track_count[1]) * sizeof(layx_grid_track);
+    }
+    return 0;
+}
+
+int layx_load_snapshot_buffer(layx_context *ctx, void *buffer, size_t size)
+{
+    LAYX_ASSERT(ctx != NULL);
+    LAYX_ASSERT(((uintptr_t)buffer & 15) == 0);
+    return layx_snapshot_attach(ctx, buffer, size, LAYX_STORAGE_EXTERNAL);
+}
+
+int layx_load_snapshot(layx_context *ctx, const char *path)
+{
+    LAYX_ASSERT(ctx != NULL && path != NULL);
+#if LAYX_SNAPSHOT_HAVE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < LAYX_SNAPSHOT_HEADER_SIZE) {
+        close(fd);
+        return -1;
+    }
+    // MAP_PRIVATE：布局写入 rects 时按页写时复制，文件本身保持不变
+    const size_t size = (size_t)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+    if (layx_snapshot_attach(ctx, base, size, LAYX_STORAGE_MAPPED) != 0) {
+        munmap(base, size);
+        return -1;
+    }
+    return 0;
+#else
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return -1;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (length < LAYX_SNAPSHOT_HEADER_SIZE) {
+        fclose(file);
+        return -1;
+    }
+    const size_t size = (size_t)length;
+    void *base = LAYX_REALLOC(NULL, size);
+    size_t read = base ? fread(base, 1, size, file) : 0;
+    fclose(file);
+    if (read != size || layx_snapshot_attach(ctx, base, size, LAYX_STORAGE_HEAP) != 0) {
+        LAYX_FREE(base);
+        return -1;
+    }
+    return 0;
+#endif
+}
@@ -0,0 +1,230 @@
+#include "layx.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef LAYX_REALLOC
+#define LAYX_REALLOC(_block, _size) realloc(_block, _size)
+#define LAYX_FREE(_block) free(_block)
+#endif
+
+// 标签最多取 64 个字符，每个字符转义后最多 6 字节（\u00XX）；
+// 一条 span 写两次标签，其余字段不超过 256 字节。缓冲区剩余空间不足一条事件时写出
+#define LAYX_TRACE_BUFFER_SIZE 8192
+#define LAYX_TRACE_TAG_MAX     64
+#define LAYX_TRACE_TAG_ESCAPED (LAYX_TRACE_TAG_MAX * 6)
+#define LAYX_TRACE_EVENT_MAX   (2 * LAYX_TRACE_TAG_ESCAPED + 256)
+
+typedef struct layx_tracer {
+    layx_trace_write_fn write;
+    void *user_data;
+    FILE *file;
+    layx_trace_tag_fn tag;
+    uint64_t threshold_ns;
+    uint64_t origin_ns;         // ts 以开始记录的时刻为 0
+    uint64_t spans;             // 写出的容器 span 数量
+    // 每个 item 的子树开始时刻，按 id 索引；遍历不使用栈，span 的起点记在这里
+    uint64_t *begin;
+    layx_id begin_capacity;
+    size_t length;
+    char buffer[LAYX_TRACE_BUFFER_SIZE];
+} layx_tracer;
+
+static const char *const layx_trace_phase_names[] = {
+    "idle", "calc_x", "arrange_x", "calc_y", "arrange_y", "scroll"
+};
+
+static const char *const layx_trace_display_names[] = {
+    "none", "block", "flex", "inline", "inline-block", "grid"
+};
+
+uint64_t layx_trace_clock(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void layx_trace_flush(layx_tracer *tracer)
+{
+    if (tracer->length == 0) return;
+    if (tracer->file != NULL) {
+        fwrite(tracer->buffer, 1, tracer->length, tracer->file);
+    } else {
+        tracer->write(tracer->user_data, tracer->buffer, tracer->length);
+    }
+    tracer->length = 0;
+}
+
+// 保证缓冲区能容纳一条事件
+static char *layx_trace_reserve_event(layx_tracer *tracer)
+{
+    if (LAYX_TRACE_BUFFER_SIZE - tracer->length < LAYX_TRACE_EVENT_MAX) {
+        layx_trace_flush(tracer);
+    }
+    return tracer->buffer + tracer->length;
+}
+
+static void layx_trace_puts(layx_tracer *tracer, const char *text)
+{
+    const size_t size = strlen(text);
+    layx_trace_reserve_event(tracer);
+    memcpy(tracer->buffer + tracer->length, text, size);
+    tracer->length += size;
+}
+
+// 写入 JSON 字符串内容（不含引号），过长的标签被截断
+static size_t layx_trace_escape(char *out, const char *text)
+{
+    size_t n = 0;
+    for (int i = 0; text[i] != '\0' && i < LAYX_TRACE_TAG_MAX; ++i) {
+        const unsigned char c = (unsigned char)text[i];
+        if (c == '"' || c == '\\') {
+            out[n++] = '\\';
+            out[n++] = (char)c;
+        } else if (c < 0x20) {
+            n += (size_t)sprintf(out + n, "\\u%04x", c);
+        } else {
+            out[n++] = (char)c;
+        }
+    }
+    out[n] = '\0';
+    return n;
+}
+
+static double layx_trace_us(const layx_tracer *tracer, uint64_t ns)
+{
+    return (double)(ns - tracer->origin_ns) / 1000.0;
+}
+
+static void layx_trace_span(layx_context *ctx, layx_id item, int phase, uint64_t start, uint64_t end)
+{
+    layx_tracer *tracer = ctx->tracer;
+    if (end - start < tracer->threshold_ns) return;
+    tracer->spans++;
+
+    const layx_item_t *pitem = ctx->items + item;
+    uint32_t children = 0;
+    for (layx_id child = pitem->first_child; child != LAYX_INVALID_ID; child = ctx->items[child].next_sibling) {
+        ++children;
+    }
+    const char *display = layx_trace_display_names[layx_get_display_from_flags(pitem->flags)];
+    char tag[LAYX_TRACE_TAG_ESCAPED + 1];
+    tag[0] = '\0';
+    if (tracer->tag != NULL) {
+        const char *text = tracer->tag(tracer->user_data, item);
+        if (text != NULL) layx_trace_escape(tag, text);
+    }
+
+    char *out = layx_trace_reserve_event(tracer);
+    const int n = snprintf(out, LAYX_TRACE_EVENT_MAX,
+        ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1,"
+        "\"args\":{\"id\":%u,\"display\":\"%s\",\"children\":%u,\"tag\":\"%s\"}}",
+        tag[0] != '\0' ? tag : display, layx_trace_phase_names[phase],
+        layx_trace_us(tracer, start), (double)(end - start) / 1000.0,
+        (unsigned)item, display, (unsigned)children, tag);
+    // 截断的事件会让整个文件不是合法的 JSON
+    LAYX_ASSERT(n > 0 && n < LAYX_TRACE_EVENT_MAX);
+    tracer->length += (size_t)n;
+}
+
+void layx_trace_reserve(layx_context *ctx)
+{
+    layx_tracer *tracer = ctx->tracer;
+    if (ctx->capacity <= tracer->begin_capacity) return;
+    tracer->begin = (uint64_t*)LAYX_REALLOC(tracer->begin, ctx->capacity * sizeof(uint64_t));
+    tracer->begin_capacity = ctx->capacity;
+}
+
+// 一个阶段（或分步布局中阶段的一段）结束
+void layx_trace_phase(layx_context *ctx, int phase, uint64_t start)
+{
+    layx_tracer *tracer = ctx->tracer;
+    const uint64_t end = layx_trace_clock();
+    char *out = layx_trace_reserve_event(tracer);
+    tracer->length += (size_t)snprintf(out, LAYX_TRACE_EVENT_MAX,
+        ",\n{\"name\":\"%s\",\"cat\":\"phase\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+        layx_trace_phase_names[phase], layx_trace_us(tracer, start), (double)(end - start) / 1000.0);
+}
+
+// 后序遍历处理完 item 后调用：容器的子树从第一个子元素的子树开始，到自身计算完成为止。
+// descended 为 false 时遍历没有进入后代（叶子或缓存根），子树从 start 开始
+void layx_trace_post(layx_context *ctx, layx_id item, int phase, uint64_t start, bool descended)
+{
+    layx_tracer *tracer = ctx->tracer;
+    const layx_item_t *pitem = ctx->items + item;
+    if (descended) start = tracer->begin[pitem->first_child];
+    tracer->begin[item] = start;
+    if (pitem->first_child != LAYX_INVALID_ID) {
+        layx_trace_span(ctx, item, phase, start, layx_trace_clock());
+    }
+}
+
+// 先序遍历处理完 item 后调用：子树从 item 自身开始；遍历不再进入后代时，
+// 沿父链向上结束所有以 item 为最后一个后代的容器，与 layx_pre_order_skip 的回溯一致
+void layx_trace_pre(layx_context *ctx, layx_id root, layx_id item, int phase, uint64_t start, bool descended)
+{
+    layx_tracer *tracer = ctx->tracer;
+    tracer->begin[item] = start;
+    if (descended) return;
+    const uint64_t end = layx_trace_clock();
+    for (;;) {
+        const layx_item_t *pitem = ctx->items + item;
+        if (pitem->first_child != LAYX_INVALID_ID) {
+            layx_trace_span(ctx, item, phase, tracer->begin[item], end);
+        }
+        if (item == root || pitem->next_sibling != LAYX_INVALID_ID) break;
+        item = pitem->parent;
+    }
+}
+
+int layx_trace_begin(layx_context *ctx, const layx_trace_config *config)
+{
+    LAYX_ASSERT(ctx != NULL && config != NULL);
+    LAYX_ASSERT(config->write != NULL || config->path != NULL);
+    if (ctx->tracer != NULL) layx_trace_end(ctx);
+
+    FILE *file = NULL;
+    if (config->write == NULL) {
+        file = fopen(config->path, "wb");
+        if (file == NULL) return -1;
+    }
+    layx_tracer *tracer = (layx_tracer*)LAYX_REALLOC(NULL, sizeof(layx_tracer));
+    memset(tracer, 0, offsetof(layx_tracer, buffer));
+    tracer->write = config->write;
+    tracer->user_data = config->user_data;
+    tracer->file = file;
+    tracer->tag = config->tag;
+    tracer->threshold_ns = config->threshold_ns;
+    tracer->origin_ns = layx_trace_clock();
+    ctx->tracer = tracer;
+    layx_trace_reserve(ctx);
+
+    // 第一条是元数据事件，之后的事件都以逗号开头
+    layx_trace_puts(tracer, "{\"traceEvents\":[\n"
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"layx\"}}");
+    return 0;
+}
+
+uint64_t layx_trace_end(layx_context *ctx)
+{
+    LAYX_ASSERT(ctx != NULL);
+    layx_tracer *tracer = ctx->tracer;
+    if (tracer == NULL) return 0;
+    layx_trace_puts(tracer, "\n]}\n");
+    layx_trace_flush(tracer);
+    if (tracer->file != NULL) fclose(tracer->file);
+    const uint64_t spans = tracer->spans;
+    LAYX_FREE(tracer->begin);
+    LAYX_FREE(tracer);
+    ctx->tracer = NULL;
+    return spans;
+}
+
+bool layx_trace_active(const layx_context *ctx)
+{
+    LAYX_ASSERT(ctx != NULL);
+    return ctx->tracer != NULL;
+}
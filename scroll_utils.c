@@ -32,13 +32,25 @@ void layx_init_scroll_fields(layx_context *ctx, layx_id item) {
 // 设置overflow属性
 void layx_set_overflow_x(layx_context *ctx, layx_id item, layx_overflow overflow) {
     LAYX_ASSERT(ctx != NULL && item != LAYX_INVALID_ID);
+    LAYX_RECORD_CALL(ctx, LAYX_REC_OVERFLOW_X, item, (uint32_t)overflow);
     layx_item_t *pitem = layx_get_item(ctx, item);
+    if (pitem->overflow_x == overflow) return;
+    // overflow 决定 item 是否为布局边界，先按修改前的状态标脏，与 layx_set_contain 相同
+    LAYX_RECORD_MUTE(ctx, 1);
+    layx_mark_dirty(ctx, item);
+    LAYX_RECORD_MUTE(ctx, -1);
     pitem->overflow_x = overflow;
 }
 
 void layx_set_overflow_y(layx_context *ctx, layx_id item, layx_overflow overflow) {
     LAYX_ASSERT(ctx != NULL && item != LAYX_INVALID_ID);
+    LAYX_RECORD_CALL(ctx, LAYX_REC_OVERFLOW_Y, item, (uint32_t)overflow);
     layx_item_t *pitem = layx_get_item(ctx, item);
+    if (pitem->overflow_y == overflow) return;
+    // overflow 决定 item 是否为布局边界，先按修改前的状态标脏，与 layx_set_contain 相同
+    LAYX_RECORD_MUTE(ctx, 1);
+    layx_mark_dirty(ctx, item);
+    LAYX_RECORD_MUTE(ctx, -1);
     pitem->overflow_y = overflow;
 }
 
@@ -58,9 +70,12 @@ const char* layx_get_overflow_string(layx_overflow overflow) {
     }
 }
 
+extern void layx_frames_touch(layx_context *ctx, layx_id item, bool subtree);
+
 // 滚动操作函数
 void layx_scroll_to(layx_context *ctx, layx_id item, layx_scalar x, layx_scalar y) {
     LAYX_ASSERT(ctx != NULL && item != LAYX_INVALID_ID);
+    LAYX_RECORD_CALL(ctx, LAYX_REC_SCROLL_TO, item, layx_record_scalar(x), layx_record_scalar(y));
     layx_item_t *pitem = layx_get_item(ctx, item);
     
     pitem->scroll_offset[0] = x;
@@ -71,6 +86,9 @@ void layx_scroll_to(layx_context *ctx, layx_id item, layx_scalar x, layx_scalar
     if (pitem->scroll_offset[1] < 0.0f) pitem->scroll_offset[1] = 0.0f;
     if (pitem->scroll_offset[0] > pitem->scroll_max[0]) pitem->scroll_offset[0] = pitem->scroll_max[0];
     if (pitem->scroll_offset[1] > pitem->scroll_max[1]) pitem->scroll_offset[1] = pitem->scroll_max[1];
+    if (ctx->frames.enabled) {
+        layx_frames_touch(ctx, item, false);
+    }
 }
 
 void layx_scroll_by(layx_context *ctx, layx_id item, layx_scalar dx, layx_scalar dy) {
@@ -89,12 +107,14 @@ void layx_get_visible_content_rect(layx_context *ctx, layx_id item,
     LAYX_ASSERT(ctx != NULL && item != LAYX_INVALID_ID);
     layx_item_t *pitem = layx_get_item(ctx, item);
     
+    const layx_vec4 padding = layx_item_box(ctx, pitem, LAYX_BOX_PADDING);
+    const layx_vec4 border = layx_item_box(ctx, pitem, LAYX_BOX_BORDER);
     layx_scalar client_width = pitem->size[0] - 
-                               pitem->padding_trbl[TRBL_LEFT] - pitem->padding_trbl[TRBL_RIGHT] -
-                               pitem->border_trbl[TRBL_LEFT] - pitem->border_trbl[TRBL_RIGHT];
+                               padding[TRBL_LEFT] - padding[TRBL_RIGHT] -
+                               border[TRBL_LEFT] - border[TRBL_RIGHT];
     layx_scalar client_height = pitem->size[1] - 
-                                pitem->padding_trbl[TRBL_TOP] - pitem->padding_trbl[TRBL_BOTTOM] -
-                                pitem->border_trbl[TRBL_TOP] - pitem->border_trbl[TRBL_BOTTOM];
+                                padding[TRBL_TOP] - padding[TRBL_BOTTOM] -
+                                border[TRBL_TOP] - border[TRBL_BOTTOM];
     
     *visible_left = pitem->scroll_offset[0];
     *visible_top = pitem->scroll_offset[1];
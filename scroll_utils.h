@@ -1,10 +1,8 @@
 #ifndef SCROLL_UTILS_H
 #define SCROLL_UTILS_H
 
-// 前向声明，避免包含layx.h
-struct layx_context;
-typedef unsigned int layx_id;
-typedef float layx_scalar;
+// layx_id 的位宽由 LAYX_ID_BITS 决定，直接使用 layx.h 中的定义
+#include "layx.h"
 
 // 辅助函数声明
 int layx_has_vertical_scrollbar(struct layx_context *ctx, layx_id item);
@@ -0,0 +1,192 @@
+/**
+ * @file test_absolute.c
+ * @brief 测试绝对定位与布局边界
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+static bool rect_is(layx_context *ctx, layx_id item, float x, float y, float w, float h)
+{
+    layx_vec4 r = layx_get_rect(ctx, item);
+    return FLOAT_EQUAL(r[0], x, 0.01f) && FLOAT_EQUAL(r[1], y, 0.01f)
+        && FLOAT_EQUAL(r[2], w, 0.01f) && FLOAT_EQUAL(r[3], h, 0.01f);
+}
+
+void test_out_of_flow() {
+    printf("\n=== Test: absolute items are out of flow ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_size(&ctx, root, 300, 100);     // content-box，border-box 为 320x120
+    layx_set_border(&ctx, root, 2);
+    layx_set_padding(&ctx, root, 8);
+
+    layx_id a = layx_item(&ctx);
+    layx_set_size(&ctx, a, 50, 20);
+    layx_append(&ctx, root, a);
+    layx_id overlay = layx_item(&ctx);
+    layx_set_position_type(&ctx, overlay, LAYX_POSITION_ABSOLUTE);
+    layx_set_size(&ctx, overlay, 40, 30);
+    layx_set_position_lt(&ctx, overlay, 5, 6);
+    layx_append(&ctx, root, overlay);
+    layx_id b = layx_item(&ctx);
+    layx_set_size(&ctx, b, 50, 20);
+    layx_append(&ctx, root, b);
+    layx_run_context(&ctx);
+
+    TEST_ASSERT(rect_is(&ctx, a, 10, 10, 50, 20) && rect_is(&ctx, b, 60, 10, 50, 20), "兄弟元素按没有 overlay 时排列");
+    TEST_ASSERT(rect_is(&ctx, overlay, 7, 8, 40, 30), "left/top 相对父元素 padding-box");
+
+    // right/bottom 从包含块的另一侧定位
+    layx_clear_position(&ctx, overlay);
+    layx_set_position_rb(&ctx, overlay, 10, 4);
+    layx_run_context(&ctx);
+    TEST_ASSERT(rect_is(&ctx, overlay, 318 - 10 - 40, 118 - 4 - 30, 40, 30), "right/bottom 定位");
+
+    // 同时设置两侧且未固定尺寸时拉伸
+    layx_id fill = layx_item(&ctx);
+    layx_set_position_type(&ctx, fill, LAYX_POSITION_ABSOLUTE);
+    layx_set_position(&ctx, fill, 0, 0, 0, 0);
+    layx_set_margin(&ctx, fill, 1);
+    layx_append(&ctx, root, fill);
+    layx_run_context(&ctx);
+    TEST_ASSERT(rect_is(&ctx, fill, 3, 3, 314, 114), "四边为 0 时铺满 padding-box");
+
+    // 内容尺寸不受绝对定位子元素影响
+    layx_id block = layx_item(&ctx);
+    layx_set_display(&ctx, block, LAYX_DISPLAY_BLOCK);
+    layx_set_width(&ctx, block, 100);
+    layx_append(&ctx, root, block);
+    layx_id inflow = layx_item(&ctx);
+    layx_set_height(&ctx, inflow, 15);
+    layx_append(&ctx, block, inflow);
+    layx_id tall = layx_item(&ctx);
+    layx_set_position_type(&ctx, tall, LAYX_POSITION_ABSOLUTE);
+    layx_set_size(&ctx, tall, 20, 500);
+    layx_append(&ctx, block, tall);
+    layx_set_align_items(&ctx, root, LAYX_ALIGN_ITEMS_FLEX_START);
+    layx_run_context(&ctx);
+    TEST_ASSERT(FLOAT_EQUAL(layx_get_rect(&ctx, block)[3], 15, 0.01f), "父元素高度只包含流内子元素");
+    TEST_ASSERT(layx_get_position_type(&ctx, tall) == LAYX_POSITION_ABSOLUTE, "读取 position 类型");
+
+    layx_destroy_context(&ctx);
+}
+
+// 根 + 内容区 + 一个带子元素的弹出层
+static layx_id build_page(layx_context *ctx, layx_scalar popup_row_height)
+{
+    layx_id root = layx_item(ctx);
+    layx_set_display(ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(ctx, root, 400);
+    for (int i = 0; i < 10; i++) {
+        layx_id row = layx_item(ctx);
+        layx_set_height(ctx, row, 30);
+        layx_append(ctx, root, row);
+    }
+    layx_id popup = layx_item(ctx);
+    layx_set_position_type(ctx, popup, LAYX_POSITION_ABSOLUTE);
+    layx_set_display(ctx, popup, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(ctx, popup, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_width(ctx, popup, 120);
+    layx_set_position_lt(ctx, popup, 50, 40);
+    layx_append(ctx, root, popup);
+    for (int i = 0; i < 3; i++) {
+        layx_id entry = layx_item(ctx);
+        layx_set_height(ctx, entry, popup_row_height);
+        layx_append(ctx, popup, entry);
+    }
+    return popup;
+}
+
+void test_layout_boundary() {
+    printf("\n=== Test: absolute items are layout boundaries ===\n");
+
+    layx_context ctx, expected;
+    layx_init_context(&ctx);
+    layx_init_context(&expected);
+    layx_id popup = build_page(&ctx, 20);
+    build_page(&expected, 35);
+    layx_run_context(&ctx);
+    layx_run_context(&expected);
+    TEST_ASSERT(FLOAT_EQUAL(layx_get_rect(&ctx, 0)[3], 300, 0.01f), "根高度不含弹出层");
+
+    // 修改弹出层内部：脏标记停在弹出层
+    layx_id entry = layx_first_child(&ctx, popup);
+    for (; entry != LAYX_INVALID_ID; entry = layx_next_sibling(&ctx, entry)) {
+        layx_set_height(&ctx, entry, 35);
+    }
+    TEST_ASSERT(layx_is_dirty(&ctx, popup) && !layx_is_dirty(&ctx, 0), "根保持干净");
+    TEST_ASSERT(!layx_layout_complete(&ctx), "有待布局的边界时结果不完整");
+
+    layx_run_dirty(&ctx);
+    TEST_ASSERT(layx_layout_complete(&ctx), "layx_run_dirty 后结果完整");
+    bool same = true;
+    for (layx_id i = 0; i < layx_items_count(&ctx); i++) {
+        layx_vec4 ra = layx_get_rect(&ctx, i);
+        layx_vec4 rb = layx_get_rect(&expected, i);
+        for (int k = 0; k < 4; k++) {
+            if (!FLOAT_EQUAL(ra[k], rb[k], 0.01f)) same = false;
+        }
+    }
+    TEST_ASSERT(same, "与完整布局的结果一致");
+    TEST_ASSERT(rect_is(&ctx, popup, 50, 40, 120, 105), "弹出层按新内容重新计算尺寸");
+
+    // 挂上新的提示框不会弄脏父元素
+    layx_id tooltip = layx_item(&ctx);
+    layx_set_position_type(&ctx, tooltip, LAYX_POSITION_ABSOLUTE);
+    layx_set_size(&ctx, tooltip, 60, 16);
+    layx_set_position_rb(&ctx, tooltip, 0, 0);
+    layx_append(&ctx, 1, tooltip);
+    TEST_ASSERT(!layx_is_dirty(&ctx, 1) && !layx_is_dirty(&ctx, 0), "挂载提示框不标记祖先");
+    layx_run_dirty(&ctx);
+    TEST_ASSERT(rect_is(&ctx, tooltip, 400 - 60, 30 - 16, 60, 16), "提示框相对所在行定位");
+
+    // 改回 static 会进入文档流，父元素需要重新布局
+    layx_set_position_type(&ctx, popup, LAYX_POSITION_STATIC);
+    TEST_ASSERT(layx_is_dirty(&ctx, 0), "进入文档流时标记父元素");
+    layx_run_dirty(&ctx);
+    TEST_ASSERT(rect_is(&ctx, popup, 0, 300, 120, 105), "原弹出层排在流内子元素之后");
+
+    layx_destroy_context(&ctx);
+    layx_destroy_context(&expected);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Absolute Positioning\n");
+    printf("========================================\n");
+
+    test_out_of_flow();
+    test_layout_boundary();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
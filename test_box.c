@@ -0,0 +1,182 @@
+/**
+ * @file test_box.c
+ * @brief 测试盒模型（margin/padding/border）的稀疏存储
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+static uint32_t live_boxes(const layx_context *ctx)
+{
+    return ctx->boxes.count > 0 ? ctx->boxes.count - 1 - ctx->boxes.free_count : 0;
+}
+
+void test_allocate_and_release() {
+    printf("\n=== Test: records follow non-zero values ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    for (int i = 0; i < 1000; i++) {
+        layx_append(&ctx, root, layx_item(&ctx));
+    }
+    TEST_ASSERT(live_boxes(&ctx) == 0 && ctx.boxes.records == NULL, "全为 0 的 item 不分配记录");
+
+    layx_id a = layx_first_child(&ctx, root);
+    layx_set_margin_left(&ctx, a, 4);
+    layx_item_t *pa = layx_get_item(&ctx, a);
+    TEST_ASSERT(pa->box_mask == (1u << LAYX_BOX_MARGIN) && live_boxes(&ctx) == 1, "设置单边 margin 后分配记录");
+    layx_set_border(&ctx, a, 1);
+    TEST_ASSERT(pa->box_mask == ((1u << LAYX_BOX_MARGIN) | (1u << LAYX_BOX_BORDER)) && live_boxes(&ctx) == 1,
+                "同一 item 的三组共用一条记录");
+
+    layx_scalar t, r, b, l;
+    layx_get_margin_trbl(&ctx, a, &t, &r, &b, &l);
+    TEST_ASSERT(t == 0 && r == 0 && b == 0 && l == 4, "读取 margin");
+    layx_get_padding_trbl(&ctx, a, &t, &r, &b, &l);
+    TEST_ASSERT(t == 0 && r == 0 && b == 0 && l == 0, "未设置的 padding 为 0");
+
+    layx_set_margin_left(&ctx, a, 0);
+    TEST_ASSERT(pa->box_mask == (1u << LAYX_BOX_BORDER) && live_boxes(&ctx) == 1, "margin 回到 0 后清除对应位");
+    layx_set_border_trbl(&ctx, a, 0, 0, 0, 0);
+    TEST_ASSERT(pa->box_mask == 0 && pa->box == 0 && live_boxes(&ctx) == 0, "三组都为 0 后释放记录");
+
+    layx_id c = layx_next_sibling(&ctx, a);
+    layx_set_padding(&ctx, c, 2);
+    TEST_ASSERT(live_boxes(&ctx) == 1 && ctx.boxes.count == 2, "复用释放的记录");
+    layx_destroy_item(&ctx, c);
+    TEST_ASSERT(live_boxes(&ctx) == 0, "销毁 item 时释放记录");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_layout_with_boxes() {
+    printf("\n=== Test: layout reads sparse boxes ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_size(&ctx, root, 300, 100);
+    layx_set_padding_trbl(&ctx, root, 5, 10, 5, 10);
+    layx_set_border(&ctx, root, 2);
+
+    layx_id plain = layx_item(&ctx);
+    layx_set_size(&ctx, plain, 50, 20);
+    layx_append(&ctx, root, plain);
+    layx_id boxed = layx_item(&ctx);
+    layx_set_size(&ctx, boxed, 50, 20);
+    layx_set_margin_left(&ctx, boxed, 8);
+    layx_set_padding(&ctx, boxed, 3);
+    layx_append(&ctx, root, boxed);
+    layx_run_context(&ctx);
+
+    layx_scalar x, y, w, h;
+    layx_get_rect_xywh(&ctx, root, &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(w, 324, 0.001f) && FLOAT_EQUAL(h, 114, 0.001f), "容器尺寸包含 padding 与 border");
+    layx_get_rect_xywh(&ctx, plain, &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(x, 12, 0.001f) && FLOAT_EQUAL(y, 7, 0.001f), "没有记录的子元素从内容区起点开始");
+    layx_get_rect_xywh(&ctx, boxed, &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(x, 70, 0.001f) && FLOAT_EQUAL(w, 56, 0.001f), "有记录的子元素计入 margin 与 padding");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_clone_and_snapshot() {
+    printf("\n=== Test: clone and snapshot keep boxes ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(&ctx, root, 200);
+    layx_id card = layx_item(&ctx);
+    layx_set_margin_trbl(&ctx, card, 1, 2, 3, 4);
+    layx_append(&ctx, root, card);
+
+    layx_id copy = layx_clone_subtree(&ctx, card);
+    TEST_ASSERT(layx_get_item(&ctx, copy)->box != layx_get_item(&ctx, card)->box, "克隆的 item 有自己的记录");
+    layx_set_margin_top(&ctx, copy, 9);
+    layx_scalar t, r, b, l;
+    layx_get_margin_trbl(&ctx, card, &t, &r, &b, &l);
+    TEST_ASSERT(t == 1 && l == 4, "修改克隆不影响模板");
+    layx_append(&ctx, root, copy);
+
+    // 制造一条空闲记录，快照中应被压紧
+    layx_id temp = layx_item(&ctx);
+    layx_set_border(&ctx, temp, 1);
+    layx_set_border(&ctx, temp, 0);
+    TEST_ASSERT(ctx.boxes.free_count == 1, "存在空闲记录");
+
+    const size_t size = layx_snapshot_size(&ctx);
+    void *buffer = aligned_alloc(16, (size + 15) & ~(size_t)15);
+    TEST_ASSERT(layx_write_snapshot(&ctx, buffer, size) == size, "写入快照");
+
+    layx_context loaded;
+    layx_init_context(&loaded);
+    TEST_ASSERT(layx_load_snapshot_buffer(&loaded, buffer, size) == 0, "加载快照");
+    TEST_ASSERT(loaded.boxes.count == 3 && loaded.boxes.free_count == 0, "快照只包含使用中的记录");
+    layx_get_margin_trbl(&loaded, copy, &t, &r, &b, &l);
+    TEST_ASSERT(t == 9 && r == 2 && b == 3 && l == 4, "加载后读取到克隆的 margin");
+
+    layx_run_context(&ctx);
+    layx_run_context(&loaded);
+    bool same = true;
+    for (layx_id i = 0; i < layx_items_count(&ctx); i++) {
+        layx_vec4 ra = layx_get_rect(&ctx, i);
+        layx_vec4 rb = layx_get_rect(&loaded, i);
+        for (int k = 0; k < 4; k++) {
+            if (!FLOAT_EQUAL(ra[k], rb[k], 0.001f)) same = false;
+        }
+    }
+    TEST_ASSERT(same, "加载后布局结果一致");
+
+    // 加载后的记录属于上下文，可以继续修改
+    layx_set_padding(&loaded, card, 6);
+    layx_get_padding_trbl(&loaded, card, &t, &r, &b, &l);
+    TEST_ASSERT(t == 6 && l == 6, "加载后可以修改盒模型");
+
+    layx_destroy_context(&loaded);
+    free(buffer);
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Sparse Box Model\n");
+    printf("========================================\n");
+
+    printf("  sizeof(layx_item_t) = %u\n", (unsigned)sizeof(layx_item_t));
+
+    test_allocate_and_release();
+    test_layout_with_boxes();
+    test_clone_and_snapshot();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file test_clone.c
+ * @brief 测试子树复制（模板实例化）
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+// 行模板：容器、图标、两个文本、角标
+static layx_id build_row_template(layx_context *ctx)
+{
+    layx_id row = layx_item(ctx);
+    layx_set_display(ctx, row, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(ctx, row, LAYX_FLEX_DIRECTION_ROW);
+    layx_set_align_items(ctx, row, LAYX_ALIGN_ITEMS_CENTER);
+    layx_set_height(ctx, row, 40);
+    layx_set_padding(ctx, row, 4);
+
+    layx_id icon = layx_item(ctx);
+    layx_set_size(ctx, icon, 24, 24);
+    layx_set_margin_right(ctx, icon, 8);
+    layx_append(ctx, row, icon);
+
+    layx_id title = layx_item(ctx);
+    layx_set_size(ctx, title, 100, 16);
+    layx_set_flex_grow(ctx, title, 1);
+    layx_append(ctx, row, title);
+
+    layx_id subtitle = layx_item(ctx);
+    layx_set_size(ctx, subtitle, 60, 12);
+    layx_append(ctx, row, subtitle);
+
+    layx_id badge = layx_item(ctx);
+    layx_set_size(ctx, badge, 16, 16);
+    layx_append(ctx, row, badge);
+    return row;
+}
+
+static bool same_relative_layout(layx_context *ctx, layx_id a, layx_id b)
+{
+    layx_vec4 ra = layx_get_rect(ctx, a);
+    layx_vec4 rb = layx_get_rect(ctx, b);
+    layx_id ca = layx_first_child(ctx, a);
+    layx_id cb = layx_first_child(ctx, b);
+    while (ca != LAYX_INVALID_ID && cb != LAYX_INVALID_ID) {
+        layx_vec4 xa = layx_get_rect(ctx, ca);
+        layx_vec4 xb = layx_get_rect(ctx, cb);
+        if (!FLOAT_EQUAL(xa[0] - ra[0], xb[0] - rb[0], 0.001f) ||
+            !FLOAT_EQUAL(xa[1] - ra[1], xb[1] - rb[1], 0.001f) ||
+            !FLOAT_EQUAL(xa[2], xb[2], 0.001f) ||
+            !FLOAT_EQUAL(xa[3], xb[3], 0.001f)) {
+            return false;
+        }
+        ca = layx_next_sibling(ctx, ca);
+        cb = layx_next_sibling(ctx, cb);
+    }
+    return ca == LAYX_INVALID_ID && cb == LAYX_INVALID_ID;
+}
+
+void test_clone_contiguous_template() {
+    printf("\n=== Test: clone contiguous row template ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+
+    layx_id list = layx_item(&ctx);
+    layx_set_display(&ctx, list, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(&ctx, list, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_width(&ctx, list, 300);
+
+    layx_id row = build_row_template(&ctx);
+    layx_append(&ctx, list, row);
+
+    layx_id clones[50];
+    for (int i = 0; i < 50; i++) {
+        clones[i] = layx_clone_subtree(&ctx, row);
+        layx_append(&ctx, list, clones[i]);
+    }
+    TEST_ASSERT(layx_items_count(&ctx) == 1 + 51 * 5, "每次复制分配 5 个 item");
+    TEST_ASSERT(layx_get_item(&ctx, clones[0])->parent == list, "复制的根已被插入列表");
+    TEST_ASSERT(layx_get_item(&ctx, layx_first_child(&ctx, clones[0]))->parent == clones[0], "子节点 parent 指向新根");
+
+    layx_run_context(&ctx);
+
+    bool all_same = true;
+    for (int i = 0; i < 50; i++) {
+        if (!same_relative_layout(&ctx, row, clones[i])) all_same = false;
+    }
+    TEST_ASSERT(all_same, "所有实例与模板布局一致");
+
+    layx_scalar x, y, w, h;
+    layx_get_rect_xywh(&ctx, clones[49], &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(y, 50 * 48, 0.001f), "实例在列表中依次堆叠");
+
+    // 修改实例不影响模板
+    layx_set_width(&ctx, layx_first_child(&ctx, clones[0]), 40);
+    layx_run_context(&ctx);
+    layx_get_rect_xywh(&ctx, layx_first_child(&ctx, row), &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(w, 24, 0.001f), "模板不受实例修改影响");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_clone_scattered_subtree() {
+    printf("\n=== Test: clone subtree with scattered ids ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(&ctx, root, 200);
+
+    layx_id a = layx_item(&ctx);
+    layx_id b = layx_item(&ctx);
+    layx_id a1 = layx_item(&ctx);   // a 的子节点在 b 之后分配，id 不连续
+    layx_set_height(&ctx, a1, 10);
+    layx_set_height(&ctx, b, 20);
+    layx_append(&ctx, root, a);
+    layx_append(&ctx, root, b);
+    layx_append(&ctx, a, a1);
+
+    layx_id copy = layx_clone_subtree(&ctx, root);
+    TEST_ASSERT(copy == 4, "新根位于数组末尾");
+    layx_id ca = layx_first_child(&ctx, copy);
+    layx_id cb = layx_next_sibling(&ctx, ca);
+    layx_id ca1 = layx_first_child(&ctx, ca);
+    TEST_ASSERT(ca == 5 && ca1 == 6 && cb == 7, "按先序重新编号");
+    TEST_ASSERT(layx_get_item(&ctx, ca1)->parent == ca && layx_get_item(&ctx, cb)->parent == copy, "parent 链接正确");
+    TEST_ASSERT(!layx_is_inserted(&ctx, copy), "新根未插入");
+
+    layx_run_context(&ctx);
+    layx_run_item(&ctx, copy);
+    TEST_ASSERT(same_relative_layout(&ctx, root, copy), "复制的子树布局与原子树一致");
+
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Subtree Cloning\n");
+    printf("========================================\n");
+
+    test_clone_contiguous_template();
+    test_clone_scattered_subtree();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
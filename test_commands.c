@@ -0,0 +1,158 @@
+/**
+ * @file test_commands.c
+ * @brief 测试命令缓冲区的记录与回放
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+void test_build_tree_from_commands() {
+    printf("\n=== Test: build tree from two producer buffers ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_size(&ctx, root, 300, 100);
+    layx_run_context(&ctx);
+
+    // 两个生产者各自记录，不访问上下文
+    layx_command_buffer bufs[2];
+    layx_cmd_init(&bufs[0]);
+    layx_cmd_init(&bufs[1]);
+
+    layx_id left = layx_cmd_create(&bufs[0]);
+    TEST_ASSERT(left & LAYX_CMD_LOCAL_BIT, "create 返回本地 handle");
+    layx_cmd_set_scalar(&bufs[0], left, LAYX_PROP_WIDTH, 50);
+    layx_cmd_set_scalar(&bufs[0], left, LAYX_PROP_HEIGHT, 40);
+    layx_cmd_set_trbl(&bufs[0], left, LAYX_PROP_MARGIN, 0, 10, 0, 0);
+    layx_cmd_append(&bufs[0], root, left);
+
+    layx_id right = layx_cmd_create(&bufs[1]);
+    layx_cmd_set_scalar(&bufs[1], right, LAYX_PROP_WIDTH, 20);
+    for (int i = 0; i < 100; i++) {
+        layx_cmd_set_scalar(&bufs[1], right, LAYX_PROP_HEIGHT, (layx_scalar)i);
+    }
+    layx_cmd_set_uint(&bufs[1], root, LAYX_PROP_JUSTIFY_CONTENT, LAYX_JUSTIFY_FLEX_END);
+    layx_cmd_append(&bufs[1], root, right);
+
+    size_t applied = layx_apply_commands(&ctx, bufs, 2);
+    TEST_ASSERT(applied == 5 + 104, "返回回放的命令数");
+    TEST_ASSERT(layx_items_count(&ctx) == 3, "创建了两个 item");
+    TEST_ASSERT(layx_is_dirty(&ctx, root), "回放经过脏标记路径");
+
+    // 与直接调用 setter 构建的树比较
+    layx_context direct;
+    layx_init_context(&direct);
+    layx_id droot = layx_item(&direct);
+    layx_set_display(&direct, droot, LAYX_DISPLAY_FLEX);
+    layx_set_size(&direct, droot, 300, 100);
+    layx_set_justify_content(&direct, droot, LAYX_JUSTIFY_FLEX_END);
+    layx_id dleft = layx_item(&direct);
+    layx_set_size(&direct, dleft, 50, 40);
+    layx_set_margin_trbl(&direct, dleft, 0, 10, 0, 0);
+    layx_append(&direct, droot, dleft);
+    layx_id dright = layx_item(&direct);
+    layx_set_size(&direct, dright, 20, 99);
+    layx_append(&direct, droot, dright);
+
+    layx_run_context(&ctx);
+    layx_run_context(&direct);
+    bool same = true;
+    for (layx_id i = 0; i < 3; i++) {
+        layx_vec4 ra = layx_get_rect(&ctx, i);
+        layx_vec4 rb = layx_get_rect(&direct, i);
+        for (int k = 0; k < 4; k++) {
+            if (!FLOAT_EQUAL(ra[k], rb[k], 0.001f)) same = false;
+        }
+    }
+    TEST_ASSERT(same, "回放结果与直接调用一致");
+    layx_scalar x, y, w, h;
+    layx_get_rect_xywh(&ctx, layx_next_sibling(&ctx, layx_first_child(&ctx, root)), &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(h, 99, 0.001f), "重复写入只保留最后一次的值");
+    layx_destroy_context(&direct);
+
+    layx_cmd_free(&bufs[0]);
+    layx_cmd_free(&bufs[1]);
+    layx_destroy_context(&ctx);
+}
+
+void test_ordering_barriers() {
+    printf("\n=== Test: style and destroy barriers ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_id a = layx_item(&ctx);
+    layx_append(&ctx, root, a);
+
+    layx_style st;
+    layx_style_reset(&st);
+    st.margin_left = 5;
+    layx_style_id sid = layx_intern_style(&ctx, &st);
+
+    layx_command_buffer buf;
+    layx_cmd_init(&buf);
+    // 先写 margin 再设置样式：样式覆盖 margin
+    layx_cmd_set_trbl(&buf, a, LAYX_PROP_MARGIN, 0, 0, 0, 1);
+    layx_cmd_set_uint(&buf, a, LAYX_PROP_STYLE, sid);
+    // 销毁后新建会复用 id，之前的写入不能落到新 item 上
+    layx_id b = layx_cmd_create(&buf);
+    layx_cmd_append(&buf, root, b);
+    layx_cmd_set_scalar(&buf, b, LAYX_PROP_HEIGHT, 7);
+    layx_cmd_destroy(&buf, b);
+    layx_cmd_append(&buf, root, layx_cmd_create(&buf));
+    layx_apply_commands(&ctx, &buf, 1);
+
+    layx_scalar t, r, bt, l;
+    layx_get_margin_trbl(&ctx, a, &t, &r, &bt, &l);
+    TEST_ASSERT(FLOAT_EQUAL(l, 5, 0.001f), "样式设置前的写入先生效");
+    layx_id reused = layx_next_sibling(&ctx, a);
+    TEST_ASSERT(reused == 2, "新 item 复用了销毁的 id");
+    layx_vec2 size = layx_get_size(&ctx, reused);
+    TEST_ASSERT(FLOAT_EQUAL(size[1], 0, 0.001f), "销毁前的写入不会落到复用的 item 上");
+
+    // 清空后可重复使用
+    layx_cmd_clear(&buf);
+    TEST_ASSERT(buf.size == 0 && layx_apply_commands(&ctx, &buf, 1) == 0, "清空后没有命令");
+
+    layx_cmd_free(&buf);
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Command Buffers\n");
+    printf("========================================\n");
+
+    test_build_tree_from_commands();
+    test_ordering_barriers();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
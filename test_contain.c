@@ -0,0 +1,252 @@
+/**
+ * @file test_contain.c
+ * @brief 测试布局边界的识别与 contain
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+// 页面：flex 列，顶部一行，中间一个面板（面板内若干行），底部一行
+typedef struct {
+    layx_id root, header, panel, footer, first_row;
+} page_ids;
+
+static page_ids build_page(layx_context *ctx, bool contain_panel)
+{
+    page_ids ids;
+    ids.root = layx_item(ctx);
+    layx_set_display(ctx, ids.root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(ctx, ids.root, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_size(ctx, ids.root, 300, 400);
+
+    ids.header = layx_item(ctx);
+    layx_set_height(ctx, ids.header, 40);
+    layx_append(ctx, ids.root, ids.header);
+
+    ids.panel = layx_item(ctx);
+    layx_set_display(ctx, ids.panel, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(ctx, ids.panel, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_padding(ctx, ids.panel, 5);
+    if (contain_panel) {
+        layx_set_flex_grow(ctx, ids.panel, 1);
+        layx_set_contain(ctx, ids.panel, true);
+    } else {
+        layx_set_size(ctx, ids.panel, 200, 300);
+        layx_set_overflow(ctx, ids.panel, LAYX_OVERFLOW_AUTO);
+    }
+    layx_append(ctx, ids.root, ids.panel);
+    for (int i = 0; i < 10; i++) {
+        layx_id row = layx_item(ctx);
+        layx_set_height(ctx, row, 20);
+        layx_append(ctx, ids.panel, row);
+        if (i == 0) ids.first_row = row;
+    }
+
+    ids.footer = layx_item(ctx);
+    layx_set_height(ctx, ids.footer, 30);
+    layx_append(ctx, ids.root, ids.footer);
+    return ids;
+}
+
+static bool same_rects(layx_context *a, layx_context *b)
+{
+    if (layx_items_count(a) != layx_items_count(b)) return false;
+    for (layx_id i = 0; i < layx_items_count(a); i++) {
+        layx_vec4 ra = layx_get_rect(a, i);
+        layx_vec4 rb = layx_get_rect(b, i);
+        for (int k = 0; k < 4; k++) {
+            if (!FLOAT_EQUAL(ra[k], rb[k], 0.001f)) return false;
+        }
+    }
+    return true;
+}
+
+void test_detection() {
+    printf("\n=== Test: boundary detection ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    page_ids ids = build_page(&ctx, false);
+
+    TEST_ASSERT(layx_is_layout_boundary(&ctx, ids.panel), "固定尺寸且滚动的 item 是边界");
+    TEST_ASSERT(!layx_is_layout_boundary(&ctx, ids.header), "普通 item 不是边界");
+    layx_set_overflow(&ctx, ids.panel, LAYX_OVERFLOW_VISIBLE);
+    TEST_ASSERT(!layx_is_layout_boundary(&ctx, ids.panel), "溢出可见时不是边界");
+    layx_set_overflow(&ctx, ids.panel, LAYX_OVERFLOW_HIDDEN);
+    layx_set_width(&ctx, ids.panel, 0);
+    TEST_ASSERT(!layx_is_layout_boundary(&ctx, ids.panel), "宽度为 auto 时不是边界");
+
+    layx_set_contain(&ctx, ids.header, true);
+    TEST_ASSERT(layx_get_contain(&ctx, ids.header) && layx_is_layout_boundary(&ctx, ids.header), "contain 的 item 是边界");
+    layx_set_position_type(&ctx, ids.footer, LAYX_POSITION_ABSOLUTE);
+    TEST_ASSERT(layx_is_layout_boundary(&ctx, ids.footer), "绝对定位的 item 是边界");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_propagation_stops() {
+    printf("\n=== Test: dirty propagation stops at boundaries ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    page_ids ids = build_page(&ctx, false);
+    layx_run_context(&ctx);
+
+    // 面板内部的修改不会标记面板之外的祖先
+    layx_set_height(&ctx, ids.first_row, 35);
+    TEST_ASSERT(layx_is_dirty(&ctx, ids.panel), "边界自身被标记为脏");
+    TEST_ASSERT(!layx_is_dirty(&ctx, ids.root), "根不是脏的");
+
+    layx_id extra = layx_item(&ctx);
+    layx_set_height(&ctx, extra, 50);
+    layx_append(&ctx, ids.panel, extra);
+    TEST_ASSERT(!layx_is_dirty(&ctx, ids.root), "插入子元素不会标记边界之外");
+
+    // 边界自身的修改仍会影响父元素
+    layx_run_dirty(&ctx);
+    layx_set_height(&ctx, ids.panel, 250);
+    TEST_ASSERT(layx_is_dirty(&ctx, ids.root), "边界自身的修改向外传播");
+
+    // 内部已脏时，边界自身的修改也要向外传播
+    layx_run_context(&ctx);
+    layx_set_height(&ctx, ids.first_row, 10);
+    layx_set_height(&ctx, ids.panel, 260);
+    TEST_ASSERT(layx_is_dirty(&ctx, ids.root), "边界已脏时自身修改仍向外传播");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_overflow_flip_on_dirty_boundary() {
+    printf("\n=== Test: flipping overflow on a dirty boundary ===\n");
+
+    layx_context inc, full;
+    layx_init_context(&inc);
+    layx_init_context(&full);
+    page_ids ids = build_page(&inc, false);
+    build_page(&full, false);
+    layx_run_context(&inc);
+
+    // 内部的修改只标记了面板；面板随后不再是边界，修改必须传到父元素
+    layx_set_height(&inc, ids.first_row, 45);
+    layx_set_overflow(&inc, ids.panel, LAYX_OVERFLOW_VISIBLE);
+    layx_set_height(&full, ids.first_row, 45);
+    layx_set_overflow(&full, ids.panel, LAYX_OVERFLOW_VISIBLE);
+    TEST_ASSERT(layx_is_dirty(&inc, ids.root), "改为 visible 时父元素被标记");
+
+    layx_run_dirty(&inc);
+    layx_run_context(&full);
+    TEST_ASSERT(!layx_is_dirty(&inc, ids.panel) && layx_layout_complete(&inc), "面板已重新布局");
+    TEST_ASSERT(same_rects(&inc, &full), "增量结果与完整布局一致");
+
+    layx_destroy_context(&inc);
+    layx_destroy_context(&full);
+}
+
+void test_incremental_matches_full() {
+    printf("\n=== Test: run_dirty on boundaries matches full layout ===\n");
+
+    for (int contain = 0; contain < 2; contain++) {
+        layx_context inc, full;
+        layx_init_context(&inc);
+        layx_init_context(&full);
+        page_ids ids = build_page(&inc, contain != 0);
+        build_page(&full, contain != 0);
+        layx_run_context(&inc);
+
+        layx_set_height(&inc, ids.first_row, 45);
+        layx_set_height(&full, ids.first_row, 45);
+        layx_id extra = layx_item(&inc);
+        layx_set_height(&inc, extra, 15);
+        layx_append(&inc, ids.panel, extra);
+        extra = layx_item(&full);
+        layx_set_height(&full, extra, 15);
+        layx_append(&full, ids.panel, extra);
+
+        layx_run_dirty(&inc);
+        layx_run_context(&full);
+        TEST_ASSERT(same_rects(&inc, &full), contain ? "contain 面板：增量结果与完整布局一致" : "滚动面板：增量结果与完整布局一致");
+        TEST_ASSERT(!layx_is_dirty(&inc, ids.panel), "布局后边界不再是脏的");
+        // 边界就是重新布局的根，它的滚动字段随之更新
+        layx_vec2 content;
+        layx_get_content_size(&inc, ids.panel, &content);
+        layx_id row = layx_first_child(&inc, ids.panel);
+        while (layx_next_sibling(&inc, row) != LAYX_INVALID_ID) row = layx_next_sibling(&inc, row);
+        layx_vec4 last = layx_get_rect(&inc, row);
+        TEST_ASSERT(FLOAT_EQUAL(content[1], last[1] + last[3], 0.001f), "更新了边界的滚动字段");
+
+        layx_destroy_context(&inc);
+        layx_destroy_context(&full);
+    }
+}
+
+void test_size_containment() {
+    printf("\n=== Test: contain sizes as if empty ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(&ctx, root, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_width(&ctx, root, 100);
+    layx_set_align_items(&ctx, root, LAYX_ALIGN_ITEMS_FLEX_START);
+    layx_id box = layx_item(&ctx);
+    layx_set_padding(&ctx, box, 4);
+    layx_append(&ctx, root, box);
+    layx_id inner = layx_item(&ctx);
+    layx_set_size(&ctx, inner, 60, 30);
+    layx_append(&ctx, box, inner);
+
+    layx_run_context(&ctx);
+    layx_vec4 r = layx_get_rect(&ctx, box);
+    TEST_ASSERT(FLOAT_EQUAL(r[2], 68, 0.001f) && FLOAT_EQUAL(r[3], 38, 0.001f), "未 contain 时按内容计算尺寸");
+
+    layx_set_contain(&ctx, box, true);
+    TEST_ASSERT(layx_is_dirty(&ctx, root), "切换 contain 标记父元素");
+    layx_run_dirty(&ctx);
+    r = layx_get_rect(&ctx, box);
+    TEST_ASSERT(FLOAT_EQUAL(r[2], 8, 0.001f) && FLOAT_EQUAL(r[3], 8, 0.001f), "contain 时只剩 padding");
+    r = layx_get_rect(&ctx, inner);
+    TEST_ASSERT(FLOAT_EQUAL(r[0], 4, 0.001f) && FLOAT_EQUAL(r[2], 60, 0.001f), "内部仍正常排列");
+
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Layout Boundaries and Contain\n");
+    printf("========================================\n");
+
+    test_detection();
+    test_propagation_stops();
+    test_overflow_flip_on_dirty_boundary();
+    test_incremental_matches_full();
+    test_size_containment();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -58,6 +58,12 @@ static bool has_fixed_height(const layx_item_t *item) {
     return (item->flags & LAYX_SIZE_FIXED_HEIGHT) != 0;
 }
 
+static bool box_equals(const layx_context *ctx, const layx_item_t *item, int kind,
+                       float top, float right, float bottom, float left) {
+    layx_vec4 trbl = layx_item_box(ctx, item, kind);
+    return trbl[0] == top && trbl[1] == right && trbl[2] == bottom && trbl[3] == left;
+}
+
 static bool is_flex_container_test(const layx_item_t *item) {
     return layx_is_flex_container(item->flags);
 }
@@ -146,14 +152,11 @@ void test_container_defaults(void) {
                 "默认没有固定高度标志");
     
     // 默认margin/padding/border为0
-    TEST_ASSERT(item->margin_trbl[0] == 0.0f && item->margin_trbl[1] == 0.0f && 
-                item->margin_trbl[2] == 0.0f && item->margin_trbl[3] == 0.0f,
+    TEST_ASSERT(box_equals(&ctx, item, LAYX_BOX_MARGIN, 0.0f, 0.0f, 0.0f, 0.0f),
                 "margin默认为0 (CSS规范: 0)");
-    TEST_ASSERT(item->padding_trbl[0] == 0.0f && item->padding_trbl[1] == 0.0f && 
-                item->padding_trbl[2] == 0.0f && item->padding_trbl[3] == 0.0f,
+    TEST_ASSERT(box_equals(&ctx, item, LAYX_BOX_PADDING, 0.0f, 0.0f, 0.0f, 0.0f),
                 "padding默认为0 (CSS规范: 0)");
-    TEST_ASSERT(item->border_trbl[0] == 0.0f && item->border_trbl[1] == 0.0f && 
-                item->border_trbl[2] == 0.0f && item->border_trbl[3] == 0.0f,
+    TEST_ASSERT(box_equals(&ctx, item, LAYX_BOX_BORDER, 0.0f, 0.0f, 0.0f, 0.0f),
                 "border默认为0 (CSS规范: 0)");
     
     layx_destroy_context(&ctx);
@@ -296,39 +299,33 @@ void test_margin_padding_border_defaults(void) {
     layx_item_t *pitem = layx_get_item(&ctx, item);
     
     // CSS: margin默认为0
-    TEST_ASSERT(pitem->margin_trbl[0] == 0.0f && pitem->margin_trbl[1] == 0.0f && 
-                pitem->margin_trbl[2] == 0.0f && pitem->margin_trbl[3] == 0.0f,
+    TEST_ASSERT(box_equals(&ctx, pitem, LAYX_BOX_MARGIN, 0.0f, 0.0f, 0.0f, 0.0f),
                 "margin默认为0");
     
     // CSS: padding默认为0
-    TEST_ASSERT(pitem->padding_trbl[0] == 0.0f && pitem->padding_trbl[1] == 0.0f && 
-                pitem->padding_trbl[2] == 0.0f && pitem->padding_trbl[3] == 0.0f,
+    TEST_ASSERT(box_equals(&ctx, pitem, LAYX_BOX_PADDING, 0.0f, 0.0f, 0.0f, 0.0f),
                 "padding默认为0");
     
     // CSS: border默认为0
-    TEST_ASSERT(pitem->border_trbl[0] == 0.0f && pitem->border_trbl[1] == 0.0f && 
-                pitem->border_trbl[2] == 0.0f && pitem->border_trbl[3] == 0.0f,
+    TEST_ASSERT(box_equals(&ctx, pitem, LAYX_BOX_BORDER, 0.0f, 0.0f, 0.0f, 0.0f),
                 "border默认为0");
     
     // 设置margin后的状态
     layx_set_margin_trbl(&ctx, item, 10, 20, 30, 40);
     pitem = layx_get_item(&ctx, item);
-    TEST_ASSERT(pitem->margin_trbl[0] == 10.0f && pitem->margin_trbl[1] == 20.0f &&
-                pitem->margin_trbl[2] == 30.0f && pitem->margin_trbl[3] == 40.0f,
+    TEST_ASSERT(box_equals(&ctx, pitem, LAYX_BOX_MARGIN, 10.0f, 20.0f, 30.0f, 40.0f),
                 "margin可以被正确设置 (left, top, right, bottom)");
     
     // 设置padding后的状态
     layx_set_padding_trbl(&ctx, item, 5, 10, 15, 20);
     pitem = layx_get_item(&ctx, item);
-    TEST_ASSERT(pitem->padding_trbl[0] == 5.0f && pitem->padding_trbl[1] == 10.0f &&
-                pitem->padding_trbl[2] == 15.0f && pitem->padding_trbl[3] == 20.0f,
+    TEST_ASSERT(box_equals(&ctx, pitem, LAYX_BOX_PADDING, 5.0f, 10.0f, 15.0f, 20.0f),
                 "padding可以被正确设置");
     
     // 设置border后的状态
     layx_set_border_trbl(&ctx, item, 2, 3, 4, 5);
     pitem = layx_get_item(&ctx, item);
-    TEST_ASSERT(pitem->border_trbl[0] == 2.0f && pitem->border_trbl[1] == 3.0f &&
-                pitem->border_trbl[2] == 4.0f && pitem->border_trbl[3] == 5.0f,
+    TEST_ASSERT(box_equals(&ctx, pitem, LAYX_BOX_BORDER, 2.0f, 3.0f, 4.0f, 5.0f),
                 "border可以被正确设置");
     
     layx_destroy_context(&ctx);
@@ -0,0 +1,196 @@
+/**
+ * @file test_delta.c
+ * @brief 测试变更流（delta stream）的写出与镜像重建
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+static uint8_t buffer[64 * 1024];
+static float mirror[256 * 4];
+
+static bool mirror_matches(layx_context *ctx)
+{
+    for (layx_id i = 0; i < layx_items_count(ctx); i++) {
+        layx_vec4 rect = layx_get_rect(ctx, i);
+        for (int k = 0; k < 4; k++) {
+            if (!FLOAT_EQUAL(mirror[i * 4 + k], rect[k], 0.001f)) return false;
+        }
+    }
+    return true;
+}
+
+static layx_id build_row(layx_context *ctx, layx_id children[3])
+{
+    layx_id root = layx_item(ctx);
+    layx_set_display(ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(ctx, root, LAYX_FLEX_DIRECTION_ROW);
+    layx_set_size(ctx, root, 300, 100);
+    for (int i = 0; i < 3; i++) {
+        children[i] = layx_item(ctx);
+        layx_set_size(ctx, children[i], 50, 40);
+        layx_append(ctx, root, children[i]);
+    }
+    return root;
+}
+
+void test_keyframe_and_incremental() {
+    printf("\n=== Test: keyframe then incremental delta ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_delta_enable(&ctx, true);
+
+    layx_id children[3];
+    build_row(&ctx, children);
+    layx_run_context(&ctx);
+
+    size_t size = layx_delta_write(&ctx, buffer, sizeof(buffer));
+    layx_delta_info info;
+    TEST_ASSERT(size > 0 && layx_delta_read_header(buffer, size, &info) == 0, "关键帧写出并可解析");
+    TEST_ASSERT(info.flags & LAYX_DELTA_FLAG_RESET, "首帧带 RESET 标志");
+    TEST_ASSERT(info.created_count == 4 && info.changed_count == 4, "首帧包含全部新建 id 与 rect");
+    TEST_ASSERT(buffer[0] == 'L' && buffer[1] == 'X' && buffer[2] == 'D' && buffer[3] == '1', "magic 按小端序写出");
+
+    memset(mirror, 0xFF, sizeof(mirror));
+    TEST_ASSERT(layx_delta_apply(buffer, size, mirror, 256) == 4, "镜像应用关键帧");
+    TEST_ASSERT(mirror_matches(&ctx), "镜像与 rects 一致");
+
+    // 无变化时只有头部
+    layx_run_context(&ctx);
+    size = layx_delta_write(&ctx, buffer, sizeof(buffer));
+    layx_delta_read_header(buffer, size, &info);
+    TEST_ASSERT(size == LAYX_DELTA_HEADER_SIZE && info.changed_count == 0, "无变化时仅写出头部");
+    TEST_ASSERT(info.frame == 1, "帧序号递增");
+
+    // 修改中间子元素宽度：它和后面的兄弟发生变化
+    layx_set_width(&ctx, children[1], 80);
+    layx_run_context(&ctx);
+    size = layx_delta_write(&ctx, buffer, sizeof(buffer));
+    layx_delta_read_header(buffer, size, &info);
+    TEST_ASSERT(info.changed_count == 2, "只输出变化的两个子元素");
+    TEST_ASSERT(size == LAYX_DELTA_HEADER_SIZE + 2 * LAYX_DELTA_RECORD_SIZE, "变更记录大小正确");
+    layx_delta_apply(buffer, size, mirror, 256);
+    TEST_ASSERT(mirror_matches(&ctx), "增量应用后镜像一致");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_created_and_destroyed() {
+    printf("\n=== Test: created/destroyed ids ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_delta_enable(&ctx, true);
+
+    layx_id children[3];
+    layx_id root = build_row(&ctx, children);
+    layx_run_context(&ctx);
+    size_t size = layx_delta_write(&ctx, buffer, sizeof(buffer));
+    layx_delta_apply(buffer, size, mirror, 256);
+
+    layx_destroy_item(&ctx, children[2]);
+    layx_id extra = layx_item(&ctx);
+    layx_set_size(&ctx, extra, 20, 20);
+    layx_append(&ctx, root, extra);
+    layx_run_context(&ctx);
+
+    size = layx_delta_write(&ctx, buffer, sizeof(buffer));
+    layx_delta_info info;
+    layx_delta_read_header(buffer, size, &info);
+    TEST_ASSERT(info.destroyed_count == 1 && info.created_count == 1, "记录一个销毁与一个新建");
+    TEST_ASSERT(extra == children[2], "新建 item 复用已销毁的 id");
+    layx_delta_apply(buffer, size, mirror, 256);
+    TEST_ASSERT(mirror_matches(&ctx), "复用 id 后镜像一致");
+
+    // 容量不足时不写出、不丢状态
+    layx_set_width(&ctx, children[0], 10);
+    layx_run_context(&ctx);
+    TEST_ASSERT(layx_delta_write(&ctx, buffer, LAYX_DELTA_HEADER_SIZE) == 0, "容量不足时返回 0");
+    size = layx_delta_write(&ctx, buffer, sizeof(buffer));
+    layx_delta_apply(buffer, size, mirror, 256);
+    TEST_ASSERT(mirror_matches(&ctx), "重试写出后镜像一致");
+    TEST_ASSERT(layx_delta_apply(buffer, size, mirror, 2) == -1, "镜像容量不足时拒绝应用");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_reused_id_same_rect() {
+    printf("\n=== Test: reused id laid out to the old rect ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_delta_enable(&ctx, true);
+
+    layx_id children[3];
+    layx_id root = build_row(&ctx, children);
+    layx_run_context(&ctx);
+    size_t size = layx_delta_write(&ctx, buffer, sizeof(buffer));
+    layx_delta_apply(buffer, size, mirror, 256);
+
+    // 新 item 复用 id 并落在同一个 rect：消费端已按新建清零，必须重新收到这条记录
+    layx_destroy_item(&ctx, children[2]);
+    layx_id reused = layx_item(&ctx);
+    layx_set_size(&ctx, reused, 50, 40);
+    layx_append(&ctx, root, reused);
+    layx_run_context(&ctx);
+    TEST_ASSERT(reused == children[2], "新建 item 复用已销毁的 id");
+
+    size = layx_delta_write(&ctx, buffer, sizeof(buffer));
+    layx_delta_info info;
+    layx_delta_read_header(buffer, size, &info);
+    TEST_ASSERT(info.changed_count == 1, "复用 id 的 rect 与旧值相同也写出记录");
+    layx_delta_apply(buffer, size, mirror, 256);
+    TEST_ASSERT(FLOAT_EQUAL(mirror[reused * 4 + 2], 50, 0.001f) && FLOAT_EQUAL(mirror[reused * 4 + 3], 40, 0.001f),
+                "镜像中复用 id 的 rect 为 0 0 50 40 而不是零");
+    TEST_ASSERT(mirror_matches(&ctx), "复用 id 后镜像一致");
+
+    // 只销毁不复用：rect 清零，不再写出记录
+    layx_destroy_item(&ctx, reused);
+    layx_run_context(&ctx);
+    size = layx_delta_write(&ctx, buffer, sizeof(buffer));
+    layx_delta_read_header(buffer, size, &info);
+    TEST_ASSERT(info.destroyed_count == 1 && info.changed_count == 0, "销毁的 id 只出现在销毁列表中");
+    layx_delta_apply(buffer, size, mirror, 256);
+    TEST_ASSERT(mirror_matches(&ctx), "销毁后镜像一致");
+
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Delta Stream\n");
+    printf("========================================\n");
+
+    test_keyframe_and_incremental();
+    test_created_and_destroyed();
+    test_reused_id_same_rect();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
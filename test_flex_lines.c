@@ -0,0 +1,118 @@
+/**
+ * @file test_flex_lines.c
+ * @brief 测试 wrap 容器的 flex 行记录（大量行、重新分行）
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+// 照片墙：固定尺寸的格子在 wrap 容器中排成多行
+static layx_id build_grid(layx_context *ctx, int cells, layx_scalar width)
+{
+    layx_id root = layx_item(ctx);
+    layx_set_display(ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_wrap(ctx, root, LAYX_FLEX_WRAP_WRAP);
+    layx_set_align_items(ctx, root, LAYX_ALIGN_ITEMS_FLEX_START);
+    layx_set_width(ctx, root, width);
+    for (int i = 0; i < cells; i++) {
+        layx_id cell = layx_item(ctx);
+        layx_set_size(ctx, cell, 100, 50);
+        layx_append(ctx, root, cell);
+    }
+    return root;
+}
+
+void test_many_lines() {
+    printf("\n=== Test: wrapped container with 2000 lines ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = build_grid(&ctx, 20000, 1000);
+    layx_run_context(&ctx);
+
+    layx_scalar x, y, w, h;
+    layx_get_rect_xywh(&ctx, root, &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(h, 2000 * 50, 0.001f), "容器高度包含全部 2000 行");
+    TEST_ASSERT(layx_get_item(&ctx, root)->line_count == 2000, "记录了 2000 行");
+
+    layx_get_rect_xywh(&ctx, 20000, &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(x, 900, 0.001f) && FLOAT_EQUAL(y, 1999 * 50, 0.001f), "最后一个格子在第 2000 行末尾");
+    layx_get_rect_xywh(&ctx, 331, &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(x, 0, 0.001f) && FLOAT_EQUAL(y, 33 * 50, 0.001f), "第 34 行的第一个格子");
+
+    bool no_break = true;
+    for (layx_id i = 1; i < layx_items_count(&ctx); i++) {
+        if (layx_get_item(&ctx, i)->flags & LAYX_BREAK) no_break = false;
+    }
+    TEST_ASSERT(no_break, "布局不写入 LAYX_BREAK");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_reflow() {
+    printf("\n=== Test: lines are recomputed on every run ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = build_grid(&ctx, 100, 1000);
+    layx_run_context(&ctx);
+    uint32_t capacity = ctx.lines.capacity;
+
+    // 加宽后每行 20 个，上一轮的分行不能残留
+    layx_set_width(&ctx, root, 2000);
+    layx_run_context(&ctx);
+    layx_scalar x, y, w, h;
+    layx_get_rect_xywh(&ctx, root, &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(h, 5 * 50, 0.001f), "加宽后重新分为 5 行");
+    layx_get_rect_xywh(&ctx, 20, &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(x, 1900, 0.001f) && FLOAT_EQUAL(y, 0, 0.001f), "第一行放下 20 个格子");
+    TEST_ASSERT(ctx.lines.capacity == capacity, "行缓冲区在多轮之间复用");
+
+    // align-content 作用于全部行
+    layx_set_height(&ctx, root, 450);
+    layx_set_align_content(&ctx, root, LAYX_ALIGN_CONTENT_CENTER);
+    layx_run_context(&ctx);
+    layx_get_rect_xywh(&ctx, 1, &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(y, 100, 0.001f), "align-content: center 作用于全部行");
+    layx_get_rect_xywh(&ctx, 100, &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(y, 300, 0.001f), "最后一行随之偏移");
+
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Flex Lines\n");
+    printf("========================================\n");
+
+    test_many_lines();
+    test_reflow();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,187 @@
+/**
+ * @file test_flex_resolve.c
+ * @brief 测试 flex-grow / flex-shrink / flex-basis 的弹性长度解析
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+static layx_id make_row(layx_context *ctx, layx_scalar width)
+{
+    layx_id row = layx_item(ctx);
+    layx_set_display(ctx, row, LAYX_DISPLAY_FLEX);
+    layx_set_size(ctx, row, width, 40);
+    return row;
+}
+
+static layx_id add_child(layx_context *ctx, layx_id row, layx_scalar width,
+                         layx_scalar grow, layx_scalar shrink, layx_scalar basis)
+{
+    layx_id child = layx_item(ctx);
+    if (width > 0) layx_set_width(ctx, child, width);
+    layx_set_height(ctx, child, 20);
+    layx_set_flex_properties(ctx, child, grow, shrink, basis);
+    layx_append(ctx, row, child);
+    return child;
+}
+
+static layx_scalar width_of(layx_context *ctx, layx_id item)
+{
+    return layx_get_rect(ctx, item)[2];
+}
+
+void test_shrink() {
+    printf("\n=== Test: flex-shrink ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+
+    // SHRINK_POLICY.md 中的例子：两个 200 的项目放进 300 的容器，各收缩 50
+    layx_id row = make_row(&ctx, 300);
+    layx_id a = add_child(&ctx, row, 0, 1, 1, 200);
+    layx_id b = add_child(&ctx, row, 0, 1, 1, 200);
+    layx_run_context(&ctx);
+    TEST_ASSERT(FLOAT_EQUAL(width_of(&ctx, a), 150, 0.01f) && FLOAT_EQUAL(width_of(&ctx, b), 150, 0.01f), "等比收缩到 150");
+    TEST_ASSERT(FLOAT_EQUAL(layx_get_rect(&ctx, b)[0], 150, 0.01f), "第二个项目紧接第一个");
+
+    // 收缩量按 flex-shrink * base 加权
+    layx_reset_context(&ctx);
+    row = make_row(&ctx, 200);
+    a = add_child(&ctx, row, 100, 0, 1, 0);
+    b = add_child(&ctx, row, 300, 0, 1, 0);
+    layx_run_context(&ctx);
+    TEST_ASSERT(FLOAT_EQUAL(width_of(&ctx, a), 50, 0.01f) && FLOAT_EQUAL(width_of(&ctx, b), 150, 0.01f), "按 base 加权收缩");
+
+    // flex-shrink: 0 的项目保持尺寸，其余项目承担全部收缩
+    layx_reset_context(&ctx);
+    row = make_row(&ctx, 200);
+    a = add_child(&ctx, row, 150, 0, 0, 0);
+    b = add_child(&ctx, row, 150, 0, 1, 0);
+    layx_run_context(&ctx);
+    TEST_ASSERT(FLOAT_EQUAL(width_of(&ctx, a), 150, 0.01f) && FLOAT_EQUAL(width_of(&ctx, b), 50, 0.01f), "flex-shrink: 0 不收缩");
+
+    // min-width 违例：冻结后把剩余收缩量分给其他项目
+    layx_reset_context(&ctx);
+    row = make_row(&ctx, 200);
+    a = add_child(&ctx, row, 200, 0, 1, 0);
+    layx_set_min_width(&ctx, a, 150);
+    b = add_child(&ctx, row, 200, 0, 1, 0);
+    layx_run_context(&ctx);
+    TEST_ASSERT(FLOAT_EQUAL(width_of(&ctx, a), 150, 0.01f) && FLOAT_EQUAL(width_of(&ctx, b), 50, 0.01f), "min-width 冻结后重新分配");
+
+    // margin 计入行的占用空间
+    layx_reset_context(&ctx);
+    row = make_row(&ctx, 200);
+    a = add_child(&ctx, row, 100, 0, 1, 0);
+    layx_set_margin_right(&ctx, a, 20);
+    b = add_child(&ctx, row, 100, 0, 1, 0);
+    layx_run_context(&ctx);
+    TEST_ASSERT(FLOAT_EQUAL(width_of(&ctx, a), 90, 0.01f) && FLOAT_EQUAL(layx_get_rect(&ctx, b)[0], 110, 0.01f), "收缩后 margin 保留");
+
+    // flex-shrink 之和小于 1 时只收缩一部分溢出量，判断用未加权的 flex-shrink
+    layx_reset_context(&ctx);
+    row = make_row(&ctx, 100);
+    a = add_child(&ctx, row, 0, 0, 0.25f, 100);
+    b = add_child(&ctx, row, 0, 0, 0.25f, 100);
+    layx_run_context(&ctx);
+    TEST_ASSERT(FLOAT_EQUAL(width_of(&ctx, a), 75, 0.01f) && FLOAT_EQUAL(width_of(&ctx, b), 75, 0.01f), "shrink 之和 0.5 时收缩一半");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_grow_and_basis() {
+    printf("\n=== Test: flex-grow and flex-basis ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+
+    // 按 flex-grow 比例分配剩余空间
+    layx_id row = make_row(&ctx, 400);
+    layx_id a = add_child(&ctx, row, 0, 1, 1, 0);
+    layx_id b = add_child(&ctx, row, 0, 3, 1, 0);
+    layx_run_context(&ctx);
+    TEST_ASSERT(FLOAT_EQUAL(width_of(&ctx, a), 100, 0.01f) && FLOAT_EQUAL(width_of(&ctx, b), 300, 0.01f), "按 1:3 分配");
+
+    // max-width 违例：冻结后剩余空间给其他项目
+    layx_set_max_width(&ctx, b, 200);
+    layx_run_context(&ctx);
+    TEST_ASSERT(FLOAT_EQUAL(width_of(&ctx, a), 200, 0.01f) && FLOAT_EQUAL(width_of(&ctx, b), 200, 0.01f), "max-width 冻结后重新分配");
+
+    // 伸展在 base 之上进行
+    layx_reset_context(&ctx);
+    row = make_row(&ctx, 300);
+    a = add_child(&ctx, row, 100, 1, 1, 0);
+    b = add_child(&ctx, row, 0, 1, 1, 0);
+    layx_run_context(&ctx);
+    TEST_ASSERT(FLOAT_EQUAL(width_of(&ctx, a), 200, 0.01f) && FLOAT_EQUAL(width_of(&ctx, b), 100, 0.01f), "grow 加在 base 之上");
+
+    // flex-grow 之和小于 1 时只分配一部分剩余空间
+    layx_reset_context(&ctx);
+    row = make_row(&ctx, 400);
+    a = add_child(&ctx, row, 0, 0.25f, 1, 0);
+    b = add_child(&ctx, row, 0, 0.25f, 1, 0);
+    layx_run_context(&ctx);
+    TEST_ASSERT(FLOAT_EQUAL(width_of(&ctx, a), 100, 0.01f) && FLOAT_EQUAL(width_of(&ctx, b), 100, 0.01f), "grow 之和 0.5 时分配一半");
+
+    // flex-basis 优先于 width
+    layx_reset_context(&ctx);
+    row = make_row(&ctx, 400);
+    a = add_child(&ctx, row, 50, 0, 1, 120);
+    b = add_child(&ctx, row, 50, 0, 1, 0);
+    layx_run_context(&ctx);
+    TEST_ASSERT(FLOAT_EQUAL(width_of(&ctx, a), 120, 0.01f) && FLOAT_EQUAL(width_of(&ctx, b), 50, 0.01f), "flex-basis 覆盖 width");
+
+    // 列方向同样生效
+    layx_reset_context(&ctx);
+    layx_id col = layx_item(&ctx);
+    layx_set_display(&ctx, col, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(&ctx, col, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_size(&ctx, col, 50, 100);
+    a = layx_item(&ctx);
+    layx_set_height(&ctx, a, 80);
+    layx_append(&ctx, col, a);
+    b = layx_item(&ctx);
+    layx_set_height(&ctx, b, 120);
+    layx_append(&ctx, col, b);
+    layx_run_context(&ctx);
+    TEST_ASSERT(FLOAT_EQUAL(layx_get_rect(&ctx, a)[3], 40, 0.01f) && FLOAT_EQUAL(layx_get_rect(&ctx, b)[3], 60, 0.01f), "列方向收缩");
+
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Flexible Length Resolution\n");
+    printf("========================================\n");
+
+    test_shrink();
+    test_grow_and_basis();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file test_frames.c
+ * @brief 测试双缓冲布局结果的发布与读取
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+void test_publish_and_acquire() {
+    printf("\n=== Test: publish and acquire frames ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_set_double_buffered(&ctx, true);
+
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(&ctx, root, 200);
+    layx_id child = layx_item(&ctx);
+    layx_set_height(&ctx, child, 30);
+    layx_append(&ctx, root, child);
+
+    const layx_frame *frame = layx_acquire_frame(&ctx);
+    TEST_ASSERT(frame != NULL && frame->frame == 0 && frame->count == 0, "发布前读取到空帧");
+
+    layx_run_context(&ctx);
+    layx_publish(&ctx);
+    frame = layx_acquire_frame(&ctx);
+    TEST_ASSERT(frame->frame == 1 && frame->count == 2, "读取到第一帧");
+    TEST_ASSERT(FLOAT_EQUAL(frame->rects[child][3], 30, 0.001f), "帧中包含 rects");
+
+    // 渲染线程持有第一帧时，布局线程继续计算并发布两帧
+    const layx_frame *held = frame;
+    layx_set_height(&ctx, child, 50);
+    layx_run_context(&ctx);
+    layx_publish(&ctx);
+    layx_set_height(&ctx, child, 70);
+    layx_run_context(&ctx);
+    layx_publish(&ctx);
+    TEST_ASSERT(FLOAT_EQUAL(held->rects[child][3], 30, 0.001f) && held->frame == 1, "持有的帧不被后续发布覆盖");
+
+    frame = layx_acquire_frame(&ctx);
+    TEST_ASSERT(frame->frame == 3 && FLOAT_EQUAL(frame->rects[child][3], 70, 0.001f), "直接跳到最新发布的帧");
+    TEST_ASSERT(layx_acquire_frame(&ctx) == frame, "没有新发布时返回同一帧");
+
+    // 扩容只影响布局线程的槽位
+    for (int i = 0; i < 100; i++) {
+        layx_id extra = layx_item(&ctx);
+        layx_set_height(&ctx, extra, 1);
+        layx_append(&ctx, root, extra);
+    }
+    layx_run_context(&ctx);
+    layx_publish(&ctx);
+    TEST_ASSERT(frame->count == 2, "读取中的帧大小不变");
+    frame = layx_acquire_frame(&ctx);
+    TEST_ASSERT(frame->count == 102 && layx_published_frames(&ctx) == 4, "新帧包含新增 item");
+
+    layx_destroy_context(&ctx);
+}
+
+// 读取到的帧与布局结果逐项一致
+static bool frame_matches(layx_context *ctx, const layx_frame *frame) {
+    if (frame->count != layx_items_count(ctx)) return false;
+    for (layx_id i = 0; i < frame->count; i++) {
+        if (memcmp(&frame->rects[i], &ctx->rects[i], sizeof(layx_vec4)) != 0) return false;
+        if (frame->tags[i] != layx_get_item(ctx, i)->tag) return false;
+    }
+    return true;
+}
+
+void test_incremental_publish() {
+    printf("\n=== Test: publish copies only changed items ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_set_double_buffered(&ctx, true);
+
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(&ctx, root, 400);
+    layx_id panels[2];
+    layx_id last = LAYX_INVALID_ID;
+    for (int p = 0; p < 2; p++) {
+        panels[p] = layx_item(&ctx);
+        layx_set_display(&ctx, panels[p], LAYX_DISPLAY_BLOCK);
+        layx_set_size(&ctx, panels[p], 400, 300);
+        layx_set_contain(&ctx, panels[p], true);
+        layx_append(&ctx, root, panels[p]);
+        for (int i = 0; i < 20; i++) {
+            layx_id child = layx_item(&ctx);
+            layx_set_height(&ctx, child, 10);
+            layx_append(&ctx, panels[p], child);
+            last = child;
+        }
+    }
+    layx_run_context(&ctx);
+    layx_publish(&ctx);
+    TEST_ASSERT(ctx.frames.copied == layx_items_count(&ctx), "第一次发布整帧复制");
+    const layx_frame *held = layx_acquire_frame(&ctx);
+    layx_publish(&ctx);
+    layx_publish(&ctx);
+
+    // 只重新布局一个边界：只复制该边界的子树
+    layx_id first = layx_get_item(&ctx, panels[0])->first_child;
+    layx_set_height(&ctx, first, 25);
+    layx_run_dirty(&ctx);
+    layx_publish(&ctx);
+    TEST_ASSERT(ctx.frames.copied == 21, "只复制脏边界内部的 21 个 item");
+
+    layx_set_tag(&ctx, panels[1], 7);
+    layx_publish(&ctx);
+    TEST_ASSERT(ctx.frames.copied <= 22, "设置 tag 只补齐之前的修改和该 item");
+
+    // 渲染线程一直持有第一帧，换到最新帧时与布局结果一致
+    TEST_ASSERT(held->frame == 1 && FLOAT_EQUAL(held->rects[first][3], 10, 0.001f), "持有的帧不变");
+    const layx_frame *frame = layx_acquire_frame(&ctx);
+    TEST_ASSERT(frame_matches(&ctx, frame), "最新帧与布局结果一致");
+
+    // 销毁后复用 id、移出子树、再布局整棵树
+    layx_destroy_item(&ctx, last);
+    layx_id reused = layx_item(&ctx);
+    layx_set_height(&ctx, reused, 40);
+    layx_append(&ctx, panels[0], reused);
+    layx_remove(&ctx, first);
+    layx_run_context(&ctx);
+    layx_publish(&ctx);
+    layx_publish(&ctx);
+    frame = layx_acquire_frame(&ctx);
+    TEST_ASSERT(frame_matches(&ctx, frame), "复用 id 和移动子树后帧与布局结果一致");
+
+    // 重置后整帧复制，不引用旧的修改记录
+    layx_reset_context(&ctx);
+    layx_id single = layx_item(&ctx);
+    layx_set_size(&ctx, single, 5, 5);
+    layx_run_context(&ctx);
+    layx_publish(&ctx);
+    frame = layx_acquire_frame(&ctx);
+    TEST_ASSERT(ctx.frames.copied == 1 && frame_matches(&ctx, frame), "重置后整帧复制");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_disabled() {
+    printf("\n=== Test: double buffering disabled ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_item(&ctx);
+    layx_run_context(&ctx);
+    layx_publish(&ctx);
+    TEST_ASSERT(layx_acquire_frame(&ctx) == NULL, "未启用时不发布");
+    TEST_ASSERT(layx_published_frames(&ctx) == 0, "发布计数为 0");
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Double-Buffered Results\n");
+    printf("========================================\n");
+
+    test_publish_and_acquire();
+    test_incremental_publish();
+    test_disabled();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
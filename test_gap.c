@@ -0,0 +1,252 @@
+/**
+ * @file test_gap.c
+ * @brief 测试容器的 row-gap / column-gap
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+static bool rect_is(layx_context *ctx, layx_id id, float x, float y, float w, float h)
+{
+    layx_vec4 r = layx_get_rect(ctx, id);
+    return FLOAT_EQUAL(r[0], x, 0.01f) && FLOAT_EQUAL(r[1], y, 0.01f) &&
+           FLOAT_EQUAL(r[2], w, 0.01f) && FLOAT_EQUAL(r[3], h, 0.01f);
+}
+
+static layx_id add_child(layx_context *ctx, layx_id parent, layx_scalar w, layx_scalar h)
+{
+    layx_id child = layx_item(ctx);
+    if (w > 0) layx_set_width(ctx, child, w);
+    if (h > 0) layx_set_height(ctx, child, h);
+    layx_append(ctx, parent, child);
+    return child;
+}
+
+void test_flex_row_gap() {
+    printf("\n=== Test: flex row column-gap ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_align_items(&ctx, root, LAYX_ALIGN_ITEMS_FLEX_START);
+    layx_set_size(&ctx, root, 400, 100);
+
+    layx_id row = layx_item(&ctx);
+    layx_set_display(&ctx, row, LAYX_DISPLAY_FLEX);
+    layx_set_column_gap(&ctx, row, 10);
+    layx_append(&ctx, root, row);
+    layx_id a = add_child(&ctx, row, 50, 20);
+    layx_id b = add_child(&ctx, row, 50, 20);
+    layx_id c = add_child(&ctx, row, 50, 20);
+    layx_run_context(&ctx);
+
+    TEST_ASSERT(rect_is(&ctx, a, 0, 0, 50, 20) && rect_is(&ctx, b, 60, 0, 50, 20) && rect_is(&ctx, c, 120, 0, 50, 20),
+                "相邻子元素之间插入间距");
+    TEST_ASSERT(FLOAT_EQUAL(layx_get_rect(&ctx, row)[2], 170, 0.01f), "内容宽度包含间距");
+
+    layx_destroy_context(&ctx);
+
+    // 伸缩时间距不参与分配
+    layx_init_context(&ctx);
+    layx_id grow = layx_item(&ctx);
+    layx_set_display(&ctx, grow, LAYX_DISPLAY_FLEX);
+    layx_set_size(&ctx, grow, 320, 20);
+    layx_set_gap(&ctx, grow, 0, 10);
+    layx_id g[3];
+    for (int i = 0; i < 3; i++) {
+        g[i] = add_child(&ctx, grow, 0, 20);
+        layx_set_flex_grow(&ctx, g[i], 1);
+    }
+    layx_run_context(&ctx);
+    TEST_ASSERT(rect_is(&ctx, g[0], 0, 0, 100, 20) && rect_is(&ctx, g[1], 110, 0, 100, 20) &&
+                rect_is(&ctx, g[2], 220, 0, 100, 20), "flex-grow 分配扣除间距后的空间");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_wrap_gap() {
+    printf("\n=== Test: wrapped lines use both gaps ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_align_items(&ctx, root, LAYX_ALIGN_ITEMS_FLEX_START);
+    layx_set_size(&ctx, root, 400, 300);
+
+    layx_id wrap = layx_item(&ctx);
+    layx_set_display(&ctx, wrap, LAYX_DISPLAY_FLEX);
+    layx_set_flex_wrap(&ctx, wrap, LAYX_FLEX_WRAP_WRAP);
+    layx_set_align_content(&ctx, wrap, LAYX_ALIGN_CONTENT_FLEX_START);
+    layx_set_width(&ctx, wrap, 200);
+    layx_set_gap(&ctx, wrap, 5, 20);
+    layx_append(&ctx, root, wrap);
+    layx_id items[4];
+    for (int i = 0; i < 4; i++) {
+        items[i] = add_child(&ctx, wrap, 90, 20);
+    }
+    layx_run_context(&ctx);
+
+    TEST_ASSERT(rect_is(&ctx, items[1], 110, 0, 90, 20), "行内间距：90 + 20 + 90 恰好放下");
+    TEST_ASSERT(rect_is(&ctx, items[2], 0, 25, 90, 20) && rect_is(&ctx, items[3], 110, 25, 90, 20), "行间距");
+    TEST_ASSERT(FLOAT_EQUAL(layx_get_rect(&ctx, wrap)[3], 45, 0.01f), "容器高度包含行间距");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_block_and_column_gap() {
+    printf("\n=== Test: block and column containers ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(&ctx, root, 200);
+    layx_set_row_gap(&ctx, root, 8);
+    layx_id a = add_child(&ctx, root, 0, 10);
+    layx_id b = add_child(&ctx, root, 0, 10);
+    layx_id c = add_child(&ctx, root, 0, 10);
+    layx_run_context(&ctx);
+
+    TEST_ASSERT(rect_is(&ctx, b, 0, 18, 200, 10) && rect_is(&ctx, c, 0, 36, 200, 10), "垂直方向使用 row-gap");
+    TEST_ASSERT(FLOAT_EQUAL(layx_get_rect(&ctx, root)[3], 46, 0.01f), "block 高度包含间距");
+
+    layx_set_margin_bottom(&ctx, a, 4);
+    layx_set_margin_top(&ctx, b, 6);
+    layx_run_context(&ctx);
+    TEST_ASSERT(rect_is(&ctx, b, 0, 10 + 6 + 8, 200, 10), "间距加在合并后的 margin 之外");
+    layx_set_margin_bottom(&ctx, a, 0);
+    layx_set_margin_top(&ctx, b, 0);
+
+    layx_id column = layx_item(&ctx);
+    layx_set_display(&ctx, column, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(&ctx, column, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_row_gap(&ctx, column, 3);
+    layx_set_column_gap(&ctx, column, 100);   // 交叉轴方向的间距对单行不起作用
+    layx_append(&ctx, root, column);
+    layx_id p = add_child(&ctx, column, 0, 10);
+    layx_id q = add_child(&ctx, column, 0, 10);
+    layx_run_context(&ctx);
+    float y0 = (float)layx_get_rect(&ctx, column)[1];
+    TEST_ASSERT(FLOAT_EQUAL(layx_get_rect(&ctx, q)[1] - layx_get_rect(&ctx, p)[1], 13, 0.01f), "column 方向使用 row-gap");
+    TEST_ASSERT(FLOAT_EQUAL(layx_get_rect(&ctx, p)[0], 0, 0.01f) && FLOAT_EQUAL(y0, 54, 0.01f), "不影响交叉轴");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_grid_gap() {
+    printf("\n=== Test: grid gaps between tracks ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id grid = layx_item(&ctx);
+    layx_set_display(&ctx, grid, LAYX_DISPLAY_GRID);
+    layx_grid_track columns[3] = { layx_track_fixed(50), layx_track_fixed(50), layx_track_fixed(50) };
+    layx_set_grid_columns(&ctx, grid, columns, 3);
+    layx_set_gap(&ctx, grid, 4, 10);
+    layx_id cells[6];
+    for (int i = 0; i < 6; i++) {
+        cells[i] = add_child(&ctx, grid, 0, 20);
+    }
+    layx_set_grid_span(&ctx, cells[3], 2, 1);
+    layx_run_context(&ctx);
+
+    TEST_ASSERT(rect_is(&ctx, cells[1], 60, 0, 50, 20) && rect_is(&ctx, cells[2], 120, 0, 50, 20), "列间距");
+    TEST_ASSERT(rect_is(&ctx, cells[3], 0, 24, 110, 20), "跨列的单元格包含中间的间距");
+    layx_vec4 r = layx_get_rect(&ctx, grid);
+    TEST_ASSERT(FLOAT_EQUAL(r[2], 170, 0.01f) && FLOAT_EQUAL(r[3], 3 * 20 + 2 * 4, 0.01f), "容器尺寸包含间距");
+
+    layx_set_column_gap(&ctx, grid, 0);
+    layx_run_context(&ctx);
+    TEST_ASSERT(rect_is(&ctx, cells[1], 50, 0, 50, 20), "修改间距后重新解析轨道");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_gap_replaces_margins() {
+    printf("\n=== Test: gap instead of per-child margins ===\n");
+
+    layx_context with_gap, with_margins;
+    layx_init_context(&with_gap);
+    layx_init_context(&with_margins);
+    layx_id lg = layx_item(&with_gap);
+    layx_id lm = layx_item(&with_margins);
+    layx_set_display(&with_gap, lg, LAYX_DISPLAY_FLEX);
+    layx_set_display(&with_margins, lm, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(&with_gap, lg, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_flex_direction(&with_margins, lm, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_size(&with_gap, lg, 300, 4000);
+    layx_set_size(&with_margins, lm, 300, 4000);
+    layx_set_row_gap(&with_gap, lg, 6);
+    for (int i = 0; i < 200; i++) {
+        add_child(&with_gap, lg, 0, 14);
+        layx_id m = add_child(&with_margins, lm, 0, 14);
+        if (i > 0) layx_set_margin_top(&with_margins, m, 6);
+    }
+    layx_run_context(&with_gap);
+    layx_run_context(&with_margins);
+
+    bool same = true;
+    for (layx_id i = 0; i < layx_items_count(&with_gap); i++) {
+        layx_vec4 ra = layx_get_rect(&with_gap, i);
+        layx_vec4 rb = layx_get_rect(&with_margins, i);
+        for (int k = 0; k < 4; k++) {
+            if (!FLOAT_EQUAL(ra[k], rb[k], 0.01f)) same = false;
+        }
+    }
+    TEST_ASSERT(same, "一个容器属性等价于每个子元素的 margin");
+
+    // 命令缓冲区
+    layx_command_buffer buf;
+    layx_cmd_init(&buf);
+    layx_cmd_set_scalar(&buf, lg, LAYX_PROP_ROW_GAP, 2);
+    layx_cmd_set_scalar(&buf, lg, LAYX_PROP_COLUMN_GAP, 1);
+    layx_apply_commands(&with_gap, &buf, 1);
+    layx_vec2 gap = layx_get_item(&with_gap, lg)->gap;
+    TEST_ASSERT(FLOAT_EQUAL(gap[1], 2, 0.001f) && FLOAT_EQUAL(gap[0], 1, 0.001f), "命令缓冲区可以设置间距");
+    layx_cmd_free(&buf);
+
+    layx_destroy_context(&with_gap);
+    layx_destroy_context(&with_margins);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Container Gaps\n");
+    printf("========================================\n");
+
+    test_flex_row_gap();
+    test_wrap_gap();
+    test_block_and_column_gap();
+    test_grid_gap();
+    test_gap_replaces_margins();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,296 @@
+/**
+ * @file test_grid.c
+ * @brief 测试 grid 容器的轨道解析、单元格放置与轨道尺寸缓存
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+static bool rect_is(layx_context *ctx, layx_id id, float x, float y, float w, float h)
+{
+    layx_vec4 r = layx_get_rect(ctx, id);
+    return FLOAT_EQUAL(r[0], x, 0.01f) && FLOAT_EQUAL(r[1], y, 0.01f) &&
+           FLOAT_EQUAL(r[2], w, 0.01f) && FLOAT_EQUAL(r[3], h, 0.01f);
+}
+
+void test_track_kinds() {
+    printf("\n=== Test: fixed, fr and auto tracks ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id grid = layx_item(&ctx);
+    layx_set_display(&ctx, grid, LAYX_DISPLAY_GRID);
+    layx_set_width(&ctx, grid, 400);
+    layx_set_padding(&ctx, grid, 10);
+
+    // 100px | auto | 1fr | 2fr
+    layx_grid_track columns[4] = { layx_track_fixed(100), layx_track_auto(), layx_track_fr(1), layx_track_fr(2) };
+    layx_set_grid_columns(&ctx, grid, columns, 4);
+    layx_grid_track rows[1] = { layx_track_fixed(30) };
+    layx_set_grid_rows(&ctx, grid, rows, 1);
+
+    layx_id cells[8];
+    for (int i = 0; i < 8; i++) {
+        cells[i] = layx_item(&ctx);
+        layx_append(&ctx, grid, cells[i]);
+    }
+    layx_set_width(&ctx, cells[1], 50);         // auto 列由内容决定
+    layx_set_margin_right(&ctx, cells[5], 10);
+    layx_set_height(&ctx, cells[4], 45);        // 第二行是隐式 auto 行
+    layx_run_context(&ctx);
+
+    TEST_ASSERT(layx_get_display_from_flags(layx_get_item(&ctx, grid)->flags) == LAYX_DISPLAY_GRID, "display 为 GRID");
+    TEST_ASSERT(rect_is(&ctx, cells[0], 10, 10, 100, 30), "固定列");
+    TEST_ASSERT(rect_is(&ctx, cells[1], 110, 10, 50, 30), "auto 列取内容宽度");
+    // 剩余 400 - 100 - 50 = 250
+    TEST_ASSERT(rect_is(&ctx, cells[2], 160, 10, 250.0f / 3, 30), "1fr 分到剩余空间的三分之一");
+    TEST_ASSERT(rect_is(&ctx, cells[3], 160 + 250.0f / 3, 10, 500.0f / 3, 30), "2fr 分到三分之二");
+    TEST_ASSERT(rect_is(&ctx, cells[4], 10, 40, 100, 45), "固定高度保持原尺寸");
+    TEST_ASSERT(rect_is(&ctx, cells[5], 110, 40, 40, 45), "拉伸到单元格并扣除 margin");
+
+    layx_scalar x, y, w, h;
+    layx_get_rect_xywh(&ctx, grid, &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(h, 20 + 30 + 45, 0.01f), "容器高度为行高之和");
+
+    const float *offsets = NULL;
+    TEST_ASSERT(layx_get_grid_track_offsets(&ctx, grid, 1, &offsets) == 2 && FLOAT_EQUAL(offsets[2], 75, 0.01f),
+                "可以读取解析后的行");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_placement() {
+    printf("\n=== Test: explicit placement and spans ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id grid = layx_item(&ctx);
+    layx_set_display(&ctx, grid, LAYX_DISPLAY_GRID);
+    layx_set_size(&ctx, grid, 300, 200);
+    layx_grid_track columns[3] = { layx_track_fr(1), layx_track_fr(1), layx_track_fr(1) };
+    layx_grid_track rows[2] = { layx_track_fr(1), layx_track_fr(1) };
+    layx_set_grid_columns(&ctx, grid, columns, 3);
+    layx_set_grid_rows(&ctx, grid, rows, 2);
+
+    layx_id header = layx_item(&ctx);
+    layx_set_grid_span(&ctx, header, 3, 1);
+    layx_append(&ctx, grid, header);
+    layx_id side = layx_item(&ctx);
+    layx_set_grid_cell(&ctx, side, 2, 1);
+    layx_append(&ctx, grid, side);
+    layx_id a = layx_item(&ctx);
+    layx_append(&ctx, grid, a);
+    layx_id b = layx_item(&ctx);
+    layx_append(&ctx, grid, b);
+    layx_id wide = layx_item(&ctx);
+    layx_set_grid_span(&ctx, wide, 2, 1);
+    layx_append(&ctx, grid, wide);
+    layx_run_context(&ctx);
+
+    TEST_ASSERT(rect_is(&ctx, header, 0, 0, 300, 100), "跨三列的标题");
+    TEST_ASSERT(rect_is(&ctx, side, 200, 100, 100, 100), "显式放置的单元格");
+    TEST_ASSERT(rect_is(&ctx, a, 0, 100, 100, 100), "自动放置接在标题之后");
+    TEST_ASSERT(rect_is(&ctx, b, 100, 100, 100, 100), "依次填充");
+    TEST_ASSERT(rect_is(&ctx, wide, 0, 200, 200, 0), "放不下时换到下一行（隐式 auto 行）");
+
+    layx_clear_grid_cell(&ctx, side);
+    layx_run_context(&ctx);
+    TEST_ASSERT(rect_is(&ctx, side, 0, 100, 100, 100), "清除后恢复自动放置");
+
+    // 复制的实例有自己的轨道记录
+    layx_id copy = layx_clone_subtree(&ctx, grid);
+    TEST_ASSERT(layx_get_item(&ctx, copy)->grid != layx_get_item(&ctx, grid)->grid, "复制得到独立的 grid 记录");
+    layx_grid_track one[1] = { layx_track_fr(1) };
+    layx_set_grid_columns(&ctx, copy, one, 1);
+    layx_run_context(&ctx);
+    layx_run_item(&ctx, copy);
+    TEST_ASSERT(rect_is(&ctx, header, 0, 0, 300, 100), "修改实例不影响模板");
+
+    layx_destroy_context(&ctx);
+}
+
+// 100 x 50 的数据表：一个 grid 容器代替 100 个 flex 行
+static layx_id build_table(layx_context *ctx, int rows, int columns)
+{
+    layx_id root = layx_item(ctx);
+    layx_set_display(ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(ctx, root, 2600);
+    layx_id table = layx_item(ctx);
+    layx_set_display(ctx, table, LAYX_DISPLAY_GRID);
+    layx_set_padding(ctx, table, 4);
+    layx_append(ctx, root, table);
+
+    layx_grid_track tracks[50];
+    for (int c = 0; c < columns; c++) {
+        tracks[c] = c == 0 ? layx_track_fixed(120) : layx_track_fr(1);
+    }
+    layx_set_grid_columns(ctx, table, tracks, (uint32_t)columns);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < columns; c++) {
+            layx_id cell = layx_item(ctx);
+            layx_set_height(ctx, cell, (layx_scalar)(18 + (r % 3)));
+            layx_append(ctx, table, cell);
+        }
+    }
+    return table;
+}
+
+void test_data_table() {
+    printf("\n=== Test: 100 x 50 data table and track cache ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id table = build_table(&ctx, 100, 50);
+    layx_run_context(&ctx);
+
+    TEST_ASSERT(layx_items_count(&ctx) == 2 + 100 * 50, "没有额外的行容器");
+    layx_id first = layx_first_child(&ctx, table);
+    TEST_ASSERT(rect_is(&ctx, first, 4, 4, 120, 18), "第一个单元格");
+    // 宽度 2600 - 8 - 120 = 2472，49 个 1fr
+    layx_id cell = first + 50 * 7 + 3;
+    float fr = 2472.0f / 49.0f;
+    float y = 4 + 18 * 3 + 19 * 2 + 20 * 2;
+    TEST_ASSERT(rect_is(&ctx, cell, 4 + 120 + 2 * fr, y, fr, 19), "第 8 行第 4 列");
+
+    layx_grid *grid = ctx.grids.records + layx_get_item(&ctx, table)->grid;
+    TEST_ASSERT(grid->cached[0] && !grid->cached[1], "列缓存，auto 行不缓存");
+    const float *columns_before = grid->offsets[0];
+    float column_3 = columns_before[3];
+
+    // 只改变单元格内容：列直接复用，行重新解析
+    grid->offsets[0][3] = -1.0f;    // 如果被重新解析会被覆盖
+    layx_set_height(&ctx, cell, 60);
+    layx_run_context(&ctx);
+    TEST_ASSERT(FLOAT_EQUAL(grid->offsets[0][3], -1.0f, 0.001f), "单元格变化不重新解析列");
+    grid->offsets[0][3] = column_3;
+    layx_run_context(&ctx);
+    layx_vec4 r = layx_get_rect(&ctx, cell + 50);
+    TEST_ASSERT(FLOAT_EQUAL(r[1], y + 60, 0.01f), "行高随内容变化");
+
+    // 容器宽度变化后列重新解析
+    layx_set_width(&ctx, 0, 1300);
+    layx_run_context(&ctx);
+    fr = (1300.0f - 8 - 120) / 49.0f;
+    TEST_ASSERT(FLOAT_EQUAL(layx_get_rect(&ctx, cell)[2], fr, 0.01f), "可用空间变化后重新解析");
+
+    layx_grid_track narrow[2] = { layx_track_fixed(10), layx_track_fixed(20) };
+    layx_set_grid_columns(&ctx, table, narrow, 2);
+    layx_run_context(&ctx);
+    TEST_ASSERT(rect_is(&ctx, first + 1, 14, 4, 20, 18), "修改轨道定义后重新解析");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_content_sized() {
+    printf("\n=== Test: content-sized grid ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_align_items(&ctx, root, LAYX_ALIGN_ITEMS_FLEX_START);
+    layx_set_size(&ctx, root, 500, 300);
+    layx_id grid = layx_item(&ctx);
+    layx_set_display(&ctx, grid, LAYX_DISPLAY_GRID);
+    layx_grid_track columns[2] = { layx_track_auto(), layx_track_fr(1) };
+    layx_set_grid_columns(&ctx, grid, columns, 2);
+    layx_append(&ctx, root, grid);
+
+    layx_id label = layx_item(&ctx);
+    layx_set_size(&ctx, label, 40, 10);
+    layx_append(&ctx, grid, label);
+    layx_id value = layx_item(&ctx);
+    layx_set_size(&ctx, value, 70, 25);
+    layx_append(&ctx, grid, value);
+    layx_run_context(&ctx);
+
+    layx_scalar x, y, w, h;
+    layx_get_rect_xywh(&ctx, grid, &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(w, 110, 0.01f) && FLOAT_EQUAL(h, 25, 0.01f), "不确定空间中 fr 轨道由内容决定");
+    TEST_ASSERT(rect_is(&ctx, value, 40, 0, 70, 25), "固定尺寸的单元格靠起点放置");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_implicit_rows() {
+    printf("\n=== Test: implicit row count ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_size(&ctx, root, 200, 0);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_GRID);
+    layx_grid_track columns[2] = { layx_track_fr(1), layx_track_fr(1) };
+    layx_set_grid_columns(&ctx, root, columns, 2);
+    layx_id cells[3];
+    for (int i = 0; i < 3; i++) {
+        cells[i] = layx_item(&ctx);
+        layx_set_height(&ctx, cells[i], 10);
+        layx_append(&ctx, root, cells[i]);
+    }
+    layx_run_context(&ctx);
+    const layx_grid *grid = ctx.grids.records + layx_get_item(&ctx, root)->grid;
+    TEST_ASSERT(grid->rows_cached && grid->rows == 2, "三个子元素放在两行");
+    TEST_ASSERT(FLOAT_EQUAL(layx_get_rect(&ctx, root)[3], 20, 0.01f), "隐式行按内容决定高度");
+
+    // 不影响子元素放置的重新布局沿用统计结果
+    layx_set_width(&ctx, root, 300);
+    layx_run_context(&ctx);
+    TEST_ASSERT(grid->rows_cached && grid->rows == 2, "宽度变化后行数不变");
+
+    layx_id extra = layx_item(&ctx);
+    layx_set_height(&ctx, extra, 10);
+    layx_append(&ctx, root, extra);
+    layx_set_grid_cell(&ctx, extra, 0, 4);
+    layx_run_context(&ctx);
+    // 中间两个空的隐式行高度为 0
+    TEST_ASSERT(grid->rows == 5 && FLOAT_EQUAL(layx_get_rect(&ctx, extra)[1], 20, 0.01f), "显式放到第 5 行后追加隐式行");
+
+    layx_grid_track wide[3] = { layx_track_fr(1), layx_track_fr(1), layx_track_fr(1) };
+    layx_set_grid_columns(&ctx, root, wide, 3);
+    layx_clear_grid_cell(&ctx, extra);
+    layx_run_context(&ctx);
+    TEST_ASSERT(grid->rows == 2 && FLOAT_EQUAL(layx_get_rect(&ctx, root)[3], 20, 0.01f), "列数变化后重新统计行数");
+
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Grid Containers\n");
+    printf("========================================\n");
+
+    test_track_kinds();
+    test_placement();
+    test_data_table();
+    test_content_sized();
+    test_implicit_rows();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file test_id16.c
+ * @brief 测试 16 位 id 模式（链接 layx_id16，LAYX_ID_BITS=16）
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+static bool rect_is(layx_context *ctx, layx_id id, float x, float y, float w, float h)
+{
+    layx_vec4 r = layx_get_rect(ctx, id);
+    return FLOAT_EQUAL(r[0], x, 0.01f) && FLOAT_EQUAL(r[1], y, 0.01f)
+        && FLOAT_EQUAL(r[2], w, 0.01f) && FLOAT_EQUAL(r[3], h, 0.01f);
+}
+
+void test_id_type() {
+    printf("\n=== Test: id type ===\n");
+
+    layx_item_t item;
+    TEST_ASSERT(LAYX_ID_BITS == 16 && sizeof(layx_id) == 2, "layx_id 为 16 位");
+    TEST_ASSERT(LAYX_INVALID_ID == 0xFFFF, "LAYX_INVALID_ID 随位宽变化");
+    TEST_ASSERT(LAYX_MAX_ITEMS == 0xFFFF, "最多 65535 个 item");
+    TEST_ASSERT(sizeof(item.first_child) + sizeof(item.next_sibling) + sizeof(item.parent) == 6, "链接字段共 6 字节");
+    printf("  sizeof(layx_item_t) = %u\n", (unsigned)sizeof(layx_item_t));
+
+    // 16 位字段排在一起，链接字段省下的 6 字节不会被对齐填充吃掉
+    TEST_ASSERT(offsetof(layx_item_t, grid_span) - offsetof(layx_item_t, first_child) == 3 * sizeof(layx_id) + 3 * sizeof(uint16_t),
+                "链接、样式覆盖与单元格字段之间没有填充");
+    const size_t fields = 13 * sizeof(uint32_t) + 3 * sizeof(layx_id) + 3 * sizeof(uint16_t) + 4 * sizeof(uint8_t)
+                        + 19 * sizeof(layx_scalar) + 3 * sizeof(void*);
+    TEST_ASSERT(sizeof(layx_item_t) < fields + sizeof(void*), "填充不超过一个对齐单位");
+    TEST_ASSERT(sizeof(layx_item_t) < fields + 3 * (sizeof(uint32_t) - sizeof(layx_id)), "比 32 位 id 的 item 小");
+}
+
+void test_full_context() {
+    printf("\n=== Test: fill the id space ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_size(&ctx, root, 300, 50);
+
+    // 按倍数扩容会越过 32768 与 65535，容量必须截断在 id 范围内
+    layx_id last = root;
+    while (layx_items_count(&ctx) < LAYX_MAX_ITEMS) {
+        last = layx_item(&ctx);
+    }
+    TEST_ASSERT(last == LAYX_INVALID_ID - 1, "最后一个 id 为 65534");
+    TEST_ASSERT(layx_items_capacity(&ctx) == LAYX_MAX_ITEMS, "容量截断在 LAYX_MAX_ITEMS");
+
+    // 链接到高位 id 的子元素正常布局
+    layx_id low = 1;
+    layx_set_size(&ctx, low, 100, 20);
+    layx_append(&ctx, root, low);
+    layx_set_flex_grow(&ctx, last, 1);
+    layx_append(&ctx, root, last);
+    layx_run_context(&ctx);
+    TEST_ASSERT(layx_next_sibling(&ctx, low) == last && layx_get_item(&ctx, last)->parent == root, "高位 id 的链接正确");
+    TEST_ASSERT(rect_is(&ctx, last, 100, 0, 200, 50), "高位 id 的子元素按 flex 布局");
+
+    // 销毁后从空闲链表复用
+    layx_destroy_item(&ctx, last);
+    layx_id reused = layx_item(&ctx);
+    TEST_ASSERT(reused == last, "销毁后复用 id");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_clone() {
+    printf("\n=== Test: clone with 16-bit ids ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(&ctx, root, 100);
+    layx_id card = layx_item(&ctx);
+    layx_append(&ctx, root, card);
+    for (int i = 0; i < 3; i++) {
+        layx_id row = layx_item(&ctx);
+        layx_set_height(&ctx, row, 10);
+        layx_append(&ctx, card, row);
+    }
+
+    // 复制到 40000 个 item 以上，跨过 32768 的扩容边界
+    while (layx_items_count(&ctx) < 40000) {
+        layx_clone_subtree(&ctx, card);
+    }
+    layx_id copy = layx_clone_subtree(&ctx, card);
+    layx_append(&ctx, root, copy);
+    layx_run_context(&ctx);
+    TEST_ASSERT(copy > 40000, "复制得到的 id 超过 40000");
+    TEST_ASSERT(rect_is(&ctx, copy, 0, 30, 100, 30), "复制的子树布局正确");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_command_limit() {
+    printf("\n=== Test: command buffers with 16-bit ids ===\n");
+
+    TEST_ASSERT(LAYX_CMD_LOCAL_BIT == 0x8000 && LAYX_CMD_MAX_ITEMS == 32768, "命令缓冲区上限为 32768 个 item");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(&ctx, root, 100);
+    while (layx_items_count(&ctx) < LAYX_CMD_MAX_ITEMS - 1) {
+        layx_item(&ctx);
+    }
+
+    // 回放中新建的最后一个 id 恰好在本地 handle 位之下
+    layx_command_buffer buf;
+    layx_cmd_init(&buf);
+    layx_id row = layx_cmd_create(&buf);
+    layx_cmd_set_scalar(&buf, row, LAYX_PROP_HEIGHT, 12);
+    layx_cmd_append(&buf, root, row);
+    layx_apply_commands(&ctx, &buf, 1);
+    layx_run_context(&ctx);
+
+    layx_id created = layx_first_child(&ctx, root);
+    TEST_ASSERT(created == LAYX_CMD_MAX_ITEMS - 1 && !(created & LAYX_CMD_LOCAL_BIT), "新建 id 为 32767");
+    TEST_ASSERT(rect_is(&ctx, created, 0, 0, 100, 12), "本地 handle 的属性写入新 item");
+
+    layx_cmd_free(&buf);
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: 16-bit Ids\n");
+    printf("========================================\n");
+
+    test_id_type();
+    test_full_context();
+    test_clone();
+    test_command_limit();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
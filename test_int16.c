@@ -0,0 +1,224 @@
+/**
+ * @file test_int16.c
+ * @brief 测试 16 位整数标量模式（链接 layx_int16，LAYX_FLOAT=0）
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+static bool rect_is(layx_context *ctx, layx_id id, int x, int y, int w, int h)
+{
+    layx_vec4 r = layx_get_rect(ctx, id);
+    return r[0] == x && r[1] == y && r[2] == w && r[3] == h;
+}
+
+void test_scalar_type() {
+    printf("\n=== Test: scalar type ===\n");
+
+#if LAYX_FLOAT == 1
+    TEST_ASSERT(false, "编译时定义了 LAYX_FLOAT=0");
+#else
+    TEST_ASSERT(true, "编译时定义了 LAYX_FLOAT=0");
+#endif
+    TEST_ASSERT(sizeof(layx_scalar) == 2, "layx_scalar 为 16 位");
+    TEST_ASSERT(sizeof(layx_vec4) == 8, "rect 为 8 字节");
+    TEST_ASSERT(sizeof(layx_vec2) == 4, "vec2 为 4 字节");
+
+    // 标量缩小后，item 中除尾部对齐外不应再有填充：tag、observer 等字段不能让 item 按模式变大
+    const size_t fields = 13 * sizeof(uint32_t) + 3 * sizeof(layx_id) + 3 * sizeof(uint16_t) + 4 * sizeof(uint8_t)
+                        + 19 * sizeof(layx_scalar) + 3 * sizeof(void*);
+    printf("  sizeof(layx_item_t) = %u\n", (unsigned)sizeof(layx_item_t));
+    TEST_ASSERT(sizeof(layx_item_t) < fields + sizeof(void*), "layx_item_t 填充不超过一个对齐单位");
+}
+
+void test_flex_integer() {
+    printf("\n=== Test: flex layout in integer pixels ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_size(&ctx, root, 301, 40);
+    layx_set_padding(&ctx, root, 5);
+
+    layx_id fixed = layx_item(&ctx);
+    layx_set_size(&ctx, fixed, 50, 20);
+    layx_set_margin_right(&ctx, fixed, 10);
+    layx_append(&ctx, root, fixed);
+
+    // 伸缩系数是 float，0.5 与 1.5 在整数模式下依然按比例分配
+    layx_id half = layx_item(&ctx);
+    layx_set_flex_grow(&ctx, half, 0.5f);
+    layx_append(&ctx, root, half);
+    layx_id rest = layx_item(&ctx);
+    layx_set_flex_grow(&ctx, rest, 1.5f);
+    layx_append(&ctx, root, rest);
+    layx_run_context(&ctx);
+
+    TEST_ASSERT(layx_get_item(&ctx, half)->flex_grow == 0.5f, "flex-grow 保留小数");
+    TEST_ASSERT(rect_is(&ctx, fixed, 5, 5, 50, 20), "固定尺寸子元素");
+    // 剩余 301 - 60 = 241，按 1:3 分配（60.25 与 180.75）并截断到像素
+    TEST_ASSERT(rect_is(&ctx, half, 65, 5, 60, 40), "0.5 分到四分之一");
+    TEST_ASSERT(rect_is(&ctx, rest, 125, 5, 180, 40), "1.5 分到四分之三");
+
+    // 奇数剩余空间居中：截断而不是产生半像素
+    layx_set_flex_grow(&ctx, half, 0);
+    layx_set_flex_grow(&ctx, rest, 0);
+    layx_set_width(&ctx, half, 20);
+    layx_set_width(&ctx, rest, 20);
+    layx_set_justify_content(&ctx, root, LAYX_JUSTIFY_CENTER);
+    layx_run_context(&ctx);
+    layx_vec4 r = layx_get_rect(&ctx, fixed);
+    TEST_ASSERT(r[0] == 5 + (301 - 100) / 2, "居中偏移截断到整数像素");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_block_and_grid_integer() {
+    printf("\n=== Test: block and grid layout in integer pixels ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(&ctx, root, 200);
+    layx_set_padding(&ctx, root, 4);
+
+    layx_id a = layx_item(&ctx);
+    layx_set_height(&ctx, a, 30);
+    layx_set_margin_bottom(&ctx, a, 6);
+    layx_append(&ctx, root, a);
+
+    layx_id grid = layx_item(&ctx);
+    layx_set_display(&ctx, grid, LAYX_DISPLAY_GRID);
+    layx_grid_track columns[3] = { layx_track_fixed(40), layx_track_fr(1), layx_track_fr(2) };
+    layx_set_grid_columns(&ctx, grid, columns, 3);
+    layx_grid_track rows[1] = { layx_track_fixed(25) };
+    layx_set_grid_rows(&ctx, grid, rows, 1);
+    layx_set_gap(&ctx, grid, 0, 3);
+    layx_append(&ctx, root, grid);
+    layx_id cells[3];
+    for (int i = 0; i < 3; i++) {
+        cells[i] = layx_item(&ctx);
+        layx_append(&ctx, grid, cells[i]);
+    }
+    layx_run_context(&ctx);
+
+    TEST_ASSERT(rect_is(&ctx, a, 4, 4, 200, 30), "block 子元素撑满内容宽度");
+    TEST_ASSERT(rect_is(&ctx, grid, 4, 40, 200, 25), "grid 在 margin 之后");
+    TEST_ASSERT(rect_is(&ctx, cells[0], 4, 40, 40, 25), "固定列");
+    // 200 - 40 - 2 * 3 = 154，1fr:2fr（51.33 与 102.67）
+    layx_vec4 c1 = layx_get_rect(&ctx, cells[1]);
+    layx_vec4 c2 = layx_get_rect(&ctx, cells[2]);
+    TEST_ASSERT(c1[0] == 47 && c1[2] == 51, "1fr 截断到整数像素");
+    TEST_ASSERT(c2[0] == 101 && c2[2] == 102, "2fr 截断到整数像素");
+
+    // fr 比例不随坐标截断为整数
+    layx_grid_track halves[2] = { layx_track_fr(0.5f), layx_track_fr(1.5f) };
+    layx_set_grid_columns(&ctx, grid, halves, 2);
+    layx_set_gap(&ctx, grid, 0, 0);
+    layx_run_context(&ctx);
+    TEST_ASSERT(layx_get_rect(&ctx, cells[0])[2] == 50 && layx_get_rect(&ctx, cells[1])[2] == 150,
+                "0.5fr:1.5fr 按小数比例分配");
+
+    layx_scalar x, y, w, h;
+    layx_get_rect_xywh(&ctx, root, &x, &y, &w, &h);
+    TEST_ASSERT(h == 4 + 30 + 6 + 25 + 4, "容器高度为整数");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_style_padding_bytes() {
+    printf("\n=== Test: shared styles ignore padding bytes ===\n");
+
+    // 整数标量模式下 layx_style 末尾有填充字节：字段相同、填充不同的两份样式必须去重为同一条记录
+    const size_t fields = offsetof(layx_style, flex_basis) + sizeof(layx_scalar);
+    TEST_ASSERT(fields < sizeof(layx_style), "layx_style 有尾部填充");
+
+    layx_style a, b;
+    memset(&a, 0x00, sizeof(a));
+    memset(&b, 0xA5, sizeof(b));
+    a.height = 40;
+    a.padding_left = 8;
+    memcpy(&b, &a, fields);
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_style_id id_a = layx_intern_style(&ctx, &a);
+    TEST_ASSERT(layx_intern_style(&ctx, &b) == id_a, "填充字节不同的相同样式得到同一个 id");
+
+    layx_id item = layx_item(&ctx);
+    layx_set_style(&ctx, item, id_a);
+    layx_run_context(&ctx);
+    layx_update_style(&ctx, id_a, &b);
+    TEST_ASSERT(!layx_is_dirty(&ctx, item), "内容相同的更新不标记引用者");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_command_factors() {
+    printf("\n=== Test: flex factors in command buffers ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_size(&ctx, root, 200, 20);
+    layx_id a = layx_item(&ctx);
+    layx_id b = layx_item(&ctx);
+    layx_append(&ctx, root, a);
+    layx_append(&ctx, root, b);
+
+    // 0.5 与 1.5 经过 int16 标量会截断为 0 和 1
+    layx_command_buffer buf;
+    layx_cmd_init(&buf);
+    layx_cmd_set_factor(&buf, a, LAYX_PROP_FLEX_GROW, 0.5f);
+    layx_cmd_set_factor(&buf, b, LAYX_PROP_FLEX_GROW, 1.5f);
+    layx_cmd_set_factor(&buf, b, LAYX_PROP_FLEX_SHRINK, 0.25f);
+    layx_apply_commands(&ctx, &buf, 1);
+    TEST_ASSERT(layx_get_item(&ctx, a)->flex_grow == 0.5f && layx_get_item(&ctx, b)->flex_grow == 1.5f &&
+                layx_get_item(&ctx, b)->flex_shrink == 0.25f, "伸缩系数保留小数");
+    layx_run_context(&ctx);
+    TEST_ASSERT(layx_get_rect(&ctx, a)[2] == 50 && layx_get_rect(&ctx, b)[2] == 150, "按 0.5:1.5 分配剩余空间");
+
+    layx_cmd_free(&buf);
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Integer Scalar Mode\n");
+    printf("========================================\n");
+
+    test_scalar_type();
+    test_flex_integer();
+    test_block_and_grid_integer();
+    test_style_padding_bytes();
+    test_command_factors();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
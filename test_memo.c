@@ -0,0 +1,279 @@
+/**
+ * @file test_memo.c
+ * @brief 测试子树布局结果缓存
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+// 卡片：标题行 + 会换行的标签容器 + 底部按钮
+static layx_id build_card(layx_context *ctx, bool memoize)
+{
+    layx_id card = layx_item(ctx);
+    layx_set_display(ctx, card, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(ctx, card, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_padding(ctx, card, 6);
+    layx_set_margin_bottom(ctx, card, 4);
+    if (memoize) layx_set_memoize(ctx, card, true);
+
+    layx_id title = layx_item(ctx);
+    layx_set_height(ctx, title, 18);
+    layx_append(ctx, card, title);
+
+    layx_id tags = layx_item(ctx);
+    layx_set_display(ctx, tags, LAYX_DISPLAY_FLEX);
+    layx_set_flex_wrap(ctx, tags, LAYX_FLEX_WRAP_WRAP);
+    layx_set_gap(ctx, tags, 2, 3);
+    layx_append(ctx, card, tags);
+    for (int i = 0; i < 7; i++) {
+        layx_id tag = layx_item(ctx);
+        layx_set_size(ctx, tag, (layx_scalar)(30 + 7 * i), 12);
+        layx_append(ctx, tags, tag);
+    }
+
+    layx_id footer = layx_item(ctx);
+    layx_set_display(ctx, footer, LAYX_DISPLAY_FLEX);
+    layx_set_justify_content(ctx, footer, LAYX_JUSTIFY_FLEX_END);
+    layx_append(ctx, card, footer);
+    layx_id button = layx_item(ctx);
+    layx_set_size(ctx, button, 40, 16);
+    layx_append(ctx, footer, button);
+    return card;
+}
+
+static layx_id build_list(layx_context *ctx, int cards, bool memoize)
+{
+    layx_id root = layx_item(ctx);
+    layx_set_display(ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(ctx, root, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_width(ctx, root, 240);
+    layx_set_padding(ctx, root, 5);
+    for (int i = 0; i < cards; i++) {
+        layx_append(ctx, root, build_card(ctx, memoize));
+    }
+    return root;
+}
+
+static bool same_rects(layx_context *a, layx_context *b)
+{
+    if (layx_items_count(a) != layx_items_count(b)) return false;
+    for (layx_id i = 0; i < layx_items_count(a); i++) {
+        layx_vec4 ra = layx_get_rect(a, i);
+        layx_vec4 rb = layx_get_rect(b, i);
+        for (int k = 0; k < 4; k++) {
+            if (!FLOAT_EQUAL(ra[k], rb[k], 0.001f)) return false;
+        }
+    }
+    return true;
+}
+
+void test_repeated_cards() {
+    printf("\n=== Test: repeated cards hit the cache ===\n");
+
+    layx_context memo, plain;
+    layx_init_context(&memo);
+    layx_init_context(&plain);
+    layx_set_memo_capacity(&memo, 16);
+    layx_id root = build_list(&memo, 20, true);
+    build_list(&plain, 20, false);
+
+    layx_memo_stats stats;
+    layx_run_context(&memo);
+    layx_run_context(&plain);
+    layx_get_memo_stats(&memo, &stats);
+    TEST_ASSERT(same_rects(&memo, &plain), "首次布局结果与未缓存一致");
+    TEST_ASSERT(stats.misses == 1 && stats.hits == 19, "首次布局只有第一张卡片需要计算");
+    TEST_ASSERT(stats.entries == 1, "相同结构只缓存一条记录");
+
+    // 宽度变化后：每种宽度只计算一次
+    layx_reset_memo_stats(&memo);
+    layx_set_width(&memo, root, 180);
+    layx_set_width(&plain, root, 180);
+    layx_run_context(&memo);
+    layx_run_context(&plain);
+    layx_get_memo_stats(&memo, &stats);
+    TEST_ASSERT(same_rects(&memo, &plain), "改变宽度后结果一致");
+    TEST_ASSERT(stats.misses == 1 && stats.hits == 19, "新宽度只计算一次");
+    TEST_ASSERT(stats.entries == 2, "两种宽度各一条记录");
+
+    // 恢复原宽度：全部命中
+    layx_reset_memo_stats(&memo);
+    layx_set_width(&memo, root, 240);
+    layx_set_width(&plain, root, 240);
+    layx_run_context(&memo);
+    layx_run_context(&plain);
+    layx_get_memo_stats(&memo, &stats);
+    TEST_ASSERT(same_rects(&memo, &plain) && stats.misses == 0 && stats.hits == 20, "之前的宽度全部命中");
+
+    layx_destroy_context(&memo);
+    layx_destroy_context(&plain);
+}
+
+void test_changed_subtree() {
+    printf("\n=== Test: a modified card misses ===\n");
+
+    layx_context memo, plain;
+    layx_init_context(&memo);
+    layx_init_context(&plain);
+    layx_set_memo_capacity(&memo, 16);
+    layx_id root = build_list(&memo, 6, true);
+    build_list(&plain, 6, false);
+    layx_run_context(&memo);
+    layx_run_context(&plain);
+
+    // 第三张卡片的标题变高，多一个标签
+    layx_id card = layx_first_child(&memo, root);
+    card = layx_next_sibling(&memo, layx_next_sibling(&memo, card));
+    layx_id title = layx_first_child(&memo, card);
+    layx_set_height(&memo, title, 30);
+    layx_set_height(&plain, title, 30);
+    layx_id tags = layx_next_sibling(&memo, title);
+    layx_id extra = layx_item(&memo);
+    layx_set_size(&memo, extra, 50, 12);
+    layx_append(&memo, tags, extra);
+    extra = layx_item(&plain);
+    layx_set_size(&plain, extra, 50, 12);
+    layx_append(&plain, tags, extra);
+
+    layx_memo_stats stats;
+    layx_reset_memo_stats(&memo);
+    layx_run_context(&memo);
+    layx_run_context(&plain);
+    layx_get_memo_stats(&memo, &stats);
+    TEST_ASSERT(same_rects(&memo, &plain), "修改后结果一致");
+    TEST_ASSERT(stats.misses == 1 && stats.hits == 5, "只有修改的卡片重新计算");
+    TEST_ASSERT(!layx_is_dirty(&memo, extra), "命中或计算后都不再是脏的");
+
+    layx_destroy_context(&memo);
+    layx_destroy_context(&plain);
+}
+
+void test_eviction() {
+    printf("\n=== Test: eviction ===\n");
+
+    layx_context memo, plain;
+    layx_init_context(&memo);
+    layx_init_context(&plain);
+    layx_set_memo_capacity(&memo, 1);
+    layx_id root = build_list(&memo, 4, true);
+    build_list(&plain, 4, false);
+
+    layx_memo_stats stats;
+    for (int round = 0; round < 3; round++) {
+        layx_scalar width = (round % 2) ? 200.0f : 240.0f;
+        layx_set_width(&memo, root, width);
+        layx_set_width(&plain, root, width);
+        layx_run_context(&memo);
+        layx_run_context(&plain);
+    }
+    layx_get_memo_stats(&memo, &stats);
+    TEST_ASSERT(same_rects(&memo, &plain), "淘汰后结果仍然正确");
+    TEST_ASSERT(stats.entries == 1 && stats.evictions == 2, "容量为 1 时交替的宽度互相淘汰");
+    TEST_ASSERT(stats.misses == 3 && stats.hits == 9, "每轮只有第一张卡片计算");
+
+    // 关闭后走普通的布局路径
+    layx_set_memo_capacity(&memo, 0);
+    layx_reset_memo_stats(&memo);
+    layx_set_width(&memo, root, 220);
+    layx_set_width(&plain, root, 220);
+    layx_run_context(&memo);
+    layx_run_context(&plain);
+    layx_get_memo_stats(&memo, &stats);
+    TEST_ASSERT(same_rects(&memo, &plain) && stats.hits == 0 && stats.misses == 0, "容量为 0 时不使用缓存");
+
+    layx_destroy_context(&memo);
+    layx_destroy_context(&plain);
+}
+
+void test_second_chance() {
+    printf("\n=== Test: clock eviction keeps reused results ===\n");
+
+    layx_context memo, plain;
+    layx_init_context(&memo);
+    layx_init_context(&plain);
+    layx_set_memo_capacity(&memo, 2);
+    layx_id root = build_list(&memo, 1, true);
+    build_list(&plain, 1, false);
+
+    // 240 插入后再次命中，160 插入时淘汰插入后没有命中过的 200
+    const layx_scalar widths[6] = { 240, 200, 240, 160, 240, 200 };
+    bool same = true;
+    layx_memo_stats stats;
+    for (int round = 0; round < 6; round++) {
+        layx_set_width(&memo, root, widths[round]);
+        layx_set_width(&plain, root, widths[round]);
+        layx_run_context(&memo);
+        layx_run_context(&plain);
+        same = same && same_rects(&memo, &plain);
+        if (round == 4) layx_get_memo_stats(&memo, &stats);
+    }
+    TEST_ASSERT(same, "每轮结果与不缓存时一致");
+    TEST_ASSERT(stats.hits == 2 && stats.evictions == 1, "命中过的 240 在淘汰后仍然命中");
+    layx_get_memo_stats(&memo, &stats);
+    TEST_ASSERT(stats.hits == 2 && stats.misses == 4 && stats.evictions == 2, "被淘汰的 200 重新计算");
+
+    layx_destroy_context(&memo);
+    layx_destroy_context(&plain);
+}
+
+void test_time_sliced() {
+    printf("\n=== Test: memoised roots in time-sliced layout ===\n");
+
+    layx_context memo, plain;
+    layx_init_context(&memo);
+    layx_init_context(&plain);
+    layx_set_memo_capacity(&memo, 8);
+    build_list(&memo, 30, true);
+    build_list(&plain, 30, false);
+
+    int calls = 0;
+    while (layx_run_context_step(&memo, 5, 0) == LAYX_STEP_IN_PROGRESS && calls < 1000) {
+        calls++;
+    }
+    layx_run_context(&plain);
+    TEST_ASSERT(calls > 1 && layx_layout_complete(&memo), "分步布局完成");
+    TEST_ASSERT(same_rects(&memo, &plain), "分步布局结果一致");
+
+    layx_destroy_context(&memo);
+    layx_destroy_context(&plain);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Subtree Memoisation\n");
+    printf("========================================\n");
+
+    test_repeated_cards();
+    test_changed_subtree();
+    test_eviction();
+    test_second_chance();
+    test_time_sliced();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
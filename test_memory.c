@@ -0,0 +1,308 @@
+/**
+ * @file test_memory.c
+ * @brief 测试内存占用统计与 layx_shrink_to_fit
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+// 文档：block 根，rows 行，每行 flex 容器带 3 个单元格（先序创建，id 与遍历顺序一致）
+static layx_id build_document(layx_context *ctx, int rows)
+{
+    layx_id root = layx_item(ctx);
+    layx_set_display(ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(ctx, root, 300);
+    for (int i = 0; i < rows; i++) {
+        layx_id row = layx_item(ctx);
+        layx_set_display(ctx, row, LAYX_DISPLAY_FLEX);
+        layx_set_margin_bottom(ctx, row, 2);
+        layx_append(ctx, root, row);
+        for (int c = 0; c < 3; c++) {
+            layx_id cell = layx_item(ctx);
+            layx_set_height(ctx, cell, 12);
+            layx_set_flex_grow(ctx, cell, (float)(c + 1));
+            layx_append(ctx, row, cell);
+        }
+    }
+    return root;
+}
+
+static bool same_subtree_rects(layx_context *a, layx_context *b, layx_id first, layx_id count)
+{
+    for (layx_id i = first; i < first + count; i++) {
+        layx_vec4 ra = layx_get_rect(a, i);
+        layx_vec4 rb = layx_get_rect(b, i);
+        for (int k = 0; k < 4; k++) {
+            if (!FLOAT_EQUAL(ra[k], rb[k], 0.001f)) return false;
+        }
+    }
+    return true;
+}
+
+void test_report() {
+    printf("\n=== Test: memory report ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    build_document(&ctx, 20);
+    layx_run_context(&ctx);
+
+    layx_memory_stats stats;
+    layx_get_memory_stats(&ctx, &stats);
+    TEST_ASSERT(stats.item_count == 81 && stats.live_items == 81 && stats.free_items == 0, "存活与空闲数量");
+    TEST_ASSERT(stats.item_capacity == ctx.capacity && stats.item_bytes == ctx.capacity * sizeof(layx_item_t) &&
+                stats.rect_bytes == ctx.capacity * sizeof(layx_vec4), "items / rects 按容量计算");
+    TEST_ASSERT(stats.box_bytes > 0 && stats.scratch_bytes > 0 && stats.cache_bytes == 0 && stats.frame_bytes == 0,
+                "分别统计各表");
+    TEST_ASSERT(stats.total_bytes == stats.item_bytes + stats.rect_bytes + stats.box_bytes + stats.style_bytes +
+                stats.grid_bytes + stats.cache_bytes + stats.scratch_bytes + stats.delta_bytes + stats.frame_bytes +
+                stats.observer_bytes,
+                "total 为各项之和");
+    TEST_ASSERT(stats.unused_bytes == (ctx.capacity - 81) * (sizeof(layx_item_t) + sizeof(layx_vec4)), "未使用的容量");
+    TEST_ASSERT(stats.fragmentation == 0.0f, "按先序创建的树没有碎片");
+
+    // 销毁中间的行后，新行复用空闲 id，先序遍历随之跳跃
+    for (int i = 0; i < 5; i++) {
+        layx_destroy_item(&ctx, layx_first_child(&ctx, 0));
+    }
+    layx_get_memory_stats(&ctx, &stats);
+    TEST_ASSERT(stats.free_items == 20 && stats.live_items == 61, "销毁后计入空闲链表");
+    layx_append(&ctx, 0, build_document(&ctx, 5));
+    layx_get_memory_stats(&ctx, &stats);
+    TEST_ASSERT(stats.free_items == 0 && stats.fragmentation > 0.0f, "复用空闲 id 后产生碎片");
+
+    layx_set_memo_capacity(&ctx, 8);
+    layx_set_double_buffered(&ctx, true);
+    layx_publish(&ctx);
+    layx_get_memory_stats(&ctx, &stats);
+    TEST_ASSERT(stats.cache_bytes > 0 && stats.frame_bytes > 0, "统计子树缓存与双缓冲");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_breadth_first_order() {
+    printf("\n=== Test: fragmentation of a breadth-first build ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_id rows[10];
+    for (int i = 0; i < 10; i++) {
+        rows[i] = layx_item(&ctx);
+        layx_append(&ctx, root, rows[i]);
+    }
+    for (int i = 0; i < 10; i++) {
+        layx_append(&ctx, rows[i], layx_item(&ctx));
+    }
+    layx_memory_stats stats;
+    layx_get_memory_stats(&ctx, &stats);
+    // 先序：root, row0, cell0, row1, cell1 ...，除第一步外每一步都跳跃
+    TEST_ASSERT(FLOAT_EQUAL(stats.fragmentation, 19.0f / 20.0f, 0.001f), "按层创建的树几乎每一步都跳跃");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_shrink_after_close() {
+    printf("\n=== Test: shrink after closing a large document ===\n");
+
+    layx_context ctx, reference;
+    layx_init_context(&ctx);
+    layx_init_context(&reference);
+    layx_id small = build_document(&ctx, 2);
+    build_document(&reference, 2);
+    layx_id large = build_document(&ctx, 3000);
+    layx_run_context(&ctx);
+    layx_run_context(&reference);
+
+    layx_memory_stats before, after;
+    layx_destroy_item(&ctx, large);
+    layx_get_memory_stats(&ctx, &before);
+    TEST_ASSERT(before.live_items == 9 && before.free_items == 12001, "关闭大文档后只剩少量存活 item");
+
+    layx_shrink_to_fit(&ctx);
+    layx_get_memory_stats(&ctx, &after);
+    TEST_ASSERT(after.item_capacity == 9 && after.item_count == 9 && after.free_items == 0, "容量截到最大的存活 id");
+    TEST_ASSERT(after.unused_bytes == 0 && after.total_bytes < before.total_bytes / 20, "释放了大部分内存");
+    TEST_ASSERT(ctx.boxes.count == 3 && ctx.boxes.free_count == 0 && ctx.boxes.free == NULL, "盒模型记录压紧");
+    TEST_ASSERT(same_subtree_rects(&ctx, &reference, small, 9), "存活 item 的 rect 保留");
+
+    layx_set_width(&ctx, small, 200);
+    layx_set_width(&reference, small, 200);
+    layx_run_context(&ctx);
+    layx_run_context(&reference);
+    layx_scalar t, r, b, l;
+    layx_get_margin_trbl(&ctx, 5, &t, &r, &b, &l);
+    TEST_ASSERT(same_subtree_rects(&ctx, &reference, small, 9) && b == 2, "收缩后继续修改与布局");
+
+    TEST_ASSERT(layx_item(&ctx) == 9, "新 item 从末尾分配");
+    build_document(&ctx, 100);
+    layx_run_context(&ctx);
+    layx_get_memory_stats(&ctx, &after);
+    TEST_ASSERT(after.live_items == 411 && after.item_capacity >= 411, "收缩后可以重新增长");
+
+    // 完全清空
+    layx_reset_context(&ctx);
+    layx_shrink_to_fit(&ctx);
+    layx_get_memory_stats(&ctx, &after);
+    TEST_ASSERT(after.item_bytes == 0 && ctx.items == NULL && ctx.boxes.records == NULL, "空上下文释放全部 item 存储");
+    TEST_ASSERT(layx_item(&ctx) == 0, "清空后仍可使用");
+
+    layx_destroy_context(&ctx);
+    layx_destroy_context(&reference);
+}
+
+void test_shrink_keeps_holes() {
+    printf("\n=== Test: free ids below the last live item stay reusable ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id a = build_document(&ctx, 1);
+    layx_id b = build_document(&ctx, 1);
+    layx_id c = build_document(&ctx, 1);
+    layx_destroy_item(&ctx, a);
+    layx_destroy_item(&ctx, c);
+    layx_shrink_to_fit(&ctx);
+
+    layx_memory_stats stats;
+    layx_get_memory_stats(&ctx, &stats);
+    TEST_ASSERT(stats.item_count == 10 && stats.item_capacity == 10, "只截掉末尾的空闲 id");
+    TEST_ASSERT(stats.free_items == 5 && stats.live_items == 5, "中间的空洞留在空闲链表中");
+    TEST_ASSERT(layx_first_child(&ctx, b) == b + 1, "存活 item 的 id 不变");
+
+    layx_id d = build_document(&ctx, 1);
+    layx_get_memory_stats(&ctx, &stats);
+    TEST_ASSERT(d < 5 && stats.free_items == 0 && stats.item_count == 10, "空洞被新 item 复用");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_shrink_tables() {
+    printf("\n=== Test: grid, style and cache tables ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_set_memo_capacity(&ctx, 4);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(&ctx, root, 300);
+
+    layx_style style;
+    layx_style_reset(&style);
+    style.height = 20;
+    const layx_style_id shared = layx_intern_style(&ctx, &style);
+
+    layx_grid_track columns[2] = { layx_track_fr(1), layx_track_fr(2) };
+    layx_id grids[4];
+    for (int i = 0; i < 4; i++) {
+        grids[i] = layx_item(&ctx);
+        layx_set_display(&ctx, grids[i], LAYX_DISPLAY_GRID);
+        layx_set_grid_columns(&ctx, grids[i], columns, 2);
+        layx_set_memoize(&ctx, grids[i], true);
+        layx_append(&ctx, root, grids[i]);
+        for (int k = 0; k < 2; k++) {
+            layx_id cell = layx_item(&ctx);
+            layx_set_style(&ctx, cell, shared);
+            layx_append(&ctx, grids[i], cell);
+        }
+    }
+    layx_run_context(&ctx);
+    layx_destroy_item(&ctx, grids[2]);
+    layx_destroy_item(&ctx, grids[3]);
+
+    layx_memory_stats before, after;
+    layx_get_memory_stats(&ctx, &before);
+    layx_shrink_to_fit(&ctx);
+    layx_get_memory_stats(&ctx, &after);
+    TEST_ASSERT(ctx.grids.count == 3 && ctx.grids.capacity == 3 && ctx.grids.scratch == NULL, "末尾的空闲 grid 记录截掉");
+    TEST_ASSERT(ctx.memo.root_count == 3 && ctx.styles.capacity == ctx.styles.count, "缓存根与样式表按使用量缩小");
+    TEST_ASSERT(after.grid_bytes < before.grid_bytes && after.scratch_bytes < before.scratch_bytes, "grid 与暂存占用减少");
+
+    layx_clear_memo(&ctx);
+    layx_run_context(&ctx);
+    layx_scalar x, y, w, h;
+    layx_get_rect_xywh(&ctx, layx_first_child(&ctx, grids[1]), &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(w, 100, 0.01f) && FLOAT_EQUAL(h, 20, 0.01f), "收缩后 grid 与共享样式仍然有效");
+
+    layx_id more = layx_item(&ctx);
+    layx_set_display(&ctx, more, LAYX_DISPLAY_GRID);
+    layx_set_grid_columns(&ctx, more, columns, 2);
+    layx_append(&ctx, root, more);
+    layx_run_context(&ctx);
+    TEST_ASSERT(ctx.grids.count == 4, "收缩后可以继续分配 grid 记录");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_shrink_drops_boundaries() {
+    printf("\n=== Test: registered boundaries beyond the new count ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_size(&ctx, root, 300, 200);
+    layx_id kept = layx_item(&ctx);
+    layx_set_position_type(&ctx, kept, LAYX_POSITION_ABSOLUTE);
+    layx_set_size(&ctx, kept, 40, 40);
+    layx_append(&ctx, root, kept);
+    layx_id popup = layx_item(&ctx);
+    layx_set_position_type(&ctx, popup, LAYX_POSITION_ABSOLUTE);
+    layx_set_size(&ctx, popup, 50, 50);
+    layx_append(&ctx, root, popup);
+    layx_run_context(&ctx);
+
+    // 绝对定位的子元素只登记自身，移除并销毁后登记项仍在，父元素保持干净
+    layx_set_width(&ctx, kept, 60);
+    layx_remove(&ctx, popup);
+    layx_destroy_item(&ctx, popup);
+    TEST_ASSERT(!layx_is_dirty(&ctx, root) && ctx.boundaries.count == 2, "销毁的绝对定位子元素仍在边界列表中");
+
+    layx_shrink_to_fit(&ctx);
+    TEST_ASSERT(ctx.count == 2 && ctx.boundaries.count == 1 && ctx.boundaries.ids[0] == kept, "截掉的 id 从边界列表中移除");
+    layx_run_dirty(&ctx);
+    layx_scalar x, y, w, h;
+    layx_get_rect_xywh(&ctx, kept, &x, &y, &w, &h);
+    TEST_ASSERT(layx_layout_complete(&ctx) && FLOAT_EQUAL(w, 60, 0.01f), "保留的边界正常布局");
+
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Memory Report and Shrink\n");
+    printf("========================================\n");
+
+    test_report();
+    test_breadth_first_order();
+    test_shrink_after_close();
+    test_shrink_keeps_holes();
+    test_shrink_tables();
+    test_shrink_drops_boundaries();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,381 @@
+/**
+ * @file test_observe.c
+ * @brief 测试尺寸观察：只为被观察且 rect 变化的 item 产生事件
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+static layx_resize_event events[32];
+
+// 一行三个 50x40 的子元素
+static layx_id build_row(layx_context *ctx, layx_id children[3])
+{
+    layx_id root = layx_item(ctx);
+    layx_set_display(ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(ctx, root, LAYX_FLEX_DIRECTION_ROW);
+    layx_set_size(ctx, root, 300, 100);
+    for (int i = 0; i < 3; i++) {
+        children[i] = layx_item(ctx);
+        layx_set_size(ctx, children[i], 50, 40);
+        layx_append(ctx, root, children[i]);
+    }
+    return root;
+}
+
+static const layx_resize_event *find_event(uint32_t count, layx_id item)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        if (events[i].item == item) return &events[i];
+    }
+    return NULL;
+}
+
+void test_initial_and_unchanged() {
+    printf("\n=== Test: first layout reports, unchanged layout does not ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id c[3];
+    build_row(&ctx, c);
+    layx_observe(&ctx, c[0], LAYX_OBSERVE_SIZE);
+    layx_observe(&ctx, c[2], LAYX_OBSERVE_SIZE | LAYX_OBSERVE_POSITION);
+    int widget = 0;
+    layx_set_tag(&ctx, c[2], 77);
+    layx_set_user_data(&ctx, c[2], &widget);
+    TEST_ASSERT(layx_observed_mask(&ctx, c[0]) == LAYX_OBSERVE_SIZE && layx_observed_mask(&ctx, c[1]) == 0, "读回观察的 mask");
+
+    layx_run_context(&ctx);
+    uint32_t count = layx_take_resize_events(&ctx, events, 32);
+    const layx_resize_event *e0 = find_event(count, c[0]);
+    const layx_resize_event *e2 = find_event(count, c[2]);
+    TEST_ASSERT(count == 2 && e0 != NULL && e2 != NULL, "第一次布局为两个被观察的 item 产生事件");
+    TEST_ASSERT(e0 != NULL && e0->changed == LAYX_OBSERVE_SIZE && FLOAT_EQUAL(e0->old_rect[2], 0, 0.001f) &&
+                FLOAT_EQUAL(e0->rect[2], 50, 0.001f), "只报告观察的变化，old_rect 为开始观察时的 rect");
+    TEST_ASSERT(e2 != NULL && e2->changed == (LAYX_OBSERVE_SIZE | LAYX_OBSERVE_POSITION) &&
+                e2->tag == 77 && e2->user_data == &widget && FLOAT_EQUAL(e2->rect[0], 100, 0.001f),
+                "事件带出 tag 与 user_data");
+
+    layx_run_context(&ctx);
+    TEST_ASSERT(layx_take_resize_events(&ctx, events, 32) == 0, "没有变化时没有事件");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_size_and_position() {
+    printf("\n=== Test: only observed changes are reported ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id c[3];
+    build_row(&ctx, c);
+    layx_run_context(&ctx);
+    layx_observe(&ctx, c[0], LAYX_OBSERVE_SIZE);
+    layx_observe(&ctx, c[1], LAYX_OBSERVE_SIZE);
+    layx_observe(&ctx, c[2], LAYX_OBSERVE_POSITION);
+
+    // 第一个变宽：第二、三个右移
+    layx_set_width(&ctx, c[0], 80);
+    layx_run_context(&ctx);
+    uint32_t count = layx_take_resize_events(&ctx, events, 32);
+    const layx_resize_event *e0 = find_event(count, c[0]);
+    const layx_resize_event *e2 = find_event(count, c[2]);
+    TEST_ASSERT(count == 2 && find_event(count, c[1]) == NULL, "只观察尺寸的 item 移动时没有事件");
+    TEST_ASSERT(e0 != NULL && FLOAT_EQUAL(e0->old_rect[2], 50, 0.001f) && FLOAT_EQUAL(e0->rect[2], 80, 0.001f), "尺寸变化");
+    TEST_ASSERT(e2 != NULL && e2->changed == LAYX_OBSERVE_POSITION &&
+                FLOAT_EQUAL(e2->old_rect[0], 100, 0.001f) && FLOAT_EQUAL(e2->rect[0], 130, 0.001f), "位置变化");
+
+    // 停止观察
+    layx_observe(&ctx, c[0], 0);
+    layx_set_width(&ctx, c[0], 60);
+    layx_run_context(&ctx);
+    count = layx_take_resize_events(&ctx, events, 32);
+    TEST_ASSERT(layx_observed_mask(&ctx, c[0]) == 0 && count == 1 && events[0].item == c[2], "停止观察后不再报告");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_coalescing() {
+    printf("\n=== Test: events coalesce until taken ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id c[3];
+    build_row(&ctx, c);
+    layx_run_context(&ctx);
+    for (int i = 0; i < 3; i++) layx_observe(&ctx, c[i], LAYX_OBSERVE_SIZE);
+
+    layx_set_height(&ctx, c[1], 60);
+    layx_run_context(&ctx);
+    layx_set_height(&ctx, c[1], 70);
+    layx_run_context(&ctx);
+    uint32_t count = layx_take_resize_events(&ctx, events, 32);
+    TEST_ASSERT(count == 1 && FLOAT_EQUAL(events[0].old_rect[3], 40, 0.001f) && FLOAT_EQUAL(events[0].rect[3], 70, 0.001f),
+                "两轮布局合并为一条事件");
+
+    // 变化后又恢复
+    layx_set_height(&ctx, c[1], 30);
+    layx_run_context(&ctx);
+    layx_set_height(&ctx, c[1], 70);
+    layx_run_context(&ctx);
+    TEST_ASSERT(layx_take_resize_events(&ctx, events, 32) == 0, "恢复原值后没有事件");
+
+    // 容量不足时余下的事件留到下一次
+    for (int i = 0; i < 3; i++) layx_set_height(&ctx, c[i], 20);
+    layx_run_context(&ctx);
+    TEST_ASSERT(layx_take_resize_events(&ctx, events, 2) == 2, "按容量取走");
+    TEST_ASSERT(layx_take_resize_events(&ctx, events, 2) == 1, "余下的事件留在队列中");
+    TEST_ASSERT(layx_take_resize_events(&ctx, events, 2) == 0, "队列已空");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_destroy_and_reuse() {
+    printf("\n=== Test: destroyed items stop being observed ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id c[3];
+    layx_id root = build_row(&ctx, c);
+    layx_observe(&ctx, c[1], LAYX_OBSERVE_SIZE);
+    layx_run_context(&ctx);
+    // 事件已在队列中，取走前销毁
+    layx_destroy_item(&ctx, c[1]);
+    TEST_ASSERT(layx_take_resize_events(&ctx, events, 32) == 0, "销毁的 item 不产生事件");
+
+    layx_id reused = layx_item(&ctx);
+    layx_set_size(&ctx, reused, 20, 20);
+    layx_append(&ctx, root, reused);
+    layx_run_context(&ctx);
+    TEST_ASSERT(reused == c[1] && layx_observed_mask(&ctx, reused) == 0 &&
+                layx_take_resize_events(&ctx, events, 32) == 0, "复用的 id 不继承观察");
+
+    // 克隆出的 item 不被观察；释放的记录被复用
+    layx_observe(&ctx, c[0], LAYX_OBSERVE_SIZE);
+    layx_id copy = layx_clone_subtree(&ctx, c[0]);
+    layx_append(&ctx, root, copy);
+    layx_observe(&ctx, reused, LAYX_OBSERVE_SIZE);
+    layx_set_width(&ctx, reused, 30);
+    layx_run_context(&ctx);
+    uint32_t count = layx_take_resize_events(&ctx, events, 32);
+    TEST_ASSERT(layx_observed_mask(&ctx, copy) == 0 && count == 1 && events[0].item == reused, "克隆不复制观察");
+    TEST_ASSERT(ctx.observers.count == 3, "释放的记录被复用");
+
+    layx_destroy_context(&ctx);
+}
+
+// 页面：头部与 contain 面板（布局边界，内有 5 行）
+void test_incremental() {
+    printf("\n=== Test: incremental layout only checks relaid items ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(&ctx, root, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_size(&ctx, root, 300, 400);
+    layx_id header = layx_item(&ctx);
+    layx_set_height(&ctx, header, 40);
+    layx_append(&ctx, root, header);
+    layx_id panel = layx_item(&ctx);
+    layx_set_display(&ctx, panel, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(&ctx, panel, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_flex_grow(&ctx, panel, 1);
+    layx_set_contain(&ctx, panel, true);
+    layx_append(&ctx, root, panel);
+    layx_id rows[5];
+    for (int i = 0; i < 5; i++) {
+        rows[i] = layx_item(&ctx);
+        layx_set_height(&ctx, rows[i], 20);
+        layx_append(&ctx, panel, rows[i]);
+        layx_observe(&ctx, rows[i], LAYX_OBSERVE_SIZE | LAYX_OBSERVE_POSITION);
+    }
+    layx_observe(&ctx, header, LAYX_OBSERVE_SIZE | LAYX_OBSERVE_POSITION);
+    layx_run_context(&ctx);
+    TEST_ASSERT(layx_take_resize_events(&ctx, events, 32) == 6, "完整布局报告全部被观察的 item");
+
+    // 篡改边界之外的 rect：若增量布局检查了它就会产生事件
+    ctx.rects[header][3] = 41;
+    layx_set_height(&ctx, rows[1], 35);
+    layx_run_dirty(&ctx);
+    uint32_t count = layx_take_resize_events(&ctx, events, 32);
+    TEST_ASSERT(count == 4 && find_event(count, header) == NULL && find_event(count, rows[0]) == NULL,
+                "只检查重新布局的边界内部");
+    const layx_resize_event *moved = find_event(count, rows[4]);
+    TEST_ASSERT(moved != NULL && moved->changed == LAYX_OBSERVE_POSITION &&
+                FLOAT_EQUAL(moved->rect[1] - moved->old_rect[1], 15, 0.001f), "后面的行报告位置变化");
+
+    layx_run_context(&ctx);
+    TEST_ASSERT(layx_take_resize_events(&ctx, events, 32) == 0, "完整布局恢复 rect 后没有事件");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_memo_subtree() {
+    printf("\n=== Test: observed items inside cached subtrees ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_set_memo_capacity(&ctx, 16);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(&ctx, root, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_size(&ctx, root, 300, 400);
+    layx_id spacer = layx_item(&ctx);
+    layx_set_height(&ctx, spacer, 10);
+    layx_append(&ctx, root, spacer);
+    layx_id card = layx_item(&ctx);
+    layx_set_display(&ctx, card, LAYX_DISPLAY_FLEX);
+    layx_set_memoize(&ctx, card, true);
+    layx_append(&ctx, root, card);
+    layx_id label = layx_item(&ctx);
+    layx_set_size(&ctx, label, 60, 20);
+    layx_append(&ctx, card, label);
+    layx_observe(&ctx, label, LAYX_OBSERVE_POSITION);
+    layx_run_context(&ctx);
+    layx_take_resize_events(&ctx, events, 32);
+
+    // 卡片内容不变，缓存命中后整体下移
+    layx_set_height(&ctx, spacer, 25);
+    layx_run_context(&ctx);
+    layx_memo_stats memo;
+    layx_get_memo_stats(&ctx, &memo);
+    uint32_t count = layx_take_resize_events(&ctx, events, 32);
+    TEST_ASSERT(memo.hits > 0, "卡片命中缓存");
+    TEST_ASSERT(count == 1 && events[0].item == label && FLOAT_EQUAL(events[0].rect[1] - events[0].old_rect[1], 15, 0.001f),
+                "缓存子树中被观察的 item 报告位置变化");
+
+    layx_destroy_context(&ctx);
+}
+
+static uint32_t memo_observed(const layx_context *ctx, layx_id item)
+{
+    return ctx->memo.roots[ctx->items[item].memo].observed;
+}
+
+void test_memo_observed_counts() {
+    printf("\n=== Test: per-root observed counts ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_set_memo_capacity(&ctx, 16);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(&ctx, root, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_size(&ctx, root, 300, 400);
+    layx_id spacer = layx_item(&ctx);
+    layx_set_height(&ctx, spacer, 10);
+    layx_append(&ctx, root, spacer);
+    layx_id cards[2];
+    for (int i = 0; i < 2; i++) {
+        cards[i] = layx_item(&ctx);
+        layx_set_display(&ctx, cards[i], LAYX_DISPLAY_FLEX);
+        layx_set_memoize(&ctx, cards[i], true);
+        layx_append(&ctx, root, cards[i]);
+    }
+    layx_id inner = layx_item(&ctx);
+    layx_set_display(&ctx, inner, LAYX_DISPLAY_FLEX);
+    layx_append(&ctx, cards[0], inner);
+    layx_id label = layx_item(&ctx);
+    layx_set_size(&ctx, label, 60, 20);
+    layx_append(&ctx, inner, label);
+
+    layx_observe(&ctx, label, LAYX_OBSERVE_POSITION);
+    layx_set_memoize(&ctx, inner, true);
+    TEST_ASSERT(memo_observed(&ctx, cards[0]) == 1 && memo_observed(&ctx, inner) == 1 && memo_observed(&ctx, cards[1]) == 0,
+                "观察与设置缓存根时计入所有缓存根祖先");
+
+    layx_remove(&ctx, inner);
+    layx_append(&ctx, cards[1], inner);
+    TEST_ASSERT(memo_observed(&ctx, cards[0]) == 0 && memo_observed(&ctx, cards[1]) == 1 && memo_observed(&ctx, inner) == 1,
+                "移动子树时计数随之转移");
+
+    layx_run_context(&ctx);
+    layx_take_resize_events(&ctx, events, 32);
+    layx_set_height(&ctx, spacer, 25);
+    layx_run_context(&ctx);
+    uint32_t count = layx_take_resize_events(&ctx, events, 32);
+    TEST_ASSERT(count == 1 && events[0].item == label, "移动后仍报告缓存子树中的变化");
+
+    layx_observe(&ctx, label, 0);
+    TEST_ASSERT(memo_observed(&ctx, cards[1]) == 0 && memo_observed(&ctx, inner) == 0, "取消观察时减去");
+    layx_observe(&ctx, label, LAYX_OBSERVE_SIZE);
+    layx_destroy_item(&ctx, inner);
+    TEST_ASSERT(memo_observed(&ctx, cards[1]) == 0, "销毁被观察的子树时减去");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_memory_and_reset() {
+    printf("\n=== Test: memory accounting, shrink and reset ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id c[3];
+    build_row(&ctx, c);
+    for (int i = 0; i < 3; i++) layx_observe(&ctx, c[i], LAYX_OBSERVE_SIZE);
+    layx_run_context(&ctx);
+
+    layx_memory_stats stats;
+    layx_get_memory_stats(&ctx, &stats);
+    TEST_ASSERT(stats.observer_bytes > 0 && stats.total_bytes >= stats.observer_bytes, "统计观察记录与队列");
+    layx_shrink_to_fit(&ctx);
+    layx_get_memory_stats(&ctx, &stats);
+    TEST_ASSERT(stats.observer_bytes == 4 * sizeof(layx_observer) + 3 * sizeof(uint32_t), "按使用量缩小");
+    TEST_ASSERT(layx_take_resize_events(&ctx, events, 32) == 3, "缩小后队列保留");
+
+    layx_set_width(&ctx, c[0], 70);
+    layx_run_context(&ctx);
+    layx_reset_context(&ctx);
+    TEST_ASSERT(layx_take_resize_events(&ctx, events, 32) == 0 && ctx.observers.count <= 1, "重置上下文清空观察");
+    layx_id item = layx_item(&ctx);
+    layx_observe(&ctx, item, LAYX_OBSERVE_SIZE);
+    layx_set_size(&ctx, item, 10, 10);
+    layx_run_context(&ctx);
+    TEST_ASSERT(layx_take_resize_events(&ctx, events, 32) == 1, "重置后重新观察");
+
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Resize Observation\n");
+    printf("========================================\n");
+
+    test_initial_and_unchanged();
+    test_size_and_position();
+    test_coalescing();
+    test_destroy_and_reuse();
+    test_incremental();
+    test_memo_subtree();
+    test_memo_observed_counts();
+    test_memory_and_reset();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
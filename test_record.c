@@ -0,0 +1,278 @@
+/**
+ * @file test_record.c
+ * @brief 测试 API 调用记录与回放（链接 LAYX_RECORD=1 的 layx_record 库）
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+static const char *log_path = "test_record_output.lxr";
+
+static void *read_file(const char *path, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+    fseek(file, 0, SEEK_END);
+    const long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    void *data = malloc(length > 0 ? (size_t)length : 1);
+    *size = fread(data, 1, (size_t)length, file);
+    fclose(file);
+    return data;
+}
+
+static bool same_rects(layx_context *a, layx_context *b)
+{
+    if (layx_items_count(a) != layx_items_count(b)) return false;
+    for (layx_id i = 0; i < layx_items_count(a); i++) {
+        layx_vec4 ra = layx_get_rect(a, i);
+        layx_vec4 rb = layx_get_rect(b, i);
+        for (int k = 0; k < 4; k++) {
+            if (!FLOAT_EQUAL(ra[k], rb[k], 0.001f)) return false;
+        }
+    }
+    return true;
+}
+
+// 回放整个日志，返回最后一条的返回值（LAYX_REC_END 或 -1）
+static int replay_all(layx_context *ctx, layx_replay_cursor *cursor, int *counts)
+{
+    int op;
+    while ((op = layx_replay_step(ctx, cursor)) > LAYX_REC_END) {
+        if (counts != NULL) counts[op]++;
+    }
+    return op;
+}
+
+// 覆盖样式、网格、盒模型、定位、滚动、克隆与销毁的场景，中间穿插几轮布局
+static void build_and_edit(layx_context *ctx)
+{
+    layx_reserve_items_capacity(ctx, 64);
+    layx_id root = layx_item(ctx);
+    layx_set_display(ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(ctx, root, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_size(ctx, root, 300, 400);
+    layx_set_padding_trbl(ctx, root, 4, 6, 4, 6);
+    layx_set_gap(ctx, root, 3, 5);
+
+    layx_style row_style;
+    layx_style_reset(&row_style);
+    row_style.display = LAYX_DISPLAY_FLEX;
+    row_style.height = 30;
+    row_style.margin_bottom = 2;
+    const layx_style_id style = layx_intern_style(ctx, &row_style);
+
+    layx_id row = layx_item(ctx);
+    layx_set_style(ctx, row, style);
+    layx_append(ctx, root, row);
+    for (int i = 0; i < 3; i++) {
+        layx_id cell = layx_item(ctx);
+        layx_set_flex_grow(ctx, cell, (float)(i + 1) * 0.5f);
+        layx_set_border_left(ctx, cell, 1);
+        layx_append(ctx, row, cell);
+    }
+
+    layx_id grid = layx_item(ctx);
+    layx_set_display(ctx, grid, LAYX_DISPLAY_GRID);
+    layx_grid_track columns[3] = { layx_track_fixed(50), layx_track_fr(1), layx_track_fr(2) };
+    layx_grid_track rows[2] = { layx_track_fixed(20), layx_track_auto() };
+    layx_set_grid_columns(ctx, grid, columns, 3);
+    layx_set_grid_rows(ctx, grid, rows, 2);
+    layx_append(ctx, root, grid);
+    for (int i = 0; i < 4; i++) {
+        layx_id cell = layx_item(ctx);
+        layx_set_height(ctx, cell, (layx_scalar)(10 + i));
+        layx_set_grid_cell(ctx, cell, (uint32_t)(i % 3), (uint32_t)(i / 3));
+        layx_append(ctx, grid, cell);
+    }
+
+    layx_id list = layx_item(ctx);
+    layx_set_display(ctx, list, LAYX_DISPLAY_BLOCK);
+    layx_set_height(ctx, list, 60);
+    layx_set_overflow(ctx, list, LAYX_OVERFLOW_SCROLL);
+    layx_append(ctx, root, list);
+    for (int i = 0; i < 8; i++) {
+        layx_id line = layx_item(ctx);
+        layx_set_height(ctx, line, 15);
+        layx_append(ctx, list, line);
+    }
+    layx_id badge = layx_item(ctx);
+    layx_set_position_type(ctx, badge, LAYX_POSITION_ABSOLUTE);
+    layx_set_position_lt(ctx, badge, 5, 7);
+    layx_set_right(ctx, badge, 9);
+    layx_set_size(ctx, badge, 12, 12);
+    layx_append(ctx, root, badge);
+    layx_run_context(ctx);
+
+    // 修改后再布局：更新共享样式、克隆一行、销毁一个子树、滚动列表
+    layx_scroll_to(ctx, list, 0, 20);
+    row_style.height = 36;
+    layx_update_style(ctx, style, &row_style);
+    layx_id copy = layx_clone_subtree(ctx, row);
+    layx_insert_after(ctx, row, copy);
+    layx_set_margin(ctx, copy, 3);
+    layx_destroy_item(ctx, grid);
+    layx_set_contain(ctx, list, true);
+    layx_set_height(ctx, layx_first_child(ctx, list), 25);
+    layx_run_dirty(ctx);
+    layx_set_width(ctx, root, 320);
+    layx_run_context(ctx);
+}
+
+void test_record_and_replay() {
+    printf("\n=== Test: replay reproduces the recorded layout ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    TEST_ASSERT(layx_record_begin(&ctx, log_path) == 0, "开始记录");
+    build_and_edit(&ctx);
+    const uint64_t calls = layx_record_end(&ctx);
+    TEST_ASSERT(calls > 50 && ctx.recorder == NULL, "结束记录并返回调用数");
+
+    size_t size = 0;
+    void *data = read_file(log_path, &size);
+    layx_replay_cursor cursor;
+    TEST_ASSERT(data != NULL && layx_replay_open(&cursor, data, size) == 0, "打开日志");
+
+    layx_context replay;
+    layx_init_context(&replay);
+    int counts[LAYX_REC_COUNT] = { 0 };
+    TEST_ASSERT(replay_all(&replay, &cursor, counts) == LAYX_REC_END && cursor.offset == size, "回放到日志末尾");
+    TEST_ASSERT(cursor.calls == calls && cursor.id_mismatches == 0, "回放的调用数与 id 与记录一致");
+    TEST_ASSERT(same_rects(&ctx, &replay), "回放后布局结果一致");
+
+    // 包装函数记录为它调用的基础函数，内部嵌套的调用不重复记录
+    TEST_ASSERT(counts[LAYX_REC_RUN_CONTEXT] == 2 && counts[LAYX_REC_RUN_DIRTY] == 1, "每次布局记录一条");
+    TEST_ASSERT(counts[LAYX_REC_MARK_DIRTY] == 0, "setter 内部的标脏不记录");
+    TEST_ASSERT(counts[LAYX_REC_WIDTH] == 3 && counts[LAYX_REC_HEIGHT] == 16, "set_size 记录为宽与高");
+    TEST_ASSERT(counts[LAYX_REC_ROW_GAP] == 1 && counts[LAYX_REC_COLUMN_GAP] == 1, "set_gap 记录为行列间距");
+    TEST_ASSERT(counts[LAYX_REC_OVERFLOW_X] == 1 && counts[LAYX_REC_OVERFLOW_Y] == 1, "set_overflow 记录为两个方向");
+    TEST_ASSERT(counts[LAYX_REC_DESTROY] == 1 && counts[LAYX_REC_REMOVE] == 0, "销毁子树只记录一条");
+    TEST_ASSERT(counts[LAYX_REC_CLONE] == 1 && counts[LAYX_REC_ITEM] == 20, "克隆内部创建的 item 不记录");
+    TEST_ASSERT(counts[LAYX_REC_GRID_COLUMNS] == 1 && counts[LAYX_REC_GRID_ROWS] == 1 &&
+                counts[LAYX_REC_INTERN_STYLE] == 1 && counts[LAYX_REC_UPDATE_STYLE] == 1, "网格轨道与样式按原始数据记录");
+
+    // 同一日志可以在另一个上下文中再次回放
+    layx_context again;
+    layx_init_context(&again);
+    layx_replay_open(&cursor, data, size);
+    replay_all(&again, &cursor, NULL);
+    TEST_ASSERT(same_rects(&ctx, &again), "重复回放结果一致");
+
+    layx_destroy_context(&again);
+    layx_destroy_context(&replay);
+    layx_destroy_context(&ctx);
+    free(data);
+}
+
+void test_id_mismatch() {
+    printf("\n=== Test: created ids are checked ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_record_begin(&ctx, log_path);
+    layx_id root = layx_item(&ctx);
+    layx_append(&ctx, root, layx_item(&ctx));
+    layx_run_context(&ctx);
+    layx_record_end(&ctx);
+
+    size_t size = 0;
+    void *data = read_file(log_path, &size);
+    layx_replay_cursor cursor;
+    layx_replay_open(&cursor, data, size);
+
+    // 回放前上下文已有 item，新建的 id 与记录不同
+    layx_context other;
+    layx_init_context(&other);
+    layx_item(&other);
+    replay_all(&other, &cursor, NULL);
+    TEST_ASSERT(cursor.id_mismatches == 2, "id 不一致时计数");
+
+    layx_destroy_context(&other);
+    layx_destroy_context(&ctx);
+    free(data);
+}
+
+void test_invalid_logs() {
+    printf("\n=== Test: invalid logs are rejected ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    TEST_ASSERT(layx_record_begin(&ctx, "no_such_dir/calls.lxr") == -1 && ctx.recorder == NULL,
+                "无法打开文件时返回 -1");
+    layx_record_begin(&ctx, log_path);
+    layx_id root = layx_item(&ctx);
+    layx_set_width(&ctx, root, 10);
+    layx_record_end(&ctx);
+
+    size_t size = 0;
+    uint8_t *data = (uint8_t*)read_file(log_path, &size);
+    layx_replay_cursor cursor;
+    TEST_ASSERT(layx_replay_open(&cursor, data, 16) == -1, "过短的数据不是调用日志");
+    data[0] ^= 0xFF;
+    TEST_ASSERT(layx_replay_open(&cursor, data, size) == -1, "magic 不符");
+    data[0] ^= 0xFF;
+    data[8] ^= 0xFF;
+    TEST_ASSERT(layx_replay_open(&cursor, data, size) == -2, "标量类型不符");
+    data[8] ^= 0xFF;
+
+    // 截断最后一条记录
+    layx_context replay;
+    layx_init_context(&replay);
+    TEST_ASSERT(layx_replay_open(&cursor, data, size - 4) == 0, "截断的日志头部仍然有效");
+    TEST_ASSERT(replay_all(&replay, &cursor, NULL) == -1 && cursor.calls == 1, "截断的记录返回 -1");
+
+    layx_destroy_context(&replay);
+    free(data);
+
+    // 销毁上下文时结束进行中的记录
+    layx_record_begin(&ctx, log_path);
+    layx_run_context(&ctx);
+    layx_destroy_context(&ctx);
+    data = (uint8_t*)read_file(log_path, &size);
+    layx_context last;
+    layx_init_context(&last);
+    layx_replay_open(&cursor, data, size);
+    TEST_ASSERT(replay_all(&last, &cursor, NULL) == LAYX_REC_END && cursor.calls == 1, "销毁上下文时写出日志");
+    layx_destroy_context(&last);
+    free(data);
+    remove(log_path);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: API Call Recording\n");
+    printf("========================================\n");
+
+    test_record_and_replay();
+    test_id_mismatch();
+    test_invalid_logs();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,296 @@
+/**
+ * @file test_snapshot.c
+ * @brief 测试二进制快照的保存与零拷贝加载
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+static void dummy_measure(void *user_data, int is_wrap, float wrap_width, float *out_width, float *out_height)
+{
+    (void)user_data; (void)is_wrap; (void)wrap_width;
+    *out_width = 10;
+    *out_height = 10;
+}
+
+static void build_screen(layx_context *ctx)
+{
+    layx_id root = layx_item(ctx);
+    layx_set_display(ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(ctx, root, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_size(ctx, root, 320, 480);
+    layx_set_padding(ctx, root, 8);
+    for (int i = 0; i < 10; i++) {
+        layx_id row = layx_item(ctx);
+        layx_set_height(ctx, row, 30);
+        layx_set_margin_bottom(ctx, row, 4);
+        layx_append(ctx, root, row);
+    }
+    layx_get_item(ctx, 1)->measure_text_fn = dummy_measure;
+}
+
+static bool same_rects(layx_context *a, layx_context *b)
+{
+    if (layx_items_count(a) != layx_items_count(b)) return false;
+    for (layx_id i = 0; i < layx_items_count(a); i++) {
+        layx_vec4 ra = layx_get_rect(a, i);
+        layx_vec4 rb = layx_get_rect(b, i);
+        for (int k = 0; k < 4; k++) {
+            if (!FLOAT_EQUAL(ra[k], rb[k], 0.001f)) return false;
+        }
+    }
+    return true;
+}
+
+void test_buffer_roundtrip() {
+    printf("\n=== Test: snapshot buffer round trip ===\n");
+
+    layx_context src;
+    layx_init_context(&src);
+    build_screen(&src);
+    layx_run_context(&src);
+
+    size_t size = layx_snapshot_size(&src);
+    void *buffer = aligned_alloc(16, (size + 15) & ~(size_t)15);
+    TEST_ASSERT(layx_write_snapshot(&src, buffer, size) == size, "快照写入缓冲区");
+    TEST_ASSERT(layx_write_snapshot(&src, buffer, size - 1) == 0, "容量不足时不写入");
+
+    layx_context dst;
+    layx_init_context(&dst);
+    TEST_ASSERT(layx_load_snapshot_buffer(&dst, buffer, size) == 0, "从缓冲区加载");
+    TEST_ASSERT((void*)dst.items == (void*)((char*)buffer + LAYX_SNAPSHOT_HEADER_SIZE), "items 直接指向快照内存");
+    TEST_ASSERT(same_rects(&src, &dst), "加载后 rects 与原上下文一致");
+    TEST_ASSERT(layx_get_item(&dst, 1)->measure_text_fn == NULL, "指针字段在快照中被清零");
+    TEST_ASSERT(layx_first_child(&dst, 0) == 1, "树结构保持不变");
+
+    // 加载后可直接布局
+    layx_run_context(&dst);
+    TEST_ASSERT(same_rects(&src, &dst), "加载后重新布局结果一致");
+
+    // 追加 item 会把存储迁移到自有内存
+    layx_id extra = layx_item(&dst);
+    layx_set_height(&dst, extra, 30);
+    layx_append(&dst, 0, extra);
+    TEST_ASSERT(dst.storage_kind == LAYX_STORAGE_OWNED, "扩容后转为自有存储");
+    layx_run_context(&dst);
+    layx_scalar x, y, w, h;
+    layx_get_rect_xywh(&dst, extra, &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(h, 30, 0.001f) && FLOAT_EQUAL(w, 320, 0.001f), "新 item 正常参与布局");
+
+    // 损坏的头部被拒绝
+    ((uint8_t*)buffer)[0] ^= 0xFF;
+    layx_context bad;
+    layx_init_context(&bad);
+    TEST_ASSERT(layx_load_snapshot_buffer(&bad, buffer, size) != 0, "magic 不匹配时拒绝加载");
+
+    layx_destroy_context(&bad);
+    layx_destroy_context(&dst);
+    layx_destroy_context(&src);
+    free(buffer);
+}
+
+void test_file_roundtrip() {
+    printf("\n=== Test: snapshot file round trip ===\n");
+
+    layx_context src;
+    layx_init_context(&src);
+    build_screen(&src);
+    layx_run_context(&src);
+
+    const char *path = "test_snapshot.bin";
+    TEST_ASSERT(layx_save_snapshot(&src, path) == 0, "保存快照文件");
+
+    layx_context dst;
+    layx_init_context(&dst);
+    TEST_ASSERT(layx_load_snapshot(&dst, path) == 0, "映射快照文件");
+    TEST_ASSERT(same_rects(&src, &dst), "映射后 rects 一致");
+
+    layx_set_height(&dst, 1, 60);
+    layx_run_context(&dst);
+    layx_scalar x, y, w, h;
+    layx_get_rect_xywh(&dst, 2, &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(y, 8 + 60 + 4, 0.001f), "修改映射内容后布局正确");
+
+    // 文件本身不受写入影响
+    layx_context again;
+    layx_init_context(&again);
+    layx_load_snapshot(&again, path);
+    TEST_ASSERT(same_rects(&src, &again), "私有映射不回写文件");
+
+    layx_destroy_context(&again);
+    layx_destroy_context(&dst);
+    layx_destroy_context(&src);
+    remove(path);
+}
+
+void test_attach_over_pending_state() {
+    printf("\n=== Test: attach over pending boundaries and step ===\n");
+
+    layx_context src;
+    layx_init_context(&src);
+    build_screen(&src);
+    layx_run_context(&src);
+    size_t size = layx_snapshot_size(&src);
+    void *buffer = aligned_alloc(16, (size + 15) & ~(size_t)15);
+    layx_write_snapshot(&src, buffer, size);
+
+    // 比快照大得多的旧树：id 靠后的 contain 面板登记为脏边界，同时有一轮未完成的分步布局
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(&ctx, root, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_size(&ctx, root, 320, 4000);
+    for (int i = 0; i < 150; i++) {
+        layx_id row = layx_item(&ctx);
+        layx_set_height(&ctx, row, 10);
+        layx_append(&ctx, root, row);
+    }
+    layx_id panel = layx_item(&ctx);
+    layx_set_size(&ctx, panel, 100, 100);
+    layx_set_contain(&ctx, panel, true);
+    layx_append(&ctx, root, panel);
+    layx_id inner = layx_item(&ctx);
+    layx_append(&ctx, panel, inner);
+    layx_run_context(&ctx);
+
+    layx_set_height(&ctx, inner, 20);
+    layx_set_height(&ctx, 1, 12);
+    TEST_ASSERT(layx_run_context_step(&ctx, 5, 0) == LAYX_STEP_IN_PROGRESS, "旧树的分步布局未完成");
+    TEST_ASSERT(ctx.boundaries.count > 0 && panel >= layx_items_count(&src), "旧树登记了超出快照 id 范围的脏边界");
+
+    TEST_ASSERT(layx_load_snapshot_buffer(&ctx, buffer, size) == 0, "加载较小的快照");
+    TEST_ASSERT(ctx.boundaries.count == 0 && ctx.lines.count == 0, "脏边界与 flex 行被清除");
+    TEST_ASSERT(layx_layout_complete(&ctx), "加载后没有进行中的分步布局");
+
+    layx_run_dirty(&ctx);
+    TEST_ASSERT(layx_run_context_step(&ctx, 5, 0) == LAYX_STEP_DONE, "分步布局不再从旧树的位置继续");
+    TEST_ASSERT(same_rects(&src, &ctx), "rects 与快照一致");
+
+    layx_set_height(&ctx, 1, 60);
+    while (layx_run_context_step(&ctx, 5, 0) == LAYX_STEP_IN_PROGRESS) {}
+    layx_run_context(&src);
+    layx_set_height(&src, 1, 60);
+    layx_run_context(&src);
+    TEST_ASSERT(same_rects(&src, &ctx), "加载后分步布局的结果与完整布局一致");
+
+    layx_destroy_context(&ctx);
+    layx_destroy_context(&src);
+    free(buffer);
+}
+
+// 两个 grid：第一个有列与行定义，第二个只有列；中间夹一个销毁后空出的 grid 记录
+static void build_grids(layx_context *ctx)
+{
+    layx_id root = layx_item(ctx);
+    layx_set_display(ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(ctx, root, 300);
+    layx_grid_track columns[3] = { layx_track_fixed(50), layx_track_fr(1), layx_track_fr(2) };
+    layx_grid_track rows[2] = { layx_track_fixed(30), layx_track_auto() };
+    layx_id dropped = layx_item(ctx);
+    layx_set_display(ctx, dropped, LAYX_DISPLAY_GRID);
+    layx_set_grid_columns(ctx, dropped, columns, 1);
+    layx_id grids[2];
+    for (int g = 0; g < 2; g++) {
+        grids[g] = layx_item(ctx);
+        layx_set_display(ctx, grids[g], LAYX_DISPLAY_GRID);
+        layx_set_grid_columns(ctx, grids[g], columns + g, 3 - (uint32_t)g);
+        if (g == 0) layx_set_grid_rows(ctx, grids[g], rows, 2);
+        layx_append(ctx, root, grids[g]);
+        for (int i = 0; i < 5; i++) {
+            layx_id cell = layx_item(ctx);
+            layx_set_height(ctx, cell, (layx_scalar)(10 + 5 * i));
+            layx_append(ctx, grids[g], cell);
+        }
+    }
+    layx_destroy_item(ctx, dropped);
+}
+
+void test_grid_tracks() {
+    printf("\n=== Test: grid track definitions ===\n");
+
+    layx_context src;
+    layx_init_context(&src);
+    build_grids(&src);
+    layx_run_context(&src);
+    size_t size = layx_snapshot_size(&src);
+    void *buffer = aligned_alloc(16, (size + 15) & ~(size_t)15);
+    TEST_ASSERT(layx_write_snapshot(&src, buffer, size) == size, "带 grid 的快照写入缓冲区");
+
+    layx_context dst;
+    layx_init_context(&dst);
+    TEST_ASSERT(layx_load_snapshot_buffer(&dst, buffer, size) == 0, "加载带 grid 的快照");
+    TEST_ASSERT(dst.grids.count == 3, "只写入使用中的 grid 记录");
+    layx_set_width(&src, 0, 240);
+    layx_set_width(&dst, 0, 240);
+    layx_run_context(&src);
+    layx_run_context(&dst);
+    TEST_ASSERT(same_rects(&src, &dst), "加载后按原来的轨道重新布局");
+
+    // 从加载的上下文再保存一次，轨道定义仍然完整
+    size_t again_size = layx_snapshot_size(&dst);
+    void *again = aligned_alloc(16, (again_size + 15) & ~(size_t)15);
+    layx_write_snapshot(&dst, again, again_size);
+    layx_context third;
+    layx_init_context(&third);
+    TEST_ASSERT(again_size == size && layx_load_snapshot_buffer(&third, again, again_size) == 0, "加载后的上下文可以再次保存");
+    layx_set_width(&third, 0, 240);
+    layx_run_context(&third);
+    TEST_ASSERT(same_rects(&src, &third), "再次加载后布局一致");
+
+    // grid 记录的长度与 owner 被篡改时拒绝加载
+    layx_context bad;
+    layx_init_context(&bad);
+    TEST_ASSERT(layx_load_snapshot_buffer(&bad, buffer, size - 1) != 0, "grid 记录被截断时拒绝加载");
+    uint32_t grid_count;
+    memcpy(&grid_count, (uint8_t*)buffer + 28, sizeof(grid_count));
+    grid_count++;
+    memcpy((uint8_t*)buffer + 28, &grid_count, sizeof(grid_count));
+    TEST_ASSERT(layx_load_snapshot_buffer(&bad, buffer, size) != 0, "grid 记录数不匹配时拒绝加载");
+
+    layx_destroy_context(&bad);
+    layx_destroy_context(&third);
+    layx_destroy_context(&dst);
+    layx_destroy_context(&src);
+    free(again);
+    free(buffer);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Binary Snapshot\n");
+    printf("========================================\n");
+
+    test_buffer_roundtrip();
+    test_file_roundtrip();
+    test_attach_over_pending_state();
+    test_grid_tracks();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
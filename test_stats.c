@@ -0,0 +1,201 @@
+/**
+ * @file test_stats.c
+ * @brief 测试布局统计（阶段耗时与计数器）
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+// 根为 block，包含一个 wrap 的 flex 行容器（10 个 40px 子元素放在 100px 宽的容器里，共 5 行）
+// 和一个固定尺寸、contain 的 block 面板（3 个子元素）
+static layx_id build_tree(layx_context *ctx, layx_id *panel_child)
+{
+    layx_id root = layx_item(ctx);
+    layx_set_display(ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(ctx, root, 100);
+
+    layx_id row = layx_item(ctx);
+    layx_set_display(ctx, row, LAYX_DISPLAY_FLEX);
+    layx_set_flex_wrap(ctx, row, LAYX_FLEX_WRAP_WRAP);
+    layx_append(ctx, root, row);
+    for (int i = 0; i < 10; i++) {
+        layx_id cell = layx_item(ctx);
+        layx_set_size(ctx, cell, 40, 10);
+        layx_append(ctx, row, cell);
+    }
+
+    layx_id panel = layx_item(ctx);
+    layx_set_display(ctx, panel, LAYX_DISPLAY_BLOCK);
+    layx_set_size(ctx, panel, 100, 50);
+    layx_set_contain(ctx, panel, true);
+    layx_append(ctx, root, panel);
+    for (int i = 0; i < 3; i++) {
+        layx_id line = layx_item(ctx);
+        layx_set_height(ctx, line, 10);
+        layx_append(ctx, panel, line);
+        *panel_child = line;
+    }
+    return root;
+}
+
+static uint64_t sum_phases(const uint64_t *phases)
+{
+    uint64_t sum = 0;
+    for (int i = 0; i < LAYX_STATS_PHASES; i++) sum += phases[i];
+    return sum;
+}
+
+void test_disabled_by_default() {
+    printf("\n=== Test: statistics are opt-in ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id leaf;
+    build_tree(&ctx, &leaf);
+    layx_run_context(&ctx);
+
+    layx_stats stats;
+    layx_get_stats(&ctx, &stats);
+    layx_stats zero;
+    memset(&zero, 0, sizeof(zero));
+    TEST_ASSERT(memcmp(&stats, &zero, sizeof(layx_stats)) == 0, "未打开时不记录");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_full_run_counters() {
+    printf("\n=== Test: counters of a full run ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_set_stats_enabled(&ctx, true);
+    layx_id leaf;
+    build_tree(&ctx, &leaf);
+    const uint32_t count = layx_items_count(&ctx);
+
+    layx_stats stats;
+    layx_get_stats(&ctx, &stats);
+    TEST_ASSERT(stats.grow_events > 0 && stats.runs == 0, "建树时记录扩容次数");
+
+    layx_run_context(&ctx);
+    layx_get_stats(&ctx, &stats);
+    TEST_ASSERT(stats.runs == 1, "记录一轮布局");
+    TEST_ASSERT(stats.items_visited == 4ull * count, "四个阶段各处理每个 item 一次");
+    TEST_ASSERT(stats.containers[LAYX_DISPLAY_BLOCK] == 2 && stats.containers[LAYX_DISPLAY_FLEX] == 1 &&
+                stats.containers[LAYX_DISPLAY_NONE] == 0, "按 display 统计容器");
+    TEST_ASSERT(stats.flex_lines == ctx.lines.count && stats.flex_lines >= 5, "记录 flex 行");
+    TEST_ASSERT(sum_phases(stats.last_phase_time) > 0, "记录阶段耗时");
+    TEST_ASSERT(memcmp(stats.phase_time, stats.last_phase_time, sizeof(stats.phase_time)) == 0,
+                "第一轮的累计耗时等于最近一轮");
+
+    layx_set_width(&ctx, 0, 120);
+    layx_run_context(&ctx);
+    layx_stats second;
+    layx_get_stats(&ctx, &second);
+    TEST_ASSERT(second.runs == 2 && second.items_visited == 8ull * count, "第二轮继续累加");
+    TEST_ASSERT(sum_phases(second.phase_time) == sum_phases(stats.phase_time) + sum_phases(second.last_phase_time),
+                "累计耗时等于各轮之和");
+
+    layx_reset_stats(&ctx);
+    layx_get_stats(&ctx, &stats);
+    TEST_ASSERT(stats.runs == 0 && stats.items_visited == 0 && stats.phase_time[0] == 0, "reset 清零");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_step_and_dirty_runs() {
+    printf("\n=== Test: time-sliced and boundary runs ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_set_stats_enabled(&ctx, true);
+    layx_id leaf;
+    build_tree(&ctx, &leaf);
+    const uint32_t count = layx_items_count(&ctx);
+
+    int calls = 0;
+    while (layx_run_context_step(&ctx, 3, 0) == LAYX_STEP_IN_PROGRESS) calls++;
+    layx_stats stats;
+    layx_get_stats(&ctx, &stats);
+    TEST_ASSERT(calls > 1 && stats.runs == 1, "分步布局完成时才计为一轮");
+    TEST_ASSERT(stats.items_visited == 4ull * count, "分步布局处理的 item 数与完整布局相同");
+
+    // 只有 contain 面板为脏：重新布局面板及其 3 个子元素
+    layx_reset_stats(&ctx);
+    layx_set_height(&ctx, leaf, 20);
+    layx_run_dirty(&ctx);
+    layx_get_stats(&ctx, &stats);
+    TEST_ASSERT(stats.runs == 1 && stats.items_visited == 4 * 4, "脏边界布局只处理边界子树");
+    TEST_ASSERT(stats.containers[LAYX_DISPLAY_BLOCK] == 1, "边界布局同样统计容器");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_memo_counters() {
+    printf("\n=== Test: subtree cache counters ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_set_memo_capacity(&ctx, 16);
+    layx_set_stats_enabled(&ctx, true);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(&ctx, root, 200);
+    for (int i = 0; i < 4; i++) {
+        layx_id card = layx_item(&ctx);
+        layx_set_display(&ctx, card, LAYX_DISPLAY_FLEX);
+        layx_set_memoize(&ctx, card, true);
+        layx_append(&ctx, root, card);
+        layx_id label = layx_item(&ctx);
+        layx_set_size(&ctx, label, 50, 20);
+        layx_append(&ctx, card, label);
+    }
+    layx_run_context(&ctx);
+
+    layx_stats stats;
+    layx_get_stats(&ctx, &stats);
+    layx_memo_stats memo;
+    layx_get_memo_stats(&ctx, &memo);
+    TEST_ASSERT(stats.memo_hits == memo.hits && stats.memo_misses == memo.misses, "与缓存统计一致");
+    TEST_ASSERT(stats.memo_hits == 3 && stats.memo_misses == 1, "相同的卡片命中缓存");
+    TEST_ASSERT(stats.items_visited < 4ull * layx_items_count(&ctx), "命中的子树不计入遍历");
+
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Layout Statistics\n");
+    printf("========================================\n");
+
+    test_disabled_by_default();
+    test_full_run_counters();
+    test_step_and_dirty_runs();
+    test_memo_counters();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file test_step.c
+ * @brief 测试分步（可恢复）布局
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+// 文档：若干段落，每段一行 flex 子元素
+static void build_document(layx_context *ctx, int sections, int rows)
+{
+    layx_id root = layx_item(ctx);
+    layx_set_display(ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(ctx, root, 400);
+    layx_set_padding(ctx, root, 5);
+    for (int s = 0; s < sections; s++) {
+        layx_id section = layx_item(ctx);
+        layx_set_display(ctx, section, LAYX_DISPLAY_FLEX);
+        layx_set_flex_direction(ctx, section, LAYX_FLEX_DIRECTION_COLUMN);
+        layx_set_margin_bottom(ctx, section, 8);
+        layx_append(ctx, root, section);
+        for (int r = 0; r < rows; r++) {
+            layx_id row = layx_item(ctx);
+            layx_set_display(ctx, row, LAYX_DISPLAY_FLEX);
+            layx_set_height(ctx, row, (layx_scalar)(10 + (r % 3)));
+            layx_append(ctx, section, row);
+            layx_id cell = layx_item(ctx);
+            layx_set_flex_grow(ctx, cell, 1);
+            layx_append(ctx, row, cell);
+        }
+    }
+}
+
+static bool same_rects(layx_context *a, layx_context *b)
+{
+    if (layx_items_count(a) != layx_items_count(b)) return false;
+    for (layx_id i = 0; i < layx_items_count(a); i++) {
+        layx_vec4 ra = layx_get_rect(a, i);
+        layx_vec4 rb = layx_get_rect(b, i);
+        for (int k = 0; k < 4; k++) {
+            if (!FLOAT_EQUAL(ra[k], rb[k], 0.001f)) return false;
+        }
+    }
+    return true;
+}
+
+void test_item_budget() {
+    printf("\n=== Test: item budget ===\n");
+
+    layx_context full, sliced;
+    layx_init_context(&full);
+    layx_init_context(&sliced);
+    build_document(&full, 20, 25);
+    build_document(&sliced, 20, 25);
+    layx_run_context(&full);
+
+    int calls = 0;
+    int result;
+    do {
+        result = layx_run_context_step(&sliced, 100, 0);
+        calls++;
+        if (result == LAYX_STEP_IN_PROGRESS && calls == 1) {
+            TEST_ASSERT(!layx_layout_complete(&sliced), "进行中时结果不完整");
+        }
+    } while (result == LAYX_STEP_IN_PROGRESS && calls < 1000);
+
+    // 1 + 20 + 20*25*2 = 1021 个 item，四个阶段
+    TEST_ASSERT(calls > 4 * 1021 / 100, "布局被分到多次调用中完成");
+    TEST_ASSERT(layx_layout_complete(&sliced), "完成后结果完整");
+    TEST_ASSERT(same_rects(&full, &sliced), "分步结果与一次性布局一致");
+    TEST_ASSERT(layx_run_context_step(&sliced, 100, 0) == LAYX_STEP_DONE, "没有修改时立即完成");
+
+    layx_destroy_context(&full);
+    layx_destroy_context(&sliced);
+}
+
+void test_mutation_restarts() {
+    printf("\n=== Test: tree mutation while in progress ===\n");
+
+    layx_context full, sliced;
+    layx_init_context(&full);
+    layx_init_context(&sliced);
+    build_document(&full, 10, 10);
+    build_document(&sliced, 10, 10);
+
+    TEST_ASSERT(layx_run_context_step(&sliced, 50, 0) == LAYX_STEP_IN_PROGRESS, "第一次调用未完成");
+
+    // 进行中删除一个段落
+    layx_id victim = layx_next_sibling(&sliced, layx_first_child(&sliced, 0));
+    layx_destroy_item(&sliced, victim);
+    layx_destroy_item(&full, victim);
+    TEST_ASSERT(sliced.step.restart, "结构修改后标记重新开始");
+
+    while (layx_run_context_step(&sliced, 50, 0) == LAYX_STEP_IN_PROGRESS) {}
+    layx_run_context(&full);
+    TEST_ASSERT(same_rects(&full, &sliced), "重新开始后结果正确");
+
+    // 进行中修改已处理过的 item 的属性
+    layx_set_height(&sliced, 0, 900);
+    layx_set_height(&full, 0, 900);
+    TEST_ASSERT(layx_run_context_step(&sliced, 50, 0) == LAYX_STEP_IN_PROGRESS, "开始新一轮");
+    layx_id first_row = layx_first_child(&sliced, layx_first_child(&sliced, 0));
+    layx_set_height(&sliced, first_row, 40);
+    layx_set_height(&full, first_row, 40);
+    TEST_ASSERT(sliced.step.restart, "属性修改后标记重新开始");
+    while (layx_run_context_step(&sliced, 50, 0) == LAYX_STEP_IN_PROGRESS) {}
+    layx_run_context(&full);
+    TEST_ASSERT(layx_layout_complete(&sliced) && same_rects(&full, &sliced), "再次布局后一致");
+
+    layx_destroy_context(&full);
+    layx_destroy_context(&sliced);
+}
+
+void test_time_budget() {
+    printf("\n=== Test: time budget ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    build_document(&ctx, 20, 25);
+
+    // 极小的时间预算：每次至少推进一个检查周期
+    int calls = 0;
+    while (layx_run_context_step(&ctx, 0, 1) == LAYX_STEP_IN_PROGRESS && calls < 10000) {
+        calls++;
+    }
+    TEST_ASSERT(calls > 0 && calls < 10000, "时间预算下逐步完成");
+    TEST_ASSERT(layx_layout_complete(&ctx), "结果完整");
+
+    // run_context 直接完成进行中的分步布局
+    layx_set_width(&ctx, 0, 300);
+    layx_run_context_step(&ctx, 10, 0);
+    layx_run_context(&ctx);
+    TEST_ASSERT(layx_layout_complete(&ctx), "完整布局结束分步状态");
+
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Time-Sliced Layout\n");
+    printf("========================================\n");
+
+    test_item_budget();
+    test_mutation_restarts();
+    test_time_budget();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
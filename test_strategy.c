@@ -0,0 +1,127 @@
+/**
+ * @file test_strategy.c
+ * @brief 测试 flags 中缓存的容器布局策略
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+static bool rect_is(layx_context *ctx, layx_id id, float x, float y, float w, float h)
+{
+    layx_vec4 r = layx_get_rect(ctx, id);
+    return FLOAT_EQUAL(r[0], x, 0.01f) && FLOAT_EQUAL(r[1], y, 0.01f)
+        && FLOAT_EQUAL(r[2], w, 0.01f) && FLOAT_EQUAL(r[3], h, 0.01f);
+}
+
+static uint32_t strategy_of(layx_context *ctx, layx_id item)
+{
+    return layx_get_item(ctx, item)->flags & LAYX_ITEM_STRATEGY_MASK;
+}
+
+// 容器 200x100，三个 40x20 的子元素
+static layx_id build_container(layx_context *ctx, layx_id children[3])
+{
+    layx_id root = layx_item(ctx);
+    layx_set_size(ctx, root, 200, 100);
+    for (int i = 0; i < 3; i++) {
+        children[i] = layx_item(ctx);
+        layx_set_size(ctx, children[i], 40, 20);
+        layx_append(ctx, root, children[i]);
+    }
+    return root;
+}
+
+void test_switch_strategy() {
+    printf("\n=== Test: strategy follows display, direction and wrap ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id c[3];
+    layx_id root = build_container(&ctx, c);
+    TEST_ASSERT(strategy_of(&ctx, root) == 0, "新 item 使用 block 策略");
+
+    layx_run_context(&ctx);
+    TEST_ASSERT(rect_is(&ctx, c[1], 0, 20, 40, 20), "block：纵向堆叠");
+
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    const uint32_t flex_row = strategy_of(&ctx, root);
+    layx_run_context(&ctx);
+    TEST_ASSERT(rect_is(&ctx, c[1], 40, 0, 40, 20), "flex row：横向排列");
+
+    layx_set_flex_direction(&ctx, root, LAYX_FLEX_DIRECTION_COLUMN);
+    TEST_ASSERT(strategy_of(&ctx, root) != flex_row, "修改方向后策略更新");
+    layx_run_context(&ctx);
+    TEST_ASSERT(rect_is(&ctx, c[2], 0, 40, 40, 20), "flex column：纵向排列");
+
+    // 列方向换行：高度 50 只放得下两个子元素，两列按 align-content: stretch 平分 200 宽度
+    layx_set_height(&ctx, root, 50);
+    layx_set_flex_wrap(&ctx, root, LAYX_FLEX_WRAP_WRAP);
+    layx_run_context(&ctx);
+    TEST_ASSERT(rect_is(&ctx, c[2], 100, 0, 40, 20), "flex column wrap：换到下一列");
+
+    layx_set_display(&ctx, root, LAYX_DISPLAY_BLOCK);
+    TEST_ASSERT(strategy_of(&ctx, root) == 0, "改回 block 后策略恢复");
+    layx_run_context(&ctx);
+    TEST_ASSERT(rect_is(&ctx, c[2], 0, 40, 40, 20), "block 布局恢复");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_style_and_clone() {
+    printf("\n=== Test: shared styles and clones carry the strategy ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id c[3];
+    layx_id root = build_container(&ctx, c);
+
+    layx_style st;
+    layx_style_reset(&st);
+    st.display = LAYX_DISPLAY_FLEX;
+    st.flex_direction = LAYX_FLEX_DIRECTION_ROW;
+    layx_set_style(&ctx, root, layx_intern_style(&ctx, &st));
+    layx_run_context(&ctx);
+    TEST_ASSERT(rect_is(&ctx, c[2], 80, 0, 40, 20), "共享样式设置 flex 后按行排列");
+
+    layx_id copy = layx_clone_subtree(&ctx, root);
+    TEST_ASSERT(strategy_of(&ctx, copy) == strategy_of(&ctx, root), "复制的子树保留策略");
+
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Cached Container Strategy\n");
+    printf("========================================\n");
+
+    test_switch_strategy();
+    test_style_and_clone();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,326 @@
+/**
+ * @file test_style.c
+ * @brief 测试共享样式记录与脏标记
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+void test_intern_dedup() {
+    printf("\n=== Test: intern deduplicates identical styles ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+
+    layx_style a, b, c;
+    layx_style_reset(&a);
+    layx_style_reset(&b);
+    layx_style_reset(&c);
+    a.height = 20;
+    a.margin_bottom = 4;
+    b.height = 20;
+    b.margin_bottom = 4;
+    c.height = 30;
+
+    layx_style_id ida = layx_intern_style(&ctx, &a);
+    layx_style_id idb = layx_intern_style(&ctx, &b);
+    layx_style_id idc = layx_intern_style(&ctx, &c);
+    TEST_ASSERT(ida != LAYX_NO_STYLE, "返回有效的样式 id");
+    TEST_ASSERT(ida == idb, "相同内容得到同一个 id");
+    TEST_ASSERT(ida != idc, "不同内容得到不同 id");
+    TEST_ASSERT(FLOAT_EQUAL(layx_get_style_record(&ctx, ida)->height, 20, 0.001f), "可读取共享记录");
+
+    // 大量不同样式触发哈希表扩容后仍能找回
+    layx_style_id ids[200];
+    for (int i = 0; i < 200; i++) {
+        layx_style s;
+        layx_style_reset(&s);
+        s.width = (layx_scalar)(i + 1);
+        ids[i] = layx_intern_style(&ctx, &s);
+    }
+    bool all_found = true;
+    for (int i = 0; i < 200; i++) {
+        layx_style s;
+        layx_style_reset(&s);
+        s.width = (layx_scalar)(i + 1);
+        if (layx_intern_style(&ctx, &s) != ids[i]) all_found = false;
+    }
+    TEST_ASSERT(all_found, "扩容后去重依然有效");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_shared_update() {
+    printf("\n=== Test: updating a shared style re-themes its users ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(&ctx, root, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_width(&ctx, root, 200);
+
+    layx_style row;
+    layx_style_reset(&row);
+    row.height = 20;
+    row.margin_bottom = 4;
+    layx_style_id row_style = layx_intern_style(&ctx, &row);
+
+    layx_id rows[100];
+    for (int i = 0; i < 100; i++) {
+        rows[i] = layx_item(&ctx);
+        layx_set_style(&ctx, rows[i], row_style);
+        layx_append(&ctx, root, rows[i]);
+    }
+    layx_id plain = layx_item(&ctx);
+    layx_set_height(&ctx, plain, 10);
+    layx_append(&ctx, root, plain);
+
+    // 单个 item 覆盖 margin，不再跟随共享记录
+    layx_set_margin_bottom(&ctx, rows[0], 10);
+
+    TEST_ASSERT(layx_style_users(&ctx, row_style) == 100, "统计引用数量");
+    layx_run_context(&ctx);
+    TEST_ASSERT(!layx_is_dirty(&ctx, root) && !layx_is_dirty(&ctx, rows[5]), "布局后清除脏标记");
+
+    layx_scalar x, y, w, h;
+    layx_get_rect_xywh(&ctx, rows[2], &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(h, 20, 0.001f) && FLOAT_EQUAL(y, 30 + 24, 0.001f), "共享样式生效");
+
+    row.height = 30;
+    row.margin_bottom = 0;
+    layx_update_style(&ctx, row_style, &row);
+    TEST_ASSERT(layx_is_dirty(&ctx, rows[50]) && layx_is_dirty(&ctx, root), "引用者及其祖先被标记为脏");
+    TEST_ASSERT(!layx_is_dirty(&ctx, plain), "未引用的 item 保持干净");
+
+    layx_run_context(&ctx);
+    layx_get_rect_xywh(&ctx, rows[2], &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(h, 30, 0.001f) && FLOAT_EQUAL(y, 40 + 30, 0.001f), "修改共享样式后所有引用者更新");
+
+    layx_scalar mt, mr, mb, ml;
+    layx_get_margin_trbl(&ctx, rows[1], &mt, &mr, &mb, &ml);
+    TEST_ASSERT(FLOAT_EQUAL(mb, 0, 0.001f), "记录中移除的属性组恢复默认值");
+    layx_get_margin_trbl(&ctx, rows[0], &mt, &mr, &mb, &ml);
+    TEST_ASSERT(FLOAT_EQUAL(mb, 10, 0.001f), "本地覆盖不受共享记录修改影响");
+    layx_get_rect_xywh(&ctx, rows[0], &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(h, 30, 0.001f), "未覆盖的属性组仍跟随共享记录");
+
+    // 复制的子树共享同一记录
+    layx_id copy = layx_clone_subtree(&ctx, rows[3]);
+    TEST_ASSERT(layx_get_style(&ctx, copy) == row_style && layx_style_users(&ctx, row_style) == 101, "复制的 item 引用同一记录");
+    layx_destroy_item(&ctx, copy);
+    TEST_ASSERT(layx_style_users(&ctx, row_style) == 100, "销毁 item 释放引用");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_dirty_propagation() {
+    printf("\n=== Test: dirty propagation ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+
+    layx_id root = layx_item(&ctx);
+    layx_id mid = layx_item(&ctx);
+    layx_id leaf = layx_item(&ctx);
+    layx_id other = layx_item(&ctx);
+    layx_append(&ctx, root, mid);
+    layx_append(&ctx, mid, leaf);
+    layx_append(&ctx, root, other);
+    TEST_ASSERT(layx_is_dirty(&ctx, leaf), "新建 item 为脏");
+
+    layx_run_context(&ctx);
+    TEST_ASSERT(!layx_is_dirty(&ctx, root) && !layx_is_dirty(&ctx, leaf), "布局后全部干净");
+
+    layx_set_width(&ctx, leaf, 50);
+    TEST_ASSERT(layx_is_dirty(&ctx, leaf) && layx_is_dirty(&ctx, mid) && layx_is_dirty(&ctx, root), "setter 向上传播");
+    TEST_ASSERT(!layx_is_dirty(&ctx, other), "兄弟子树不受影响");
+
+    layx_run_context(&ctx);
+    layx_remove(&ctx, other);
+    TEST_ASSERT(layx_is_dirty(&ctx, root) && !layx_is_dirty(&ctx, mid), "移除子节点标记父节点");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_update_visits_users() {
+    printf("\n=== Test: update visits only current users ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+
+    layx_style a, b;
+    layx_style_reset(&a);
+    layx_style_reset(&b);
+    a.height = 10;
+    b.height = 20;
+    layx_style_id style_a = layx_intern_style(&ctx, &a);
+    layx_style_id style_b = layx_intern_style(&ctx, &b);
+
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(&ctx, root, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_id items[64];
+    for (int i = 0; i < 64; i++) {
+        items[i] = layx_item(&ctx);
+        layx_append(&ctx, root, items[i]);
+    }
+    // 反复切换：引用者列表中留下大量失效与重复的条目
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 64; i++) {
+            layx_set_style(&ctx, items[i], (i + round) % 2 ? style_a : style_b);
+        }
+    }
+    // 销毁后复用的 id 重新引用同一记录
+    layx_destroy_item(&ctx, items[2]);
+    items[2] = layx_item(&ctx);
+    layx_append(&ctx, root, items[2]);
+    layx_set_style(&ctx, items[2], style_a);
+    TEST_ASSERT(layx_style_users(&ctx, style_a) == 32 && layx_style_users(&ctx, style_b) == 32, "引用计数正确");
+    TEST_ASSERT(ctx.styles.records[style_a].user_count <= 4 * 32 + 32, "引用者列表整理后不随切换次数增长");
+    layx_run_context(&ctx);
+
+    a.height = 15;
+    layx_update_style(&ctx, style_a, &a);
+    TEST_ASSERT(ctx.styles.records[style_a].user_count == 32, "更新时列表只剩当前引用者");
+    bool ok = true;
+    for (int i = 0; i < 64; i++) {
+        const bool uses_a = layx_get_style(&ctx, items[i]) == style_a;
+        if (layx_is_dirty(&ctx, items[i]) != uses_a) ok = false;
+    }
+    TEST_ASSERT(ok, "只有当前引用者被重写并标记为脏");
+
+    layx_run_context(&ctx);
+    layx_scalar x, y, w, h;
+    layx_get_rect_xywh(&ctx, items[2], &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(h, 15, 0.001f), "复用 id 的引用者得到新值");
+    layx_get_rect_xywh(&ctx, items[0], &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(h, layx_get_style(&ctx, items[0]) == style_a ? 15 : 20, 0.001f), "其他记录的引用者不变");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_shared_box_record() {
+    printf("\n=== Test: users share the style's box record ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_set_display(&ctx, root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(&ctx, root, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_width(&ctx, root, 200);
+
+    layx_style card;
+    layx_style_reset(&card);
+    card.height = 20;
+    card.padding_left = 6;
+    card.margin_bottom = 4;
+    layx_style_id card_style = layx_intern_style(&ctx, &card);
+    layx_id cards[50];
+    for (int i = 0; i < 50; i++) {
+        cards[i] = layx_item(&ctx);
+        layx_set_style(&ctx, cards[i], card_style);
+        layx_append(&ctx, root, cards[i]);
+    }
+    const uint32_t shared = ctx.styles.records[card_style].box;
+    TEST_ASSERT(shared != 0 && ctx.boxes.count - ctx.boxes.free_count == 2, "50 个引用者只占一条盒模型记录");
+
+    // 本地覆盖时换成独立的副本
+    layx_set_padding_left(&ctx, cards[0], 12);
+    layx_scalar t, r, b, l;
+    layx_get_margin_trbl(&ctx, cards[0], &t, &r, &b, &l);
+    TEST_ASSERT(ctx.items[cards[0]].box != shared && FLOAT_EQUAL(b, 4, 0.001f), "覆盖后复制共享记录");
+    layx_get_padding_trbl(&ctx, cards[1], &t, &r, &b, &l);
+    TEST_ASSERT(FLOAT_EQUAL(l, 6, 0.001f), "其他引用者不受影响");
+    layx_run_context(&ctx);
+
+    // 修改样式只改一条记录
+    const uint32_t records = ctx.boxes.count - ctx.boxes.free_count;
+    card.margin_bottom = 10;
+    layx_update_style(&ctx, card_style, &card);
+    TEST_ASSERT(ctx.boxes.count - ctx.boxes.free_count == records && ctx.items[cards[7]].box == shared, "更新样式不分配记录");
+    TEST_ASSERT(layx_is_dirty(&ctx, cards[7]) && layx_is_dirty(&ctx, root), "共享记录的引用者被标记为脏");
+    layx_run_context(&ctx);
+    layx_scalar x, y, w, h;
+    layx_get_rect_xywh(&ctx, cards[2], &x, &y, &w, &h);
+    TEST_ASSERT(FLOAT_EQUAL(y, 2 * 30, 0.001f), "新的 margin 生效");
+    layx_get_margin_trbl(&ctx, cards[0], &t, &r, &b, &l);
+    TEST_ASSERT(FLOAT_EQUAL(b, 10, 0.001f), "覆盖了 padding 的 item 仍跟随 margin");
+
+    // 解除引用后保留当前值；销毁共享的引用者不释放样式的记录
+    layx_set_style(&ctx, cards[3], LAYX_NO_STYLE);
+    layx_get_padding_trbl(&ctx, cards[3], &t, &r, &b, &l);
+    TEST_ASSERT(ctx.items[cards[3]].box != shared && FLOAT_EQUAL(l, 6, 0.001f), "解除引用后转为本地记录");
+    layx_destroy_item(&ctx, cards[4]);
+    layx_id fresh = layx_item(&ctx);
+    layx_set_padding(&ctx, fresh, 1);
+    TEST_ASSERT(ctx.items[fresh].box != shared, "共享记录没有进入空闲列表");
+
+    // 收缩后引用者仍指向同一条记录
+    layx_shrink_to_fit(&ctx);
+    const uint32_t moved = ctx.styles.records[card_style].box;
+    TEST_ASSERT(ctx.items[cards[5]].box == moved && ctx.items[cards[49]].box == moved && ctx.items[cards[0]].box != moved,
+                "收缩后共享关系保留");
+    layx_get_padding_trbl(&ctx, cards[49], &t, &r, &b, &l);
+    TEST_ASSERT(FLOAT_EQUAL(l, 6, 0.001f), "收缩后值不变");
+
+    // 快照为每个引用者写出各自的记录，加载后布局一致
+    layx_run_context(&ctx);
+    size_t size = layx_snapshot_size(&ctx);
+    void *buffer = aligned_alloc(16, (size + 15) & ~(size_t)15);
+    TEST_ASSERT(layx_write_snapshot(&ctx, buffer, size) == size, "带共享记录的树写入快照");
+    layx_context loaded;
+    layx_init_context(&loaded);
+    TEST_ASSERT(layx_load_snapshot_buffer(&loaded, buffer, size) == 0, "加载快照");
+    layx_run_context(&loaded);
+    layx_scalar lx, ly, lw, lh;
+    layx_get_rect_xywh(&ctx, cards[49], &x, &y, &w, &h);
+    layx_get_rect_xywh(&loaded, cards[49], &lx, &ly, &lw, &lh);
+    layx_get_padding_trbl(&loaded, cards[49], &t, &r, &b, &l);
+    TEST_ASSERT(FLOAT_EQUAL(y, ly, 0.001f) && FLOAT_EQUAL(l, 6, 0.001f), "快照中的盒模型与原树一致");
+    layx_destroy_context(&loaded);
+    free(buffer);
+
+    layx_destroy_context(&ctx);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Shared Styles\n");
+    printf("========================================\n");
+
+    test_intern_dedup();
+    test_shared_update();
+    test_dirty_propagation();
+    test_update_visits_users();
+    test_shared_box_record();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
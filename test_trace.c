@@ -0,0 +1,372 @@
+/**
+ * @file test_trace.c
+ * @brief 测试布局追踪（Chrome trace_event JSON 输出）
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+typedef struct trace_sink {
+    char *data;
+    size_t size;
+    int writes;
+} trace_sink;
+
+static void sink_write(void *user_data, const char *data, size_t size)
+{
+    trace_sink *sink = (trace_sink*)user_data;
+    sink->data = (char*)realloc(sink->data, sink->size + size + 1);
+    memcpy(sink->data + sink->size, data, size);
+    sink->size += size;
+    sink->data[sink->size] = '\0';
+    sink->writes++;
+}
+
+static const char *tag_item(void *user_data, layx_id item)
+{
+    (void)user_data;
+    if (item == 1) return "row \"main\"";
+    return NULL;
+}
+
+static int count_substr(const char *text, const char *needle)
+{
+    int count = 0;
+    for (const char *p = strstr(text, needle); p != NULL; p = strstr(p + 1, needle)) count++;
+    return count;
+}
+
+// 最小的 JSON 语法检查：只判断能否完整解析，不构造值
+static const char *json_value(const char *p);
+
+static const char *json_space(const char *p)
+{
+    while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t') p++;
+    return p;
+}
+
+static const char *json_string(const char *p)
+{
+    if (*p++ != '"') return NULL;
+    for (; *p != '"'; p++) {
+        if ((unsigned char)*p < 0x20) return NULL;
+        if (*p != '\\') continue;
+        p++;
+        if (*p == 'u') {
+            for (int i = 1; i <= 4; i++) {
+                if (strchr("0123456789abcdefABCDEF", p[i]) == NULL || p[i] == '\0') return NULL;
+            }
+            p += 4;
+        } else if (*p == '\0' || strchr("\"\\/bfnrt", *p) == NULL) {
+            return NULL;
+        }
+    }
+    return p + 1;
+}
+
+static const char *json_list(const char *p, char close, bool object)
+{
+    p = json_space(p + 1);
+    if (*p == close) return p + 1;
+    for (;;) {
+        if (object) {
+            p = json_string(json_space(p));
+            if (p == NULL || *(p = json_space(p)) != ':') return NULL;
+            p++;
+        }
+        p = json_value(p);
+        if (p == NULL) return NULL;
+        p = json_space(p);
+        if (*p == close) return p + 1;
+        if (*p++ != ',') return NULL;
+    }
+}
+
+static const char *json_value(const char *p)
+{
+    p = json_space(p);
+    if (*p == '{') return json_list(p, '}', true);
+    if (*p == '[') return json_list(p, ']', false);
+    if (*p == '"') return json_string(p);
+    char *end;
+    strtod(p, &end);
+    return end != p ? end : NULL;
+}
+
+static bool json_valid(const char *text)
+{
+    const char *end = json_value(text);
+    return end != NULL && *json_space(end) == '\0';
+}
+
+// 找到某个阶段中某个 item 的 span，返回 ts 与 dur（微秒）
+static bool find_span(const char *text, const char *phase, unsigned id, double *ts, double *dur)
+{
+    char cat[32];
+    snprintf(cat, sizeof(cat), "\"cat\":\"%s\"", phase);
+    char key[32];
+    snprintf(key, sizeof(key), "\"id\":%u,", id);
+    for (const char *line = text; line != NULL; line = strchr(line + 1, '\n')) {
+        const char *end = strchr(line + 1, '\n');
+        const char *c = strstr(line, cat);
+        const char *k = strstr(line, key);
+        if (c == NULL || k == NULL || (end != NULL && (c > end || k > end))) continue;
+        const char *t = strstr(line, "\"ts\":");
+        return sscanf(t, "\"ts\":%lf,\"dur\":%lf", ts, dur) == 2;
+    }
+    return false;
+}
+
+// 根为 block：一个 flex 行（10 个子元素）和一个 contain 的 block 面板（3 个子元素）
+static layx_id build_tree(layx_context *ctx, layx_id *panel_child)
+{
+    layx_id root = layx_item(ctx);
+    layx_set_display(ctx, root, LAYX_DISPLAY_BLOCK);
+    layx_set_width(ctx, root, 100);
+
+    layx_id row = layx_item(ctx);
+    layx_set_display(ctx, row, LAYX_DISPLAY_FLEX);
+    layx_set_flex_wrap(ctx, row, LAYX_FLEX_WRAP_WRAP);
+    layx_append(ctx, root, row);
+    for (int i = 0; i < 10; i++) {
+        layx_id cell = layx_item(ctx);
+        layx_set_size(ctx, cell, 40, 10);
+        layx_append(ctx, row, cell);
+    }
+
+    layx_id panel = layx_item(ctx);
+    layx_set_display(ctx, panel, LAYX_DISPLAY_BLOCK);
+    layx_set_size(ctx, panel, 100, 50);
+    layx_set_contain(ctx, panel, true);
+    layx_append(ctx, root, panel);
+    for (int i = 0; i < 3; i++) {
+        layx_id line = layx_item(ctx);
+        layx_set_height(ctx, line, 10);
+        layx_append(ctx, panel, line);
+        *panel_child = line;
+    }
+    return root;
+}
+
+void test_callback_output() {
+    printf("\n=== Test: JSON spans through a callback ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id leaf;
+    build_tree(&ctx, &leaf);
+    TEST_ASSERT(!layx_trace_active(&ctx), "默认不记录");
+
+    trace_sink sink = { NULL, 0, 0 };
+    layx_trace_config config = { sink_write, NULL, &sink, tag_item, 0 };
+    TEST_ASSERT(layx_trace_begin(&ctx, &config) == 0 && layx_trace_active(&ctx), "开始记录");
+    layx_run_context(&ctx);
+    const uint64_t spans = layx_trace_end(&ctx);
+    TEST_ASSERT(!layx_trace_active(&ctx) && sink.writes > 0, "结束后写出");
+
+    // 3 个容器 × 4 个阶段
+    TEST_ASSERT(spans == 12 && count_substr(sink.data, "\"args\":{\"id\":") == 12, "每个容器每个阶段一条 span");
+    TEST_ASSERT(count_substr(sink.data, "\"cat\":\"phase\"") == 5, "每个阶段一条 span");
+    TEST_ASSERT(strncmp(sink.data, "{\"traceEvents\":[", 16) == 0 &&
+                strcmp(sink.data + sink.size - 4, "\n]}\n") == 0, "输出完整的 JSON 对象");
+    TEST_ASSERT(strstr(sink.data, "\"id\":1,\"display\":\"flex\",\"children\":10,\"tag\":\"row \\\"main\\\"\"") != NULL,
+                "args 包含 id、display、子元素数量与转义后的标签");
+    TEST_ASSERT(strstr(sink.data, "\"id\":5,") == NULL, "叶子不产生 span");
+
+    double root_ts, root_dur, row_ts, row_dur;
+    bool found = find_span(sink.data, "calc_x", 0, &root_ts, &root_dur) &&
+                 find_span(sink.data, "calc_x", 1, &row_ts, &row_dur);
+    TEST_ASSERT(found && row_ts >= root_ts && row_ts + row_dur <= root_ts + root_dur + 0.001,
+                "尺寸计算 span 覆盖子树并正确嵌套");
+    found = find_span(sink.data, "arrange_y", 0, &root_ts, &root_dur) &&
+            find_span(sink.data, "arrange_y", 12, &row_ts, &row_dur);
+    TEST_ASSERT(found && row_ts >= root_ts && row_ts + row_dur <= root_ts + root_dur + 0.001,
+                "排列 span 覆盖子树并正确嵌套");
+
+    free(sink.data);
+    layx_destroy_context(&ctx);
+}
+
+void test_threshold() {
+    printf("\n=== Test: sampling threshold ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id leaf;
+    build_tree(&ctx, &leaf);
+
+    trace_sink sink = { NULL, 0, 0 };
+    layx_trace_config config = { sink_write, NULL, &sink, NULL, 60ull * 1000000000ull };
+    layx_trace_begin(&ctx, &config);
+    layx_run_context(&ctx);
+    TEST_ASSERT(layx_trace_end(&ctx) == 0 && strstr(sink.data, "\"args\":{\"id\":") == NULL, "低于阈值的容器不写出");
+    TEST_ASSERT(count_substr(sink.data, "\"cat\":\"phase\"") == 5, "阶段 span 不受阈值影响");
+
+    free(sink.data);
+    layx_destroy_context(&ctx);
+}
+
+void test_step_and_dirty_runs() {
+    printf("\n=== Test: time-sliced and boundary runs ===\n");
+
+    layx_context ctx, plain;
+    layx_init_context(&ctx);
+    layx_init_context(&plain);
+    layx_id leaf;
+    build_tree(&ctx, &leaf);
+    build_tree(&plain, &leaf);
+
+    trace_sink sink = { NULL, 0, 0 };
+    layx_trace_config config = { sink_write, NULL, &sink, NULL, 0 };
+    layx_trace_begin(&ctx, &config);
+    int calls = 0;
+    while (layx_run_context_step(&ctx, 3, 0) == LAYX_STEP_IN_PROGRESS) calls++;
+    layx_trace_end(&ctx);
+    layx_run_context(&plain);
+    TEST_ASSERT(calls > 1 && count_substr(sink.data, "\"args\":{\"id\":") == 12, "分步布局写出的容器 span 与完整布局相同");
+
+    bool same = true;
+    for (layx_id i = 0; i < layx_items_count(&ctx); i++) {
+        layx_vec4 ra = layx_get_rect(&ctx, i);
+        layx_vec4 rb = layx_get_rect(&plain, i);
+        for (int k = 0; k < 4; k++) {
+            if (!FLOAT_EQUAL(ra[k], rb[k], 0.001f)) same = false;
+        }
+    }
+    TEST_ASSERT(same, "记录不影响布局结果");
+
+    // 只有 contain 面板为脏；输出先写入缓冲区，结束记录后才能检查
+    const size_t before = sink.size;
+    layx_trace_begin(&ctx, &config);
+    layx_set_height(&ctx, leaf, 20);
+    layx_run_dirty(&ctx);
+    layx_trace_end(&ctx);
+    const char *tail = sink.data + before;
+    TEST_ASSERT(count_substr(tail, "\"args\":{\"id\":12,") == 4 && count_substr(tail, "\"args\":{\"id\":") == 4,
+                "脏边界布局只写出边界子树");
+    TEST_ASSERT(count_substr(tail, "\"cat\":\"phase\"") == 5, "边界布局同样写出阶段 span");
+
+    free(sink.data);
+    layx_destroy_context(&ctx);
+    layx_destroy_context(&plain);
+}
+
+// 超长且每个字符都要转义的标签
+static char long_tag_text[200];
+
+static const char *long_tag(void *user_data, layx_id item)
+{
+    (void)user_data;
+    (void)item;
+    return long_tag_text;
+}
+
+void test_escaped_long_tag() {
+    printf("\n=== Test: longest escaped tag ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id leaf;
+    build_tree(&ctx, &leaf);
+
+    memset(long_tag_text, '\x01', sizeof(long_tag_text) - 1);
+    trace_sink sink = { NULL, 0, 0 };
+    layx_trace_config config = { sink_write, NULL, &sink, long_tag, 0 };
+    layx_trace_begin(&ctx, &config);
+    layx_run_context(&ctx);
+    layx_trace_end(&ctx);
+
+    TEST_ASSERT(json_valid(sink.data), "输出仍是合法的 JSON");
+    TEST_ASSERT(count_substr(sink.data, "\"args\":{\"id\":") == 12, "所有 span 完整写出");
+    char escaped[64 * 6 + 1];
+    for (int i = 0; i < 64; i++) memcpy(escaped + i * 6, "\\u0001", 6);
+    escaped[64 * 6] = '\0';
+    char expected[64 * 6 + 16];
+    snprintf(expected, sizeof(expected), "\"tag\":\"%s\"}", escaped);
+    TEST_ASSERT(strstr(sink.data, expected) != NULL, "标签截断为 64 个字符并完整转义");
+
+    free(sink.data);
+    layx_destroy_context(&ctx);
+}
+
+void test_file_output() {
+    printf("\n=== Test: file output ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id leaf;
+    build_tree(&ctx, &leaf);
+
+    const char *path = "test_trace_output.json";
+    layx_trace_config config = { NULL, path, NULL, NULL, 0 };
+    TEST_ASSERT(layx_trace_begin(&ctx, &config) == 0, "打开文件");
+    for (int i = 0; i < 50; i++) {
+        layx_set_width(&ctx, 0, (layx_scalar)(100 + i));
+        layx_run_context(&ctx);
+    }
+    TEST_ASSERT(layx_trace_end(&ctx) == 50 * 12, "每轮布局都写出");
+
+    FILE *file = fopen(path, "rb");
+    char tail[8] = { 0 };
+    long size = 0;
+    if (file != NULL) {
+        fseek(file, 0, SEEK_END);
+        size = ftell(file);
+        fseek(file, -4, SEEK_END);
+        fread(tail, 1, 4, file);
+        fclose(file);
+    }
+    TEST_ASSERT(size > 8192 && strcmp(tail, "\n]}\n") == 0, "超过缓冲区的输出完整写入文件");
+    remove(path);
+
+    layx_trace_config bad = { NULL, "no_such_dir/trace.json", NULL, NULL, 0 };
+    TEST_ASSERT(layx_trace_begin(&ctx, &bad) == -1 && !layx_trace_active(&ctx), "无法打开文件时返回 -1");
+
+    // 销毁上下文时结束进行中的记录
+    trace_sink sink = { NULL, 0, 0 };
+    layx_trace_config open_config = { sink_write, NULL, &sink, NULL, 0 };
+    layx_trace_begin(&ctx, &open_config);
+    layx_destroy_context(&ctx);
+    TEST_ASSERT(sink.size > 0 && strcmp(sink.data + sink.size - 4, "\n]}\n") == 0, "销毁上下文时写出结尾");
+    free(sink.data);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Layout Trace\n");
+    printf("========================================\n");
+
+    test_callback_output();
+    test_threshold();
+    test_step_and_dirty_runs();
+    test_escaped_long_tag();
+    test_file_output();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
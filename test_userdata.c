@@ -0,0 +1,357 @@
+/**
+ * @file test_userdata.c
+ * @brief 测试 item 的 user_data / tag 以及带出它们的命中测试、双缓冲帧与变更流
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "layx.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FLOAT_EQUAL(a, b, epsilon) (fabs((a) - (b)) < (epsilon))
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (condition) { \
+            printf("  ✓ %s\n", message); \
+            tests_passed++; \
+        } else { \
+            printf("  ✗ %s\n", message); \
+            tests_failed++; \
+        } \
+    } while(0)
+
+// 宿主侧的 widget，user_data 指向它
+typedef struct widget {
+    const char *name;
+} widget;
+
+static widget widgets[16];
+
+typedef struct scene {
+    layx_id root;
+    layx_id header;
+    layx_id list;
+    layx_id lines[6];
+    layx_id badge;
+} scene;
+
+static void bind(layx_context *ctx, layx_id item, int index)
+{
+    layx_set_user_data(ctx, item, &widgets[index]);
+    layx_set_tag(ctx, item, 100u + (uint32_t)index);
+}
+
+// 根 400x300，列方向：头部 50 高，列表 90 高且可滚动（6 行 × 30），绝对定位的角标盖住头部右侧
+static void build_scene(layx_context *ctx, scene *s)
+{
+    s->root = layx_item(ctx);
+    layx_set_display(ctx, s->root, LAYX_DISPLAY_FLEX);
+    layx_set_flex_direction(ctx, s->root, LAYX_FLEX_DIRECTION_COLUMN);
+    layx_set_size(ctx, s->root, 400, 300);
+    bind(ctx, s->root, 0);
+
+    s->header = layx_item(ctx);
+    layx_set_height(ctx, s->header, 50);
+    layx_set_flex_shrink(ctx, s->header, 0);
+    layx_append(ctx, s->root, s->header);
+    bind(ctx, s->header, 1);
+
+    s->list = layx_item(ctx);
+    layx_set_display(ctx, s->list, LAYX_DISPLAY_BLOCK);
+    layx_set_height(ctx, s->list, 90);
+    layx_set_flex_shrink(ctx, s->list, 0);
+    layx_set_overflow(ctx, s->list, LAYX_OVERFLOW_SCROLL);
+    layx_append(ctx, s->root, s->list);
+    bind(ctx, s->list, 2);
+    for (int i = 0; i < 6; i++) {
+        s->lines[i] = layx_item(ctx);
+        layx_set_height(ctx, s->lines[i], 30);
+        layx_append(ctx, s->list, s->lines[i]);
+        bind(ctx, s->lines[i], 3 + i);
+    }
+
+    s->badge = layx_item(ctx);
+    layx_set_position_type(ctx, s->badge, LAYX_POSITION_ABSOLUTE);
+    layx_set_position_lt(ctx, s->badge, 350, 10);
+    layx_set_size(ctx, s->badge, 40, 30);
+    layx_append(ctx, s->root, s->badge);
+    bind(ctx, s->badge, 10);
+
+    layx_run_context(ctx);
+}
+
+void test_accessors() {
+    printf("\n=== Test: user data and tag accessors ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id root = layx_item(&ctx);
+    layx_id child = layx_item(&ctx);
+    layx_append(&ctx, root, child);
+    TEST_ASSERT(layx_get_user_data(&ctx, child) == NULL && layx_get_tag(&ctx, child) == 0, "新建 item 为 NULL / 0");
+
+    layx_run_context(&ctx);
+    layx_set_user_data(&ctx, child, &widgets[1]);
+    layx_set_tag(&ctx, child, 0xDEADBEEFu);
+    TEST_ASSERT(layx_get_user_data(&ctx, child) == &widgets[1] && layx_get_tag(&ctx, child) == 0xDEADBEEFu, "读回设置的值");
+    TEST_ASSERT(!(ctx.items[child].flags & LAYX_ITEM_DIRTY) && !(ctx.items[root].flags & LAYX_ITEM_DIRTY), "设置不标脏");
+
+    layx_id copy = layx_clone_subtree(&ctx, child);
+    TEST_ASSERT(layx_get_user_data(&ctx, copy) == &widgets[1] && layx_get_tag(&ctx, copy) == 0xDEADBEEFu, "克隆原样复制");
+
+    layx_destroy_item(&ctx, child);
+    layx_id reused = layx_item(&ctx);
+    TEST_ASSERT(reused == child && layx_get_user_data(&ctx, reused) == NULL && layx_get_tag(&ctx, reused) == 0,
+                "复用的 item 重新置零");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_hit_test_item() {
+    printf("\n=== Test: hit test returns the topmost item with its data ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    scene s;
+    build_scene(&ctx, &s);
+
+    layx_hit hit = layx_hit_test_item(&ctx, s.root, 20, 20);
+    TEST_ASSERT(hit.item == s.header && hit.tag == 101 && hit.user_data == &widgets[1], "命中头部并带出 tag 与 user_data");
+
+    hit = layx_hit_test_item(&ctx, s.root, 360, 20);
+    TEST_ASSERT(hit.item == s.badge && hit.tag == 110, "后绘制的兄弟优先");
+
+    hit = layx_hit_test_item(&ctx, s.root, 20, 65);
+    TEST_ASSERT(hit.item == s.lines[0] && ((widget*)hit.user_data) == &widgets[3], "子元素优先于父元素");
+
+    hit = layx_hit_test_item(&ctx, s.root, 20, 250);
+    TEST_ASSERT(hit.item == s.root && hit.tag == 100, "只落在根上时返回根");
+
+    hit = layx_hit_test_item(&ctx, s.root, 410, 20);
+    TEST_ASSERT(hit.item == LAYX_INVALID_ID && hit.tag == 0 && hit.user_data == NULL, "根外没有命中");
+
+    // 列表 y 范围 [50, 140)，第 4 行（y 140..170）溢出到列表外，被裁剪
+    hit = layx_hit_test_item(&ctx, s.root, 20, 150);
+    TEST_ASSERT(hit.item == s.root, "滚动容器裁剪溢出的子元素");
+
+    // 从子树开始查找时只考虑该子树
+    hit = layx_hit_test_item(&ctx, s.list, 360, 20);
+    TEST_ASSERT(hit.item == LAYX_INVALID_ID, "子树外没有命中");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_hit_test_scrolled() {
+    printf("\n=== Test: hit test follows scroll offsets ===\n");
+
+    // 滚动范围只在布局的根上计算，这里让列表本身作为根
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_id list = layx_item(&ctx);
+    layx_set_display(&ctx, list, LAYX_DISPLAY_BLOCK);
+    layx_set_size(&ctx, list, 400, 90);
+    layx_set_overflow(&ctx, list, LAYX_OVERFLOW_SCROLL);
+    layx_id lines[6];
+    for (int i = 0; i < 6; i++) {
+        lines[i] = layx_item(&ctx);
+        layx_set_height(&ctx, lines[i], 30);
+        layx_append(&ctx, list, lines[i]);
+        bind(&ctx, lines[i], 3 + i);
+    }
+    layx_run_context(&ctx);
+
+    // 滚动 45 后，y = 5 对应内容中的 y = 50，落在第 2 行（30..60）
+    layx_scroll_to(&ctx, list, 0, 45);
+    layx_hit hit = layx_hit_test_item(&ctx, list, 20, 5);
+    TEST_ASSERT(hit.item == lines[1] && hit.tag == 104, "考虑滚动偏移");
+    hit = layx_hit_test_item(&ctx, list, 20, 85);
+    TEST_ASSERT(hit.item == lines[4] && hit.user_data == &widgets[7], "滚动后露出原先被裁剪的行");
+    hit = layx_hit_test_item(&ctx, list, 20, 100);
+    TEST_ASSERT(hit.item == LAYX_INVALID_ID, "容器外的内容不命中");
+
+    layx_destroy_context(&ctx);
+}
+
+static layx_vec2 shift_screen(layx_vec2 screen_pos)
+{
+    layx_vec2 local = screen_pos;
+    local[0] -= 100;
+    local[1] -= 100;
+    return local;
+}
+
+void test_hit_test_screen_transform() {
+    printf("\n=== Test: hit test applies screen_to_local_fn ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    scene s;
+    build_scene(&ctx, &s);
+    ctx.screen_to_local_fn = shift_screen;
+
+    layx_hit hit = layx_hit_test_item(&ctx, s.root, 120, 120);
+    TEST_ASSERT(hit.item == s.header, "先转换到本地坐标");
+    hit = layx_hit_test_item(&ctx, s.root, 20, 20);
+    TEST_ASSERT(hit.item == LAYX_INVALID_ID, "转换后落在根外");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_published_frame() {
+    printf("\n=== Test: published frames carry tags and user data ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    scene s;
+    build_scene(&ctx, &s);
+    layx_set_double_buffered(&ctx, true);
+    layx_publish(&ctx);
+
+    const layx_frame *frame = layx_acquire_frame(&ctx);
+    bool same = frame->count == layx_items_count(&ctx);
+    for (layx_id i = 0; same && i < frame->count; i++) {
+        same = frame->tags[i] == layx_get_tag(&ctx, i) && frame->user_data[i] == layx_get_user_data(&ctx, i);
+    }
+    TEST_ASSERT(same, "帧中的 tag 与 user_data 与上下文一致");
+
+    // 发布之后的修改不影响已取得的帧
+    layx_set_tag(&ctx, s.header, 7);
+    TEST_ASSERT(frame->tags[s.header] == 101, "已发布的帧不受后续修改影响");
+    layx_publish(&ctx);
+    frame = layx_acquire_frame(&ctx);
+    TEST_ASSERT(frame->tags[s.header] == 7, "下一帧带出新的 tag");
+
+    layx_destroy_context(&ctx);
+}
+
+static uint8_t buffer[16 * 1024];
+static float mirror[64 * 4];
+static uint32_t mirror_tags[64];
+
+static bool mirrors_match(layx_context *ctx)
+{
+    for (layx_id i = 0; i < layx_items_count(ctx); i++) {
+        layx_vec4 rect = layx_get_rect(ctx, i);
+        for (int k = 0; k < 4; k++) {
+            if (!FLOAT_EQUAL(mirror[i * 4 + k], rect[k], 0.001f)) return false;
+        }
+        if (mirror_tags[i] != layx_get_tag(ctx, i)) return false;
+    }
+    return true;
+}
+
+void test_delta_tags() {
+    printf("\n=== Test: delta stream carries tags ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    layx_delta_enable(&ctx, true);
+    layx_delta_include_tags(&ctx, true);
+    scene s;
+    build_scene(&ctx, &s);
+
+    layx_delta_info info;
+    const size_t bound = layx_delta_bound(&ctx);
+    size_t size = layx_delta_write(&ctx, buffer, sizeof(buffer));
+    TEST_ASSERT(size > 0 && layx_delta_read_header(buffer, size, &info) == 0, "写出关键帧");
+    TEST_ASSERT(info.flags == (LAYX_DELTA_FLAG_RESET | LAYX_DELTA_FLAG_TAGS) &&
+                size == LAYX_DELTA_HEADER_SIZE + 4 * info.created_count + LAYX_DELTA_TAGGED_RECORD_SIZE * info.changed_count,
+                "记录带 tag，长度 24 字节");
+    TEST_ASSERT(size == bound, "关键帧恰好写满 bound");
+    TEST_ASSERT(layx_delta_apply_tags(buffer, size, mirror, mirror_tags, 64) == (int)layx_items_count(&ctx) &&
+                mirrors_match(&ctx), "重建 rect 与 tag 镜像");
+
+    // 只改 tag 也产生变更记录
+    layx_set_tag(&ctx, s.lines[2], 42);
+    size = layx_delta_write(&ctx, buffer, sizeof(buffer));
+    layx_delta_read_header(buffer, size, &info);
+    TEST_ASSERT(info.flags == LAYX_DELTA_FLAG_TAGS && info.changed_count == 1, "只改变 tag 的 item 写出一条记录");
+    layx_delta_apply_tags(buffer, size, mirror, mirror_tags, 64);
+    TEST_ASSERT(mirror_tags[s.lines[2]] == 42 && mirrors_match(&ctx), "tag 镜像更新");
+
+    // 不关心 tag 的消费端照常应用
+    static float plain[64 * 4];
+    layx_set_width(&ctx, s.root, 380);
+    layx_run_context(&ctx);
+    size = layx_delta_write(&ctx, buffer, sizeof(buffer));
+    TEST_ASSERT(layx_delta_apply(buffer, size, plain, 64) > 0 &&
+                FLOAT_EQUAL(plain[s.header * 4 + 2], 380, 0.001f), "layx_delta_apply 按记录长度跳过 tag");
+    layx_delta_apply_tags(buffer, size, mirror, mirror_tags, 64);
+    TEST_ASSERT(mirrors_match(&ctx), "rect 变更后镜像一致");
+
+    // 新建的 id 在镜像中清零后写入新 tag
+    layx_id extra = layx_item(&ctx);
+    layx_set_tag(&ctx, extra, 9);
+    layx_append(&ctx, s.header, extra);
+    layx_run_context(&ctx);
+    size = layx_delta_write(&ctx, buffer, sizeof(buffer));
+    layx_delta_apply_tags(buffer, size, mirror, mirror_tags, 64);
+    TEST_ASSERT(mirror_tags[extra] == 9 && mirrors_match(&ctx), "新建 item 的 tag 写入镜像");
+
+    // 关闭后回到 20 字节记录，并从关键帧开始
+    layx_delta_include_tags(&ctx, false);
+    size = layx_delta_write(&ctx, buffer, sizeof(buffer));
+    layx_delta_read_header(buffer, size, &info);
+    TEST_ASSERT(info.flags == LAYX_DELTA_FLAG_RESET &&
+                size == LAYX_DELTA_HEADER_SIZE + LAYX_DELTA_RECORD_SIZE * info.changed_count, "关闭后写出不带 tag 的关键帧");
+    layx_set_tag(&ctx, s.header, 5);
+    size = layx_delta_write(&ctx, buffer, sizeof(buffer));
+    layx_delta_read_header(buffer, size, &info);
+    TEST_ASSERT(info.changed_count == 0, "关闭后 tag 变化不产生记录");
+
+    layx_destroy_context(&ctx);
+}
+
+void test_snapshot() {
+    printf("\n=== Test: snapshots keep tags and drop user data ===\n");
+
+    layx_context ctx;
+    layx_init_context(&ctx);
+    scene s;
+    build_scene(&ctx, &s);
+
+    const size_t size = layx_snapshot_size(&ctx);
+    void *data = malloc(size);
+    layx_write_snapshot(&ctx, data, size);
+    TEST_ASSERT(layx_get_user_data(&ctx, s.header) == &widgets[1], "保存不修改原上下文");
+
+    layx_context loaded;
+    layx_init_context(&loaded);
+    TEST_ASSERT(layx_load_snapshot_buffer(&loaded, data, size) == 0, "加载快照");
+    TEST_ASSERT(layx_get_tag(&loaded, s.badge) == 110 && layx_get_user_data(&loaded, s.badge) == NULL,
+                "tag 保留，user_data 清零");
+    layx_hit hit = layx_hit_test_item(&loaded, s.root, 20, 20);
+    TEST_ASSERT(hit.item == s.header && hit.tag == 101 && hit.user_data == NULL, "加载后按 tag 命中");
+
+    layx_destroy_context(&loaded);
+    layx_destroy_context(&ctx);
+    free(data);
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Testing: Item User Data and Tags\n");
+    printf("========================================\n");
+
+    test_accessors();
+    test_hit_test_item();
+    test_hit_test_scrolled();
+    test_hit_test_screen_transform();
+    test_published_frame();
+    test_delta_tags();
+    test_snapshot();
+
+    printf("\n========================================\n");
+    printf("Test Results:\n");
+    printf("  Passed: %d\n", tests_passed);
+    printf("  Failed: %d\n", tests_failed);
+    printf("========================================\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}